@@ -0,0 +1,474 @@
+#ifndef _CORE_AABB_TREE_
+#define _CORE_AABB_TREE_
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "Vector.h"
+
+//\brief Dynamic bounding volume hierarchy of axis aligned boxes. Each proxy is stored with a fattened box so small
+//		 movements don't touch the tree at all, a proxy that leaves its fat box is taken out and reinserted where it
+//		 adds the least surface area. Tree rotations on the way back up keep it balanced.
+class AabbTree
+{
+public:
+
+	static const int s_nullNode = -1;
+	static const unsigned int s_packetSize = 16;		///< Rays traversed together by a batched cast
+
+	//\brief A ray segment to cast into the tree
+	struct Ray
+	{
+		Vector m_start{ 0.0f };
+		Vector m_dir{ 0.0f };							///< Normalised direction
+		float m_length{ 0.0f };							///< How far along the direction the ray reaches
+	};
+
+	//\brief Set how far boxes are fattened when inserted, bigger means fewer reinserts but looser queries
+	inline void SetMargin(float a_margin) { m_margin = a_margin; }
+
+	//\brief Add a box to the tree
+	//\return the id of the new proxy to move and destroy it with
+	int CreateProxy(const Vector & a_min, const Vector & a_max, void * a_userData)
+	{
+		const int proxyId = AllocateNode();
+		Node & node = m_nodes[proxyId];
+		SetFatBounds(node, a_min, a_max);
+		node.m_userData = a_userData;
+		node.m_height = 0;
+		InsertLeaf(proxyId);
+		++m_numProxies;
+		return proxyId;
+	}
+
+	void DestroyProxy(int a_proxyId)
+	{
+		assert(a_proxyId >= 0 && a_proxyId < (int)m_nodes.size() && m_nodes[a_proxyId].IsLeaf());
+		RemoveLeaf(a_proxyId);
+		FreeNode(a_proxyId);
+		--m_numProxies;
+	}
+
+	//\brief Update the bounds of a proxy, cheap when it has not left its fattened box
+	//\return true if the proxy had to be reinserted
+	bool MoveProxy(int a_proxyId, const Vector & a_min, const Vector & a_max)
+	{
+		Node & node = m_nodes[a_proxyId];
+		if (node.m_min[0] <= a_min.GetX() && node.m_min[1] <= a_min.GetY() && node.m_min[2] <= a_min.GetZ() &&
+			node.m_max[0] >= a_max.GetX() && node.m_max[1] >= a_max.GetY() && node.m_max[2] >= a_max.GetZ())
+		{
+			return false;
+		}
+
+		RemoveLeaf(a_proxyId);
+		SetFatBounds(m_nodes[a_proxyId], a_min, a_max);
+		InsertLeaf(a_proxyId);
+		return true;
+	}
+
+	void Clear()
+	{
+		m_nodes.clear();
+		m_root = s_nullNode;
+		m_freeList = s_nullNode;
+		m_numProxies = 0;
+	}
+
+	inline void * GetUserData(int a_proxyId) const { return m_nodes[a_proxyId].m_userData; }
+	inline unsigned int GetNumProxies() const { return m_numProxies; }
+	inline int GetHeight() const { return m_root == s_nullNode ? 0 : m_nodes[m_root].m_height; }
+
+	//\brief Cast rays into the tree and call back for every proxy whose box a ray passes through.
+	//		 Rays are walked down the tree in packets so nodes that several rays pass through are only visited
+	//		 once per packet, each ray is tested against a node's box and only the rays that hit carry on down.
+	//\param a_callback is called as float(unsigned int a_rayIndex, void * a_userData, float a_length) with
+	//		 the ray's current length and returns the length to clip the ray to. Return the length passed in
+	//		 to keep going, the distance to a hit to only look for closer hits or zero to stop that ray.
+	template <typename TCallback>
+	void RayCast(const Ray * a_rays, unsigned int a_numRays, TCallback a_callback) const
+	{
+		if (m_root == s_nullNode)
+		{
+			return;
+		}
+
+		float start[s_packetSize][3];
+		float invDir[s_packetSize][3];
+		float length[s_packetSize];
+		int stackNodes[s_maxStackSize];
+		uint32_t stackMasks[s_maxStackSize];
+		for (unsigned int first = 0; first < a_numRays; first += s_packetSize)
+		{
+			const unsigned int numInPacket = (a_numRays - first) < s_packetSize ? (a_numRays - first) : s_packetSize;
+			for (unsigned int i = 0; i < numInPacket; ++i)
+			{
+				const Ray & ray = a_rays[first + i];
+				start[i][0] = ray.m_start.GetX();	start[i][1] = ray.m_start.GetY();	start[i][2] = ray.m_start.GetZ();
+				invDir[i][0] = GetInverse(ray.m_dir.GetX());
+				invDir[i][1] = GetInverse(ray.m_dir.GetY());
+				invDir[i][2] = GetInverse(ray.m_dir.GetZ());
+				length[i] = ray.m_length;
+			}
+
+			int stackSize = 0;
+			stackNodes[stackSize] = m_root;
+			stackMasks[stackSize++] = (1u << numInPacket) - 1;
+			while (stackSize > 0)
+			{
+				--stackSize;
+				const Node & node = m_nodes[stackNodes[stackSize]];
+				uint32_t hitMask = 0;
+				for (uint32_t mask = stackMasks[stackSize]; mask != 0; mask &= mask - 1)
+				{
+					const unsigned int i = CountTrailingZeros(mask);
+					if (length[i] > 0.0f && IntersectRay(node, start[i], invDir[i], length[i]))
+					{
+						hitMask |= 1u << i;
+					}
+				}
+				if (hitMask == 0)
+				{
+					continue;
+				}
+
+				if (node.IsLeaf())
+				{
+					for (uint32_t mask = hitMask; mask != 0; mask &= mask - 1)
+					{
+						const unsigned int i = CountTrailingZeros(mask);
+						const float clipped = a_callback(first + i, node.m_userData, length[i]);
+						length[i] = clipped < length[i] ? clipped : length[i];
+					}
+				}
+				else
+				{
+					assert(stackSize + 2 <= (int)s_maxStackSize);
+					stackNodes[stackSize] = node.m_child2;
+					stackMasks[stackSize++] = hitMask;
+					stackNodes[stackSize] = node.m_child1;
+					stackMasks[stackSize++] = hitMask;
+				}
+			}
+		}
+	}
+
+private:
+
+	//\brief Leaves hold the proxies, branches always have two children. Free nodes use m_parent as the next free node.
+	struct Node
+	{
+		inline bool IsLeaf() const { return m_child1 == s_nullNode; }
+
+		float m_min[3]{ 0.0f, 0.0f, 0.0f };
+		float m_max[3]{ 0.0f, 0.0f, 0.0f };
+		void * m_userData{ nullptr };
+		int m_parent{ s_nullNode };
+		int m_child1{ s_nullNode };
+		int m_child2{ s_nullNode };
+		int m_height{ -1 };								///< Zero for leaves, -1 for free nodes
+	};
+
+	static const unsigned int s_maxStackSize = 128;		///< Balanced trees this deep would hold far more objects than a scene has
+
+	inline static float GetInverse(float a_value)
+	{
+		// A huge value keeps the slab maths free of the NaNs that infinity times zero would make
+		return a_value != 0.0f ? 1.0f / a_value : (a_value < 0.0f ? -1e30f : 1e30f);
+	}
+
+	inline static unsigned int CountTrailingZeros(uint32_t a_mask)
+	{
+		unsigned int count = 0;
+		while ((a_mask & 1u) == 0)
+		{
+			a_mask >>= 1;
+			++count;
+		}
+		return count;
+	}
+
+	inline static bool IntersectRay(const Node & a_node, const float * a_start, const float * a_invDir, float a_length)
+	{
+		float tMin = 0.0f;
+		float tMax = a_length;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float t1 = (a_node.m_min[axis] - a_start[axis]) * a_invDir[axis];
+			float t2 = (a_node.m_max[axis] - a_start[axis]) * a_invDir[axis];
+			if (t1 > t2)
+			{
+				const float swap = t1;
+				t1 = t2;
+				t2 = swap;
+			}
+			tMin = t1 > tMin ? t1 : tMin;
+			tMax = t2 < tMax ? t2 : tMax;
+			if (tMin > tMax)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline static float GetSurfaceArea(const float * a_min, const float * a_max)
+	{
+		const float x = a_max[0] - a_min[0];
+		const float y = a_max[1] - a_min[1];
+		const float z = a_max[2] - a_min[2];
+		return 2.0f * (x * y + y * z + z * x);
+	}
+
+	inline static void Combine(const Node & a_nodeA, const Node & a_nodeB, float * a_min_OUT, float * a_max_OUT)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			a_min_OUT[axis] = a_nodeA.m_min[axis] < a_nodeB.m_min[axis] ? a_nodeA.m_min[axis] : a_nodeB.m_min[axis];
+			a_max_OUT[axis] = a_nodeA.m_max[axis] > a_nodeB.m_max[axis] ? a_nodeA.m_max[axis] : a_nodeB.m_max[axis];
+		}
+	}
+
+	inline static float GetCombinedArea(const Node & a_nodeA, const Node & a_nodeB)
+	{
+		float combinedMin[3], combinedMax[3];
+		Combine(a_nodeA, a_nodeB, combinedMin, combinedMax);
+		return GetSurfaceArea(combinedMin, combinedMax);
+	}
+
+	inline void SetFatBounds(Node & a_node, const Vector & a_min, const Vector & a_max) const
+	{
+		a_node.m_min[0] = a_min.GetX() - m_margin;	a_node.m_min[1] = a_min.GetY() - m_margin;	a_node.m_min[2] = a_min.GetZ() - m_margin;
+		a_node.m_max[0] = a_max.GetX() + m_margin;	a_node.m_max[1] = a_max.GetY() + m_margin;	a_node.m_max[2] = a_max.GetZ() + m_margin;
+	}
+
+	inline void UpdateBranch(int a_index)
+	{
+		Node & node = m_nodes[a_index];
+		const Node & child1 = m_nodes[node.m_child1];
+		const Node & child2 = m_nodes[node.m_child2];
+		Combine(child1, child2, node.m_min, node.m_max);
+		node.m_height = 1 + (child1.m_height > child2.m_height ? child1.m_height : child2.m_height);
+	}
+
+	int AllocateNode()
+	{
+		if (m_freeList == s_nullNode)
+		{
+			m_nodes.emplace_back();
+			return (int)m_nodes.size() - 1;
+		}
+		const int index = m_freeList;
+		m_freeList = m_nodes[index].m_parent;
+		m_nodes[index] = Node();
+		return index;
+	}
+
+	void FreeNode(int a_index)
+	{
+		Node & node = m_nodes[a_index];
+		node.m_parent = m_freeList;
+		node.m_height = -1;
+		node.m_userData = nullptr;
+		m_freeList = a_index;
+	}
+
+	void InsertLeaf(int a_leaf)
+	{
+		if (m_root == s_nullNode)
+		{
+			m_root = a_leaf;
+			m_nodes[a_leaf].m_parent = s_nullNode;
+			return;
+		}
+
+		// Walk down to the sibling that makes the new parent's box and the growth of its ancestors the smallest
+		const Node & leaf = m_nodes[a_leaf];
+		int index = m_root;
+		while (!m_nodes[index].IsLeaf())
+		{
+			const Node & node = m_nodes[index];
+			const float area = GetSurfaceArea(node.m_min, node.m_max);
+			const float combinedArea = GetCombinedArea(node, leaf);
+
+			// Cost of making a new parent for this node and the leaf, and the minimum cost of pushing it further down
+			const float cost = 2.0f * combinedArea;
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+			const float cost1 = GetDescendCost(m_nodes[node.m_child1], leaf) + inheritanceCost;
+			const float cost2 = GetDescendCost(m_nodes[node.m_child2], leaf) + inheritanceCost;
+			if (cost < cost1 && cost < cost2)
+			{
+				break;
+			}
+			index = cost1 < cost2 ? node.m_child1 : node.m_child2;
+		}
+
+		const int sibling = index;
+		const int oldParent = m_nodes[sibling].m_parent;
+		const int newParent = AllocateNode();
+		{
+			Node & parent = m_nodes[newParent];
+			Combine(m_nodes[a_leaf], m_nodes[sibling], parent.m_min, parent.m_max);
+			parent.m_parent = oldParent;
+			parent.m_height = m_nodes[sibling].m_height + 1;
+			parent.m_child1 = sibling;
+			parent.m_child2 = a_leaf;
+		}
+		if (oldParent != s_nullNode)
+		{
+			Node & grandParent = m_nodes[oldParent];
+			if (grandParent.m_child1 == sibling)
+			{
+				grandParent.m_child1 = newParent;
+			}
+			else
+			{
+				grandParent.m_child2 = newParent;
+			}
+		}
+		else
+		{
+			m_root = newParent;
+		}
+		m_nodes[sibling].m_parent = newParent;
+		m_nodes[a_leaf].m_parent = newParent;
+
+		FixUpwards(m_nodes[a_leaf].m_parent);
+	}
+
+	inline float GetDescendCost(const Node & a_child, const Node & a_leaf) const
+	{
+		const float combinedArea = GetCombinedArea(a_child, a_leaf);
+		return a_child.IsLeaf() ? combinedArea : combinedArea - GetSurfaceArea(a_child.m_min, a_child.m_max);
+	}
+
+	void RemoveLeaf(int a_leaf)
+	{
+		if (a_leaf == m_root)
+		{
+			m_root = s_nullNode;
+			return;
+		}
+
+		// The leaf's parent goes and the sibling takes its place
+		const int parent = m_nodes[a_leaf].m_parent;
+		const int grandParent = m_nodes[parent].m_parent;
+		const int sibling = m_nodes[parent].m_child1 == a_leaf ? m_nodes[parent].m_child2 : m_nodes[parent].m_child1;
+		if (grandParent != s_nullNode)
+		{
+			Node & grandParentNode = m_nodes[grandParent];
+			if (grandParentNode.m_child1 == parent)
+			{
+				grandParentNode.m_child1 = sibling;
+			}
+			else
+			{
+				grandParentNode.m_child2 = sibling;
+			}
+			m_nodes[sibling].m_parent = grandParent;
+			FreeNode(parent);
+			FixUpwards(grandParent);
+		}
+		else
+		{
+			m_root = sibling;
+			m_nodes[sibling].m_parent = s_nullNode;
+			FreeNode(parent);
+		}
+	}
+
+	//\brief Rebalance and refit every ancestor from a node up to the root
+	void FixUpwards(int a_index)
+	{
+		while (a_index != s_nullNode)
+		{
+			a_index = Balance(a_index);
+			UpdateBranch(a_index);
+			a_index = m_nodes[a_index].m_parent;
+		}
+	}
+
+	//\brief Rotate a child up if one side is more than one level taller than the other
+	//\return the index of the node that is now at the top of this part of the tree
+	int Balance(int a_indexA)
+	{
+		Node & nodeA = m_nodes[a_indexA];
+		if (nodeA.IsLeaf() || nodeA.m_height < 2)
+		{
+			return a_indexA;
+		}
+
+		const int indexB = nodeA.m_child1;
+		const int indexC = nodeA.m_child2;
+		const int balance = m_nodes[indexC].m_height - m_nodes[indexB].m_height;
+		if (balance > 1)
+		{
+			RotateUp(a_indexA, indexC, false);
+			return indexC;
+		}
+		if (balance < -1)
+		{
+			RotateUp(a_indexA, indexB, true);
+			return indexB;
+		}
+		return a_indexA;
+	}
+
+	//\brief Swap a node with one of its children, the child's taller grandchild stays with it
+	//\param a_isChild1 is true if the child is on the first side of the node
+	void RotateUp(int a_indexA, int a_indexChild, bool a_isChild1)
+	{
+		Node & nodeA = m_nodes[a_indexA];
+		Node & child = m_nodes[a_indexChild];
+		const int indexF = child.m_child1;
+		const int indexG = child.m_child2;
+
+		// The child takes the node's place under its parent
+		child.m_child1 = a_indexA;
+		child.m_parent = nodeA.m_parent;
+		nodeA.m_parent = a_indexChild;
+		if (child.m_parent != s_nullNode)
+		{
+			Node & parent = m_nodes[child.m_parent];
+			if (parent.m_child1 == a_indexA)
+			{
+				parent.m_child1 = a_indexChild;
+			}
+			else
+			{
+				parent.m_child2 = a_indexChild;
+			}
+		}
+		else
+		{
+			m_root = a_indexChild;
+		}
+
+		// The taller grandchild stays with the child and the other one moves across to the node
+		const bool keepF = m_nodes[indexF].m_height > m_nodes[indexG].m_height;
+		const int kept = keepF ? indexF : indexG;
+		const int moved = keepF ? indexG : indexF;
+		child.m_child2 = kept;
+		if (a_isChild1)
+		{
+			nodeA.m_child1 = moved;
+		}
+		else
+		{
+			nodeA.m_child2 = moved;
+		}
+		m_nodes[moved].m_parent = a_indexA;
+		UpdateBranch(a_indexA);
+		UpdateBranch(a_indexChild);
+	}
+
+	std::vector<Node> m_nodes;							///< Leaves and branches, freed nodes are reused
+	int m_root{ s_nullNode };
+	int m_freeList{ s_nullNode };						///< First unused node
+	unsigned int m_numProxies{ 0 };
+	float m_margin{ 0.1f };								///< Distance boxes are fattened by on insertion
+};
+
+#endif // _CORE_AABB_TREE_
@@ -0,0 +1,296 @@
+#ifndef _CORE_DYNAMIC_BODIES_
+#define _CORE_DYNAMIC_BODIES_
+#pragma once
+
+#include <string.h>
+
+#include <vector>
+
+#include "Simd.h"
+#include "SlotMap.h"
+#include "Vector.h"
+
+//\brief State of simulated bodies stored as one array per component so integration can step several bodies with
+//		 each instruction. Bodies are packed at the front of the arrays and found again through handles that stay
+//		 valid until the body is removed, removal moves the last body into the hole. The arrays are padded to a
+//		 whole number of SIMD lanes with bodies that have no mass so the kernels never need a scalar tail.
+//		 Awake bodies are kept in front of sleeping ones so the kernels only walk the bodies that move, a lane
+//		 that straddles the two steps its sleeping bodies with no time.
+class DynamicBodies
+{
+public:
+
+	static const unsigned int s_invalidIndex = SlotMap<void *>::s_invalidIndex;
+
+	//\brief Add a body at rest
+	//\param a_owner is returned by GetOwner so the results can be written back to whatever the body simulates
+	//\return the handle to find the body again with
+	SlotHandle Add(void * a_owner, const Vector & a_pos, float a_mass, float a_linearDrag)
+	{
+		const SlotHandle handle = m_owners.Add(a_owner);
+		if (m_owners.GetCount() > m_capacity)
+		{
+			Grow(m_capacity == 0 ? s_defaultCapacity : m_capacity * 2);
+		}
+		Wake(m_owners.GetCount() - 1);
+		const unsigned int index = m_owners.GetIndex(handle);
+		SetPos(index, a_pos);
+		SetPrevPos(index, a_pos);
+		SetMass(index, a_mass);
+		SetLinearDrag(index, a_linearDrag);
+		return handle;
+	}
+
+	//\brief Remove a body, the last body is moved into its place
+	//\return false if the handle was stale or invalid
+	bool Remove(SlotHandle a_handle)
+	{
+		unsigned int index = m_owners.GetIndex(a_handle);
+		if (index == s_invalidIndex)
+		{
+			return false;
+		}
+
+		// Put the body to sleep first so the hole left is in the sleeping bodies and the awake ones stay together
+		if (IsAwake(index))
+		{
+			index = Sleep(index);
+		}
+		const unsigned int last = m_owners.GetCount() - 1;
+		for (std::vector<float> & component : m_components)
+		{
+			component[index] = component[last];
+			component[last] = 0.0f;
+		}
+		m_owners.Remove(a_handle);
+		return true;
+	}
+
+	void Clear()
+	{
+		m_owners.Clear();
+		m_numAwake = 0;
+		for (std::vector<float> & component : m_components)
+		{
+			memset(component.data(), 0, component.size() * sizeof(float));
+		}
+	}
+
+	//\brief Dense access by index, the order changes when bodies are removed
+	inline unsigned int GetIndex(SlotHandle a_handle) const { return m_owners.GetIndex(a_handle); }
+	inline unsigned int GetCount() const { return m_owners.GetCount(); }
+	inline void * GetOwner(unsigned int a_index) { return m_owners.GetValue(a_index); }
+	inline SlotHandle GetHandle(unsigned int a_index) const { return m_owners.GetHandle(a_index); }
+
+	inline Vector GetPos(unsigned int a_index) const { return GetVector(PosX, a_index); }
+	inline Vector GetPrevPos(unsigned int a_index) const { return GetVector(PrevPosX, a_index); }
+	inline Vector GetVelocity(unsigned int a_index) const { return GetVector(VelX, a_index); }
+	inline Vector GetForce(unsigned int a_index) const { return GetVector(ForceX, a_index); }
+	inline float GetInvMass(unsigned int a_index) const { return m_components[InvMass][a_index]; }
+	inline float GetSleepTime(unsigned int a_index) const { return m_components[SleepTime][a_index]; }
+
+	inline void SetPos(unsigned int a_index, const Vector & a_pos) { SetVector(PosX, a_index, a_pos); }
+	inline void SetPrevPos(unsigned int a_index, const Vector & a_pos) { SetVector(PrevPosX, a_index, a_pos); }
+	inline void SetVelocity(unsigned int a_index, const Vector & a_vel) { SetVector(VelX, a_index, a_vel); }
+	inline void SetForce(unsigned int a_index, const Vector & a_force) { SetVector(ForceX, a_index, a_force); }
+	inline void SetLinearDrag(unsigned int a_index, float a_drag) { m_components[LinearDrag][a_index] = a_drag; }
+
+	//\brief A body without a positive mass is never moved by forces or impulses
+	inline void SetMass(unsigned int a_index, float a_mass) { m_components[InvMass][a_index] = a_mass > 0.0f ? 1.0f / a_mass : 0.0f; }
+
+	//\brief Change the velocity of a body by an impulse scaled by its mass
+	inline void AddImpulse(unsigned int a_index, const Vector & a_impulse)
+	{
+		SetVelocity(a_index, GetVelocity(a_index) + a_impulse * GetInvMass(a_index));
+	}
+
+	//\brief Awake bodies are indices 0 to GetAwakeCount, sleeping bodies follow them
+	inline unsigned int GetAwakeCount() const { return m_numAwake; }
+	inline bool IsAwake(unsigned int a_index) const { return a_index < m_numAwake; }
+
+	//\brief Stop a body moving until it is woken
+	//\return the index the body has moved to
+	unsigned int Sleep(unsigned int a_index)
+	{
+		const unsigned int index = --m_numAwake;
+		SwapBodies(a_index, index);
+		m_components[Awake][index] = 0.0f;
+		SetVelocity(index, Vector::Zero());
+		SetPrevPos(index, GetPos(index));
+		return index;
+	}
+
+	//\brief Start a sleeping body moving again, its sleep time starts counting from zero
+	//\return the index the body has moved to
+	unsigned int Wake(unsigned int a_index)
+	{
+		const unsigned int index = m_numAwake++;
+		SwapBodies(a_index, index);
+		m_components[Awake][index] = 1.0f;
+		m_components[SleepTime][index] = 0.0f;
+		return index;
+	}
+
+	//\brief Count how long each awake body has been moving slower than a speed
+	void UpdateSleepTimes(float a_sleepSpeed, float a_dt)
+	{
+		const float sleepSpeedSq = a_sleepSpeed * a_sleepSpeed;
+		const float * velX = m_components[VelX].data();	const float * velY = m_components[VelY].data();	const float * velZ = m_components[VelZ].data();
+		float * sleepTime = m_components[SleepTime].data();
+		for (unsigned int i = 0; i < m_numAwake; ++i)
+		{
+			const float speedSq = velX[i] * velX[i] + velY[i] * velY[i] + velZ[i] * velZ[i];
+			sleepTime[i] = speedSq < sleepSpeedSq ? sleepTime[i] + a_dt : 0.0f;
+		}
+	}
+
+	//\brief Remember where every awake body is so the step can be blended from it
+	void StorePreviousPositions()
+	{
+		const size_t size = GetPaddedAwakeCount() * sizeof(float);
+		memcpy(m_components[PrevPosX].data(), m_components[PosX].data(), size);
+		memcpy(m_components[PrevPosY].data(), m_components[PosY].data(), size);
+		memcpy(m_components[PrevPosZ].data(), m_components[PosZ].data(), size);
+	}
+
+	//\brief Semi implicit Euler step of every awake body. Gravity only acts along the up axis and is an acceleration so
+	//		 every body falls at the same rate, velocity is damped by the linear drag before moving the position.
+	//		 Bodies with no inverse mass are static and gravity leaves them where they are.
+	void IntegrateEuler(const Vector & a_gravity, float a_dt)
+	{
+		const Simd::Float4 stepDt = Simd::Splat(a_dt);
+		const Simd::Float4 zero = Simd::Splat(0.0f);
+		const Simd::Float4 one = Simd::Splat(1.0f);
+		const Simd::Float4 gravity = Simd::Splat(a_gravity.GetZ());
+		float * posX = m_components[PosX].data();	float * posY = m_components[PosY].data();	float * posZ = m_components[PosZ].data();
+		float * velX = m_components[VelX].data();	float * velY = m_components[VelY].data();	float * velZ = m_components[VelZ].data();
+		const float * forceX = m_components[ForceX].data();	const float * forceY = m_components[ForceY].data();	const float * forceZ = m_components[ForceZ].data();
+		const float * invMass = m_components[InvMass].data();
+		const float * linearDrag = m_components[LinearDrag].data();
+		const float * awake = m_components[Awake].data();
+
+		const unsigned int paddedCount = GetPaddedAwakeCount();
+		for (unsigned int i = 0; i < paddedCount; i += Simd::s_width)
+		{
+			const Simd::Float4 dt = Simd::Mul(stepDt, Simd::Load(awake + i));
+			const Simd::Float4 massScale = Simd::Load(invMass + i);
+			const Simd::Float4 gravityDeltaV = Simd::Select(Simd::CmpLe(massScale, zero), zero, Simd::Mul(gravity, dt));
+			const Simd::Float4 forceScale = Simd::Mul(massScale, dt);
+			const Simd::Float4 damping = Simd::Div(one, Simd::MulAdd(dt, Simd::Load(linearDrag + i), one));
+
+			Simd::Float4 vx = Simd::MulAdd(Simd::Load(forceX + i), forceScale, Simd::Load(velX + i));
+			Simd::Float4 vy = Simd::MulAdd(Simd::Load(forceY + i), forceScale, Simd::Load(velY + i));
+			Simd::Float4 vz = Simd::Add(gravityDeltaV, Simd::Load(velZ + i));
+			vz = Simd::MulAdd(Simd::Load(forceZ + i), forceScale, vz);
+			vx = Simd::Mul(vx, damping);
+			vy = Simd::Mul(vy, damping);
+			vz = Simd::Mul(vz, damping);
+
+			Simd::Store(velX + i, vx);
+			Simd::Store(velY + i, vy);
+			Simd::Store(velZ + i, vz);
+			Simd::Store(posX + i, Simd::MulAdd(vx, dt, Simd::Load(posX + i)));
+			Simd::Store(posY + i, Simd::MulAdd(vy, dt, Simd::Load(posY + i)));
+			Simd::Store(posZ + i, Simd::MulAdd(vz, dt, Simd::Load(posZ + i)));
+		}
+	}
+
+	//\brief Velocity Verlet step of every awake body, acceleration from the last step is kept per body.
+	//		 Gravity is an acceleration like in the Euler step and doesn't act on static bodies.
+	void IntegrateVerlet(const Vector & a_gravity, float a_dt)
+	{
+		const Simd::Float4 stepDt = Simd::Splat(a_dt);
+		const Simd::Float4 zero = Simd::Splat(0.0f);
+		const Simd::Float4 half = Simd::Splat(0.5f);
+		const Simd::Float4 gravity[3] = { Simd::Splat(a_gravity.GetX()), Simd::Splat(a_gravity.GetY()), Simd::Splat(a_gravity.GetZ()) };
+		const float * invMass = m_components[InvMass].data();
+		const float * awake = m_components[Awake].data();
+
+		const unsigned int paddedCount = GetPaddedAwakeCount();
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float * pos = m_components[PosX + axis].data();
+			float * vel = m_components[VelX + axis].data();
+			float * acc = m_components[AccX + axis].data();
+			const float * force = m_components[ForceX + axis].data();
+			for (unsigned int i = 0; i < paddedCount; i += Simd::s_width)
+			{
+				const Simd::Float4 dt = Simd::Mul(stepDt, Simd::Load(awake + i));
+				const Simd::Float4 halfDt = Simd::Mul(dt, half);
+				const Simd::Float4 halfDtSq = Simd::Mul(halfDt, dt);
+				const Simd::Float4 lastAcc = Simd::Load(acc + i);
+				const Simd::Float4 v = Simd::Load(vel + i);
+				const Simd::Float4 massScale = Simd::Load(invMass + i);
+				const Simd::Float4 bodyGravity = Simd::Select(Simd::CmpLe(massScale, zero), zero, gravity[axis]);
+				const Simd::Float4 newAcc = Simd::MulAdd(Simd::Load(force + i), massScale, bodyGravity);
+				Simd::Store(pos + i, Simd::Add(Simd::Load(pos + i), Simd::MulAdd(v, dt, Simd::Mul(lastAcc, halfDtSq))));
+				Simd::Store(vel + i, Simd::MulAdd(Simd::Add(lastAcc, newAcc), halfDt, v));
+				Simd::Store(acc + i, newAcc);
+			}
+		}
+	}
+
+private:
+
+	enum Component
+	{
+		PosX, PosY, PosZ,
+		PrevPosX, PrevPosY, PrevPosZ,
+		VelX, VelY, VelZ,
+		ForceX, ForceY, ForceZ,
+		AccX, AccY, AccZ,
+		InvMass,
+		LinearDrag,
+		SleepTime,
+		Awake,
+		Count,
+	};
+
+	inline unsigned int GetPaddedAwakeCount() const { return (m_numAwake + Simd::s_width - 1) & ~(Simd::s_width - 1); }
+
+	inline void SwapBodies(unsigned int a_indexA, unsigned int a_indexB)
+	{
+		if (a_indexA == a_indexB)
+		{
+			return;
+		}
+		m_owners.Swap(a_indexA, a_indexB);
+		for (std::vector<float> & component : m_components)
+		{
+			const float value = component[a_indexA];
+			component[a_indexA] = component[a_indexB];
+			component[a_indexB] = value;
+		}
+	}
+
+	inline Vector GetVector(int a_firstComponent, unsigned int a_index) const
+	{
+		return Vector(m_components[a_firstComponent][a_index], m_components[a_firstComponent + 1][a_index], m_components[a_firstComponent + 2][a_index]);
+	}
+
+	inline void SetVector(int a_firstComponent, unsigned int a_index, const Vector & a_vec)
+	{
+		m_components[a_firstComponent][a_index] = a_vec.GetX();
+		m_components[a_firstComponent + 1][a_index] = a_vec.GetY();
+		m_components[a_firstComponent + 2][a_index] = a_vec.GetZ();
+	}
+
+	//\brief Capacity is always a whole number of SIMD lanes and new space is zeroed so padding bodies stay still
+	void Grow(unsigned int a_newCapacity)
+	{
+		for (std::vector<float> & component : m_components)
+		{
+			component.resize(a_newCapacity, 0.0f);
+		}
+		m_capacity = a_newCapacity;
+	}
+
+	static const unsigned int s_defaultCapacity = 64;		///< Allocated on first add, must be a multiple of the SIMD width
+
+	SlotMap<void *> m_owners;								///< Hands out handles and keeps the owner of each packed body
+	std::vector<float> m_components[Count];					///< One array per component of the body state
+	unsigned int m_capacity{ 0 };							///< Length of every component array
+	unsigned int m_numAwake{ 0 };							///< Bodies at the front of the arrays that are integrated
+};
+
+#endif // _CORE_DYNAMIC_BODIES_
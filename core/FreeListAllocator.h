@@ -0,0 +1,139 @@
+#ifndef _CORE_FREE_LIST_ALLOCATOR_
+#define _CORE_FREE_LIST_ALLOCATOR_
+#pragma once
+
+#include <map>
+
+//\brief Hands out ranges of a fixed size resource, like a GPU buffer, without touching the resource itself.
+//		 Free ranges are indexed by size for best fit allocation and by offset for merging neighbours on release,
+//		 so allocating and releasing are both O(log n) in the number of free ranges.
+class FreeListAllocator
+{
+public:
+
+	static const unsigned int s_invalidOffset = 0xFFFFFFFF;	///< Returned when there is no free range large enough
+
+	//\brief Start with the whole resource free
+	//\param a_size is the number of units the resource has room for
+	void Init(unsigned int a_size)
+	{
+		m_freeBySize.clear();
+		m_freeByOffset.clear();
+		m_allocated.clear();
+		m_size = a_size;
+		m_freeSize = 0;
+		if (a_size > 0)
+		{
+			AddFree(0, a_size);
+		}
+	}
+
+	//\brief Take a range from the smallest free range that fits
+	//\return the offset of the start of the range or s_invalidOffset
+	unsigned int Allocate(unsigned int a_size)
+	{
+		if (a_size == 0)
+		{
+			return s_invalidOffset;
+		}
+
+		auto bestFit = m_freeBySize.lower_bound(a_size);
+		if (bestFit == m_freeBySize.end())
+		{
+			return s_invalidOffset;
+		}
+
+		// Split the range and return the remainder to the free list
+		const unsigned int offset = bestFit->second;
+		const unsigned int freeSize = bestFit->first;
+		RemoveFree(bestFit);
+		if (freeSize > a_size)
+		{
+			AddFree(offset + a_size, freeSize - a_size);
+		}
+		m_allocated[offset] = a_size;
+		return offset;
+	}
+
+	//\brief Return a range and merge it with any free neighbours
+	//\return false if the offset was not allocated
+	bool Free(unsigned int a_offset)
+	{
+		auto allocation = m_allocated.find(a_offset);
+		if (allocation == m_allocated.end())
+		{
+			return false;
+		}
+
+		unsigned int offset = a_offset;
+		unsigned int size = allocation->second;
+		m_allocated.erase(allocation);
+
+		auto next = m_freeByOffset.lower_bound(offset);
+		if (next != m_freeByOffset.end() && next->first == offset + size)
+		{
+			size += next->second.m_size;
+			auto toRemove = next++;
+			RemoveFree(toRemove->second.m_bySize);
+		}
+		if (next != m_freeByOffset.begin())
+		{
+			auto prev = next;
+			--prev;
+			if (prev->first + prev->second.m_size == offset)
+			{
+				offset = prev->first;
+				size += prev->second.m_size;
+				RemoveFree(prev->second.m_bySize);
+			}
+		}
+		AddFree(offset, size);
+		return true;
+	}
+
+	//\brief Usage statistics
+	inline unsigned int GetSize() const { return m_size; }
+	inline unsigned int GetFreeSize() const { return m_freeSize; }
+	inline unsigned int GetUsedSize() const { return m_size - m_freeSize; }
+	inline unsigned int GetNumAllocations() const { return (unsigned int)m_allocated.size(); }
+	inline unsigned int GetNumFreeRanges() const { return (unsigned int)m_freeBySize.size(); }
+	inline unsigned int GetLargestFreeRange() const { return m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first; }
+
+	//\brief How much of the free space can't be used by a single allocation
+	//\return 0 when all free space is one range up to nearly 1 when it is scattered in small pieces
+	inline float GetFragmentation() const { return m_freeSize == 0 ? 0.0f : 1.0f - (float)GetLargestFreeRange() / (float)m_freeSize; }
+
+private:
+
+	typedef std::multimap<unsigned int, unsigned int> SizeMap;		///< Free range size to offset
+
+	struct FreeRange
+	{
+		unsigned int m_size;
+		SizeMap::iterator m_bySize;									///< Entry in the size index so both indices are updated together
+	};
+
+	void AddFree(unsigned int a_offset, unsigned int a_size)
+	{
+		FreeRange range;
+		range.m_size = a_size;
+		range.m_bySize = m_freeBySize.insert(SizeMap::value_type(a_size, a_offset));
+		m_freeByOffset[a_offset] = range;
+		m_freeSize += a_size;
+	}
+
+	void RemoveFree(SizeMap::iterator a_bySize)
+	{
+		m_freeSize -= a_bySize->first;
+		m_freeByOffset.erase(a_bySize->second);
+		m_freeBySize.erase(a_bySize);
+	}
+
+	SizeMap m_freeBySize;											///< Free ranges ordered by size for best fit
+	std::map<unsigned int, FreeRange> m_freeByOffset;				///< Free ranges ordered by position for merging
+	std::map<unsigned int, unsigned int> m_allocated;				///< Allocated offset to size
+	unsigned int m_size{ 0 };										///< Total units managed
+	unsigned int m_freeSize{ 0 };									///< Units not allocated
+};
+
+#endif // _CORE_FREE_LIST_ALLOCATOR_
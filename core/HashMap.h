@@ -1,200 +1,344 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
 #include "Iterator.h"
 
-//\brief Unordered hash node class to be used with HashMap
+//\brief A slot in the HashMap table, stored inline in the table so inserting never allocates
 template <typename K, typename T>
 class HashNode
 {
 public:
 	HashNode()
-		: m_next(nullptr) {}
+		: m_key()
+		, m_object()
+		, m_distance(0) {}
 
-	HashNode(const K & a_key, T & a_object)
-		: m_key(a_key)
-		, m_object(a_object)
-		, m_next(nullptr) {}
+	inline bool IsOccupied() const { return m_distance != 0; }
+	inline const K & GetKey() const { return m_key; }
+	inline T & GetObject() { return m_object; }
 
 private:
 
-	template <typename K, typename T> friend class HashMap;
+	template <typename TKey, typename TObject, typename THash> friend class HashMap;
 
-	K m_key;					// Index into the bucket
-	T m_object;					// Storage for object type
-	HashNode * m_next;			// In the case of collisions, each node is a singly linked list forward
+	K m_key;					///< Identifier the object was inserted with
+	T m_object;					///< Storage for object type
+	unsigned int m_distance;	///< One more than how many slots past its ideal slot the key is, zero for empty
 };
 
-// Default hash function assuming unique keys supplied, collision free is impossible esp over small data
+//\brief Default hash function, mixes all bits of an integer key so keys that only differ in their high bits still spread over the table
 template <typename K>
-struct KeyHash 
+struct KeyHash
 {
-	unsigned int GetHash(K a_key, unsigned int a_tableSize) const { return a_key % a_tableSize; }
+	unsigned int GetHash(const K & a_key) const
+	{
+		uint64_t hash = (uint64_t)a_key;
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		return (unsigned int)hash;
+	}
 };
 
-//\brief Unordered map class with simple hash functions for string types resolving to uints.
-//		 Utilises separate chaining with list head cells for collision management.
-template <typename K, typename T>
+//\brief Unordered map with open addressing and robin hood probing. Keys that have travelled further from
+//		 their ideal slot take the place of ones that are closer, which keeps probe lengths short and lets
+//		 lookups for missing keys stop early. Removal shifts the following run back so there are no tombstones.
+template <typename K, typename T, typename THash = KeyHash<K>>
 class HashMap
 {
 public:
 
-	HashMap(const HashMap & a_moveFrom)
+	typedef HashNode<K, T> Node;
+
+	HashMap() = default;
+
+	HashMap(const HashMap & a_copyFrom)
+		: m_hashFunc(a_copyFrom.m_hashFunc)
 	{
-		// TODO
+		CopyFrom(a_copyFrom);
 	}
 
 	HashMap(HashMap && a_moveFrom)
-		: m_map(a_moveFrom.m_map)
-		, m_tableSize(a_moveFrom.m_tableSize)
+		: m_nodes(a_moveFrom.m_nodes)
+		, m_capacity(a_moveFrom.m_capacity)
 		, m_length(a_moveFrom.m_length)
+		, m_hashFunc(a_moveFrom.m_hashFunc)
 	{
-		a_moveFrom.m_map = nullptr;
+		a_moveFrom.m_nodes = nullptr;
+		a_moveFrom.m_capacity = 0;
+		a_moveFrom.m_length = 0;
 	}
 
-	HashMap() 
-		: m_map(nullptr)
-		, m_tableSize(s_defaultTableSize)
-		, m_length(0)
+	~HashMap()
 	{
-		Allocate();
+		Deallocate();
 	}
 
-	~HashMap()
+	HashMap & operator = (const HashMap & a_copyFrom)
 	{
-		Deallocate();
+		if (this != &a_copyFrom)
+		{
+			Deallocate();
+			m_hashFunc = a_copyFrom.m_hashFunc;
+			CopyFrom(a_copyFrom);
+		}
+		return *this;
 	}
 
+	HashMap & operator = (HashMap && a_moveFrom)
+	{
+		if (this != &a_moveFrom)
+		{
+			Deallocate();
+			m_nodes = a_moveFrom.m_nodes;
+			m_capacity = a_moveFrom.m_capacity;
+			m_length = a_moveFrom.m_length;
+			m_hashFunc = a_moveFrom.m_hashFunc;
+			a_moveFrom.m_nodes = nullptr;
+			a_moveFrom.m_capacity = 0;
+			a_moveFrom.m_length = 0;
+		}
+		return *this;
+	}
+
+	//\brief Remove everything and make room for a number of elements without growing
 	void ResizeAndClearAll(size_t a_newSize)
 	{
 		Deallocate();
-		m_tableSize = a_newSize;
+		Reserve((unsigned int)a_newSize);
+	}
+
+	//\brief Remove all elements but keep the table allocated
+	void Clear()
+	{
+		for (unsigned int i = 0; i < m_capacity; ++i)
+		{
+			m_nodes[i] = Node();
+		}
 		m_length = 0;
-		Allocate();
 	}
 
-	bool Contains(K a_key)
+	//\brief Grow the table so a number of elements can be inserted without rehashing
+	void Reserve(unsigned int a_numElements)
+	{
+		unsigned int capacity = s_defaultTableSize;
+		while (a_numElements * s_maxLoadDenominator > capacity * s_maxLoadNumerator)
+		{
+			capacity <<= 1;
+		}
+		if (capacity > m_capacity)
+		{
+			Rehash(capacity);
+		}
+	}
+
+	inline bool Contains(const K & a_key) const
 	{
-		unsigned int rawKey = KeyHash<K>().GetHash(a_key, m_tableSize);
-		HashNode<K, T> * found = m_map[rawKey];
-		return found != nullptr;
+		return FindNode(a_key) != nullptr;
 	}
 
 	//\brief Retrieve an element in the map
 	//\param a_key the identifier for the item to look for
 	//\param a_value_OUT is a ref to and itme to populate if found
 	//\return true if the item was found and a_value_OUT will be modified
-	bool Get(K a_key, T & a_value_OUT)
+	bool Get(const K & a_key, T & a_value_OUT) const
 	{
-		unsigned int rawKey = KeyHash<K>().GetHash(a_key, m_tableSize);
-		HashNode<K, T> * found = m_map[rawKey];
-		if (found != nullptr)
+		if (const Node * found = FindNode(a_key))
 		{
 			a_value_OUT = found->m_object;
-			auto * next = found->m_next;
-			while (next != nullptr)
-			{
-				a_value_OUT = next->m_object;
-				next = next->m_next;
-			}
-
 			return true;
 		}
 		return false;
 	}
 
-	//\brief Add an element to the map
+	//\brief Get a pointer to an element in the map that stays valid until the next insert or remove
+	T * Find(const K & a_key)
+	{
+		Node * found = const_cast<Node *>(FindNode(a_key));
+		return found != nullptr ? &found->m_object : nullptr;
+	}
+
+	//\brief Add an element to the map or replace the element already inserted with the same key
 	//\param a_key the unique way to identify the object
 	//\param a_data the object to insert
-	void Insert(K a_key, T & a_data) 
+	//\return true if the key was not already in the map
+	bool Insert(const K & a_key, const T & a_data)
 	{
-		HashNode<K, T> * newNode = new HashNode<K, T>(a_key, a_data);
-		unsigned int rawKey = KeyHash<K>().GetHash(a_key, m_tableSize);
-		HashNode<K, T> * tNode = m_map[rawKey];
-		if (tNode != nullptr)
+		if (Node * existing = const_cast<Node *>(FindNode(a_key)))
 		{
-			auto * next = tNode->m_next;
-			while (next != nullptr)
-			{
-				next = next->m_next;
-			}
-			next->m_next = newNode;
+			existing->m_object = a_data;
+			return false;
 		}
-		else
+
+		// Grow before the table gets full enough for probe lengths to climb
+		if ((m_length + 1) * s_maxLoadDenominator > m_capacity * s_maxLoadNumerator)
 		{
-			m_map[rawKey] = newNode;
+			Rehash(m_capacity == 0 ? s_defaultTableSize : m_capacity * 2);
 		}
+
+		Node newNode;
+		newNode.m_key = a_key;
+		newNode.m_object = a_data;
+		newNode.m_distance = 1;
+		InsertNode(newNode);
 		++m_length;
+		return true;
 	}
 
-	//\brief Iterator like functionality for collections that need value matching and single element walks
-	Iterator<HashNode<K,T>> GetIterator() 
-	{ 
-		Iterator<HashNode<K, T>> it = Iterator<HashNode<K, T>>(m_map[0]);
-		return it;
-	}
-	bool GetNext(Iterator<HashNode<K, T>> & a_it, T & a_value_OUT)
+	//\brief Take an element out of the map
+	//\return false if the key was not in the map
+	bool Remove(const K & a_key)
 	{
-		// Early out for no objects
-		if (m_length == 0)
+		Node * found = const_cast<Node *>(FindNode(a_key));
+		if (found == nullptr)
 		{
 			return false;
 		}
 
-		// And for overrun
-		if (a_it.GetCount() > m_tableSize - 1)
-		{ 
-			return false;
-		}
-
-		// Check for openly addressed nodes
-		if (a_it.GetObject() != nullptr && a_it.GetObject()->m_next != nullptr)
+		// Pull following nodes that are not in their ideal slot back by one, stops at an empty or ideally placed node
+		const unsigned int mask = m_capacity - 1;
+		unsigned int index = (unsigned int)(found - m_nodes);
+		unsigned int next = (index + 1) & mask;
+		while (m_nodes[next].m_distance > 1)
 		{
-			a_it.SetObject(a_it.GetObject()->m_next);
-			a_value_OUT = a_it.GetObject()->m_object;
-			return true;
+			m_nodes[index] = std::move(m_nodes[next]);
+			--m_nodes[index].m_distance;
+			index = next;
+			next = (next + 1) & mask;
 		}
-		a_it.Inc();
-		while (m_map[a_it.GetCount()] == nullptr)
+		m_nodes[index] = Node();
+		--m_length;
+		return true;
+	}
+
+	inline unsigned int GetLength() const { return m_length; }
+	inline unsigned int GetCapacity() const { return m_capacity; }
+	inline float GetLoadFactor() const { return m_capacity > 0 ? (float)m_length / (float)m_capacity : 0.0f; }
+
+	//\brief Iterator like functionality for collections that need value matching and single element walks
+	//		 Order is the table order so inserting or removing while iterating is not supported
+	Iterator<Node> GetIterator()
+	{
+		return Iterator<Node>(m_nodes);
+	}
+	bool GetNext(Iterator<Node> & a_it, T & a_value_OUT)
+	{
+		while (a_it.GetCount() < m_capacity)
 		{
+			Node * node = a_it.GetObject();
 			a_it.Inc();
-			if (a_it.GetCount() > m_tableSize - 1)
+			if (node->IsOccupied())
 			{
-				return false;
+				a_value_OUT = node->m_object;
+				return true;
 			}
 		}
-		a_it.SetObject(m_map[a_it.GetCount()]);
-		a_value_OUT = m_map[a_it.GetCount()]->m_object;
-		return true;	
+		return false;
 	}
 
 private:
 
-	bool Allocate()
+	const Node * FindNode(const K & a_key) const
 	{
-		// Zero initialise the complete table so that IsValid calls will always fail to empty buckets
-		m_map = new HashNode<K, T> * [m_tableSize]();
-		m_length = 0;
-		return m_map != nullptr;
+		if (m_length == 0)
+		{
+			return nullptr;
+		}
+
+		// A node closer to its ideal slot than the probe is to ours means the key would have displaced it
+		const unsigned int mask = m_capacity - 1;
+		unsigned int index = m_hashFunc.GetHash(a_key) & mask;
+		unsigned int distance = 1;
+		while (true)
+		{
+			const Node & node = m_nodes[index];
+			if (node.m_distance < distance)
+			{
+				return nullptr;
+			}
+			if (node.m_key == a_key)
+			{
+				return &node;
+			}
+			++distance;
+			index = (index + 1) & mask;
+		}
 	}
 
-	bool Deallocate()
+	//\brief Place a node known not to be in the table, there must be a free slot
+	void InsertNode(Node & a_node)
 	{
-		if (m_map != nullptr)
+		const unsigned int mask = m_capacity - 1;
+		unsigned int index = m_hashFunc.GetHash(a_node.m_key) & mask;
+		a_node.m_distance = 1;
+		while (true)
 		{
-			delete[] m_map;
-			m_map = nullptr;
-			m_length = 0;
-			return true;
+			Node & node = m_nodes[index];
+			if (!node.IsOccupied())
+			{
+				node = std::move(a_node);
+				return;
+			}
+
+			// Take from the rich, the displaced node carries on probing
+			if (node.m_distance < a_node.m_distance)
+			{
+				std::swap(node, a_node);
+			}
+			++a_node.m_distance;
+			index = (index + 1) & mask;
 		}
-		return false;
 	}
 
-	static const size_t s_defaultTableSize = 512;	
+	void Rehash(unsigned int a_newCapacity)
+	{
+		Node * oldNodes = m_nodes;
+		const unsigned int oldCapacity = m_capacity;
+		m_nodes = new Node[a_newCapacity];
+		m_capacity = a_newCapacity;
+		for (unsigned int i = 0; i < oldCapacity; ++i)
+		{
+			if (oldNodes[i].IsOccupied())
+			{
+				InsertNode(oldNodes[i]);
+			}
+		}
+		delete[] oldNodes;
+	}
+
+	void CopyFrom(const HashMap & a_copyFrom)
+	{
+		if (a_copyFrom.m_capacity > 0)
+		{
+			m_nodes = new Node[a_copyFrom.m_capacity];
+			for (unsigned int i = 0; i < a_copyFrom.m_capacity; ++i)
+			{
+				m_nodes[i] = a_copyFrom.m_nodes[i];
+			}
+		}
+		m_capacity = a_copyFrom.m_capacity;
+		m_length = a_copyFrom.m_length;
+	}
+
+	void Deallocate()
+	{
+		delete[] m_nodes;
+		m_nodes = nullptr;
+		m_capacity = 0;
+		m_length = 0;
+	}
+
+	static const unsigned int s_defaultTableSize = 16;			///< Allocated on first insert, always a power of two
+	static const unsigned int s_maxLoadNumerator = 4;			///< Grow when more than four fifths of the slots are used
+	static const unsigned int s_maxLoadDenominator = 5;
 
+	Node * m_nodes{ nullptr };									///< Table of slots with the objects stored inline
+	unsigned int m_capacity{ 0 };								///< Number of slots in the table
 	unsigned int m_length{ 0 };									///< How many objects are inserted into the map
-	unsigned int m_tableSize{ 0 };								///< Number of bytes allocated to hold the complete table
-	HashNode<K, T> ** m_map;									///< Chunk of memory pointing to the objects in the map ordered by key
-	KeyHash<K> m_hashFunc;										///< Pointer to struct for hashing
+	THash m_hashFunc;											///< Struct for hashing
 };
 
 static const int s_maxStringHash32bit = 9;						// TODO Move the StringHash guts into the HashMap to replace this hacky hash stuff
@@ -0,0 +1,490 @@
+#ifndef _CORE_JOB_SYSTEM_
+#define _CORE_JOB_SYSTEM_
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+//\brief A unit of work with storage for its arguments. Jobs come from a ring of preallocated jobs owned by
+//		 the thread that created them and are reused some time after they finish, so don't hold on to them.
+struct alignas(64) Job
+{
+	typedef void (*Function)(Job * a_job, void * a_data);
+
+	static const int s_maxContinuations = 4;		///< Jobs that are queued when this one and all its children finish
+	static const int s_dataSize = 64;				///< Bytes of argument storage copied into the job
+
+	Function m_function{ nullptr };
+	Job * m_parent{ nullptr };						///< Job that will not finish until this one does
+	std::atomic<int> m_unfinished{ 0 };				///< One for the job itself plus one per unfinished child
+	std::atomic<int> m_numContinuations{ 0 };
+	Job * m_continuations[s_maxContinuations]{ };
+	alignas(16) char m_data[s_dataSize];
+};
+
+//\brief Single producer multi consumer deque, the owning thread pushes and pops at the bottom while
+//		 other threads steal from the top. Lock free as described by Chase and Lev with the memory
+//		 ordering from Le et al. Fixed capacity as jobs are recycled before a queue could overflow.
+class JobQueue
+{
+public:
+
+	static const unsigned int s_capacity = 4096;	///< Must be a power of two
+
+	//\brief Only the owning thread may push
+	inline void Push(Job * a_job)
+	{
+		const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		assert(bottom - m_top.load(std::memory_order_relaxed) < (int64_t)s_capacity);
+		m_jobs[bottom & (s_capacity - 1)].store(a_job, std::memory_order_relaxed);
+		m_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	//\brief Only the owning thread may pop, takes the most recently pushed job for cache locality
+	inline Job * Pop()
+	{
+		const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_top.load(std::memory_order_relaxed);
+		if (top > bottom)
+		{
+			// Empty
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job * job = m_jobs[bottom & (s_capacity - 1)].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// Last job in the queue, race any thieves for it
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				job = nullptr;
+			}
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	//\brief Any thread may steal, takes the oldest job which is likely the largest piece of work
+	inline Job * Steal()
+	{
+		int64_t top = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+		{
+			return nullptr;
+		}
+
+		Job * job = m_jobs[top & (s_capacity - 1)].load(std::memory_order_relaxed);
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			// Lost to another thief or the owner
+			return nullptr;
+		}
+		return job;
+	}
+
+	inline bool IsEmpty() const { return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed); }
+
+private:
+
+	alignas(64) std::atomic<int64_t> m_top{ 0 };	///< Next job to steal, on its own cache line to the owner's end
+	alignas(64) std::atomic<int64_t> m_bottom{ 0 };	///< Next free entry
+	std::atomic<Job *> m_jobs[s_capacity];
+};
+
+//\brief Runs jobs on a pool of worker threads. Each thread has its own queue and steals from the
+//		 others when it runs dry. The thread that starts the system is thread zero and takes part in
+//		 running jobs while it waits. Jobs may only be created and run from that thread or from inside
+//		 other jobs.
+class JobSystem
+{
+public:
+
+	static const unsigned int s_maxThreads = 64;
+	static const unsigned int s_maxJobsPerThread = JobQueue::s_capacity;
+
+	JobSystem() = default;
+	JobSystem(const JobSystem &) = delete;
+	JobSystem & operator = (const JobSystem &) = delete;
+	~JobSystem() { Shutdown(); }
+
+	//\return one less than the number of hardware threads so the main thread keeps a core
+	static unsigned int GetDefaultNumWorkers()
+	{
+		const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	//\brief Allocate queues and start the workers
+	//\param a_numWorkers is how many threads to start in addition to the calling thread, zero runs everything while waiting
+	bool Startup(unsigned int a_numWorkers)
+	{
+		Shutdown();
+		if (a_numWorkers > s_maxThreads - 1)
+		{
+			a_numWorkers = s_maxThreads - 1;
+		}
+
+		m_numThreads = a_numWorkers + 1;
+		m_queues = new JobQueue[m_numThreads];
+		m_jobs = new Job[m_numThreads * s_maxJobsPerThread];
+		m_numAllocated = new ThreadCounter[m_numThreads];
+		GetThreadIndex() = 0;
+
+		m_running = true;
+		m_workers = new std::thread[a_numWorkers];
+		for (unsigned int i = 0; i < a_numWorkers; ++i)
+		{
+			m_workers[i] = std::thread(&JobSystem::WorkerLoop, this, i + 1);
+		}
+		return true;
+	}
+
+	//\brief Stop and join all workers, any queued jobs are dropped
+	void Shutdown()
+	{
+		if (m_numThreads == 0)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_running = false;
+		}
+		m_wake.notify_all();
+		for (unsigned int i = 0; i < m_numThreads - 1; ++i)
+		{
+			m_workers[i].join();
+		}
+
+		delete[] m_workers;
+		delete[] m_queues;
+		delete[] m_jobs;
+		delete[] m_numAllocated;
+		m_workers = nullptr;
+		m_queues = nullptr;
+		m_jobs = nullptr;
+		m_numAllocated = nullptr;
+		m_numThreads = 0;
+	}
+
+	//\brief Create a job that calls a function with a copy of some data
+	//\param a_data is copied into the job, a_size must be no more than Job::s_dataSize
+	Job * CreateJob(Job::Function a_function, const void * a_data = nullptr, size_t a_size = 0)
+	{
+		return AllocateJob(a_function, nullptr, a_data, a_size);
+	}
+
+	//\brief Create a job that its parent will wait for, must be called before the parent finishes
+	Job * CreateChildJob(Job * a_parent, Job::Function a_function, const void * a_data = nullptr, size_t a_size = 0)
+	{
+		a_parent->m_unfinished.fetch_add(1, std::memory_order_relaxed);
+		return AllocateJob(a_function, a_parent, a_data, a_size);
+	}
+
+	//\brief Create a job from a lambda or functor that is copied into the job
+	template <typename TFunc>
+	Job * CreateJob(const TFunc & a_func)
+	{
+		return CreateChildJob<TFunc>(nullptr, a_func);
+	}
+	template <typename TFunc>
+	Job * CreateChildJob(Job * a_parent, const TFunc & a_func)
+	{
+		static_assert(sizeof(TFunc) <= Job::s_dataSize, "Job lambda captures too much, capture by reference or pass a pointer");
+		static_assert(std::is_trivially_destructible<TFunc>::value, "Job lambdas are never destroyed so can't own resources");
+		if (a_parent != nullptr)
+		{
+			a_parent->m_unfinished.fetch_add(1, std::memory_order_relaxed);
+		}
+		Job * job = AllocateJob(&InvokeFunctor<TFunc>, a_parent, nullptr, 0);
+		new (job->m_data) TFunc(a_func);
+		return job;
+	}
+
+	//\brief Queue a job to run when another job and all its children have finished
+	//		 Must be added before the ancestor is run
+	bool AddContinuation(Job * a_ancestor, Job * a_continuation)
+	{
+		const int index = a_ancestor->m_numContinuations.fetch_add(1, std::memory_order_relaxed);
+		if (index >= Job::s_maxContinuations)
+		{
+			a_ancestor->m_numContinuations.fetch_sub(1, std::memory_order_relaxed);
+			return false;
+		}
+		a_ancestor->m_continuations[index] = a_continuation;
+		return true;
+	}
+
+	//\brief Put a job on the calling thread's queue where it can be picked up by any thread
+	void Run(Job * a_job)
+	{
+		m_queues[GetThreadIndex()].Push(a_job);
+
+		// Pairs with the sleeping count being raised before a worker checks the queues one last time
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_numSleeping.load(std::memory_order_relaxed) > 0)
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_wake.notify_one();
+		}
+	}
+
+	inline bool IsFinished(const Job * a_job) const { return a_job->m_unfinished.load(std::memory_order_acquire) == 0; }
+
+	//\brief Run other jobs until a job and all its children have finished rather than blocking
+	void Wait(const Job * a_job)
+	{
+		while (!IsFinished(a_job))
+		{
+			if (Job * job = GetJob())
+			{
+				Execute(job);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	//\brief Call a function over a range of indices split into pieces that are run in parallel, returns when all are done
+	//\param a_grainSize is the most indices handed to one call, large enough that a call costs more than scheduling a job
+	//\param a_func is called with a begin and end index as a_func(begin, end)
+	template <typename TFunc>
+	void ParallelFor(unsigned int a_begin, unsigned int a_end, unsigned int a_grainSize, const TFunc & a_func)
+	{
+		if (a_end <= a_begin)
+		{
+			return;
+		}
+
+		// Small ranges are cheaper to do here than to hand out
+		if (a_end - a_begin <= a_grainSize || m_numThreads <= 1)
+		{
+			a_func(a_begin, a_end);
+			return;
+		}
+
+		ParallelForData<TFunc> data;
+		data.m_system = this;
+		data.m_func = &a_func;
+		data.m_begin = a_begin;
+		data.m_end = a_end;
+		data.m_grainSize = a_grainSize > 0 ? a_grainSize : 1;
+		Job * root = CreateJob(&ParallelForJob<TFunc>, &data, sizeof(data));
+		Run(root);
+		Wait(root);
+	}
+
+	inline unsigned int GetNumThreads() const { return m_numThreads; }
+	inline unsigned int GetNumWorkers() const { return m_numThreads > 0 ? m_numThreads - 1 : 0; }
+
+	//\return the index of the calling thread, zero for the thread that started the system
+	static unsigned int & GetThreadIndex()
+	{
+		static thread_local unsigned int s_threadIndex = 0;
+		return s_threadIndex;
+	}
+
+private:
+
+	template <typename TFunc>
+	struct ParallelForData
+	{
+		JobSystem * m_system;
+		const TFunc * m_func;
+		unsigned int m_begin;
+		unsigned int m_end;
+		unsigned int m_grainSize;
+	};
+
+	//\brief Halve the range handing the top half to another job until it is small enough to run, so
+	//		 idle threads steal large pieces and only the calling thread pays for the split
+	template <typename TFunc>
+	static void ParallelForJob(Job * a_job, void * a_data)
+	{
+		ParallelForData<TFunc> data = *(ParallelForData<TFunc> *)a_data;
+		while (data.m_end - data.m_begin > data.m_grainSize)
+		{
+			ParallelForData<TFunc> split = data;
+			split.m_begin = data.m_begin + (data.m_end - data.m_begin) / 2;
+			data.m_end = split.m_begin;
+			data.m_system->Run(data.m_system->CreateChildJob(a_job, &ParallelForJob<TFunc>, &split, sizeof(split)));
+		}
+		(*data.m_func)(data.m_begin, data.m_end);
+	}
+
+	template <typename TFunc>
+	static void InvokeFunctor(Job *, void * a_data)
+	{
+		(*(TFunc *)a_data)();
+	}
+
+	//\brief Take the next finished job out of the ring for the calling thread. Parents stay unfinished
+	//		 until their whole tree is done so those slots are stepped over rather than reused.
+	Job * AllocateJob(Job::Function a_function, Job * a_parent, const void * a_data, size_t a_size)
+	{
+		assert(m_numThreads > 0 && a_size <= Job::s_dataSize);
+		const unsigned int threadIndex = GetThreadIndex();
+		Job * ring = &m_jobs[threadIndex * s_maxJobsPerThread];
+		unsigned int & count = m_numAllocated[threadIndex].m_count;
+		Job * job = &ring[count++ & (s_maxJobsPerThread - 1)];
+		for (unsigned int i = 1; job->m_unfinished.load(std::memory_order_acquire) != 0; ++i)
+		{
+			assert(i < s_maxJobsPerThread && "Every job for this thread is in flight");
+			job = &ring[count++ & (s_maxJobsPerThread - 1)];
+		}
+		job->m_function = a_function;
+		job->m_parent = a_parent;
+		job->m_unfinished.store(1, std::memory_order_relaxed);
+		job->m_numContinuations.store(0, std::memory_order_relaxed);
+		if (a_size > 0)
+		{
+			memcpy(job->m_data, a_data, a_size);
+		}
+		return job;
+	}
+
+	//\brief Own queue first, then steal from the others starting at a random thread so thieves spread out
+	Job * GetJob()
+	{
+		const unsigned int threadIndex = GetThreadIndex();
+		if (Job * job = m_queues[threadIndex].Pop())
+		{
+			return job;
+		}
+
+		const unsigned int start = NextRandom() % m_numThreads;
+		for (unsigned int i = 0; i < m_numThreads; ++i)
+		{
+			const unsigned int victim = (start + i) % m_numThreads;
+			if (victim != threadIndex)
+			{
+				if (Job * job = m_queues[victim].Steal())
+				{
+					return job;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	void Execute(Job * a_job)
+	{
+		a_job->m_function(a_job, a_job->m_data);
+		Finish(a_job);
+	}
+
+	void Finish(Job * a_job)
+	{
+		// Continuations were added before the job ran so can be read before anyone else sees it finish
+		const int numContinuations = a_job->m_numContinuations.load(std::memory_order_relaxed);
+		Job * continuations[Job::s_maxContinuations];
+		for (int i = 0; i < numContinuations; ++i)
+		{
+			continuations[i] = a_job->m_continuations[i];
+		}
+		Job * parent = a_job->m_parent;
+
+		if (a_job->m_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			if (parent != nullptr)
+			{
+				Finish(parent);
+			}
+			for (int i = 0; i < numContinuations; ++i)
+			{
+				Run(continuations[i]);
+			}
+		}
+	}
+
+	bool HasQueuedJobs() const
+	{
+		for (unsigned int i = 0; i < m_numThreads; ++i)
+		{
+			if (!m_queues[i].IsEmpty())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void WorkerLoop(unsigned int a_threadIndex)
+	{
+		GetThreadIndex() = a_threadIndex;
+		unsigned int idleSpins = 0;
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			if (Job * job = GetJob())
+			{
+				Execute(job);
+				idleSpins = 0;
+			}
+			else if (++idleSpins < s_spinsBeforeSleep)
+			{
+				// Work usually arrives in bursts so stay awake for a short while
+				std::this_thread::yield();
+			}
+			else
+			{
+				std::unique_lock<std::mutex> lock(m_sleepMutex);
+				m_numSleeping.fetch_add(1, std::memory_order_seq_cst);
+				m_wake.wait_for(lock, std::chrono::milliseconds(s_sleepTimeoutMs), [this] { return !m_running || HasQueuedJobs(); });
+				m_numSleeping.fetch_sub(1, std::memory_order_relaxed);
+				idleSpins = 0;
+			}
+		}
+	}
+
+	//\brief Per thread xorshift so thieves don't all hit the same victim
+	static unsigned int NextRandom()
+	{
+		static thread_local unsigned int s_state = 0;
+		if (s_state == 0)
+		{
+			s_state = 0x9E3779B9u ^ (GetThreadIndex() * 0x85EBCA6Bu + 1);
+		}
+		s_state ^= s_state << 13;
+		s_state ^= s_state >> 17;
+		s_state ^= s_state << 5;
+		return s_state;
+	}
+
+	//\brief Allocation count on its own cache line so threads creating jobs don't contend
+	struct alignas(64) ThreadCounter
+	{
+		unsigned int m_count{ 0 };
+	};
+
+	static const unsigned int s_spinsBeforeSleep = 256;		///< Empty polls before a worker sleeps
+	static const unsigned int s_sleepTimeoutMs = 2;			///< Sleeping workers check the queues this often in case a wake was missed
+
+	JobQueue * m_queues{ nullptr };							///< One per thread, index zero belongs to the thread that started the system
+	Job * m_jobs{ nullptr };								///< Ring of jobs for each thread
+	ThreadCounter * m_numAllocated{ nullptr };				///< How many jobs each thread has created
+	std::thread * m_workers{ nullptr };
+	unsigned int m_numThreads{ 0 };							///< Workers plus the main thread
+	std::atomic<bool> m_running{ false };
+	std::atomic<int> m_numSleeping{ 0 };					///< Workers waiting on the condition so Run knows to wake one
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wake;
+};
+
+#endif // _CORE_JOB_SYSTEM_
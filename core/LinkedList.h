@@ -42,8 +42,8 @@ private:
 	LinkedListNode* m_prev { nullptr };
 
 	// Allows list and iterators to access neighbours without function calls
-	template <class T> friend class LinkedList;
-	template <class T> friend class cIterator;
+	template <class U> friend class LinkedList;
+	template <class U> friend class cIterator;
 };
 
 template <class T>
@@ -5,6 +5,8 @@
 #include <random>
 #include <cstdlib>
 #include <ctime>
+#include <stdint.h>
+#include <string.h>
 
 #include "Vector.h"
 
@@ -109,6 +111,72 @@ namespace MathUtils
 	{
 		return (a_val < a_min) ? a_min : (a_val > a_max) ? a_max : a_val;
 	}
+
+	//\brief Fold a unit vector onto an octahedron unwrapped into a square, both components are in the range -1 to 1
+	static Vector2 EncodeOctahedral(const Vector & a_normal)
+	{
+		const float manhattanLength = fabsf(a_normal.GetX()) + fabsf(a_normal.GetY()) + fabsf(a_normal.GetZ());
+		if (manhattanLength <= 0.0f)
+		{
+			return Vector2(0.0f, 0.0f);
+		}
+
+		float x = a_normal.GetX() / manhattanLength;
+		float y = a_normal.GetY() / manhattanLength;
+		if (a_normal.GetZ() < 0.0f)
+		{
+			// The lower half is folded out over the corners
+			const float foldX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			const float foldY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldX;
+			y = foldY;
+		}
+		return Vector2(x, y);
+	}
+
+	//\brief Convert to a 16 bit float, rounding to nearest and flushing values too small for a half to zero
+	static uint16_t FloatToHalf(float a_val)
+	{
+		uint32_t bits;
+		memcpy(&bits, &a_val, sizeof(bits));
+		const uint32_t sign = (bits >> 16) & 0x8000;
+		const uint32_t floatExp = (bits >> 23) & 0xFF;
+		uint32_t mantissa = bits & 0x7FFFFF;
+		const int exp = (int)floatExp - 127 + 15;
+
+		if (floatExp == 0xFF)
+		{
+			return (uint16_t)(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+		}
+		if (exp >= 31)
+		{
+			return (uint16_t)(sign | 0x7C00);
+		}
+		if (exp <= 0)
+		{
+			// Denormal halves keep the implicit bit in the mantissa
+			if (exp < -10)
+			{
+				return (uint16_t)sign;
+			}
+			mantissa |= 0x800000;
+			const int shift = 14 - exp;
+			uint32_t half = mantissa >> shift;
+			if ((mantissa >> (shift - 1)) & 1)
+			{
+				++half;
+			}
+			return (uint16_t)(sign | half);
+		}
+
+		// A carry out of the mantissa when rounding correctly bumps the exponent
+		uint32_t half = sign | ((uint32_t)exp << 10) | (mantissa >> 13);
+		if (mantissa & 0x1000)
+		{
+			++half;
+		}
+		return (uint16_t)half;
+	}
 }
 
 #endif //_CORE_MATH_UTILS_
\ No newline at end of file
@@ -23,8 +23,12 @@ public:
 		f[8] = a_8;	f[9] = a_9;	f[10] = a_10; f[11] = a_11;
 		f[12] = a_12; f[13] = a_13; f[14] = a_14; f[15] = a_15;
 	}
-	Matrix(const Vector& a_right, const Vector& a_look, const Vector& a_up, const Vector& a_pos) : right(a_right), look(a_look), up(a_up), pos(a_pos)
+	Matrix(const Vector& a_right, const Vector& a_look, const Vector& a_up, const Vector& a_pos)
 	{
+		axes.right = a_right;
+		axes.look = a_look;
+		axes.up = a_up;
+		axes.pos = a_pos;
 		f[3] = 0.0f;
 		f[7] = 0.0f;
 		f[11] = 0.0f;
@@ -34,18 +38,18 @@ public:
 	inline float GetValue(unsigned int a_index) const							{ return f[a_index]; }
 	inline float * GetValues() { return &f[0]; }
 	inline void SetValue(int a_index, float a_val) { if (a_index >= 0 && a_index <= 15) { f[a_index] = a_val; } }
-	inline void SetRight(Vector a_right,	float a_w = 0.0f) { right = a_right; rightW = a_w;}
-	inline void SetLook(Vector a_look,		float a_w = 0.0f) { look = a_look; lookW = a_w;}
-	inline void SetUp(Vector a_up,			float a_w = 0.0f) { up = a_up; upW = a_w;}
-	inline void SetPos(Vector a_pos,		float a_w = 1.0f) { pos = a_pos; posW = a_w;}
-	inline void SetPosX(float a_posX) { pos.SetX(a_posX); }
-	inline void SetPosY(float a_posY) { pos.SetY(a_posY); }
-	inline void SetPosZ(float a_posZ) { pos.SetZ(a_posZ); }
-	inline void Translate(Vector a_trans) { pos += a_trans; }
-	inline Vector GetRight() const	{ return right; }
-	inline Vector GetLook()	const	{ return look; }
-	inline Vector GetUp() const		{ return up; }
-	inline Vector GetPos() const	{ return pos; }
+	inline void SetRight(Vector a_right,	float a_w = 0.0f) { axes.right = a_right; axes.rightW = a_w;}
+	inline void SetLook(Vector a_look,		float a_w = 0.0f) { axes.look = a_look; axes.lookW = a_w;}
+	inline void SetUp(Vector a_up,			float a_w = 0.0f) { axes.up = a_up; axes.upW = a_w;}
+	inline void SetPos(Vector a_pos,		float a_w = 1.0f) { axes.pos = a_pos; axes.posW = a_w;}
+	inline void SetPosX(float a_posX) { axes.pos.SetX(a_posX); }
+	inline void SetPosY(float a_posY) { axes.pos.SetY(a_posY); }
+	inline void SetPosZ(float a_posZ) { axes.pos.SetZ(a_posZ); }
+	inline void Translate(Vector a_trans) { axes.pos += a_trans; }
+	inline Vector GetRight() const	{ return axes.right; }
+	inline Vector GetLook()	const	{ return axes.look; }
+	inline Vector GetUp() const		{ return axes.up; }
+	inline Vector GetPos() const	{ return axes.pos; }
 	inline float GetDeterminant() const { return 0.0f; } //TODO
 	inline bool HasInverse() const { return GetDeterminant() > 0.0f; }
 	inline Matrix GetInverse() const 
@@ -347,9 +351,9 @@ public:
 		const float & x = a_vec.GetX();
 		const float & y = a_vec.GetY();
 		const float & z = a_vec.GetZ();
-		return Vector(	right.GetX() * x + look.GetX() * y + up.GetX() * z,
-						right.GetY() * x + look.GetY()  * y + up.GetY() * z,
-						right.GetZ() * x + look.GetZ() * y + up.GetZ() * z);
+		return Vector(	axes.right.GetX() * x + axes.look.GetX() * y + axes.up.GetX() * z,
+						axes.right.GetY() * x + axes.look.GetY()  * y + axes.up.GetY() * z,
+						axes.right.GetZ() * x + axes.look.GetZ() * y + axes.up.GetZ() * z);
 	}
 	inline Vector TransformInverse(const Vector & a_vec)
 	{
@@ -381,13 +385,13 @@ public:
 	}
 	inline Vector GetScale() const
 	{
-		return Vector(right.Length(), look.Length(), up.Length());
+		return Vector(axes.right.Length(), axes.look.Length(), axes.up.Length());
 	}
 	inline void RemoveScale()
 	{
-		right.Normalise();
-		look.Normalise();
-		up.Normalise();
+		axes.right.Normalise();
+		axes.look.Normalise();
+		axes.up.Normalise();
 	}
 	inline Matrix GetTranspose() const
 	{
@@ -410,7 +414,7 @@ private:
 			Vector		look;	float lookW;	// if they are a point or a vector
 			Vector		up;		float upW;		// 0 is for vectors/directions
 			Vector		pos;	float posW;		// 1 is for points.
-		};
+		} axes;
 	};
 };
 
@@ -0,0 +1,415 @@
+#ifndef _CORE_MESH_BVH_
+#define _CORE_MESH_BVH_
+#pragma once
+
+#include <assert.h>
+
+#include <vector>
+
+#include "Vector.h"
+
+//\brief Static bounding volume hierarchy over the triangles of an indexed mesh, built once when the mesh is loaded.
+//		 Splits are chosen with the surface area heuristic over a few bins of triangle centres and each node packs
+//		 into 32 bytes so two share a cache line. The vertices and indices are not copied, they must outlive the tree.
+//		 Queries hand back candidate triangles and leave the exact test to the caller.
+class MeshBvh
+{
+public:
+
+	//\brief Sort the triangles of a mesh into a tree
+	//\param a_verts vertex positions the indices refer to
+	//\param a_indices three per triangle
+	//\param a_numIndices length of the index list
+	void Build(const Vector * a_verts, const unsigned int * a_indices, unsigned int a_numIndices)
+	{
+		Clear();
+		const unsigned int numTris = a_numIndices / 3;
+		if (a_verts == nullptr || a_indices == nullptr || numTris == 0)
+		{
+			return;
+		}
+		m_verts = a_verts;
+		m_indices = a_indices;
+
+		// Bounds and centres are only needed while building
+		std::vector<Bounds> triBounds(numTris);
+		m_triangles.resize(numTris);
+		for (unsigned int i = 0; i < numTris; ++i)
+		{
+			Vector a, b, c;
+			GetTriangle(i, a, b, c);
+			Bounds & bounds = triBounds[i];
+			bounds.Reset();
+			bounds.Grow(a);
+			bounds.Grow(b);
+			bounds.Grow(c);
+			m_triangles[i] = i;
+		}
+
+		// A binary tree over n leaves never needs more than 2n - 1 nodes
+		m_nodes.reserve(numTris * 2);
+		m_nodes.resize(1);
+		m_nodes[0].m_leftFirst = 0;
+		m_nodes[0].m_count = numTris;
+		Subdivide(0, triBounds);
+		m_nodes.shrink_to_fit();
+	}
+
+	void Clear()
+	{
+		m_nodes.clear();
+		m_triangles.clear();
+		m_verts = nullptr;
+		m_indices = nullptr;
+	}
+
+	inline bool IsBuilt() const { return !m_nodes.empty(); }
+	inline unsigned int GetNumNodes() const { return (unsigned int)m_nodes.size(); }
+	inline unsigned int GetNumTriangles() const { return (unsigned int)m_triangles.size(); }
+	inline size_t GetMemorySize() const { return m_nodes.size() * sizeof(Node) + m_triangles.size() * sizeof(unsigned int); }
+
+	//\brief Bounds of the whole mesh
+	inline Vector GetMin() const { return IsBuilt() ? Vector(m_nodes[0].m_min[0], m_nodes[0].m_min[1], m_nodes[0].m_min[2]) : Vector::Zero(); }
+	inline Vector GetMax() const { return IsBuilt() ? Vector(m_nodes[0].m_max[0], m_nodes[0].m_max[1], m_nodes[0].m_max[2]) : Vector::Zero(); }
+
+	//\brief Corners of a triangle by its index in the original index list divided by three
+	inline void GetTriangle(unsigned int a_triIndex, Vector & a_vertA_OUT, Vector & a_vertB_OUT, Vector & a_vertC_OUT) const
+	{
+		const unsigned int * tri = m_indices + a_triIndex * 3;
+		a_vertA_OUT = m_verts[tri[0]];
+		a_vertB_OUT = m_verts[tri[1]];
+		a_vertC_OUT = m_verts[tri[2]];
+	}
+
+	//\brief Visit every triangle in a leaf whose bounds overlap a box
+	//\param a_callback called with the triangle index
+	template <typename TCallback>
+	void Query(const Vector & a_min, const Vector & a_max, TCallback a_callback) const
+	{
+		if (!IsBuilt())
+		{
+			return;
+		}
+
+		const float queryMin[3] = { a_min.GetX(), a_min.GetY(), a_min.GetZ() };
+		const float queryMax[3] = { a_max.GetX(), a_max.GetY(), a_max.GetZ() };
+		unsigned int stack[s_maxStackSize];
+		unsigned int stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0)
+		{
+			const Node & node = m_nodes[stack[--stackSize]];
+			if (!Overlaps(node, queryMin, queryMax))
+			{
+				continue;
+			}
+			if (node.IsLeaf())
+			{
+				for (unsigned int i = 0; i < node.m_count; ++i)
+				{
+					a_callback(m_triangles[node.m_leftFirst + i]);
+				}
+			}
+			else
+			{
+				assert(stackSize + 2 <= s_maxStackSize);
+				stack[stackSize++] = node.m_leftFirst + 1;
+				stack[stackSize++] = node.m_leftFirst;
+			}
+		}
+	}
+
+	//\brief Visit the triangles in leaves a ray passes through, nearer children first so hits can shorten the ray
+	//\param a_rayDir direction of the ray, lengths are measured in multiples of it so it need not be normalised
+	//\param a_callback called with the triangle index and the current ray length, returns the length to clip the ray to
+	template <typename TCallback>
+	void RayCast(const Vector & a_rayStart, const Vector & a_rayDir, float a_rayLength, TCallback a_callback) const
+	{
+		if (!IsBuilt())
+		{
+			return;
+		}
+
+		const float start[3] = { a_rayStart.GetX(), a_rayStart.GetY(), a_rayStart.GetZ() };
+		const float invDir[3] = { GetInverse(a_rayDir.GetX()), GetInverse(a_rayDir.GetY()), GetInverse(a_rayDir.GetZ()) };
+		float length = a_rayLength;
+		unsigned int stack[s_maxStackSize];
+		unsigned int stackSize = 0;
+		if (IntersectRay(m_nodes[0], start, invDir, length) < 0.0f)
+		{
+			return;
+		}
+		stack[stackSize++] = 0;
+		while (stackSize > 0)
+		{
+			const Node & node = m_nodes[stack[--stackSize]];
+			if (node.IsLeaf())
+			{
+				for (unsigned int i = 0; i < node.m_count; ++i)
+				{
+					const float clipped = a_callback(m_triangles[node.m_leftFirst + i], length);
+					length = clipped < length ? clipped : length;
+				}
+				continue;
+			}
+
+			// Push the further child first so the nearer one is popped next
+			unsigned int near = node.m_leftFirst;
+			unsigned int far = node.m_leftFirst + 1;
+			float nearDist = IntersectRay(m_nodes[near], start, invDir, length);
+			float farDist = IntersectRay(m_nodes[far], start, invDir, length);
+			if (farDist >= 0.0f && (nearDist < 0.0f || farDist < nearDist))
+			{
+				const unsigned int swapNode = near;		near = far;				far = swapNode;
+				const float swapDist = nearDist;		nearDist = farDist;		farDist = swapDist;
+			}
+			assert(stackSize + 2 <= s_maxStackSize);
+			if (farDist >= 0.0f)
+			{
+				stack[stackSize++] = far;
+			}
+			if (nearDist >= 0.0f)
+			{
+				stack[stackSize++] = near;
+			}
+		}
+	}
+
+private:
+
+	//\brief Branches have their two children next to each other at m_leftFirst, leaves have m_count triangles starting there
+	struct Node
+	{
+		float m_min[3];
+		unsigned int m_leftFirst{ 0 };
+		float m_max[3];
+		unsigned int m_count{ 0 };
+
+		inline bool IsLeaf() const { return m_count > 0; }
+	};
+	static_assert(sizeof(Node) == 32, "Mesh BVH nodes are sized to pack two to a cache line");
+
+	struct Bounds
+	{
+		float m_min[3];
+		float m_max[3];
+
+		inline void Reset()
+		{
+			m_min[0] = m_min[1] = m_min[2] = s_huge;
+			m_max[0] = m_max[1] = m_max[2] = -s_huge;
+		}
+		inline void Grow(const Vector & a_point)
+		{
+			const float point[3] = { a_point.GetX(), a_point.GetY(), a_point.GetZ() };
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				m_min[axis] = point[axis] < m_min[axis] ? point[axis] : m_min[axis];
+				m_max[axis] = point[axis] > m_max[axis] ? point[axis] : m_max[axis];
+			}
+		}
+		inline void Grow(const Bounds & a_bounds)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				m_min[axis] = a_bounds.m_min[axis] < m_min[axis] ? a_bounds.m_min[axis] : m_min[axis];
+				m_max[axis] = a_bounds.m_max[axis] > m_max[axis] ? a_bounds.m_max[axis] : m_max[axis];
+			}
+		}
+		inline float GetCentre(int a_axis) const { return (m_min[a_axis] + m_max[a_axis]) * 0.5f; }
+		inline float GetHalfArea() const
+		{
+			if (m_max[0] < m_min[0])
+			{
+				return 0.0f;
+			}
+			const float x = m_max[0] - m_min[0];
+			const float y = m_max[1] - m_min[1];
+			const float z = m_max[2] - m_min[2];
+			return x * y + y * z + z * x;
+		}
+	};
+
+	struct Bin
+	{
+		Bounds m_bounds;
+		unsigned int m_count{ 0 };
+	};
+
+	inline static float GetInverse(float a_value)
+	{
+		// A huge value keeps the slab maths free of the NaNs that infinity times zero would make
+		return a_value != 0.0f ? 1.0f / a_value : (a_value < 0.0f ? -1e30f : 1e30f);
+	}
+
+	inline static bool Overlaps(const Node & a_node, const float * a_min, const float * a_max)
+	{
+		return a_node.m_min[0] <= a_max[0] && a_min[0] <= a_node.m_max[0] &&
+			   a_node.m_min[1] <= a_max[1] && a_min[1] <= a_node.m_max[1] &&
+			   a_node.m_min[2] <= a_max[2] && a_min[2] <= a_node.m_max[2];
+	}
+
+	//\return distance along the ray to where it enters the node, negative for a miss
+	inline static float IntersectRay(const Node & a_node, const float * a_start, const float * a_invDir, float a_length)
+	{
+		float tMin = 0.0f;
+		float tMax = a_length;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float t1 = (a_node.m_min[axis] - a_start[axis]) * a_invDir[axis];
+			float t2 = (a_node.m_max[axis] - a_start[axis]) * a_invDir[axis];
+			if (t1 > t2)
+			{
+				const float swap = t1;
+				t1 = t2;
+				t2 = swap;
+			}
+			tMin = t1 > tMin ? t1 : tMin;
+			tMax = t2 < tMax ? t2 : tMax;
+			if (tMin > tMax)
+			{
+				return -1.0f;
+			}
+		}
+		return tMin;
+	}
+
+	//\brief Fit a node around its triangles then split it where the surface area heuristic says it's cheapest to test
+	void Subdivide(unsigned int a_nodeIndex, const std::vector<Bounds> & a_triBounds)
+	{
+		Bounds nodeBounds;
+		Bounds centreBounds;
+		nodeBounds.Reset();
+		centreBounds.Reset();
+		{
+			const Node & node = m_nodes[a_nodeIndex];
+			for (unsigned int i = 0; i < node.m_count; ++i)
+			{
+				const Bounds & triBounds = a_triBounds[m_triangles[node.m_leftFirst + i]];
+				nodeBounds.Grow(triBounds);
+				centreBounds.Grow(Vector(triBounds.GetCentre(0), triBounds.GetCentre(1), triBounds.GetCentre(2)));
+			}
+		}
+		Node & node = m_nodes[a_nodeIndex];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			node.m_min[axis] = nodeBounds.m_min[axis];
+			node.m_max[axis] = nodeBounds.m_max[axis];
+		}
+		if (node.m_count <= s_minLeafTriangles)
+		{
+			return;
+		}
+
+		// Drop the triangle centres into bins along each axis and sweep the bins for the cheapest split
+		int bestAxis = -1;
+		unsigned int bestSplit = 0;
+		const float nodeArea = nodeBounds.GetHalfArea();
+		float bestCost = nodeArea * (float)node.m_count;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float extent = centreBounds.m_max[axis] - centreBounds.m_min[axis];
+			if (extent <= 0.0f)
+			{
+				continue;
+			}
+
+			Bin bins[s_numBins];
+			for (Bin & bin : bins)
+			{
+				bin.m_bounds.Reset();
+			}
+			const float binScale = (float)s_numBins / extent;
+			for (unsigned int i = 0; i < node.m_count; ++i)
+			{
+				const Bounds & triBounds = a_triBounds[m_triangles[node.m_leftFirst + i]];
+				Bin & bin = bins[GetBin(triBounds.GetCentre(axis), centreBounds.m_min[axis], binScale)];
+				bin.m_bounds.Grow(triBounds);
+				++bin.m_count;
+			}
+
+			float rightArea[s_numBins];
+			unsigned int rightCount[s_numBins];
+			Bounds sweep;
+			sweep.Reset();
+			unsigned int count = 0;
+			for (unsigned int i = s_numBins - 1; i > 0; --i)
+			{
+				sweep.Grow(bins[i].m_bounds);
+				count += bins[i].m_count;
+				rightArea[i] = sweep.GetHalfArea();
+				rightCount[i] = count;
+			}
+			sweep.Reset();
+			count = 0;
+			for (unsigned int i = 1; i < s_numBins; ++i)
+			{
+				sweep.Grow(bins[i - 1].m_bounds);
+				count += bins[i - 1].m_count;
+				const float cost = nodeArea * s_traversalCost + sweep.GetHalfArea() * (float)count + rightArea[i] * (float)rightCount[i];
+				if (count > 0 && rightCount[i] > 0 && cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = i;
+				}
+			}
+		}
+
+		// Keep the node as a leaf when no split beats testing every triangle in it
+		if (bestAxis < 0)
+		{
+			return;
+		}
+
+		// Partition the triangles in place so each child's triangles are contiguous
+		const float binScale = (float)s_numBins / (centreBounds.m_max[bestAxis] - centreBounds.m_min[bestAxis]);
+		unsigned int first = node.m_leftFirst;
+		unsigned int last = node.m_leftFirst + node.m_count;
+		while (first < last)
+		{
+			if (GetBin(a_triBounds[m_triangles[first]].GetCentre(bestAxis), centreBounds.m_min[bestAxis], binScale) < bestSplit)
+			{
+				++first;
+			}
+			else
+			{
+				const unsigned int swapTri = m_triangles[first];
+				m_triangles[first] = m_triangles[--last];
+				m_triangles[last] = swapTri;
+			}
+		}
+
+		const unsigned int leftCount = first - node.m_leftFirst;
+		const unsigned int leftChild = (unsigned int)m_nodes.size();
+		m_nodes.resize(m_nodes.size() + 2);
+		Node & parent = m_nodes[a_nodeIndex];
+		m_nodes[leftChild].m_leftFirst = parent.m_leftFirst;
+		m_nodes[leftChild].m_count = leftCount;
+		m_nodes[leftChild + 1].m_leftFirst = first;
+		m_nodes[leftChild + 1].m_count = parent.m_count - leftCount;
+		parent.m_leftFirst = leftChild;
+		parent.m_count = 0;
+		Subdivide(leftChild, a_triBounds);
+		Subdivide(leftChild + 1, a_triBounds);
+	}
+
+	inline static unsigned int GetBin(float a_centre, float a_min, float a_binScale)
+	{
+		const unsigned int bin = (unsigned int)((a_centre - a_min) * a_binScale);
+		return bin < s_numBins ? bin : s_numBins - 1;
+	}
+
+	static const unsigned int s_numBins = 12;				///< Candidate split planes per axis are the gaps between bins
+	static const unsigned int s_minLeafTriangles = 2;		///< Nodes this small are never split
+	static constexpr float s_traversalCost = 1.0f;			///< Cost of visiting a branch relative to testing a triangle
+	static const unsigned int s_maxStackSize = 64;			///< Deeper than any tree the splits can build for a loadable mesh
+	static constexpr float s_huge = 1e30f;
+
+	std::vector<Node> m_nodes;							///< Root first, children of a branch are next to each other
+	std::vector<unsigned int> m_triangles;				///< Triangle indices sorted so each leaf's are contiguous
+	const Vector * m_verts{ nullptr };					///< Vertices of the mesh, not owned
+	const unsigned int * m_indices{ nullptr };			///< Three per triangle, not owned
+};
+
+#endif // _CORE_MESH_BVH_
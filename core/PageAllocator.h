@@ -55,6 +55,8 @@ public:
 		}
 		return nullptr;
 	}
+
+	inline bool IsInitialised() const { return m_memory != nullptr; }
 	
 	~Page()
 	{
@@ -100,16 +102,21 @@ public:
 
 	inline T * Add(unsigned int a_index)
 	{
-		// Calculate position in page from index
-		int pagePos = a_index - ((m_numPages-1) * m_itemsPerPage);
+		// Calculate which page the index lands in and the position in that page
+		const unsigned int page = a_index / m_itemsPerPage;
+		const unsigned int pagePos = a_index - (page * m_itemsPerPage);
+		assert(page < s_maxPages);
 
-		// Try to add to current page, otherwise setup a new page and add to that
-		void * newAlloc = m_pages[m_numPages-1].Add(pagePos);
-		if (newAlloc == nullptr)
+		// Pages kept from before a reset are reused rather than allocated again
+		while (m_numPages <= page)
 		{
-			m_pages[m_numPages++].Init(m_itemSize, m_itemsPerPage);
-			newAlloc = m_pages[m_numPages-1].Add(pagePos);
+			if (!m_pages[m_numPages].IsInitialised())
+			{
+				m_pages[m_numPages].Init(m_itemSize, m_itemsPerPage);
+			}
+			++m_numPages;
 		}
+		void * newAlloc = m_pages[page].Add(pagePos);
 		assert(newAlloc != nullptr);
 		++m_count;
 		return (T*)newAlloc;
@@ -124,9 +131,13 @@ public:
 
 	inline T * Get(unsigned int a_index)
 	{
-		// Calculate position in page from index
-		int pagePos = a_index - ((m_numPages-1) * m_itemsPerPage);
-		return (T*)m_pages[m_numPages-1].Get(pagePos);
+		// Calculate which page the index lands in and the position in that page
+		const unsigned int page = a_index / m_itemsPerPage;
+		if (page >= m_numPages)
+		{
+			return nullptr;
+		}
+		return (T*)m_pages[page].Get(a_index - (page * m_itemsPerPage));
 	}
 
 	inline unsigned int GetCount() const { return m_count; }
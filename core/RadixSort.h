@@ -0,0 +1,81 @@
+#ifndef _CORE_RADIX_SORT_
+#define _CORE_RADIX_SORT_
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+namespace RadixSort
+{
+	static const int s_bitsPerPass = 8;
+	static const int s_numBuckets = 1 << s_bitsPerPass;
+	static const int s_numPasses = 64 / s_bitsPerPass;
+
+	//\brief Sort 64 bit keys in ascending order, carrying a value along with each key
+	//		 Least significant byte first so the sort is stable, passes where every key has the same byte are skipped
+	//\param a_keys and a_values are sorted in place
+	//\param a_tempKeys and a_tempValues are scratch storage with room for a_count elements each
+	template <typename TValue>
+	void Sort(uint64_t * a_keys, TValue * a_values, uint64_t * a_tempKeys, TValue * a_tempValues, int a_count)
+	{
+		if (a_count <= 1)
+		{
+			return;
+		}
+
+		// Histogram every digit in one read of the keys
+		int counts[s_numPasses][s_numBuckets];
+		memset(&counts[0][0], 0, sizeof(counts));
+		for (int i = 0; i < a_count; ++i)
+		{
+			const uint64_t key = a_keys[i];
+			for (int pass = 0; pass < s_numPasses; ++pass)
+			{
+				++counts[pass][(key >> (pass * s_bitsPerPass)) & (s_numBuckets - 1)];
+			}
+		}
+
+		uint64_t * srcKeys = a_keys;
+		uint64_t * dstKeys = a_tempKeys;
+		TValue * srcValues = a_values;
+		TValue * dstValues = a_tempValues;
+		for (int pass = 0; pass < s_numPasses; ++pass)
+		{
+			// A digit shared by all keys won't change the order
+			const int shift = pass * s_bitsPerPass;
+			int * passCounts = counts[pass];
+			if (passCounts[(srcKeys[0] >> shift) & (s_numBuckets - 1)] == a_count)
+			{
+				continue;
+			}
+
+			// Turn counts into starting offsets for each bucket
+			int offset = 0;
+			for (int b = 0; b < s_numBuckets; ++b)
+			{
+				const int count = passCounts[b];
+				passCounts[b] = offset;
+				offset += count;
+			}
+
+			for (int i = 0; i < a_count; ++i)
+			{
+				const int dst = passCounts[(srcKeys[i] >> shift) & (s_numBuckets - 1)]++;
+				dstKeys[dst] = srcKeys[i];
+				dstValues[dst] = srcValues[i];
+			}
+
+			uint64_t * swapKeys = srcKeys; srcKeys = dstKeys; dstKeys = swapKeys;
+			TValue * swapValues = srcValues; srcValues = dstValues; dstValues = swapValues;
+		}
+
+		// Odd number of passes performed leaves the result in the scratch buffers
+		if (srcKeys != a_keys)
+		{
+			memcpy(a_keys, srcKeys, sizeof(uint64_t) * a_count);
+			memcpy(a_values, srcValues, sizeof(TValue) * a_count);
+		}
+	}
+}
+
+#endif // _CORE_RADIX_SORT_
@@ -24,7 +24,7 @@ public:
 
 	inline bool IsValid() const { return m_hi > m_low; }
 	inline T GetDiff() const { return m_hi - m_low; }
-	inline T GetMedian() const { return m_low + (GetDiff() * / 2.0)}
+	inline T GetMedian() const { return m_low + (GetDiff() / 2.0); }
 
 	T GetRandom()
 	{
@@ -36,7 +36,7 @@ public:
 };
 
 template <>
-Vector Range<Vector>::GetRandom()
+inline Vector Range<Vector>::GetRandom()
 {
 	return Vector(	m_low.GetX() + (m_hi.GetX() - m_low.GetX()) * MathUtils::RandFloat(),
 					m_low.GetY() + (m_hi.GetY() - m_low.GetY()) * MathUtils::RandFloat(),
@@ -44,7 +44,7 @@ Vector Range<Vector>::GetRandom()
 }
 
 template <>
-Colour Range<Colour>::GetRandom()
+inline Colour Range<Colour>::GetRandom()
 {
 	return Colour(	m_low.GetR() + (m_hi.GetR() - m_low.GetR()) * MathUtils::RandFloat(),
 					m_low.GetG() + (m_hi.GetG() - m_low.GetG()) * MathUtils::RandFloat(),
@@ -53,7 +53,7 @@ Colour Range<Colour>::GetRandom()
 }
 
 template <>
-bool Range<Colour>::IsValid() const
+inline bool Range<Colour>::IsValid() const
 {
 	return m_low.GetR() + m_low.GetG() + m_low.GetB() + m_low.GetA() > 0.0f && m_hi.GetR() + m_hi.GetG() + m_hi.GetB() + m_hi.GetA() > 0.0f;
 }
\ No newline at end of file
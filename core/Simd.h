@@ -0,0 +1,99 @@
+#ifndef _CORE_SIMD_
+#define _CORE_SIMD_
+#pragma once
+
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define SIMD_SSE 1
+	#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#define SIMD_NEON 1
+	#include <arm_neon.h>
+#endif
+
+//\brief Four wide float operations for kernels that process several objects at once
+//		 Maps to SSE or NEON where available and plain floats everywhere else so callers only write the kernel once.
+//		 Comparisons return a mask with every bit of a lane set where the comparison is true.
+namespace Simd
+{
+	static const int s_width = 4;	///< Number of floats processed by each operation
+
+#if SIMD_SSE
+	typedef __m128 Float4;
+
+	inline Float4 Load(const float * a_values) { return _mm_loadu_ps(a_values); }
+	inline void Store(float * a_values_OUT, Float4 a_val) { _mm_storeu_ps(a_values_OUT, a_val); }
+	inline Float4 Splat(float a_val) { return _mm_set1_ps(a_val); }
+	inline Float4 Add(Float4 a_a, Float4 a_b) { return _mm_add_ps(a_a, a_b); }
+	inline Float4 Sub(Float4 a_a, Float4 a_b) { return _mm_sub_ps(a_a, a_b); }
+	inline Float4 Mul(Float4 a_a, Float4 a_b) { return _mm_mul_ps(a_a, a_b); }
+	inline Float4 MulAdd(Float4 a_a, Float4 a_b, Float4 a_c) { return _mm_add_ps(_mm_mul_ps(a_a, a_b), a_c); }
+	inline Float4 Div(Float4 a_a, Float4 a_b) { return _mm_div_ps(a_a, a_b); }
+	inline Float4 Min(Float4 a_a, Float4 a_b) { return _mm_min_ps(a_a, a_b); }
+	inline Float4 Max(Float4 a_a, Float4 a_b) { return _mm_max_ps(a_a, a_b); }
+	inline Float4 CmpGe(Float4 a_a, Float4 a_b) { return _mm_cmpge_ps(a_a, a_b); }
+	inline Float4 CmpLe(Float4 a_a, Float4 a_b) { return _mm_cmple_ps(a_a, a_b); }
+	inline Float4 And(Float4 a_a, Float4 a_b) { return _mm_and_ps(a_a, a_b); }
+	inline Float4 Select(Float4 a_mask, Float4 a_true, Float4 a_false) { return _mm_or_ps(_mm_and_ps(a_mask, a_true), _mm_andnot_ps(a_mask, a_false)); }
+	inline Float4 AllTrue() { const Float4 zero = _mm_setzero_ps(); return _mm_cmpeq_ps(zero, zero); }
+	inline int MoveMask(Float4 a_mask) { return _mm_movemask_ps(a_mask); }
+
+#elif SIMD_NEON
+	typedef float32x4_t Float4;
+
+	inline Float4 Load(const float * a_values) { return vld1q_f32(a_values); }
+	inline void Store(float * a_values_OUT, Float4 a_val) { vst1q_f32(a_values_OUT, a_val); }
+	inline Float4 Splat(float a_val) { return vdupq_n_f32(a_val); }
+	inline Float4 Add(Float4 a_a, Float4 a_b) { return vaddq_f32(a_a, a_b); }
+	inline Float4 Sub(Float4 a_a, Float4 a_b) { return vsubq_f32(a_a, a_b); }
+	inline Float4 Mul(Float4 a_a, Float4 a_b) { return vmulq_f32(a_a, a_b); }
+	inline Float4 MulAdd(Float4 a_a, Float4 a_b, Float4 a_c) { return vmlaq_f32(a_c, a_a, a_b); }
+	inline Float4 Div(Float4 a_a, Float4 a_b)
+	{
+		// 32 bit NEON has no divide, refine the reciprocal estimate twice to get close to full precision
+		float32x4_t recip = vrecpeq_f32(a_b);
+		recip = vmulq_f32(vrecpsq_f32(a_b, recip), recip);
+		recip = vmulq_f32(vrecpsq_f32(a_b, recip), recip);
+		return vmulq_f32(a_a, recip);
+	}
+	inline Float4 Min(Float4 a_a, Float4 a_b) { return vminq_f32(a_a, a_b); }
+	inline Float4 Max(Float4 a_a, Float4 a_b) { return vmaxq_f32(a_a, a_b); }
+	inline Float4 CmpGe(Float4 a_a, Float4 a_b) { return vreinterpretq_f32_u32(vcgeq_f32(a_a, a_b)); }
+	inline Float4 CmpLe(Float4 a_a, Float4 a_b) { return vreinterpretq_f32_u32(vcleq_f32(a_a, a_b)); }
+	inline Float4 And(Float4 a_a, Float4 a_b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a_a), vreinterpretq_u32_f32(a_b))); }
+	inline Float4 Select(Float4 a_mask, Float4 a_true, Float4 a_false) { return vbslq_f32(vreinterpretq_u32_f32(a_mask), a_true, a_false); }
+	inline Float4 AllTrue() { return vreinterpretq_f32_u32(vdupq_n_u32(0xFFFFFFFF)); }
+	inline int MoveMask(Float4 a_mask)
+	{
+		const uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(a_mask), 31);
+		return (int)(vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) | (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3));
+	}
+
+#else
+	struct Float4 { float v[s_width]; };
+
+	//\brief Lane masks are stored in floats so reinterpret the bits rather than convert the value
+	inline unsigned int MaskBits(float a_val) { unsigned int bits; memcpy(&bits, &a_val, sizeof(bits)); return bits; }
+	inline float MaskFloat(unsigned int a_bits) { float val; memcpy(&val, &a_bits, sizeof(val)); return val; }
+
+	inline Float4 Load(const float * a_values) { Float4 r; memcpy(r.v, a_values, sizeof(r.v)); return r; }
+	inline void Store(float * a_values_OUT, Float4 a_val) { memcpy(a_values_OUT, a_val.v, sizeof(a_val.v)); }
+	inline Float4 Splat(float a_val) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = a_val; } return r; }
+	inline Float4 Add(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = a_a.v[i] + a_b.v[i]; } return r; }
+	inline Float4 Sub(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = a_a.v[i] - a_b.v[i]; } return r; }
+	inline Float4 Mul(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = a_a.v[i] * a_b.v[i]; } return r; }
+	inline Float4 MulAdd(Float4 a_a, Float4 a_b, Float4 a_c) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = a_a.v[i] * a_b.v[i] + a_c.v[i]; } return r; }
+	inline Float4 Div(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = a_a.v[i] / a_b.v[i]; } return r; }
+	inline Float4 Min(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = a_a.v[i] < a_b.v[i] ? a_a.v[i] : a_b.v[i]; } return r; }
+	inline Float4 Max(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = a_a.v[i] > a_b.v[i] ? a_a.v[i] : a_b.v[i]; } return r; }
+	inline Float4 CmpGe(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = MaskFloat(a_a.v[i] >= a_b.v[i] ? 0xFFFFFFFF : 0); } return r; }
+	inline Float4 CmpLe(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = MaskFloat(a_a.v[i] <= a_b.v[i] ? 0xFFFFFFFF : 0); } return r; }
+	inline Float4 And(Float4 a_a, Float4 a_b) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = MaskFloat(MaskBits(a_a.v[i]) & MaskBits(a_b.v[i])); } return r; }
+	inline Float4 Select(Float4 a_mask, Float4 a_true, Float4 a_false) { Float4 r; for (int i = 0; i < s_width; ++i) { r.v[i] = MaskBits(a_mask.v[i]) != 0 ? a_true.v[i] : a_false.v[i]; } return r; }
+	inline Float4 AllTrue() { return Splat(MaskFloat(0xFFFFFFFF)); }
+	inline int MoveMask(Float4 a_mask) { int r = 0; for (int i = 0; i < s_width; ++i) { r |= (MaskBits(a_mask.v[i]) >> 31) << i; } return r; }
+#endif
+}
+
+#endif // _CORE_SIMD_
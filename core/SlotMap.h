@@ -0,0 +1,202 @@
+#ifndef _CORE_SLOT_MAP_
+#define _CORE_SLOT_MAP_
+#pragma once
+
+#include <stdint.h>
+
+//\brief Handles pack a 32 bit slot index in the low half and the slot's generation in the high half.
+//		 Zero is never handed out so it can be used as a null handle.
+typedef uint64_t SlotHandle;
+
+//\brief Stores objects densely and hands out handles that stay valid until the object is removed.
+//		 Each slot remembers a generation that is bumped on removal so a handle to a removed object
+//		 resolves to null even after the slot is reused. Add, Remove and Get are all O(1), removal
+//		 swaps the last object into the hole so the values are always packed for iteration.
+template <typename T>
+class SlotMap
+{
+public:
+
+	static const SlotHandle s_invalidHandle = 0;
+	static const unsigned int s_invalidIndex = 0xFFFFFFFF;
+
+	SlotMap() = default;
+	SlotMap(const SlotMap &) = delete;
+	SlotMap & operator = (const SlotMap &) = delete;
+	~SlotMap()
+	{
+		Deallocate();
+	}
+
+	//\brief Add an object and get the handle to find it again
+	SlotHandle Add(const T & a_object)
+	{
+		if (m_count == m_capacity)
+		{
+			Grow(m_capacity == 0 ? s_defaultCapacity : m_capacity * 2);
+		}
+
+		// Reuse the most recently freed slot, otherwise take a fresh one off the end
+		unsigned int slotIndex = m_freeHead;
+		if (slotIndex != s_endOfFreeList)
+		{
+			m_freeHead = m_slots[slotIndex].m_index;
+		}
+		else
+		{
+			slotIndex = m_numSlots++;
+			m_slots[slotIndex].m_generation = 1;
+		}
+
+		Slot & slot = m_slots[slotIndex];
+		slot.m_index = m_count;
+		m_values[m_count] = a_object;
+		m_valueSlots[m_count] = slotIndex;
+		++m_count;
+		return MakeHandle(slotIndex, slot.m_generation);
+	}
+
+	//\brief Remove the object a handle refers to, the handle and any copies of it will no longer resolve
+	//\return false if the handle was stale or invalid
+	bool Remove(SlotHandle a_handle)
+	{
+		const unsigned int slotIndex = GetSlotIndex(a_handle);
+		if (!IsValid(a_handle))
+		{
+			return false;
+		}
+
+		// Move the last value into the hole and point its slot at the new position
+		Slot & slot = m_slots[slotIndex];
+		const unsigned int last = m_count - 1;
+		if (slot.m_index != last)
+		{
+			m_values[slot.m_index] = m_values[last];
+			m_valueSlots[slot.m_index] = m_valueSlots[last];
+			m_slots[m_valueSlots[last]].m_index = slot.m_index;
+		}
+		m_values[last] = T();
+		--m_count;
+
+		// Generation zero would let a fully wrapped slot match the null handle
+		if (++slot.m_generation == 0)
+		{
+			slot.m_generation = 1;
+		}
+		slot.m_index = m_freeHead;
+		m_freeHead = slotIndex;
+		return true;
+	}
+
+	//\return true if the handle refers to an object that is still in the map
+	inline bool IsValid(SlotHandle a_handle) const
+	{
+		const unsigned int slotIndex = GetSlotIndex(a_handle);
+		return slotIndex < m_numSlots && m_slots[slotIndex].m_generation == GetGeneration(a_handle) && a_handle != s_invalidHandle;
+	}
+
+	//\brief Resolve a handle
+	//\return a pointer to the object that stays valid until the next add or remove, nullptr for a stale handle
+	inline T * Get(SlotHandle a_handle)
+	{
+		return IsValid(a_handle) ? &m_values[m_slots[GetSlotIndex(a_handle)].m_index] : nullptr;
+	}
+
+	//\brief Find where the object a handle refers to is packed so data kept alongside the map can follow it
+	//\return the dense index that stays valid until the next remove, s_invalidIndex for a stale handle
+	inline unsigned int GetIndex(SlotHandle a_handle) const
+	{
+		return IsValid(a_handle) ? m_slots[GetSlotIndex(a_handle)].m_index : s_invalidIndex;
+	}
+
+	//\brief Exchange where two objects are packed, handles to both stay valid
+	inline void Swap(unsigned int a_indexA, unsigned int a_indexB)
+	{
+		const T value = m_values[a_indexA];
+		m_values[a_indexA] = m_values[a_indexB];
+		m_values[a_indexB] = value;
+		const unsigned int slotIndex = m_valueSlots[a_indexA];
+		m_valueSlots[a_indexA] = m_valueSlots[a_indexB];
+		m_valueSlots[a_indexB] = slotIndex;
+		m_slots[m_valueSlots[a_indexA]].m_index = a_indexA;
+		m_slots[m_valueSlots[a_indexB]].m_index = a_indexB;
+	}
+
+	//\brief Remove every object, all outstanding handles become stale
+	void Clear()
+	{
+		while (m_count > 0)
+		{
+			Remove(GetHandle(m_count - 1));
+		}
+	}
+
+	//\brief Dense access to the stored objects, order changes when objects are removed
+	inline unsigned int GetCount() const { return m_count; }
+	inline unsigned int GetCapacity() const { return m_capacity; }
+	inline T & GetValue(unsigned int a_index) { return m_values[a_index]; }
+	inline SlotHandle GetHandle(unsigned int a_index) const
+	{
+		const unsigned int slotIndex = m_valueSlots[a_index];
+		return MakeHandle(slotIndex, m_slots[slotIndex].m_generation);
+	}
+
+	//\brief Take a handle apart and put it back together, for passing handles where 64 bits don't fit
+	inline static unsigned int GetSlotIndex(SlotHandle a_handle) { return (unsigned int)(a_handle & 0xFFFFFFFF); }
+	inline static unsigned int GetGeneration(SlotHandle a_handle) { return (unsigned int)(a_handle >> 32); }
+	inline static SlotHandle MakeHandle(unsigned int a_slotIndex, unsigned int a_generation) { return ((SlotHandle)a_generation << 32) | a_slotIndex; }
+
+private:
+
+	//\brief Indirection from a handle to the dense arrays, free slots use m_index as the next free slot
+	struct Slot
+	{
+		unsigned int m_index{ 0 };
+		unsigned int m_generation{ 0 };
+	};
+
+	//\brief There are never more slots than the peak number of objects so all three arrays share a capacity
+	void Grow(unsigned int a_newCapacity)
+	{
+		Slot * slots = new Slot[a_newCapacity];
+		T * values = new T[a_newCapacity];
+		unsigned int * valueSlots = new unsigned int[a_newCapacity];
+		for (unsigned int i = 0; i < m_numSlots; ++i)
+		{
+			slots[i] = m_slots[i];
+		}
+		for (unsigned int i = 0; i < m_count; ++i)
+		{
+			values[i] = m_values[i];
+			valueSlots[i] = m_valueSlots[i];
+		}
+		Deallocate();
+		m_slots = slots;
+		m_values = values;
+		m_valueSlots = valueSlots;
+		m_capacity = a_newCapacity;
+	}
+
+	void Deallocate()
+	{
+		delete[] m_slots;
+		delete[] m_values;
+		delete[] m_valueSlots;
+		m_slots = nullptr;
+		m_values = nullptr;
+		m_valueSlots = nullptr;
+	}
+
+	static const unsigned int s_defaultCapacity = 64;			///< Allocated on first add
+	static const unsigned int s_endOfFreeList = 0xFFFFFFFF;
+
+	Slot * m_slots{ nullptr };									///< Handle indirection, indexed by the low half of a handle
+	T * m_values{ nullptr };									///< Objects packed at the front
+	unsigned int * m_valueSlots{ nullptr };						///< The slot each packed object belongs to so removal can fix up the moved object
+	unsigned int m_numSlots{ 0 };								///< Slots that have ever been used
+	unsigned int m_count{ 0 };									///< Objects currently stored
+	unsigned int m_capacity{ 0 };								///< Size of all three arrays
+	unsigned int m_freeHead{ s_endOfFreeList };					///< Most recently freed slot
+};
+
+#endif // _CORE_SLOT_MAP_
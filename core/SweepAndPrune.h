@@ -0,0 +1,214 @@
+#ifndef _CORE_SWEEP_AND_PRUNE_
+#define _CORE_SWEEP_AND_PRUNE_
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Vector.h"
+
+//\brief Incremental sweep and prune broadphase over axis aligned boxes. Proxies stay sorted by their minimum along
+//		 one axis between frames, objects barely move from one frame to the next so an insertion sort only has
+//		 to shuffle a few neighbours. The sort axis follows whichever axis the boxes are most spread out along.
+class SweepAndPrune
+{
+public:
+
+	//\brief An overlapping pair, each unordered pair is only reported once
+	struct Pair
+	{
+		void * m_userDataA{ nullptr };
+		void * m_userDataB{ nullptr };
+	};
+
+	//\brief Start tracking an object, its bounds are empty until the first UpdateProxy
+	void Add(void * a_userData)
+	{
+		Proxy proxy;
+		proxy.m_userData = a_userData;
+		m_proxies.push_back(proxy);
+		++m_numAdded;
+	}
+
+	//\brief Stop tracking an object, keeps the order of the remaining proxies so the next sort stays cheap
+	//\return false if the object was not being tracked
+	bool Remove(void * a_userData)
+	{
+		for (auto it = m_proxies.begin(); it != m_proxies.end(); ++it)
+		{
+			if (it->m_userData == a_userData)
+			{
+				m_proxies.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Clear()
+	{
+		m_proxies.clear();
+		m_numAdded = 0;
+	}
+
+	//\brief Proxies are walked in sorted order to refresh their bounds before each FindPairs
+	inline unsigned int GetNumProxies() const { return (unsigned int)m_proxies.size(); }
+	inline void * GetUserData(unsigned int a_index) const { return m_proxies[a_index].m_userData; }
+
+	//\brief Set the world bounds and filter for a proxy
+	//\param a_groupBits which collision groups the object is in
+	//\param a_collidesWith which collision groups the object wants to hear about, a pair is kept if either side wants the other
+	inline void UpdateProxy(unsigned int a_index, const Vector & a_min, const Vector & a_max, unsigned int a_groupBits, unsigned int a_collidesWith)
+	{
+		Proxy & proxy = m_proxies[a_index];
+		proxy.m_min[0] = a_min.GetX();	proxy.m_min[1] = a_min.GetY();	proxy.m_min[2] = a_min.GetZ();
+		proxy.m_max[0] = a_max.GetX();	proxy.m_max[1] = a_max.GetY();	proxy.m_max[2] = a_max.GetZ();
+		proxy.m_groupBits = a_groupBits;
+		proxy.m_collidesWith = a_collidesWith;
+	}
+
+	//\brief Sort the proxies and collect every overlapping pair that passes the group filter
+	//\param a_pairs_OUT is cleared and filled with the overlapping pairs
+	void FindPairs(std::vector<Pair> & a_pairs_OUT)
+	{
+		a_pairs_OUT.clear();
+		ChooseAxis();
+		Sort();
+
+		const int axis = m_axis;
+		const int axisB = (axis + 1) % 3;
+		const int axisC = (axis + 2) % 3;
+		const unsigned int numProxies = (unsigned int)m_proxies.size();
+		for (unsigned int i = 0; i < numProxies; ++i)
+		{
+			const Proxy & proxyA = m_proxies[i];
+			const float sweepEnd = proxyA.m_max[axis];
+			for (unsigned int j = i + 1; j < numProxies && m_proxies[j].m_min[axis] <= sweepEnd; ++j)
+			{
+				const Proxy & proxyB = m_proxies[j];
+				if ((proxyA.m_collidesWith & proxyB.m_groupBits) == 0 && (proxyB.m_collidesWith & proxyA.m_groupBits) == 0)
+				{
+					continue;
+				}
+				if (proxyA.m_min[axisB] > proxyB.m_max[axisB] || proxyB.m_min[axisB] > proxyA.m_max[axisB] ||
+					proxyA.m_min[axisC] > proxyB.m_max[axisC] || proxyB.m_min[axisC] > proxyA.m_max[axisC])
+				{
+					continue;
+				}
+				Pair pair;
+				pair.m_userDataA = proxyA.m_userData;
+				pair.m_userDataB = proxyB.m_userData;
+				a_pairs_OUT.push_back(pair);
+			}
+		}
+	}
+
+	//\brief Stats from the last FindPairs for tuning and debug display
+	inline int GetSortAxis() const { return m_axis; }
+	inline unsigned int GetNumSwaps() const { return m_numSwaps; }
+
+private:
+
+	struct Proxy
+	{
+		float m_min[3]{ 0.0f, 0.0f, 0.0f };
+		float m_max[3]{ 0.0f, 0.0f, 0.0f };
+		void * m_userData{ nullptr };
+		unsigned int m_groupBits{ 0 };
+		unsigned int m_collidesWith{ 0 };
+	};
+
+	//\brief Pick the axis with the greatest variance of box centres, only switching when another axis is clearly better
+	//		 so objects spread evenly over two axes don't make the order thrash between them
+	void ChooseAxis()
+	{
+		const unsigned int numProxies = (unsigned int)m_proxies.size();
+		if (numProxies < 2)
+		{
+			return;
+		}
+
+		float sum[3] = { 0.0f, 0.0f, 0.0f };
+		float sumSq[3] = { 0.0f, 0.0f, 0.0f };
+		for (const Proxy & proxy : m_proxies)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float centre = (proxy.m_min[axis] + proxy.m_max[axis]) * 0.5f;
+				sum[axis] += centre;
+				sumSq[axis] += centre * centre;
+			}
+		}
+
+		const float invNum = 1.0f / (float)numProxies;
+		int bestAxis = m_axis;
+		float bestVariance = 0.0f;
+		float variance[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float mean = sum[axis] * invNum;
+			variance[axis] = sumSq[axis] * invNum - mean * mean;
+			if (variance[axis] > bestVariance)
+			{
+				bestVariance = variance[axis];
+				bestAxis = axis;
+			}
+		}
+
+		if (bestAxis != m_axis && variance[bestAxis] > variance[m_axis] * s_axisSwitchRatio)
+		{
+			m_axis = bestAxis;
+			m_fullSort = true;
+		}
+	}
+
+	//\brief Insertion sort on the minimum along the sort axis, close to linear when the order barely changed.
+	//		 A new axis or a lot of new proxies at the end means the old order is no help so it gets a full sort instead.
+	void Sort()
+	{
+		const int axis = m_axis;
+		m_numSwaps = 0;
+		if (m_fullSort || m_numAdded > s_maxInsertedProxies)
+		{
+			std::stable_sort(m_proxies.begin(), m_proxies.end(), [axis](const Proxy & a_proxyA, const Proxy & a_proxyB)
+			{
+				return a_proxyA.m_min[axis] < a_proxyB.m_min[axis];
+			});
+			m_fullSort = false;
+			m_numAdded = 0;
+			return;
+		}
+		m_numAdded = 0;
+
+		const unsigned int numProxies = (unsigned int)m_proxies.size();
+		for (unsigned int i = 1; i < numProxies; ++i)
+		{
+			const float key = m_proxies[i].m_min[axis];
+			if (m_proxies[i - 1].m_min[axis] <= key)
+			{
+				continue;
+			}
+
+			const Proxy moving = m_proxies[i];
+			unsigned int j = i;
+			while (j > 0 && m_proxies[j - 1].m_min[axis] > key)
+			{
+				m_proxies[j] = m_proxies[j - 1];
+				--j;
+			}
+			m_proxies[j] = moving;
+			m_numSwaps += i - j;
+		}
+	}
+
+	static constexpr float s_axisSwitchRatio = 1.5f;		///< How much more spread another axis needs before the sort axis changes
+	static const unsigned int s_maxInsertedProxies = 32;	///< More new proxies than this are cheaper to place with a full sort
+
+	std::vector<Proxy> m_proxies;						///< Kept sorted by minimum along the sort axis between frames
+	int m_axis{ 0 };									///< Axis the proxies are sorted along
+	bool m_fullSort{ false };							///< Set when the axis changes so the next sort starts from scratch
+	unsigned int m_numAdded{ 0 };						///< Proxies added since the last sort
+	unsigned int m_numSwaps{ 0 };						///< Places moved by the last insertion sort
+};
+
+#endif // _CORE_SWEEP_AND_PRUNE_
@@ -57,20 +57,10 @@ bool AnimationBlender::Update(float a_dt)
 		{
 			const float fracToNextFrame = MathUtils::GetMin(m_channels[i].m_lastFrame / m_channels[i].m_frameRateRecip, 1.0f);
 			
-			// Lerp between postions
-			Vector curKey = m_channels[i].m_data->m_pos;
-			Vector nextKey = m_channels[i].m_curFrame < m_channels[i].m_numFrames-1 ? (m_channels[i].m_data+1)->m_pos : curKey;
-			keyPos = MathUtils::LerpVector(curKey, nextKey, fracToNextFrame);
-			
-			// Rotations
-			curKey = m_channels[i].m_data->m_rot;
-			nextKey = m_channels[i].m_curFrame < m_channels[i].m_numFrames-1 ? (m_channels[i].m_data+1)->m_rot : curKey;
-			keyRot = MathUtils::LerpVector(curKey, nextKey, fracToNextFrame);
-
-			// Scale
-			curKey = m_channels[i].m_data->m_scale;
-			nextKey = m_channels[i].m_curFrame < m_channels[i].m_numFrames-1 ? (m_channels[i].m_data+1)->m_scale : curKey;
-			keyScale = MathUtils::LerpVector(curKey, nextKey, fracToNextFrame);
+			// Sample pos, rot and scale part way to the next frame, clips only hold one transform per object for now
+			const float lastFrame = (float)(m_channels[i].m_numFrames - 1);
+			const float sampleFrame = MathUtils::GetMin((float)m_channels[i].m_curFrame + fracToNextFrame, lastFrame);
+			m_channels[i].m_clip->Sample(0, sampleFrame, keyPos, keyRot, keyScale);
 
 			// If it's time for a new frame
 			if (m_channels[i].m_curFrame == 0 || m_channels[i].m_lastFrame >= m_channels[i].m_frameRateRecip)
@@ -80,7 +70,6 @@ bool AnimationBlender::Update(float a_dt)
 					m_channels[i].m_lastFrame -= m_channels[i].m_frameRateRecip;
 				}
 				m_channels[i].m_curFrame++;
-				m_channels[i].m_data++;
 				playedAnim = true;
 			}
 			else // Accumulate time
@@ -2,10 +2,10 @@
 
 #include "../core/Matrix.h"
 
+#include "AnimationClip.h"
 #include "StringHash.h"
 
 class GameObject;
-struct KeyFrame;
 
 //\brief Animation Blender reads animation data and applies it to a model
 class AnimationBlender
@@ -19,15 +19,15 @@ public:
 	//\brief Update will apply keyframes to the model from animation channels
 	bool Update(float a_dt);
 
-	//\brief Play will start the blender mixing data from the provided keyframe stream into the transforms
-	inline bool PlayAnimation(KeyFrame * a_data, int a_numFrames, int a_frameRate, StringHash a_animName)
+	//\brief Play will start the blender mixing data sampled from the provided clip into the transforms
+	inline bool PlayAnimation(const AnimationClip * a_clip, int a_frameRate, StringHash a_animName)
 	{
 		int freeChannel = GetChannel();
 		if (freeChannel >= 0 && freeChannel < s_maxAnimationChannels)
 		{
-			m_channels[freeChannel].m_data = a_data;
+			m_channels[freeChannel].m_clip = a_clip;
 			m_channels[freeChannel].m_curFrame = 0;
-			m_channels[freeChannel].m_numFrames = a_numFrames;
+			m_channels[freeChannel].m_numFrames = (int)a_clip->GetNumFrames();
 			m_channels[freeChannel].m_frameRateRecip = 1.0f / a_frameRate;
 			m_channels[freeChannel].m_lastFrame = 0.0f;
 			m_channels[freeChannel].m_active = true;
@@ -54,7 +54,7 @@ private:
 			, m_frameRateRecip(0.0f)
 			, m_lastFrame(0.0f)
 			, m_name()
-			, m_data(nullptr) { }
+			, m_clip(nullptr) { }
 		bool m_active;				///< If an animation is currently playing
 		float m_influence;			///< How much weight the animation has
 		int m_curFrame;				///< How far through the animation
@@ -62,7 +62,7 @@ private:
 		float m_frameRateRecip;		///< Reciprocal of how many frames should be played per second
 		float m_lastFrame;			///< The time elapsed since the last frame was played
 		StringHash m_name;			///< The name of the animation that is being played
-		KeyFrame * m_data;			///< The current keyframe data for the channel
+		const AnimationClip * m_clip;	///< The animation data for the channel
 	};
 
 	//\brief Get the next free channel to play an animation on
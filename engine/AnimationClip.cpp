@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "../core/MathUtils.h"
+
+#include "AnimationClip.h"
+
+const float AnimationClip::s_posTolerance = 0.001f;
+const float AnimationClip::s_rotTolerance = 0.01f;
+const float AnimationClip::s_scaleTolerance = 0.001f;
+
+bool AnimationClip::AddChannel(const char * a_transformName, const KeyFrame * a_frames, unsigned int a_numFrames)
+{
+	if (a_frames == nullptr || a_numFrames == 0 || a_numFrames > s_maxFrames)
+	{
+		return false;
+	}
+	if (!m_channels.empty() && a_numFrames != m_numFrames)
+	{
+		return false;
+	}
+	m_numFrames = a_numFrames;
+
+	// Name goes on the end of the table
+	Channel channel;
+	const char * name = a_transformName != nullptr ? a_transformName : "";
+	channel.m_nameHash = StringHash::GenerateCRC(name);
+	channel.m_nameOffset = (unsigned int)m_nameTable.size();
+	m_nameTable.insert(m_nameTable.end(), name, name + strlen(name) + 1);
+
+	std::vector<float> values(a_numFrames);
+	std::vector<unsigned int> keys;
+	keys.reserve(a_numFrames);
+	for (unsigned int i = 0; i < s_numTracks; ++i)
+	{
+		// Pull one component out of the frames
+		const unsigned int component = i % 3;
+		float tolerance = s_posTolerance;
+		for (unsigned int j = 0; j < a_numFrames; ++j)
+		{
+			const Vector & source = i < 3 ? a_frames[j].m_pos : i < 6 ? a_frames[j].m_rot : a_frames[j].m_scale;
+			values[j] = component == 0 ? source.GetX() : component == 1 ? source.GetY() : source.GetZ();
+		}
+		if (i >= 3)
+		{
+			tolerance = i < 6 ? s_rotTolerance : s_scaleTolerance;
+		}
+
+		// Rounding to 16 bits adds up to half a step of error on top of the reduction. The kept keys can't span more
+		// than the whole track so its range bounds the step, tracks too wide to quantise within tolerance stay as floats.
+		const float maxQuantised = 65535.0f;
+		const auto range = std::minmax_element(values.begin(), values.end());
+		const float quantiseError = (*range.second - *range.first) / maxQuantised * 0.5f;
+		Track & track = channel.m_tracks[i];
+		track.m_quantised = m_quantise && quantiseError < tolerance;
+
+		ReduceTrack(values, track.m_quantised ? tolerance - quantiseError : tolerance, keys);
+
+		// Quantise against the range of the kept keys
+		track.m_firstKey = (unsigned int)m_keyFrames.size();
+		track.m_numKeys = (unsigned int)keys.size();
+		track.m_firstValue = (unsigned int)(track.m_quantised ? m_quantisedValues.size() : m_values.size());
+		float maxValue = values[keys[0]];
+		track.m_min = maxValue;
+		for (unsigned int key : keys)
+		{
+			track.m_min = MathUtils::GetMin(track.m_min, values[key]);
+			maxValue = MathUtils::GetMax(maxValue, values[key]);
+		}
+		track.m_step = (maxValue - track.m_min) / maxQuantised;
+		for (unsigned int key : keys)
+		{
+			m_keyFrames.push_back((unsigned short)key);
+			if (track.m_quantised)
+			{
+				const float quantised = track.m_step > 0.0f ? (values[key] - track.m_min) / track.m_step + 0.5f : 0.0f;
+				m_quantisedValues.push_back((unsigned short)MathUtils::Clamp(0.0f, quantised, maxQuantised));
+			}
+			else
+			{
+				m_values.push_back(values[key]);
+			}
+		}
+	}
+
+	m_channels.push_back(channel);
+	return true;
+}
+
+void AnimationClip::ReduceTrack(const std::vector<float> & a_values, float a_tolerance, std::vector<unsigned int> & a_keys_OUT)
+{
+	a_keys_OUT.clear();
+	a_keys_OUT.push_back(0);
+	const unsigned int numValues = (unsigned int)a_values.size();
+
+	// A track that doesn't move only needs one key
+	bool constant = true;
+	for (unsigned int i = 1; i < numValues && constant; ++i)
+	{
+		constant = fabsf(a_values[i] - a_values[0]) <= a_tolerance;
+	}
+	if (constant)
+	{
+		return;
+	}
+
+	// Grow a segment from the last kept key until a key in between strays too far from the line, then keep the key before
+	unsigned int anchor = 0;
+	for (unsigned int end = 2; end < numValues; ++end)
+	{
+		const float startValue = a_values[anchor];
+		const float gradient = (a_values[end] - startValue) / (float)(end - anchor);
+		for (unsigned int i = anchor + 1; i < end; ++i)
+		{
+			if (fabsf(startValue + gradient * (float)(i - anchor) - a_values[i]) > a_tolerance)
+			{
+				anchor = end - 1;
+				a_keys_OUT.push_back(anchor);
+				break;
+			}
+		}
+	}
+	a_keys_OUT.push_back(numValues - 1);
+}
+
+float AnimationClip::SampleTrack(const Track & a_track, float a_frame) const
+{
+	const unsigned int firstKey = a_track.m_firstKey;
+	const unsigned int lastKey = firstKey + a_track.m_numKeys - 1;
+	if (a_track.m_numKeys == 1 || a_frame <= (float)m_keyFrames[firstKey])
+	{
+		return GetValue(a_track, firstKey);
+	}
+	if (a_frame >= (float)m_keyFrames[lastKey])
+	{
+		return GetValue(a_track, lastKey);
+	}
+
+	// First key after the frame, there is always one before it
+	const unsigned short * trackFrames = &m_keyFrames[firstKey];
+	const unsigned int nextKey = firstKey + (unsigned int)(std::upper_bound(trackFrames, trackFrames + a_track.m_numKeys, a_frame,
+		[](float a_time, unsigned short a_keyFrame) { return a_time < (float)a_keyFrame; }) - trackFrames);
+	const unsigned int prevKey = nextKey - 1;
+	const float prevFrame = (float)m_keyFrames[prevKey];
+	const float t = (a_frame - prevFrame) / ((float)m_keyFrames[nextKey] - prevFrame);
+	const float prevValue = GetValue(a_track, prevKey);
+	return prevValue + (GetValue(a_track, nextKey) - prevValue) * t;
+}
+
+void AnimationClip::Sample(unsigned int a_channel, float a_frame, Vector & a_pos_OUT, Vector & a_rot_OUT, Vector & a_scale_OUT) const
+{
+	if (a_channel >= m_channels.size())
+	{
+		return;
+	}
+
+	const Track * tracks = &m_channels[a_channel].m_tracks[0];
+	a_pos_OUT = Vector(SampleTrack(tracks[0], a_frame), SampleTrack(tracks[1], a_frame), SampleTrack(tracks[2], a_frame));
+	a_rot_OUT = Vector(SampleTrack(tracks[3], a_frame), SampleTrack(tracks[4], a_frame), SampleTrack(tracks[5], a_frame));
+	a_scale_OUT = Vector(SampleTrack(tracks[6], a_frame), SampleTrack(tracks[7], a_frame), SampleTrack(tracks[8], a_frame));
+}
+
+int AnimationClip::FindChannel(const StringHash & a_transformName) const
+{
+	for (unsigned int i = 0; i < m_channels.size(); ++i)
+	{
+		if (a_transformName == m_channels[i].m_nameHash)
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+size_t AnimationClip::GetMemorySize() const
+{
+	return sizeof(AnimationClip) +
+		m_channels.capacity() * sizeof(Channel) +
+		m_nameTable.capacity() * sizeof(char) +
+		m_keyFrames.capacity() * sizeof(unsigned short) +
+		m_values.capacity() * sizeof(float) +
+		m_quantisedValues.capacity() * sizeof(unsigned short);
+}
@@ -0,0 +1,118 @@
+#ifndef _ENGINE_ANIMATION_CLIP_
+#define _ENGINE_ANIMATION_CLIP_
+#pragma once
+
+#include <vector>
+
+#include "../core/Vector.h"
+
+#include "StringHash.h"
+
+//\brief A KeyFrame stores data to apply to a model at a certain time, only used while an animation is loading
+struct KeyFrame
+{
+	KeyFrame()
+		: m_time(0)
+		, m_pos(0.0f)
+		, m_rot(0.0f)
+		, m_scale(1.0f) { }
+	int m_time;					///< What relative time the keyframe is applied
+	Vector m_pos;				///< Where the keyframe locates the transform
+	Vector m_rot;				///< Three axis of rotation
+	Vector m_scale;				///< Scale in each dimension
+};
+
+//\brief An AnimationClip is the compact form of an animation that blenders sample from.
+//		 Each transform the animation moves is a channel with a separate track for every component of
+//		 position, rotation and scale. Keys that lie on a line between their neighbours are dropped and
+//		 the remaining keys are stored as an array of frames and an array of values, which can be
+//		 quantised to 16 bits against the range of their track when that stays within the tolerance.
+//		 Transform names are stored once per clip.
+class AnimationClip
+{
+public:
+
+	static const unsigned int s_numTracks = 9;				///< Position, rotation and scale, each with x, y and z
+	static const unsigned int s_maxFrames = 65536;			///< Key frames are stored in 16 bits
+	static const float s_posTolerance;						///< How far a position can be from the source keys once reduced
+	static const float s_rotTolerance;						///< How many degrees a rotation can be from the source keys once reduced
+	static const float s_scaleTolerance;					///< How far a scale can be from the source keys once reduced
+
+	//\brief Values are stored as floats or quantised to 16 bits, a quantised clip still keeps floats for tracks
+	//		 whose range is too wide to quantise within the tolerance
+	AnimationClip(bool a_quantise = true)
+		: m_numFrames(0)
+		, m_quantise(a_quantise) { }
+
+	//\brief Reduce a stream of key frames for one transform and add them as a channel
+	//\param a_transformName what the keys locate, copied into the clip's name table
+	//\param a_frames one key frame per frame of the animation
+	//\param a_numFrames how many frames there are, all channels of a clip are the same length
+	//\return false if the frame count doesn't fit or doesn't match the other channels
+	bool AddChannel(const char * a_transformName, const KeyFrame * a_frames, unsigned int a_numFrames);
+
+	//\brief Evaluate a channel at a time in frames, between keys the values are blended linearly
+	void Sample(unsigned int a_channel, float a_frame, Vector & a_pos_OUT, Vector & a_rot_OUT, Vector & a_scale_OUT) const;
+
+	//\brief Find the channel for a transform
+	//\return the channel index or -1 if the clip doesn't move the transform
+	int FindChannel(const StringHash & a_transformName) const;
+
+	//\brief Accessors for the clip's contents
+	inline const char * GetChannelName(unsigned int a_channel) const { return &m_nameTable[m_channels[a_channel].m_nameOffset]; }
+	inline unsigned int GetNumChannels() const { return (unsigned int)m_channels.size(); }
+	inline unsigned int GetNumFrames() const { return m_numFrames; }
+	inline unsigned int GetNumKeys() const { return (unsigned int)m_keyFrames.size(); }
+
+	//\return if tracks are quantised where the tolerance allows, wide tracks keep floats either way
+	inline bool IsQuantised() const { return m_quantise; }
+
+	//\return how many bytes the clip uses including all its arrays
+	size_t GetMemorySize() const;
+
+private:
+
+	//\brief A track is one component's keys, a contiguous run of the clip's key arrays
+	struct Track
+	{
+		unsigned int m_firstKey{ 0 };		///< Index of the track's first key
+		unsigned int m_numKeys{ 0 };		///< How many keys the track kept after reduction
+		float m_min{ 0.0f };				///< Smallest value on the track
+		float m_step{ 0.0f };				///< Quantised values are m_min + value * m_step
+		unsigned int m_firstValue{ 0 };		///< Index of the track's first value in the float or quantised values
+		bool m_quantised{ false };			///< If the track's values are stored in 16 bits
+	};
+
+	//\brief A channel is everything that moves one transform
+	struct Channel
+	{
+		unsigned int m_nameHash{ 0 };		///< Hash of the transform name for lookups
+		unsigned int m_nameOffset{ 0 };		///< Where the transform name starts in the name table
+		Track m_tracks[s_numTracks];		///< Position xyz, rotation xyz then scale xyz
+	};
+
+	//\brief Drop keys that are within a tolerance of the line between the keys kept either side
+	//\param a_values one value per frame
+	//\param a_keys_OUT receives the frames that are kept, always the first and last unless the track is constant
+	static void ReduceTrack(const std::vector<float> & a_values, float a_tolerance, std::vector<unsigned int> & a_keys_OUT);
+
+	//\return the value of a key on a track
+	inline float GetValue(const Track & a_track, unsigned int a_key) const
+	{
+		const unsigned int value = a_track.m_firstValue + a_key - a_track.m_firstKey;
+		return a_track.m_quantised ? a_track.m_min + (float)m_quantisedValues[value] * a_track.m_step : m_values[value];
+	}
+
+	//\brief Evaluate one track at a time in frames
+	float SampleTrack(const Track & a_track, float a_frame) const;
+
+	std::vector<Channel> m_channels;					///< One channel for each transform the clip moves
+	std::vector<char> m_nameTable;						///< All the transform names one after the other, each null terminated
+	std::vector<unsigned short> m_keyFrames;			///< Frame of every key in the clip
+	std::vector<float> m_values;						///< Value of every key on tracks that aren't quantised
+	std::vector<unsigned short> m_quantisedValues;		///< Value of every key on quantised tracks
+	unsigned int m_numFrames;							///< How many frames long each channel is
+	bool m_quantise;									///< If values are stored in 16 bits where the tolerance allows
+};
+
+#endif // _ENGINE_ANIMATION_CLIP_
@@ -11,16 +11,12 @@
 
 template<> AnimationManager * Singleton<AnimationManager>::s_instance = nullptr;
 
-const unsigned int AnimationManager::s_animPoolSize = 67108864;					///< How much memory is assigned for all game animations
 const float AnimationManager::s_updateFreq = 1.0f;								///< How often the animation manager should check for updates to disk resources
 
 using namespace std;	//< For fstream operations
 
 bool AnimationManager::Startup(const char * a_animPath, const DataPack * a_dataPack)
 {
-	// Initialise the anim memory pool
-	m_data.Init(s_animPoolSize);
-
 	// Cache off path and look for the main game lua file
 	strncpy(m_animPath, a_animPath, sizeof(char) * strlen(a_animPath) + 1);
 
@@ -86,9 +82,6 @@ bool AnimationManager::Shutdown()
 		delete cur;
 	}
 
-	// Clean up the memory pool
-	m_data.Done();
-
 	return true;
 }
 
@@ -159,7 +152,7 @@ bool AnimationManager::PlayAnimation(GameObject * a_gameObj, const StringHash &
 		}
 		if (AnimationBlender * blend = a_gameObj->GetAnimationBlender())
 		{
-			return blend->PlayAnimation(foundAnim->m_data, foundAnim->m_numKeys, foundAnim->m_frameRate, foundAnim->m_name);
+			return blend->PlayAnimation(&foundAnim->m_clip, foundAnim->m_frameRate, foundAnim->m_name);
 		}
 	}
 
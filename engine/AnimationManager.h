@@ -2,10 +2,14 @@
 #define _ENGINE_ANIMATION_MANAGER_
 #pragma once
 
+#include <vector>
+
 #include "../core/LinearAllocator.h"
 #include "../core/LinkedList.h"
 #include "../core/Matrix.h"
 
+#include "AnimationClip.h"
+#include "DataPack.h"
 #include "FileManager.h"
 #include "Log.h"
 #include "Singleton.h"
@@ -15,22 +19,6 @@ class DataPack;
 struct DataPackEntry;
 class GameObject;
 
-//\brief A KeyFrame stores data to apply to a model at a certain time
-struct KeyFrame
-{
-	KeyFrame()
-		: m_time(0)
-		, m_pos(0.0f)
-		, m_rot(0.0f)
-		, m_scale(1.0f)
-		, m_transformName() { }
-	int m_time;					///< What relative time the keyframe is applied
-	Vector m_pos;					///< Where the keyframe locates the transform
-	Vector m_rot;					///< Three axis of rotation
-	Vector m_scale;					///< Scale in each dimension
-	StringHash m_transformName;		///< What the keyframe locates 
-};
-
 //\brief AnimationManager loads animations for disk resources and supplies to animation blenders
 class AnimationManager : public Singleton<AnimationManager>
 {
@@ -40,7 +28,6 @@ public:
 	AnimationManager(float a_updateFreq = s_updateFreq) 
 		: m_updateFreq(a_updateFreq)
 		, m_updateTimer(0.0f)
-		, m_data()
 		{ m_animPath[0] = '\0'; }
 	~AnimationManager() { Shutdown(); }
 
@@ -56,7 +43,6 @@ public:
 
 private:
 
-	static const unsigned int s_animPoolSize;					///< How much memory is assigned for all game animations
 	static const float s_updateFreq;							///< How often the animation manager should check for resource updates
 
 	//\brief A Key Component is a component of a keyframe used only when loading the animation
@@ -72,26 +58,21 @@ private:
 	{
 		ManagedAnim(const char * a_animName)
 			: m_timeStamp()
-			, m_numKeys(0)
 			, m_name(a_animName)
-			, m_data(nullptr)
 		{
 			m_path[0] = '\0';
 		}
 		ManagedAnim(const char * a_animPath, const char * a_animName, const FileManager::Timestamp & a_timeStamp)
 			: m_timeStamp(a_timeStamp)	
-			, m_numKeys(0)
 			, m_name(a_animName)
-			, m_data(nullptr)
 		{ 
 			strncpy(&m_path[0], a_animPath, StringUtils::s_maxCharsPerLine);
 		}
 		FileManager::Timestamp m_timeStamp;						///< When the anim file was last edited
 		char m_path[StringUtils::s_maxCharsPerLine];			///< Where the anim resides for reloading
 		StringHash m_name;										///< What the anim is called
-		int m_numKeys{ 0 };											///< How many keys are in the animation
-		int m_frameRate{ 0 };										///< The speed at which the animation should be played
-		KeyFrame* m_data{ nullptr };										///< Pointer to the keyframe data
+		int m_frameRate{ 0 };									///< The speed at which the animation should be played
+		AnimationClip m_clip;									///< Reduced and quantised keys for each transform the animation moves
 	};
 
 	typedef LinkedListNode<ManagedAnim> ManagedAnimNode;		///< Alias for a linked list node that points to a managed animation
@@ -190,7 +171,10 @@ private:
 							a_input.getline(line, maxAnimFileLineChars);
 							lineCount++;
 						}
-						const char * transformName = StringUtils::ExtractField(line, ":", 1);
+						char transformName[StringUtils::s_maxCharsPerName];
+						const char * channelName = StringUtils::ExtractField(line, ":", 1);
+						strncpy(&transformName[0], channelName != nullptr ? channelName : "", StringUtils::s_maxCharsPerName - 1);
+						transformName[StringUtils::s_maxCharsPerName - 1] = '\0';
 
 						// Preamble for each transform manipulation
 						for (int chanCount = 0; chanCount < numChannels; ++chanCount)
@@ -276,17 +260,8 @@ private:
 							a_input.getline(line, maxAnimFileLineChars);		lineCount++;
 						}
 
-						// Compile the keys and components into a stream of frames
-						int totalFrameCount = 0;
-						KeyFrame * firstFrame = nullptr;
-						KeyComp * currentKeyComp[numChannels][numComponents];
-						for (int i = 0; i < numChannels; ++i)
-						{
-							for (int j = 0; j < numComponents; ++j)
-							{
-								currentKeyComp[i][j] = inputKeys[i][j]->GetHead();
-							}
-						}
+						// Compile the keys and components into a stream of frames that is only kept until it's reduced into a clip
+						std::vector<KeyFrame> frames;
 
 						// Each key can have have a different number of frames. Read and hold on to the last value until a time passes with a new value for each channel
 						int keyProgress[numChannels][numComponents];
@@ -313,13 +288,7 @@ private:
 								curKey.m_scale = Vector(sX->m_value, sY->m_value, sZ->m_value);
 								curKey.m_time = timeCount;
 
-								KeyFrame * newKey = m_data.Allocate(sizeof(KeyFrame));
-								*newKey = curKey;
-								++totalFrameCount;
-								if (firstFrame == nullptr)
-								{
-									firstFrame = newKey;
-								}
+								frames.push_back(curKey);
 							}
 
 							// Advance component to next frame if there is another frame for the channel component after the time we are at
@@ -342,6 +311,16 @@ private:
 							}
 						}
 
+						// Components are all in the frame stream now
+						for (int i = 0; i < numChannels; ++i)
+						{
+							for (int j = 0; j < numComponents; ++j)
+							{
+								delete inputKeys[i][j];
+								inputKeys[i][j] = nullptr;
+							}
+						}
+
 						// Add the new managed animation to the list
 						ManagedAnim * manAnim = nullptr;
 						if (DataPack::Get().IsLoaded())
@@ -358,8 +337,16 @@ private:
 						}
 						if (manAnim != nullptr)
 						{
-							manAnim->m_numKeys = totalFrameCount;
-							manAnim->m_data = firstFrame;
+							if (!manAnim->m_clip.AddChannel(transformName, frames.data(), (unsigned int)frames.size()))
+							{
+								Log::Get().Write(LogLevel::Error, LogCategory::Engine, "Animation %s has %u frames which can't be stored, the most is %u.", a_animName, (unsigned int)frames.size(), AnimationClip::s_maxFrames);
+							}
+
+							// Each frame used to be stored whole along with the name of the transform it moved
+							const size_t streamBytes = frames.size() * (sizeof(KeyFrame) + sizeof(StringHash));
+							const size_t clipBytes = manAnim->m_clip.GetMemorySize();
+							Log::Get().Write(LogLevel::Info, LogCategory::Engine, "Animation %s reduced %u frames to %u keys, %u bytes as frames and %u bytes as a clip (%.1fx smaller)",
+								a_animName, (unsigned int)frames.size(), manAnim->m_clip.GetNumKeys(), (unsigned int)streamBytes, (unsigned int)clipBytes, (float)streamBytes / (float)clipBytes);
 							manAnim->m_frameRate = fileFrameRate;
 							ManagedAnimNode * manAnimNode = new ManagedAnimNode();
 							if (manAnim != nullptr && manAnimNode != nullptr)
@@ -397,7 +384,6 @@ private:
 	}
 
 	ManagedAnimList m_anims;									///< List of all the scripts found on disk at startup
-	LinearAllocator<KeyFrame> m_data;							///< Keyframe data shared with blenders
 	char m_animPath[StringUtils::s_maxCharsPerLine];			///< Cache off path to animation data 
 	float m_updateFreq{ 0.0f };									///< How often the script manager should check for changes to shaders
 	float m_updateTimer{ 0.0f };								///< If we are due for a scan and update of scripts
@@ -1,6 +1,6 @@
 #include <SDL.h>
 
-#include "..\core\MathUtils.h"
+#include "../core/MathUtils.h"
 
 #include "CameraManager.h"
 #include "InputManager.h"
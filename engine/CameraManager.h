@@ -1,7 +1,7 @@
 #pragma once
 
-#include "..\core\Matrix.h"
-#include "..\core\Vector.h"
+#include "../core/Matrix.h"
+#include "../core/Vector.h"
 
 #include "Singleton.h"
 
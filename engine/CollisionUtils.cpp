@@ -1,3 +1,5 @@
+#include <float.h>
+
 #include "../core/MathUtils.h"
 
 #include "CollisionUtils.h"
@@ -225,6 +227,26 @@ bool CollisionUtils::IntersectAxisBoxSphere(const Vector& a_spherePos, float a_s
 		(y - a_spherePos.GetY()) * (y - a_spherePos.GetY()) +
 		(z - a_spherePos.GetZ()) * (z - a_spherePos.GetZ()));
 
+	// A centre inside the box is its own closest point, so push out through the nearest face instead
+	if (distance <= 0.0f)
+	{
+		const float faceDists[6] = { a_spherePos.GetX() - boxMinX, boxMaxX - a_spherePos.GetX(),
+									 a_spherePos.GetY() - boxMinY, boxMaxY - a_spherePos.GetY(),
+									 a_spherePos.GetZ() - boxMinZ, boxMaxZ - a_spherePos.GetZ() };
+		int nearestFace = 0;
+		for (int i = 1; i < 6; ++i)
+		{
+			if (faceDists[i] < faceDists[nearestFace])
+			{
+				nearestFace = i;
+			}
+		}
+		const float faceSign = (nearestFace & 1) ? 1.0f : -1.0f;
+		const int axis = nearestFace / 2;
+		a_collisionNormal_OUT = Vector(axis == 0 ? faceSign : 0.0f, axis == 1 ? faceSign : 0.0f, axis == 2 ? faceSign : 0.0f);
+		a_collisionPos_OUT = a_spherePos + a_collisionNormal_OUT * faceDists[nearestFace];
+		return true;
+	}
 	if (distance <= a_sphereRadius)
 	{
 		a_collisionPos_OUT = Vector(x, y, z);
@@ -234,3 +256,326 @@ bool CollisionUtils::IntersectAxisBoxSphere(const Vector& a_spherePos, float a_s
 	}
 	return false;
 }
+
+bool CollisionUtils::IntersectRaySphere(const Vector& a_rayStart, const Vector& a_rayDir, float a_rayLength, const Vector& a_spherePos, float a_sphereRadius, float& a_distance_OUT, Vector& a_normal_OUT)
+{
+	const Vector toStart = a_rayStart - a_spherePos;
+	const float radiusSq = a_sphereRadius * a_sphereRadius;
+	const float startDistSq = toStart.LengthSquared();
+	if (startDistSq <= radiusSq)
+	{
+		a_distance_OUT = 0.0f;
+		a_normal_OUT = a_rayDir * -1.0f;
+		return true;
+	}
+
+	// Solve for the nearer root of |start + dir * t - pos| = radius, the ray must be heading towards the sphere
+	const float b = toStart.Dot(a_rayDir);
+	const float discriminant = b * b - (startDistSq - radiusSq);
+	if (b > 0.0f || discriminant < 0.0f)
+	{
+		return false;
+	}
+	const float distance = -b - sqrtf(discriminant);
+	if (distance > a_rayLength)
+	{
+		return false;
+	}
+
+	a_distance_OUT = distance;
+	a_normal_OUT = (toStart + a_rayDir * distance) * (1.0f / a_sphereRadius);
+	return true;
+}
+
+bool CollisionUtils::IntersectRayAxisBox(const Vector& a_rayStart, const Vector& a_rayDir, float a_rayLength, const Vector& a_boxPos, const Vector& a_boxDimensions, float& a_distance_OUT, Vector& a_normal_OUT)
+{
+	// Slab test in box space, remembering which face the ray entered through for the normal
+	Vector start = a_rayStart - a_boxPos;
+	Vector dir = a_rayDir;
+	Vector halfDim = a_boxDimensions * 0.5f;
+	const float * startValues = start.GetValues();
+	const float * dirValues = dir.GetValues();
+	const float * halfDimValues = halfDim.GetValues();
+	float tMin = 0.0f;
+	float tMax = a_rayLength;
+	int enterAxis = -1;
+	float enterSign = 0.0f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (MathUtils::IsZeroEpsilon(dirValues[axis]))
+		{
+			// Parallel to this pair of faces so must already be between them
+			if (fabsf(startValues[axis]) > halfDimValues[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const float invDir = 1.0f / dirValues[axis];
+		float tNear = (-halfDimValues[axis] - startValues[axis]) * invDir;
+		float tFar = (halfDimValues[axis] - startValues[axis]) * invDir;
+		float sign = -1.0f;
+		if (tNear > tFar)
+		{
+			const float swap = tNear;
+			tNear = tFar;
+			tFar = swap;
+			sign = 1.0f;
+		}
+		if (tNear > tMin)
+		{
+			tMin = tNear;
+			enterAxis = axis;
+			enterSign = sign;
+		}
+		tMax = MathUtils::GetMin(tMax, tFar);
+		if (tMin > tMax)
+		{
+			return false;
+		}
+	}
+
+	a_distance_OUT = tMin;
+	if (enterAxis < 0)
+	{
+		a_normal_OUT = a_rayDir * -1.0f;
+	}
+	else
+	{
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		normal[enterAxis] = enterSign;
+		a_normal_OUT = Vector(normal);
+	}
+	return true;
+}
+
+bool CollisionUtils::IntersectRayBox(const Vector& a_rayStart, const Vector& a_rayDir, float a_rayLength, const Vector& a_boxPos, const Vector& a_boxDimensions, const Quaternion& a_boxRot, float& a_distance_OUT, Vector& a_normal_OUT)
+{
+	// Take the ray into the space of the box so it can be tested as an axis aligned one
+	const Matrix rotMat = a_boxRot.GetRotationMatrix();
+	const Vector right = rotMat.GetRight();
+	const Vector look = rotMat.GetLook();
+	const Vector up = rotMat.GetUp();
+	const Vector toStart = a_rayStart - a_boxPos;
+	const Vector localStart(toStart.Dot(right), toStart.Dot(look), toStart.Dot(up));
+	const Vector localDir(a_rayDir.Dot(right), a_rayDir.Dot(look), a_rayDir.Dot(up));
+
+	Vector localNormal(0.0f);
+	if (IntersectRayAxisBox(localStart, localDir, a_rayLength, Vector::Zero(), a_boxDimensions, a_distance_OUT, localNormal))
+	{
+		a_normal_OUT = right * localNormal.GetX() + look * localNormal.GetY() + up * localNormal.GetZ();
+		return true;
+	}
+	return false;
+}
+
+bool CollisionUtils::IntersectRayTriangle(const Vector& a_rayStart, const Vector& a_rayDir, float a_rayLength, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC, float& a_distance_OUT)
+{
+	// Solve for the barycentric coordinates of the crossing point and the distance to it at once
+	const Vector edge1 = a_vertB - a_vertA;
+	const Vector edge2 = a_vertC - a_vertA;
+	const Vector p = a_rayDir.Cross(edge2);
+	const float det = edge1.Dot(p);
+	if (fabsf(det) < 1e-12f)
+	{
+		// Parallel to the plane of the triangle
+		return false;
+	}
+
+	const float invDet = 1.0f / det;
+	const Vector toStart = a_rayStart - a_vertA;
+	const float u = toStart.Dot(p) * invDet;
+	if (u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+	const Vector q = toStart.Cross(edge1);
+	const float v = a_rayDir.Dot(q) * invDet;
+	if (v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+	const float distance = edge2.Dot(q) * invDet;
+	if (distance < 0.0f || distance > a_rayLength)
+	{
+		return false;
+	}
+
+	a_distance_OUT = distance;
+	return true;
+}
+
+Vector CollisionUtils::GetClosestPointOnTriangle(const Vector& a_point, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC)
+{
+	// Work out which of the corners, edges or face the point is nearest from its barycentric coordinates
+	const Vector ab = a_vertB - a_vertA;
+	const Vector ac = a_vertC - a_vertA;
+	const Vector ap = a_point - a_vertA;
+	const float d1 = ab.Dot(ap);
+	const float d2 = ac.Dot(ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+	{
+		return a_vertA;
+	}
+
+	const Vector bp = a_point - a_vertB;
+	const float d3 = ab.Dot(bp);
+	const float d4 = ac.Dot(bp);
+	if (d3 >= 0.0f && d4 <= d3)
+	{
+		return a_vertB;
+	}
+
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		return a_vertA + ab * (d1 / (d1 - d3));
+	}
+
+	const Vector cp = a_point - a_vertC;
+	const float d5 = ab.Dot(cp);
+	const float d6 = ac.Dot(cp);
+	if (d6 >= 0.0f && d5 <= d6)
+	{
+		return a_vertC;
+	}
+
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		return a_vertA + ac * (d2 / (d2 - d6));
+	}
+
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		return a_vertB + (a_vertC - a_vertB) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+	}
+
+	const float denom = 1.0f / (va + vb + vc);
+	return a_vertA + ab * (vb * denom) + ac * (vc * denom);
+}
+
+bool CollisionUtils::IntersectSphereTriangle(const Vector& a_spherePos, float a_sphereRadius, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC, Vector& a_collisionPos_OUT, Vector& a_collisionNormal_OUT, float& a_depth_OUT)
+{
+	Vector faceNormal = (a_vertB - a_vertA).Cross(a_vertC - a_vertA);
+	if (faceNormal.LengthSquared() <= 0.0f)
+	{
+		return false;
+	}
+	faceNormal.Normalise();
+
+	const Vector closest = GetClosestPointOnTriangle(a_spherePos, a_vertA, a_vertB, a_vertC);
+	const Vector toSphere = a_spherePos - closest;
+	const float distSq = toSphere.LengthSquared();
+	if (distSq > a_sphereRadius * a_sphereRadius)
+	{
+		return false;
+	}
+
+	// Past the plane the sphere is pushed back out the front so it can't be squeezed through a surface
+	const float planeDist = (a_spherePos - a_vertA).Dot(faceNormal);
+	const float dist = sqrtf(distSq);
+	a_collisionPos_OUT = closest;
+	if (planeDist < 0.0f || dist <= 0.0f)
+	{
+		a_collisionNormal_OUT = faceNormal;
+		a_depth_OUT = a_sphereRadius - planeDist;
+	}
+	else
+	{
+		a_collisionNormal_OUT = toSphere * (1.0f / dist);
+		a_depth_OUT = a_sphereRadius - dist;
+	}
+	return true;
+}
+
+bool CollisionUtils::IntersectAxisBoxTriangle(const Vector& a_boxPos, const Vector& a_boxSize, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC, Vector& a_collisionPos_OUT, Vector& a_collisionNormal_OUT, float& a_depth_OUT)
+{
+	// Test with the box at the origin against the box faces, the triangle face and the nine edge cross products
+	const Vector verts[3] = { a_vertA - a_boxPos, a_vertB - a_boxPos, a_vertC - a_boxPos };
+	const Vector edges[3] = { verts[1] - verts[0], verts[2] - verts[1], verts[0] - verts[2] };
+	const Vector boxAxes[3] = { Vector(1.0f, 0.0f, 0.0f), Vector(0.0f, 1.0f, 0.0f), Vector(0.0f, 0.0f, 1.0f) };
+	Vector axes[13];
+	int numAxes = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		axes[numAxes++] = boxAxes[i];
+	}
+	axes[numAxes++] = edges[0].Cross(edges[1]);
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			axes[numAxes++] = boxAxes[i].Cross(edges[j]);
+		}
+	}
+
+	float minOverlap = FLT_MAX;
+	Vector minAxis(0.0f);
+	for (int i = 0; i < numAxes; ++i)
+	{
+		// Edges parallel to a box axis give no axis to test
+		Vector axis = axes[i];
+		if (axis.LengthSquared() < 1e-12f)
+		{
+			continue;
+		}
+		axis.Normalise();
+
+		const float p0 = verts[0].Dot(axis);
+		const float p1 = verts[1].Dot(axis);
+		const float p2 = verts[2].Dot(axis);
+		const float triMin = MathUtils::GetMin(p0, MathUtils::GetMin(p1, p2));
+		const float triMax = MathUtils::GetMax(p0, MathUtils::GetMax(p1, p2));
+		const float radius = a_boxSize.GetX() * fabsf(axis.GetX()) + a_boxSize.GetY() * fabsf(axis.GetY()) + a_boxSize.GetZ() * fabsf(axis.GetZ());
+
+		// Overlap is how far the box would need to move along the axis either way to come free
+		const float pushPositive = triMax + radius;
+		const float pushNegative = radius - triMin;
+		if (pushPositive < 0.0f || pushNegative < 0.0f)
+		{
+			return false;
+		}
+		if (pushPositive < minOverlap)
+		{
+			minOverlap = pushPositive;
+			minAxis = axis;
+		}
+		if (pushNegative < minOverlap)
+		{
+			minOverlap = pushNegative;
+			minAxis = axis * -1.0f;
+		}
+	}
+
+	a_collisionPos_OUT = GetClosestPointOnTriangle(a_boxPos, a_vertA, a_vertB, a_vertC);
+	a_collisionNormal_OUT = minAxis;
+	a_depth_OUT = minOverlap;
+	return true;
+}
+
+bool CollisionUtils::IntersectBoxTriangle(const Vector& a_boxPos, const Vector& a_boxSize, const Quaternion& a_boxRot, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC, Vector& a_collisionPos_OUT, Vector& a_collisionNormal_OUT, float& a_depth_OUT)
+{
+	// Take the triangle into the space of the box so it can be tested as an axis aligned one
+	const Matrix rotMat = a_boxRot.GetRotationMatrix();
+	const Vector right = rotMat.GetRight();
+	const Vector look = rotMat.GetLook();
+	const Vector up = rotMat.GetUp();
+	const auto toBoxSpace = [&](const Vector & a_vert)
+	{
+		const Vector toVert = a_vert - a_boxPos;
+		return Vector(toVert.Dot(right), toVert.Dot(look), toVert.Dot(up));
+	};
+
+	Vector localPos(0.0f);
+	Vector localNormal(0.0f);
+	if (IntersectAxisBoxTriangle(Vector::Zero(), a_boxSize, toBoxSpace(a_vertA), toBoxSpace(a_vertB), toBoxSpace(a_vertC), localPos, localNormal, a_depth_OUT))
+	{
+		a_collisionPos_OUT = a_boxPos + right * localPos.GetX() + look * localPos.GetY() + up * localPos.GetZ();
+		a_collisionNormal_OUT = right * localNormal.GetX() + look * localNormal.GetY() + up * localNormal.GetZ();
+		return true;
+	}
+	return false;
+}
@@ -91,6 +91,55 @@ public:
 	//\a_collisionNormal_OUT Output parameter of the normalized direction of the collision if there is one
 	//\return true if the two supplied shapes are touching and the a_normal_OUT was modified
 	static bool IntersectAxisBoxSphere(const Vector& a_spherePos, float a_sphereRadius, const Vector& a_boxPos, const Vector& a_boxSize, Vector& a_collisionPos_OUT, Vector& a_collisionNormal_OUT);
+
+	//\brief Distance along a ray to where it first enters a sphere, a ray starting inside hits straight away
+	//\param a_rayStart is the start of the ray in worldspace
+	//\param a_rayDir is the normalised direction of the ray
+	//\param a_rayLength is how far the ray reaches
+	//\param a_spherePos The position of a sphere in worldspace
+	//\param a_sphereRadius The size of the sphere from centre to extent
+	//\param a_distance_OUT Output parameter of the distance along the ray to the hit
+	//\param a_normal_OUT Output parameter of the normalized surface direction at the hit
+	//\return true if the ray hit the sphere within its length and the outputs were modified
+	static bool IntersectRaySphere(const Vector& a_rayStart, const Vector& a_rayDir, float a_rayLength, const Vector& a_spherePos, float a_sphereRadius, float& a_distance_OUT, Vector& a_normal_OUT);
+
+	//\brief Distance along a ray to where it first enters an axis aligned box, a ray starting inside hits straight away
+	//\param a_boxPos The position of a box in worldspace
+	//\param a_boxDimensions The size of the box in all three axis
+	//\return true if the ray hit the box within its length and the outputs were modified
+	static bool IntersectRayAxisBox(const Vector& a_rayStart, const Vector& a_rayDir, float a_rayLength, const Vector& a_boxPos, const Vector& a_boxDimensions, float& a_distance_OUT, Vector& a_normal_OUT);
+
+	//\brief Distance along a ray to where it first enters a rotated box, a ray starting inside hits straight away
+	//\param a_boxRot The orientation of the box
+	//\return true if the ray hit the box within its length and the outputs were modified
+	static bool IntersectRayBox(const Vector& a_rayStart, const Vector& a_rayDir, float a_rayLength, const Vector& a_boxPos, const Vector& a_boxDimensions, const Quaternion& a_boxRot, float& a_distance_OUT, Vector& a_normal_OUT);
+
+	//\brief Distance along a ray to where it crosses a triangle from either side
+	//\param a_rayDir is the direction of the ray, the distance is measured in multiples of it so it need not be normalised
+	//\param a_vertA, a_vertB, a_vertC are the corners of the triangle
+	//\param a_distance_OUT Output parameter of the distance along the ray to the hit
+	//\return true if the ray crossed the triangle within its length and the output was modified
+	static bool IntersectRayTriangle(const Vector& a_rayStart, const Vector& a_rayDir, float a_rayLength, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC, float& a_distance_OUT);
+
+	//\brief The point on or inside a triangle that is nearest to another point
+	static Vector GetClosestPointOnTriangle(const Vector& a_point, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC);
+
+	//\brief Intersection between a sphere and a single sided triangle, a sphere more than halfway through is pushed out the front
+	//\param a_collisionPos_OUT Output parameter of the point on the triangle nearest the sphere
+	//\param a_collisionNormal_OUT Output parameter of the normalized direction from the triangle towards the sphere
+	//\param a_depth_OUT Output parameter of how far the sphere has sunk into the triangle
+	//\return true if the two shapes are touching and the outputs were modified
+	static bool IntersectSphereTriangle(const Vector& a_spherePos, float a_sphereRadius, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC, Vector& a_collisionPos_OUT, Vector& a_collisionNormal_OUT, float& a_depth_OUT);
+
+	//\brief Intersection between an axis aligned box and a triangle using the separating axis test
+	//\param a_boxSize Half the size of the box in each axis, as the box and sphere tests take it
+	//\param a_collisionNormal_OUT Output parameter of the axis of least overlap, pointing from the triangle towards the box
+	//\param a_depth_OUT Output parameter of the overlap along the collision normal
+	//\return true if the two shapes are touching and the outputs were modified
+	static bool IntersectAxisBoxTriangle(const Vector& a_boxPos, const Vector& a_boxSize, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC, Vector& a_collisionPos_OUT, Vector& a_collisionNormal_OUT, float& a_depth_OUT);
+
+	//\brief Intersection between a rotated box and a triangle, done as an axis aligned test in the space of the box
+	static bool IntersectBoxTriangle(const Vector& a_boxPos, const Vector& a_boxSize, const Quaternion& a_boxRot, const Vector& a_vertA, const Vector& a_vertB, const Vector& a_vertC, Vector& a_collisionPos_OUT, Vector& a_collisionNormal_OUT, float& a_depth_OUT);
 };
 
 #endif /* _ENGINE_COLLISION_UTILS_H_ */
@@ -7,6 +7,7 @@
 #include "Log.h"
 #include "ModelManager.h"
 #include "RenderManager.h"
+#include "RenderState.h"
 #include "ScriptManager.h"
 #include "StringHash.h"
 #include "TextureManager.h"
@@ -340,8 +341,8 @@ void DebugMenu::Update(float a_dt)
                 {
                     if (inMan.IsKeyDepressed(SDLK_LALT))
                     {
-                        const Quaternion moveAmount(MathUtils::Deg2Rad(Vector(moveAmount * 16.0f, 0.0f, 0.0f)));
-                        m_lightToEdit->m_dir *= moveAmount;
+                        const Quaternion rotAmount(MathUtils::Deg2Rad(Vector(moveAmount * 16.0f, 0.0f, 0.0f)));
+                        m_lightToEdit->m_dir *= rotAmount;
                     }
                     else
                     {
@@ -353,8 +354,8 @@ void DebugMenu::Update(float a_dt)
                 {
                     if (inMan.IsKeyDepressed(SDLK_LALT))
                     {
-                        const Quaternion moveAmount(MathUtils::Deg2Rad(Vector(0.0f, moveAmount * 16.0f, 0.0f)));
-                        m_lightToEdit->m_dir *= moveAmount;
+                        const Quaternion rotAmount(MathUtils::Deg2Rad(Vector(0.0f, moveAmount * 16.0f, 0.0f)));
+                        m_lightToEdit->m_dir *= rotAmount;
                     }
                     else
                     {
@@ -366,8 +367,8 @@ void DebugMenu::Update(float a_dt)
                 {
                     if (inMan.IsKeyDepressed(SDLK_LALT))
                     {
-                        const Quaternion moveAmount(MathUtils::Deg2Rad(Vector(0.0f, 0.0f, moveAmount * 16.0f)));
-                        m_lightToEdit->m_dir *= moveAmount;
+                        const Quaternion rotAmount(MathUtils::Deg2Rad(Vector(0.0f, 0.0f, moveAmount * 16.0f)));
+                        m_lightToEdit->m_dir *= rotAmount;
                     }
                     else
                     {
@@ -1256,12 +1257,23 @@ void DebugMenu::Draw()
     renMan.AddLine2D(RenderLayer::Debug2D, mousePos+sc_vectorCursor[3], mousePos+sc_vectorCursor[0], sc_colourGreen);
 
     // Draw some consumer perf stats
-    const int numObjects = WorldManager::Get().GetCurrentScene()->GetNumObjects();
+    const Scene * scene = WorldManager::Get().GetCurrentScene();
+    const int numObjects = scene->GetNumObjects();
+    const int numVisible = scene->GetNumVisible();
+    const int numCulled = scene->GetNumCulled();
     const int numPhysics = 0;
-    const int numDrawCalls = RenderManager::Get().GetDrawCallCount();
+    int numBatches = 0;
+    int numBatchedPrimitives = 0;
+    const int numDrawCalls = RenderManager::Get().GetDrawCallCount(numBatches, numBatchedPrimitives);
+    const int numStateChanges = RenderState::GetIssuedCount();
+    const int numStateFiltered = RenderState::GetFilteredCount();
+    unsigned int meshVerts = 0;
+    unsigned int meshCapacity = 0;
+    float meshFragmentation = 0.0f;
+    const int numMeshes = RenderManager::Get().GetMeshArenaStats(meshVerts, meshCapacity, meshFragmentation);
     const int numMusic = SoundManager::Get().GetNumMusicPlaying();
     char statBuf[256];
-    sprintf(statBuf, "GameObjects: %d\nPhysics: %d\nDraw: %d\nMusic: %d\n", numObjects, numPhysics, numDrawCalls, numMusic);
+    sprintf(statBuf, "GameObjects: %d\nVisible: %d (%d culled)\nPhysics: %d\nDraw: %d\nBatches: %d (%d prims)\nState: %d (%d filtered)\nMeshes: %d (%uk verts, %.0f%% frag)\nMusic: %d\n", numObjects, numVisible, numCulled, numPhysics, numDrawCalls, numBatches, numBatchedPrimitives, numStateChanges, numStateFiltered, numMeshes, meshVerts / 1024, meshFragmentation * 100.0f, numMusic);
     fontMan.DrawDebugString2D(statBuf, Vector2(-0.85f, 0.75f), sc_colourGreen);
 #endif
 }
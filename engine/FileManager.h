@@ -129,7 +129,7 @@ public:
 		FileEvent * newEvent = newFileNode->GetData();
 		sprintf(newEvent->m_fileName, "%s", a_filePath);
 		newEvent->m_delegate.SetCallback(a_callerObject, a_callback);
-		m_events.Insert(newEvent);
+		m_events.Insert(newFileNode);
 
 		// The filelist itself is regular
 		return FillFileList(a_filePath, a_fileList_OUT, a_fileSubstring);
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <fstream>
+#include <stdlib.h>
+#include <string.h>
 
 #include "DataPack.h"
 #include "RenderManager.h"
@@ -94,6 +96,8 @@ bool FontManager::Startup(const char * a_fontPath, const DataPack * a_dataPack)
 
 bool FontManager::Shutdown()
 {
+	ClearLayoutCache();
+
 	m_fonts.ForeachAndDelete([&](auto * cur)
 	{
 		m_fonts.Remove(cur);
@@ -116,72 +120,20 @@ bool FontManager::DrawString(const char * a_string, unsigned int a_fontNameHash,
 bool FontManager::DrawString(const char * a_string, unsigned int a_fontNameHash, float a_size, Vector a_pos, Colour a_colour, RenderLayer a_renderLayer)
 {
 	const bool is2D = a_renderLayer != RenderLayer::Debug3D && a_renderLayer != RenderLayer::World;
-
-	FontListNode * curFont = m_fonts.GetHead();
-	RenderManager & renderMan = RenderManager::Get();
-	const float viewAspect = renderMan.GetViewAspect();
-	const char newLine = 10;
-	while(curFont != nullptr)
+	const TextLayout * layout = GetLayout(a_string, a_fontNameHash, a_size, is2D);
+	if (layout == nullptr)
 	{
-		if (curFont->GetData()->m_fontName == a_fontNameHash)
-		{
-			// Draw each character in the string
-			Font * font = curFont->GetData();
-			float xAdvance = 0.0f;
-
-			// Calculate a scaling ratio for the font to match the requested pixel size, font size limit is 1 meg
-			a_size *= (float)font->m_sizeX / (float)s_maxFontTexSize;
-			const Vector2 sizeWithAspect = Vector2(is2D ? a_size : a_size * viewAspect, a_size);
-			const Vector2 sizeRatio(sizeWithAspect.GetX() / font->m_sizeX / viewAspect, a_size / font->m_sizeY);
-
-			unsigned int textLength = strlen(a_string);
-			for (unsigned int j = 0; j < textLength; ++j)
-			{
-				// Handle newline first
-				if (a_string[j] == newLine)
-				{
-					xAdvance = 0.0f;
-					const FontChar & defaultChar = font->m_chars[64];
-					a_pos.SetY(a_pos.GetY() - (defaultChar.m_height / font->m_sizeY) * sizeWithAspect.GetY());
-				}
-				else
-				{
-					// Safety check for unexported characters
-					const FontChar & curChar = font->m_chars[(int)a_string[j]];
-					if (curChar.m_width > 0 || curChar.m_height > 0)
-					{ 
-						// Do not add a quad for a space
-						if (a_string[j] != ' ') 
-						{
-							float xPos = a_pos.GetX() + xAdvance + ((curChar.m_xoffset / font->m_sizeX) * sizeWithAspect.GetX());
-							float yPos = a_pos.GetY() - ((curChar.m_yoffset / font->m_sizeY) * sizeWithAspect.GetY());
-							float zPos = a_pos.GetZ() -((curChar.m_yoffset / font->m_sizeY) * sizeWithAspect.GetY());
-
-							// Align font chars 2D vs 3D
-							if (is2D)
-							{
-								renderMan.AddFontChar(a_renderLayer, curChar.m_charSize, curChar.m_texSize, curChar.m_texCoord, font->m_texture, sizeWithAspect, Vector(xPos, yPos, 0.0f), a_colour);
-							}
-							else
-							{
-								renderMan.AddFontChar(a_renderLayer, curChar.m_charSize, curChar.m_texSize, curChar.m_texCoord, font->m_texture, sizeWithAspect, Vector(xPos, a_pos.GetY(), zPos), a_colour);
-							}
-						}
-						xAdvance += (float)(curChar.m_xadvance * sizeRatio.GetX());
-					}
-					else
-					{
-						Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Unexported font glyph for character.");
-					}
-				}
-			}
-			return true;
-		}
-		curFont = curFont->GetNext();
+		// Could not find the font to draw with
+		return false;
 	}
 
-	// Could not find the font to draw with
-	return false;
+	// The whole string goes to the render manager as one run of quads
+	if (layout->m_numGlyphs > 0)
+	{
+		const Vector stringPos = is2D ? Vector(a_pos.GetX(), a_pos.GetY(), 0.0f) : a_pos;
+		RenderManager::Get().AddFontRun(a_renderLayer, layout->m_glyphs, layout->m_numGlyphs, layout->m_texture, stringPos, a_colour);
+	}
+	return true;
 }
 
 bool FontManager::MeasureString2D(const char * a_string, unsigned int a_fontNameHash, float a_size, float & a_width, float & a_height)
@@ -189,57 +141,158 @@ bool FontManager::MeasureString2D(const char * a_string, unsigned int a_fontName
 	a_width = 0;
 	a_height = 0;
 
+	const TextLayout * layout = GetLayout(a_string, a_fontNameHash, a_size, true);
+	if (layout == nullptr)
+	{
+		// Could not find the font to measure with
+		return false;
+	}
+
+	a_width = layout->m_width;
+	a_height = layout->m_height;
+	return true;
+}
+
+FontManager::Font * FontManager::GetFont(unsigned int a_fontNameHash)
+{
 	FontListNode * curFont = m_fonts.GetHead();
-	RenderManager & renderMan = RenderManager::Get();
-	const float viewAspect = renderMan.GetViewAspect();
-	const char newLine = 10;
-	while(curFont != nullptr)
+	while (curFont != nullptr)
 	{
 		if (curFont->GetData()->m_fontName == a_fontNameHash)
 		{
-			// Draw each character in the string
-			Font * font = curFont->GetData();
-			a_size *= (float)font->m_sizeX / (float)s_maxFontTexSize;
-			const Vector2 sizeWithAspect = Vector2(a_size, a_size);
-			float xAdvance = 0.0f;
-			
-			// Calculate a scaling ratio for the font to match the requested pixel size, font size limit is 1 meg
-			const Vector2 sizeRatio(sizeWithAspect.GetX() / font->m_sizeX / viewAspect, a_size / font->m_sizeY);
-
-			const FontChar & defaultChar = font->m_chars[64];
-			const float lineHeight = (defaultChar.m_height / font->m_sizeY) * sizeWithAspect.GetY();
-			a_height = lineHeight + defaultChar.m_height * sizeRatio.GetY();
-
-			unsigned int textLength = strlen(a_string);
-			for (unsigned int j = 0; j < textLength; ++j)
-			{
-				// Handle newline first
-				if (a_string[j] == newLine)
-				{
-					xAdvance = 0.0f;
-					a_height += lineHeight;
-				}
-				else
-				{
-					// Safety check for unexported characters
-					const FontChar & curChar = font->m_chars[(int)a_string[j]];
-					if (curChar.m_width > 0 || curChar.m_height > 0)
-					{ 
-						xAdvance += curChar.m_xadvance * sizeRatio.GetX();
-						if (xAdvance > a_width)
-						{
-							a_width = xAdvance + (curChar.m_xoffset / font->m_sizeX) * sizeWithAspect.GetX();
-						}
-					}
-				}
-			}
-			return true;
+			return curFont->GetData();
 		}
 		curFont = curFont->GetNext();
 	}
+	return nullptr;
+}
 
-	// Could not find the font to measure with
-	return false;
+const FontManager::TextLayout * FontManager::GetLayout(const char * a_string, unsigned int a_fontNameHash, float a_size, bool a_is2D)
+{
+	// Strings are case sensitive here unlike names so hash the raw characters
+	unsigned int sizeBits = 0;
+	memcpy(&sizeBits, &a_size, sizeof(sizeBits));
+	const unsigned int stringLength = (unsigned int)strlen(a_string);
+	const unsigned int key = StringHash::GenerateCRC(a_string, false) ^ (a_fontNameHash * 2654435761u) ^ (sizeBits * 40503u) ^ (a_is2D ? 0x9E3779B9u : 0u);
+	const float viewAspect = RenderManager::Get().GetViewAspect();
+
+	TextLayout & layout = m_layoutCache[key & (s_layoutCacheSize - 1)];
+	if (layout.m_string != nullptr &&
+		layout.m_key == key &&
+		layout.m_fontNameHash == a_fontNameHash &&
+		layout.m_size == a_size &&
+		layout.m_is2D == a_is2D &&
+		layout.m_viewAspect == viewAspect &&
+		layout.m_stringLength == stringLength &&
+		memcmp(layout.m_string, a_string, stringLength) == 0)
+	{
+		return &layout;
+	}
+
+	Font * font = GetFont(a_fontNameHash);
+	if (font == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Storage is kept when a slot is reused and only grows for longer strings
+	if (stringLength + 1 > layout.m_stringCapacity)
+	{
+		free(layout.m_string);
+		layout.m_stringCapacity = stringLength + 1;
+		layout.m_string = (char *)malloc(layout.m_stringCapacity);
+	}
+	if (stringLength > layout.m_glyphCapacity)
+	{
+		free(layout.m_glyphs);
+		layout.m_glyphCapacity = stringLength;
+		layout.m_glyphs = (RenderManager::FontGlyph *)malloc(sizeof(RenderManager::FontGlyph) * layout.m_glyphCapacity);
+	}
+	memcpy(layout.m_string, a_string, stringLength + 1);
+	layout.m_stringLength = stringLength;
+	layout.m_key = key;
+	layout.m_fontNameHash = a_fontNameHash;
+	layout.m_size = a_size;
+	layout.m_is2D = a_is2D;
+	layout.m_viewAspect = viewAspect;
+	LayoutString(layout, font);
+	return &layout;
+}
+
+void FontManager::LayoutString(TextLayout & a_layout_OUT, Font * a_font)
+{
+	const float viewAspect = a_layout_OUT.m_viewAspect;
+	const bool is2D = a_layout_OUT.m_is2D;
+	const char newLine = 10;
+
+	// Calculate a scaling ratio for the font to match the requested pixel size, font size limit is 1 meg
+	const float size = a_layout_OUT.m_size * (float)a_font->m_sizeX / (float)s_maxFontTexSize;
+	const Vector2 sizeWithAspect = Vector2(is2D ? size : size * viewAspect, size);
+	const Vector2 sizeRatio(sizeWithAspect.GetX() / a_font->m_sizeX / viewAspect, size / a_font->m_sizeY);
+
+	// Measurements are always in 2D proportions so widgets size the same way no matter where the text is drawn
+	const Vector2 measureRatio(size / a_font->m_sizeX / viewAspect, size / a_font->m_sizeY);
+	const FontChar & defaultChar = a_font->m_chars[64];
+	const float lineHeight = (defaultChar.m_height / a_font->m_sizeY) * size;
+	const float drawLineHeight = (defaultChar.m_height / a_font->m_sizeY) * sizeWithAspect.GetY();
+	a_layout_OUT.m_width = 0.0f;
+	a_layout_OUT.m_height = lineHeight + defaultChar.m_height * measureRatio.GetY();
+	a_layout_OUT.m_numGlyphs = 0;
+	a_layout_OUT.m_texture = a_font->m_texture;
+
+	float xAdvance = 0.0f;
+	float measureAdvance = 0.0f;
+	float lineY = 0.0f;
+	const char * string = a_layout_OUT.m_string;
+	for (unsigned int j = 0; j < a_layout_OUT.m_stringLength; ++j)
+	{
+		// Handle newline first
+		if (string[j] == newLine)
+		{
+			xAdvance = 0.0f;
+			measureAdvance = 0.0f;
+			lineY -= drawLineHeight;
+			a_layout_OUT.m_height += lineHeight;
+			continue;
+		}
+
+		// Safety check for unexported characters
+		const FontChar & curChar = a_font->m_chars[(unsigned char)string[j]];
+		if (curChar.m_width <= 0 && curChar.m_height <= 0)
+		{
+			Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Unexported font glyph for character.");
+			continue;
+		}
+
+		// Do not add a quad for a space
+		if (string[j] != ' ')
+		{
+			const float xOffset = xAdvance + ((curChar.m_xoffset / a_font->m_sizeX) * sizeWithAspect.GetX());
+			const float yOffset = (curChar.m_yoffset / a_font->m_sizeY) * sizeWithAspect.GetY();
+
+			// Align font chars 2D vs 3D
+			const Vector offset = is2D ? Vector(xOffset, lineY - yOffset, 0.0f) : Vector(xOffset, lineY, -yOffset);
+			RenderManager::SetFontGlyph(a_layout_OUT.m_glyphs[a_layout_OUT.m_numGlyphs++], is2D, curChar.m_charSize, curChar.m_texSize, curChar.m_texCoord, sizeWithAspect, offset);
+		}
+		xAdvance += curChar.m_xadvance * sizeRatio.GetX();
+
+		measureAdvance += curChar.m_xadvance * measureRatio.GetX();
+		if (measureAdvance > a_layout_OUT.m_width)
+		{
+			a_layout_OUT.m_width = measureAdvance + (curChar.m_xoffset / a_font->m_sizeX) * size;
+		}
+	}
+}
+
+void FontManager::ClearLayoutCache()
+{
+	for (unsigned int i = 0; i < s_layoutCacheSize; ++i)
+	{
+		TextLayout & layout = m_layoutCache[i];
+		free(layout.m_string);
+		free(layout.m_glyphs);
+		layout = TextLayout();
+	}
 }
 
 bool FontManager::DrawDebugString2D(const char * a_string, Vector2 a_pos, Colour a_colour, RenderLayer a_renderLayer)
@@ -374,7 +427,7 @@ bool FontManager::LoadDefaultFont(const char * a_fontDefinition)
 			}
 			else if (lineCount == 1) // common lineHeight=x base=33	
 			{
-				sscanf_s(line, "common lineHeight=%d base=%d scaleW=%d scaleH=%d pages=%d",
+				sscanf(line, "common lineHeight=%d base=%d scaleW=%d scaleH=%d pages=%d",
 				&lineHeight, &base, &sizeW, &sizeH, &pages);
 				newFont->m_sizeX = sizeW;
 				newFont->m_sizeY = sizeH;
@@ -384,7 +437,7 @@ bool FontManager::LoadDefaultFont(const char * a_fontDefinition)
 			}
 			else if (lineCount == 3) // chars count=x
 			{
-				sscanf_s(line, "chars count=%d", &numChars);
+				sscanf(line, "chars count=%d", &numChars);
 				newFont->m_numChars = numChars;
 			}
 			else
@@ -393,7 +446,7 @@ bool FontManager::LoadDefaultFont(const char * a_fontDefinition)
 				for (unsigned int i = 0; i < numChars; ++i)
 				{
 					int charId, x, y, width, height, xoffset, yoffset, xadvance, page, chnl;
-					sscanf_s(line, "char id=%d   x=%d    y=%d    width=%d     height=%d     xoffset=%d     yoffset=%d    xadvance=%d     page=%d  chnl=%d",
+					sscanf(line, "char id=%d   x=%d    y=%d    width=%d     height=%d     xoffset=%d     yoffset=%d    xadvance=%d     page=%d  chnl=%d",
 						&charId, &x, &y, &width, &height, &xoffset, &yoffset, &xadvance, &page, &chnl);
 					FontChar & curChar = newFont->m_chars[charId];
 					curChar.m_x = (float)x;
@@ -45,7 +45,7 @@ public:
 	bool DrawDebugString2D(const char * a_string, Vector2 a_pos, Colour a_colour = sc_colourWhite, RenderLayer a_renderLayer = RenderLayer::Debug2D);
 	bool DrawDebugString3D(const char * a_string, Vector a_pos, Colour a_colour = sc_colourWhite, float a_size = s_debugFontSize3D);
 
-	//\brief Do the same work as draw string but just accumlate width and height
+	//\brief Get the extents of a string as it would be drawn in 2D, shares the layout cache with drawing
 	//\param a_width_OUT the width the string
 	//\param a_height_OUT the height of the string
 	bool MeasureString2D(const char * a_string, unsigned int a_fontNameHash, float a_size, float & a_width, float & a_height);
@@ -67,6 +67,7 @@ private:
 	static const float s_debugFontSize3D;				///< Glyph height for debug drawing in debug mode
 	static const unsigned int s_maxCharsPerFont = 256u;	///< No non-unicode support needed (yet)
 	static const unsigned int s_maxFontTexSize = 1024u; ///< Cannot load fonts greater than a meg
+	static const unsigned int s_layoutCacheSize = 1024u;///< Laid out strings kept between frames, must be a power of two
 
 	//\brief Spacing and positioning info about a character in a font
 	struct FontChar
@@ -104,6 +105,38 @@ private:
 	typedef LinkedListNode<Font> FontListNode;
 	typedef LinkedList<Font> FontList;
 
+	//\brief A string laid out in a font at a size, kept so text that doesn't change isn't laid out every frame
+	struct TextLayout
+	{
+		unsigned int m_key{ 0 };								///< Combined hash of the string, font, size and dimension
+		unsigned int m_fontNameHash{ 0 };
+		float m_size{ 0.0f };
+		float m_viewAspect{ 0.0f };								///< Glyph sizes depend on the aspect so a change invalidates the layout
+		bool m_is2D{ false };
+		char * m_string{ nullptr };								///< Copy of the string to rule out hash collisions
+		unsigned int m_stringLength{ 0 };
+		unsigned int m_stringCapacity{ 0 };
+		Texture * m_texture{ nullptr };
+		RenderManager::FontGlyph * m_glyphs{ nullptr };			///< Quads relative to the start of the string
+		unsigned int m_numGlyphs{ 0 };
+		unsigned int m_glyphCapacity{ 0 };
+		float m_width{ 0.0f };									///< Extents as measured for 2D widgets
+		float m_height{ 0.0f };
+	};
+
+	//\brief Find a loaded font by name
+	Font * GetFont(unsigned int a_fontNameHash);
+
+	//\brief Get the cached layout of a string or lay it out again if it is not in the cache
+	//\return nullptr if the font is not loaded
+	const TextLayout * GetLayout(const char * a_string, unsigned int a_fontNameHash, float a_size, bool a_is2D);
+
+	//\brief Fill out glyph quads and extents of a string
+	void LayoutString(TextLayout & a_layout_OUT, Font * a_font);
+
+	//\brief Free all memory owned by the layout cache
+	void ClearLayoutCache();
+
 	//\brief Load the font as an include file so the engine is not dependant on external files to draw messages to the screen
 	bool LoadDefaultFont(const char * a_fontDefinition);
 
@@ -145,7 +178,7 @@ private:
 				sprintf(shortFontName, "%s", StringUtils::TrimString(StringUtils::ExtractField(line, "\"", 1), true));
 				newFont->m_fontName.SetCString(shortFontName);
 				a_input.getline(line, StringUtils::s_maxCharsPerLine);			// common lineHeight=x base=33			
-				sscanf_s(line, "common lineHeight=%d base=%d scaleW=%d scaleH=%d pages=%d",
+				sscanf(line, "common lineHeight=%d base=%d scaleW=%d scaleH=%d pages=%d",
 					&lineHeight, &base, &sizeW, &sizeH, &pages);
 
 				// As we try to render all fonts the same size, fail to load fonts greater than a meg
@@ -160,7 +193,7 @@ private:
 				sprintf(textureName, "%s", StringUtils::TrimString(StringUtils::ExtractField(line, "=", 2), true));
 
 				a_input.getline(line, StringUtils::s_maxCharsPerLine);			// chars count=x
-				sscanf_s(line, "chars count=%d", &numChars);
+				sscanf(line, "chars count=%d", &numChars);
 
 				// Load texture for font
 				sprintf(texturePath, "%s%s", m_fontPath, textureName);
@@ -174,7 +207,7 @@ private:
 				{
 					a_input.getline(line, StringUtils::s_maxCharsPerLine);
 					int charId, x, y, width, height, xoffset, yoffset, xadvance, page, chnl;
-					sscanf_s(line, "char id=%d   x=%d    y=%d    width=%d     height=%d     xoffset=%d     yoffset=%d    xadvance=%d     page=%d  chnl=%d",
+					sscanf(line, "char id=%d   x=%d    y=%d    width=%d     height=%d     xoffset=%d     yoffset=%d    xadvance=%d     page=%d  chnl=%d",
 						&charId, &x, &y, &width, &height, &xoffset, &yoffset, &xadvance, &page, &chnl);
 					FontChar & curChar = newFont->m_chars[charId];
 					curChar.m_x = (float)x;
@@ -220,6 +253,7 @@ private:
 	char m_fontPath[StringUtils::s_maxCharsPerLine];	///< Cache off path to fonts
 	FontList m_fonts;									///< Storage for all fonts that are available for drawing
 	Texture m_defaultFontTexture;						///< Pointer to a texture in memory loaded from an inc file
+	TextLayout m_layoutCache[s_layoutCacheSize];		///< Direct mapped by key, a collision just lays out the newer string
 };
 
 
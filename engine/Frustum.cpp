@@ -0,0 +1,140 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "../core/MathUtils.h"
+#include "../core/Simd.h"
+
+#include "Frustum.h"
+
+void CullBounds::Init(int a_capacity)
+{
+	Shutdown();
+
+	// Pad to a whole group so the last group can be loaded without reading past the end
+	m_capacity = ((a_capacity + Simd::s_width - 1) / Simd::s_width) * Simd::s_width;
+	float ** components[] = { &m_centreX, &m_centreY, &m_centreZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius };
+	for (float ** component : components)
+	{
+		*component = (float *)calloc(m_capacity, sizeof(float));
+	}
+	m_count = 0;
+}
+
+void CullBounds::Shutdown()
+{
+	float ** components[] = { &m_centreX, &m_centreY, &m_centreZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius };
+	for (float ** component : components)
+	{
+		free(*component);
+		*component = nullptr;
+	}
+	m_count = 0;
+	m_capacity = 0;
+}
+
+bool CullBounds::Add(const Vector & a_centre, const Vector & a_extents, float a_radius)
+{
+	if (m_count >= m_capacity)
+	{
+		return false;
+	}
+
+	m_centreX[m_count] = a_centre.GetX();
+	m_centreY[m_count] = a_centre.GetY();
+	m_centreZ[m_count] = a_centre.GetZ();
+	m_extentX[m_count] = a_extents.GetX();
+	m_extentY[m_count] = a_extents.GetY();
+	m_extentZ[m_count] = a_extents.GetZ();
+	m_radius[m_count] = a_radius;
+	++m_count;
+	return true;
+}
+
+void Frustum::Extract(const Matrix & a_viewMatrix, const Matrix & a_perspectiveMatrix)
+{
+	// Points are row vectors transformed by view then projection, so each clip space component is a column of the product
+	Matrix viewProj = a_viewMatrix.Multiply(a_perspectiveMatrix);
+	const float * m = viewProj.GetValues();
+	const float sign[s_numPlanes] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+	for (int i = 0; i < s_numPlanes; ++i)
+	{
+		// Left/right use clip x, bottom/top clip y and near/far clip z, each compared against clip w
+		const int col = i / 2;
+		const float x = m[3] + sign[i] * m[col];
+		const float y = m[7] + sign[i] * m[4 + col];
+		const float z = m[11] + sign[i] * m[8 + col];
+		const float w = m[15] + sign[i] * m[12 + col];
+		const float length = sqrtf(x * x + y * y + z * z);
+		const float invLength = length > EPSILON ? 1.0f / length : 0.0f;
+		m_normalX[i] = x * invLength;
+		m_normalY[i] = y * invLength;
+		m_normalZ[i] = z * invLength;
+		m_distance[i] = w * invLength;
+	}
+}
+
+bool Frustum::Intersect(const Vector & a_centre, const Vector & a_extents, float a_radius) const
+{
+	for (int i = 0; i < s_numPlanes; ++i)
+	{
+		// The box and sphere are both conservative so whichever reaches less far towards the plane is used
+		const float dist = m_normalX[i] * a_centre.GetX() + m_normalY[i] * a_centre.GetY() + m_normalZ[i] * a_centre.GetZ() + m_distance[i];
+		const float boxReach = fabsf(m_normalX[i]) * a_extents.GetX() + fabsf(m_normalY[i]) * a_extents.GetY() + fabsf(m_normalZ[i]) * a_extents.GetZ();
+		if (dist < -MathUtils::GetMin(boxReach, a_radius))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int Frustum::Cull(const CullBounds & a_bounds, bool * a_visible_OUT) const
+{
+	// Plane constants are the same for every group so splat them once
+	Simd::Float4 normalX[s_numPlanes], normalY[s_numPlanes], normalZ[s_numPlanes], distance[s_numPlanes];
+	Simd::Float4 absNormalX[s_numPlanes], absNormalY[s_numPlanes], absNormalZ[s_numPlanes];
+	for (int i = 0; i < s_numPlanes; ++i)
+	{
+		normalX[i] = Simd::Splat(m_normalX[i]);
+		normalY[i] = Simd::Splat(m_normalY[i]);
+		normalZ[i] = Simd::Splat(m_normalZ[i]);
+		distance[i] = Simd::Splat(m_distance[i]);
+		absNormalX[i] = Simd::Splat(fabsf(m_normalX[i]));
+		absNormalY[i] = Simd::Splat(fabsf(m_normalY[i]));
+		absNormalZ[i] = Simd::Splat(fabsf(m_normalZ[i]));
+	}
+
+	// Storage is padded to whole groups so the tail is tested along with everything else and ignored
+	const Simd::Float4 zero = Simd::Splat(0.0f);
+	const int count = a_bounds.GetCount();
+	int numVisible = 0;
+	for (int group = 0; group < count; group += Simd::s_width)
+	{
+		const Simd::Float4 centreX = Simd::Load(a_bounds.m_centreX + group);
+		const Simd::Float4 centreY = Simd::Load(a_bounds.m_centreY + group);
+		const Simd::Float4 centreZ = Simd::Load(a_bounds.m_centreZ + group);
+		const Simd::Float4 extentX = Simd::Load(a_bounds.m_extentX + group);
+		const Simd::Float4 extentY = Simd::Load(a_bounds.m_extentY + group);
+		const Simd::Float4 extentZ = Simd::Load(a_bounds.m_extentZ + group);
+		const Simd::Float4 radius = Simd::Load(a_bounds.m_radius + group);
+
+		Simd::Float4 inside = Simd::AllTrue();
+		for (int i = 0; i < s_numPlanes; ++i)
+		{
+			const Simd::Float4 dist = Simd::MulAdd(normalX[i], centreX, Simd::MulAdd(normalY[i], centreY, Simd::MulAdd(normalZ[i], centreZ, distance[i])));
+			const Simd::Float4 boxReach = Simd::MulAdd(absNormalX[i], extentX, Simd::MulAdd(absNormalY[i], extentY, Simd::Mul(absNormalZ[i], extentZ)));
+			const Simd::Float4 reach = Simd::Min(boxReach, radius);
+			inside = Simd::And(inside, Simd::CmpGe(dist, Simd::Sub(zero, reach)));
+		}
+
+		const int mask = Simd::MoveMask(inside);
+		const int groupSize = MathUtils::GetMin(Simd::s_width, count - group);
+		for (int lane = 0; lane < groupSize; ++lane)
+		{
+			const bool visible = (mask & (1 << lane)) != 0;
+			a_visible_OUT[group + lane] = visible;
+			numVisible += visible ? 1 : 0;
+		}
+	}
+	return numVisible;
+}
@@ -0,0 +1,82 @@
+#ifndef _ENGINE_FRUSTUM_H_
+#define _ENGINE_FRUSTUM_H_
+#pragma once
+
+#include "../core/Matrix.h"
+#include "../core/Vector.h"
+
+//\brief World space bounds of many objects stored component by component so they can be tested several at a time.
+//		 Each entry is an axis aligned box and a sphere sharing the same centre.
+class CullBounds
+{
+public:
+
+	CullBounds() = default;
+	~CullBounds() { Shutdown(); }
+
+	//\brief Allocate storage for a number of entries, rounded up to a whole number of SIMD groups
+	void Init(int a_capacity);
+	void Shutdown();
+
+	//\brief Append the bounds of an object, false if there is no room left
+	bool Add(const Vector & a_centre, const Vector & a_extents, float a_radius);
+	inline void Clear() { m_count = 0; }
+
+	inline int GetCount() const { return m_count; }
+	inline int GetCapacity() const { return m_capacity; }
+
+	float * m_centreX{ nullptr };				///< Centre of each box and sphere
+	float * m_centreY{ nullptr };
+	float * m_centreZ{ nullptr };
+	float * m_extentX{ nullptr };				///< Half size of each box along the world axes
+	float * m_extentY{ nullptr };
+	float * m_extentZ{ nullptr };
+	float * m_radius{ nullptr };				///< Radius of each sphere
+
+private:
+
+	int m_count{ 0 };							///< Number of entries added since the last clear
+	int m_capacity{ 0 };						///< Number of entries there is storage for
+};
+
+//\brief The six planes bounding the volume a camera can see, used to reject objects before they are submitted for rendering
+class Frustum
+{
+public:
+
+	enum class Plane : int
+	{
+		Left = 0,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far,
+		Count,
+	};
+
+	//\brief Derive the planes from the matrices the scene is rendered with, normals point into the frustum
+	//\param a_viewMatrix is the inverse of the camera matrix
+	//\param a_perspectiveMatrix is the projection used when drawing the world layer
+	void Extract(const Matrix & a_viewMatrix, const Matrix & a_perspectiveMatrix);
+
+	//\brief Test a single box and sphere against all planes
+	//\return true if the bounds are inside or touching the frustum
+	bool Intersect(const Vector & a_centre, const Vector & a_extents, float a_radius) const;
+
+	//\brief Test every entry in a set of bounds, four at a time
+	//\param a_visible_OUT receives true for each entry that is inside or touching the frustum
+	//\return the number of visible entries
+	int Cull(const CullBounds & a_bounds, bool * a_visible_OUT) const;
+
+private:
+
+	static const int s_numPlanes = static_cast<int>(Plane::Count);
+
+	float m_normalX[s_numPlanes]{};				///< Plane normals and distances stored by component for splatting into SIMD registers
+	float m_normalY[s_numPlanes]{};
+	float m_normalZ[s_numPlanes]{};
+	float m_distance[s_numPlanes]{};
+};
+
+#endif // _ENGINE_FRUSTUM_H_
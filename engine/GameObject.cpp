@@ -1,3 +1,4 @@
+#include "../core/MathUtils.h"
 #include "../core/Quaternion.h"
 
 #include "AnimationBlender.h"
@@ -20,6 +21,7 @@ const char * GameObject::s_clipTypeStrings[static_cast<int>(ClipType::Count)] =
 	"axisbox",
 	"sphere",
 	"box",
+	"mesh",
 };
 
 void GameObject::SetTemplateProperties()
@@ -54,8 +56,7 @@ void GameObject::SetTemplateProperties()
 				}
 				else if (strstr(clipType->GetString(), GameObject::s_clipTypeStrings[static_cast<int>(ClipType::Mesh)]) != nullptr)
 				{
-					Log::Get().Write(LogLevel::Warning, LogCategory::Game, "Mesh clip type no longer supported for object %s, defaulting to axisbox.", GetName());
-					SetClipType(ClipType::AxisBox);
+					SetClipType(ClipType::Mesh);
 				}
 				else
 				{
@@ -103,21 +104,9 @@ void GameObject::SetTemplateProperties()
 	}
 }
 
-bool GameObject::Update(float a_dt)
-{
 #ifndef _RELEASE
-	// Don't update game objects while debugging
-	if (DebugMenu::Get().IsDebugMenuEnabled())
-	{
-		return true;
-	}
-
-	// Don't update scripts if time paused
-	if (DebugMenu::Get().IsTimePaused())
-	{
-		return true;
-	}
-
+void GameObject::UpdateTemplate()
+{
 	// Monitor and reload from template
 	if (HasTemplate())
 	{
@@ -132,8 +121,11 @@ bool GameObject::Update(float a_dt)
 			m_templateTimeStamp = tempTime;
 		}
 	}
-
+}
 #endif
+
+bool GameObject::Update(float a_dt)
+{
 	// Early out for deactivated objects
 	if (m_state == GameObjectState::Sleep)
 	{
@@ -163,17 +155,46 @@ bool GameObject::Update(float a_dt)
 	return true;
 }
 
-bool GameObject::Draw()
+bool GameObject::UpdateWorldBounds()
+{
+	m_finalMat.SetIdentity();
+	Vector finalPos = m_worldMat.GetPos() + m_localMat.GetPos();
+	m_finalMat = m_worldMat.Multiply(m_localMat);
+	m_finalMat.SetPos(finalPos);
+
+	m_hasWorldBounds = m_visible && m_model != nullptr && m_model->IsLoaded();
+	if (!m_hasWorldBounds)
+	{
+		return false;
+	}
+
+	// The box centre moves with the full transform, the extents are the model box projected onto the world axes
+	const Vector & boundsMin = m_model->GetBoundsMin();
+	const Vector & boundsMax = m_model->GetBoundsMax();
+	const Vector centre = (boundsMin + boundsMax) * 0.5f;
+	const Vector extents = (boundsMax - boundsMin) * 0.5f;
+	const Vector right = m_finalMat.GetRight();
+	const Vector look = m_finalMat.GetLook();
+	const Vector up = m_finalMat.GetUp();
+	m_worldBoundsCentre = m_finalMat.Transform(centre) + m_finalMat.GetPos();
+	m_worldBoundsExtents = Vector(	fabsf(right.GetX()) * extents.GetX() + fabsf(look.GetX()) * extents.GetY() + fabsf(up.GetX()) * extents.GetZ(),
+									fabsf(right.GetY()) * extents.GetX() + fabsf(look.GetY()) * extents.GetY() + fabsf(up.GetY()) * extents.GetZ(),
+									fabsf(right.GetZ()) * extents.GetX() + fabsf(look.GetZ()) * extents.GetY() + fabsf(up.GetZ()) * extents.GetZ());
+
+	// Non uniform scale stretches the sphere so take the largest axis
+	const Vector scale = m_finalMat.GetScale();
+	const float maxScale = MathUtils::GetMax(scale.GetX(), MathUtils::GetMax(scale.GetY(), scale.GetZ()));
+	m_worldBoundsRadius = m_model->GetBoundingSphereRadius() * maxScale;
+	return true;
+}
+
+bool GameObject::Draw(bool a_inView)
 {
 	if (m_state == GameObjectState::Active)
 	{
 		// Normal mesh rendering
 		RenderManager & rMan = RenderManager::Get();
-		m_finalMat.SetIdentity();
-		Vector finalPos = m_worldMat.GetPos() + m_localMat.GetPos();
-		m_finalMat = m_worldMat.Multiply(m_localMat);
-		m_finalMat.SetPos(finalPos);
-		if (m_visible && m_model != nullptr && m_model->IsLoaded())
+		if (a_inView && m_visible && m_model != nullptr && m_model->IsLoaded())
 		{
 			rMan.AddModel(RenderLayer::World, m_model, &m_finalMat, m_shader, m_shaderData, m_lifeTime);
 		}
@@ -207,8 +228,8 @@ bool GameObject::Draw()
 				}
 				case ClipType::Mesh:
 				{
-					// TODO: proper collision mesh drawing
-					rMan.AddDebugSphere(GetClipPos(), 1.0f, sc_colourGreen); 
+					// Triangles collide where the model is drawn so show the box they fit in
+					rMan.AddDebugAxisBox(m_worldBoundsCentre, m_worldBoundsExtents, sc_colourGreen); 
 					break;
 				}
 				
@@ -224,15 +245,33 @@ bool GameObject::Draw()
 	return false;
 }
 
+void GameObject::SetPhysicsMass(const float & a_newMass)
+{
+	m_physicsMass = a_newMass;
+	if (HasPhysics())
+	{
+		PhysicsManager::Get().UpdatePhysicsProperties(this);
+	}
+}
+
+void GameObject::SetPhysicsLinearDrag(const float & a_newDrag)
+{
+	m_physicsLinearDrag = a_newDrag;
+	if (HasPhysics())
+	{
+		PhysicsManager::Get().UpdatePhysicsProperties(this);
+	}
+}
+
 bool GameObject::Shutdown() 
 {
 	// Empty collision list and remove from physics simulation
-	if (m_physics != nullptr)
+	if (HasPhysics())
 	{
 		PhysicsManager & physMan = PhysicsManager::Get();
 		physMan.RemovePhysicsObject(this);
 		physMan.RemoveCollisionObject(this);
-		m_physics = nullptr;
+		m_physics = 0;
 	}
 
 	// Remove references to managed resources
@@ -261,9 +300,12 @@ void GameObject::SetTemplate(const char * a_templateName)
 	strncpy(m_template, a_templateName, StringUtils::s_maxCharsPerName);
 	// Find the timestamp for the template file monitoring
 #ifndef _RELEASE
-	char fullTemplatePath[StringUtils::s_maxCharsPerLine];
-	sprintf(fullTemplatePath, "%s%s", WorldManager::Get().GetTemplatePath(), a_templateName);
-	FileManager::Get().GetFileTimeStamp(fullTemplatePath, m_templateTimeStamp);
+	if (HasTemplate())
+	{
+		char fullTemplatePath[StringUtils::s_maxCharsPerLine];
+		sprintf(fullTemplatePath, "%s%s", WorldManager::Get().GetTemplatePath(), a_templateName);
+		FileManager::Get().GetFileTimeStamp(fullTemplatePath, m_templateTimeStamp);
+	}
 #endif
 }
 
@@ -385,10 +427,10 @@ void GameObject::Serialise(GameFile * outputFile, GameFile::Object * a_parent)
 		{
 			if (m_clipType != ClipType::None)
 			{
-				// Primitive type clipping
+				// Mesh clipping takes its shape from the model so only primitives need a size
+				outputFile->AddProperty(fileObject, "clipType", s_clipTypeStrings[static_cast<int>(m_clipType)]);
 				if (m_clipType != ClipType::Mesh)
 				{
-					outputFile->AddProperty(fileObject, "clipType", s_clipTypeStrings[static_cast<int>(m_clipType)]);
 					outputFile->AddProperty(fileObject, "clipSize", m_clipVolumeSize);
 					outputFile->AddProperty(fileObject, "clipOffset", m_clipVolumeOffset);
 				}
@@ -439,9 +481,9 @@ void GameObject::SerialiseTemplate()
 	}
 	if (m_clipType != ClipType::None)
 	{
+		templateFile->AddProperty(templateObj, "clipType", s_clipTypeStrings[static_cast<int>(m_clipType)]);
 		if (m_clipType != ClipType::Mesh)
 		{
-			templateFile->AddProperty(templateObj, "clipType", s_clipTypeStrings[static_cast<int>(m_clipType)]);
 			templateFile->AddProperty(templateObj, "clipSize", m_clipVolumeSize);
 			templateFile->AddProperty(templateObj, "clipOffset", m_clipVolumeOffset);
 		}
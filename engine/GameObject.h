@@ -6,6 +6,7 @@
 
 #include "../core/Matrix.h"
 #include "../core/Quaternion.h"
+#include "../core/SlotMap.h"
 
 #include "GameFile.h"
 #ifndef _RELEASE
@@ -16,7 +17,6 @@
 
 class AnimationBlender;
 class Model;
-class PhysicsObject;
 class Shader;
 
 //\brief GameObject state determines how the update effects related subsystems
@@ -37,7 +37,7 @@ enum class ClipType : unsigned char
 	AxisBox,	///< Box that can't be rotated
 	Sphere,		///< Sphere bounding volume
 	Box,		///< Box with three seperate dimensions
-	Mesh,		///< Triangles defined in a separate collision mesh
+	Mesh,		///< Triangles of the object's model, static level geometry that doesn't need hand placed boxes
 	Count,
 };
 	
@@ -56,7 +56,7 @@ public:
 		, m_next(nullptr)
 		, m_model(nullptr)
 		, m_shader(nullptr)
-		, m_physics(nullptr)
+		, m_physics(0)
 		, m_blender(nullptr)
 		, m_state(GameObjectState::New)
 		, m_lifeTime(0.0f)
@@ -75,20 +75,35 @@ public:
 			SetTemplate("");
 		}
 
-	~GameObject() { assert(m_physics == nullptr); }
+	~GameObject() { assert(!HasPhysics()); }
 
 	//\brief Lifecycle functionality inherited by children
+	//		 Update and UpdateWorldBounds only touch the object itself so many objects can be updated at once on different threads
 	bool Startup() { return true; }
 	bool Update(float a_dt);
-	bool Draw();
 	bool Shutdown();
 
+#ifndef _RELEASE
+	//\brief Reload the object's properties if its template has changed on disk
+	//		 Goes through the file system and other managers so must be called from the main thread
+	void UpdateTemplate();
+#endif
+
+	//\brief Combine the world and local transforms for rendering and move the model's bounds into world space
+	//\return true if the object has a visible model that should be tested against the view, also kept for HasWorldBounds
+	bool UpdateWorldBounds();
+	inline bool HasWorldBounds() const { return m_hasWorldBounds; }
+
+	//\brief Submit the object's model and debug display to the render manager, UpdateWorldBounds must be called first
+	//\param a_inView false if the object's bounds are outside the view, the model is not submitted
+	bool Draw(bool a_inView = true);
+
 	//\brief State mutators and accessors
 	inline void SetSleeping() { m_state = GameObjectState::Sleep; }
 	inline void SetActive()	  { m_state = GameObjectState::Active; }
 	inline bool IsActive()	  { return m_state == GameObjectState::Active; }
 	inline bool IsSleeping()  { return m_state == GameObjectState::Sleep; }
-	inline void SetId(unsigned int a_newId) { m_id = a_newId; }
+	inline void SetId(SlotHandle a_newId) { m_id = a_newId; }
 	inline void SetLifeTime(float a_newTime) { m_lifeTime = a_newTime; }
 	inline void SetShaderData(const Vector & a_shaderData) { m_shaderData = a_shaderData; }
 	inline void SetClipType(ClipType a_newClipType) { m_clipType = a_newClipType; }
@@ -96,16 +111,16 @@ public:
 	inline void SetClipOffset(const Vector & a_clipOffset) { m_clipVolumeOffset = a_clipOffset; }
 	inline void SetClipGroup(const char* a_clipGroupName, const int& a_clipGroupId) { m_clipGroup.SetCString(a_clipGroupName); m_clipGroupId = a_clipGroupId; }
 	inline void SetClipping(bool a_enable) { m_clipping = a_enable; }
-	inline void SetPhysicsMass(const float & a_newMass) { m_physicsMass = a_newMass; }
+	void SetPhysicsMass(const float & a_newMass);
 	inline void SetPhysicsElasticity(const float & a_newElastic) { m_physicsElasticity = a_newElastic; }
-	inline void SetPhysicsLinearDrag(const float & a_newDrag) { m_physicsLinearDrag = a_newDrag; }
+	void SetPhysicsLinearDrag(const float & a_newDrag);
 	inline void SetPhysicsAngularDrag(const float & a_newDrag) { m_physicsAngularDrag = a_newDrag; }
 	inline void SetVisible(bool a_enable) { m_visible = a_enable; }
 	inline void SetWorldMat(const Matrix & a_mat) { m_worldMat = a_mat; }
 	inline void SetScriptReference(int a_scriptRef) { m_scriptRef = a_scriptRef; }
-	inline void SetPhysics(PhysicsObject* a_physics) { m_physics = a_physics; }
+	inline void SetPhysics(SlotHandle a_physics) { m_physics = a_physics; }
 	
-	inline unsigned int GetId() const { return m_id; }
+	inline SlotHandle GetId() const { return m_id; }
 	inline const char * GetName() const { return m_name; }
 	inline const char * GetTemplate() const { return m_template; }
 	inline Model * GetModel() const { return m_model; }
@@ -119,6 +134,9 @@ public:
 	inline Vector GetClipOffset() { return m_clipVolumeOffset; }
 	inline Vector GetClipSize() const { return m_clipVolumeSize; }
 	inline ClipType GetClipType() const { return m_clipType; }
+	inline const Vector & GetWorldBoundsCentre() const { return m_worldBoundsCentre; }
+	inline const Vector & GetWorldBoundsExtents() const { return m_worldBoundsExtents; }
+	inline float GetWorldBoundsRadius() const { return m_worldBoundsRadius; }
 	inline StringHash GetClipGroup() const { return m_clipGroup; }
 	inline int GetClipGroupId() const { return m_clipGroupId; }
 	inline auto GetPhysicsMass() const { return m_physicsMass; }
@@ -129,7 +147,8 @@ public:
 	inline bool IsScriptOwned() const { return m_scriptRef >= 0; }
 	inline bool IsClipping() const { return m_clipping; }
 	inline int GetScriptReference() const { return m_scriptRef; }
-	inline PhysicsObject * GetPhysics() const { return m_physics; }
+	inline SlotHandle GetPhysics() const { return m_physics; }
+	inline bool HasPhysics() const { return m_physics != 0; }
 	Quaternion GetRot() const;
 	Vector GetScale() const;
 	
@@ -152,12 +171,10 @@ public:
 	inline GameObject * GetNext() { return m_next; }
 
 	//\ingroup Collision
-	typedef LinkedListNode<GameObject> Collider;		///< Alias for passing lists of game objects around
-	typedef LinkedList<GameObject> CollisionList;		///< Alias for passing lists of game objects around
-
-	//\brief Collision utility functions
-	inline CollisionList * GetCollisions() { return &m_collisions; }
-	inline bool HasColliders() { return !m_collisions.IsEmpty(); }
+	//\brief Script function called when a contact with this object begins or ends
+	inline void SetCollisionCallback(int a_callbackRef) { m_collisionCallbackRef = a_callbackRef; }
+	inline int GetCollisionCallback() const { return m_collisionCallbackRef; }
+	inline bool HasCollisionCallback() const { return m_collisionCallbackRef >= 0; }
 	
 	//\brief Realtime collision functions
 	//\param The vector(s) to check intersection against the game object
@@ -184,14 +201,13 @@ private:
 	//\brief Reset member data from any template properties that exist
 	void SetTemplateProperties();
 
-	unsigned int			m_id;										///< Unique identifier, objects can be resolved from ids
+	SlotHandle				m_id;										///< Handle from the world lookup, resolves to null once the object is destroyed
 	char					m_name[StringUtils::s_maxCharsPerName];		///< Every creature needs a name, up top for ease of debugging
 	GameObject *			m_child{ nullptr };							///< Pointer to first child game obhject
 	GameObject *			m_next{ nullptr };							///< Pointer to sibling game objects
-	CollisionList			m_collisions;								///< List of objects that this game object has collided with this frame
 	Model *					m_model{ nullptr };							///< Pointer to a mesh for display purposes
 	Shader *				m_shader{ nullptr };						///< Pointer to a shader owned by the render manager to draw with
-	PhysicsObject*			m_physics{ nullptr };						///< Pointer to physics manager object for collisions and dynamics
+	SlotHandle				m_physics{ 0 };								///< Handle to the dynamic body the physics manager simulates for this object
 	AnimationBlender *		m_blender{ nullptr };						///< Pointer to an animation blender if present
 	GameObjectState			m_state;									///< What state the object is in
 	float					m_lifeTime;									///< How long this guy has been active
@@ -210,9 +226,14 @@ private:
 	Matrix					m_worldMat;									///< Position and orientation in the world
 	Matrix					m_localMat;									///< Position and orientation relative to world mat, used for animation
 	Matrix					m_finalMat;									///< Aggregate of world and local only used by render
+	Vector					m_worldBoundsCentre{ 0.0f };				///< Centre of the model's bounds after the final transform
+	Vector					m_worldBoundsExtents{ 0.0f };				///< Half size of the world axis aligned box enclosing the model
+	float					m_worldBoundsRadius{ 0.0f };				///< Radius of the model's bounding sphere after scaling
+	bool					m_hasWorldBounds{ false };					///< If the last UpdateWorldBounds found a visible model to cull
 	char					m_template[StringUtils::s_maxCharsPerName];	///< Every persistent, serializable creature needs a template
 #ifndef _RELEASE
 	FileManager::Timestamp	m_templateTimeStamp;						///< For auto-reloading of templates
 #endif
 	int						m_scriptRef;								///< If the object is created and managed by script, the ID on the script side is stored here
+	int						m_collisionCallbackRef{ -1 };				///< Script registry reference to the function to call on contact changes
 };
@@ -0,0 +1,22 @@
+#include "GameFile.h"
+#include "Log.h"
+
+#include "JobManager.h"
+
+template<> JobManager * Singleton<JobManager>::s_instance = nullptr;
+
+bool JobManager::Startup(const GameFile & a_config)
+{
+	unsigned int numWorkers = GetDefaultNumWorkers();
+	if (GameFile::Object * jobsConfig = a_config.FindObject("jobs"))
+	{
+		if (GameFile::Property * workersProp = jobsConfig->FindProperty("workers"))
+		{
+			const int configWorkers = workersProp->GetInt();
+			numWorkers = configWorkers > 0 ? (unsigned int)configWorkers : numWorkers;
+		}
+	}
+
+	Log::Get().Write(LogLevel::Info, LogCategory::Engine, "Starting job system with %u workers", numWorkers);
+	return JobSystem::Startup(numWorkers);
+}
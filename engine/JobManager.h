@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../core/JobSystem.h"
+
+#include "Singleton.h"
+
+class GameFile;
+
+//\brief JobManager owns the engine's worker threads, systems hand it work with CreateJob and Run or ParallelFor
+class JobManager : public Singleton<JobManager>, public JobSystem
+{
+public:
+
+	//\brief Start the workers, the count is read from jobs.workers in the game config
+	//		 and defaults to one less than the number of hardware threads when it is missing or 0
+	bool Startup(const GameFile & a_config);
+};
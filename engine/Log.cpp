@@ -4,14 +4,14 @@
 
 template<> Log * Singleton<Log>::s_instance = nullptr;
 
-const float	Log::s_logDisplayTime[LogLevel::Count] =
+const float	Log::s_logDisplayTime[s_numLogs] =
 {
 	1.0f,	// INFO
 	2.0f,	// WARNING
 	9.0f	// ERROR
 };
 
-const Colour Log::s_logDisplayColour[LogLevel::Count]=
+const Colour Log::s_logDisplayColour[s_numLogs]=
 {
 	sc_colourGreen,
 	sc_colourPurple,
@@ -46,17 +46,20 @@ void Log::Write(LogLevel a_level, LogCategory a_category, const char * a_message
 	memset(&errorString, 0, sizeof(char)*StringUtils::s_maxCharsPerLine);
 	sprintf(errorString, "%u -> %s::%s:", Time::GetSystemTime(), categoryBuf, levelBuf);
 
-	// Grab all the log arguments passed in the elipsis
+	// Grab all the log arguments passed in the elipsis, measuring the message uses up a copy of them
 	va_list formatArgs;
 	va_start(formatArgs, a_message);
-	int finalStringSize = _vscprintf(a_message, formatArgs);
+	va_list sizeArgs;
+	va_copy(sizeArgs, formatArgs);
+	int finalStringSize = vsnprintf(nullptr, 0, a_message, sizeArgs);
+	va_end(sizeArgs);
 	formatString = (char *)malloc(sizeof(char) * finalStringSize + 1);
 	finalString = (char *)malloc(sizeof(char) * finalStringSize + strlen(errorString) + 8);
  	if (finalString != nullptr && formatString != nullptr)
 	{
 		vsprintf(formatString, a_message, formatArgs);
 		sprintf(finalString, "%s %s\n", errorString, formatString);
-		printf(finalString);
+		printf("%s", finalString);
 	}
 	else // Something is horribly wrong
 	{
@@ -112,13 +115,10 @@ void Log::WriteOnce(LogLevel a_level, LogCategory a_category, const char * a_mes
 	return;
 #endif
 
-	// Add message to write once list
-	void * tempVal = nullptr;
+	// Add message to write once list, insert only succeeds the first time the message is seen
 	unsigned int msgHash = StringHash::GenerateCRC(a_message, false);
-	if (!m_writeOnceList.Get(msgHash, tempVal))
+	if (m_writeOnceList.Insert(msgHash, nullptr))
 	{
-		m_writeOnceList.Insert(msgHash, tempVal);
-
 		char levelBuf[128];
 		char categoryBuf[128];
 		memset(levelBuf, 0, sizeof(char)*128);
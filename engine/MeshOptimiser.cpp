@@ -0,0 +1,333 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MeshOptimiser.h"
+
+namespace
+{
+	// Tuning values from Forsyth's linear speed vertex cache optimisation
+	const int s_forsythCacheSize = 32;
+	const float s_cacheDecayPower = 1.5f;
+	const float s_lastTriScore = 0.75f;
+	const float s_valenceBoostScale = 2.0f;
+	const float s_valenceBoostPower = 0.5f;
+
+	//\brief How desirable it is to use a vertex next given where it is in the cache and how many triangles still need it
+	float ScoreVertex(int a_cachePos, unsigned int a_numActiveTris)
+	{
+		if (a_numActiveTris == 0)
+		{
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (a_cachePos >= 0)
+		{
+			// The last triangle's verts score the same so there is no preference for order within it
+			if (a_cachePos < 3)
+			{
+				score = s_lastTriScore;
+			}
+			else
+			{
+				const float scaler = 1.0f / (s_forsythCacheSize - 3);
+				score = powf(1.0f - (a_cachePos - 3) * scaler, s_cacheDecayPower);
+			}
+		}
+
+		// Boost verts with few triangles left so lone triangles don't get stranded
+		score += s_valenceBoostScale * powf((float)a_numActiveTris, -s_valenceBoostPower);
+		return score;
+	}
+
+	inline uint32_t HashFloats(const float * a_values, int a_count)
+	{
+		uint32_t hash = 2166136261u;
+		for (int i = 0; i < a_count; ++i)
+		{
+			uint32_t bits;
+			memcpy(&bits, &a_values[i], sizeof(bits));
+			hash = (hash ^ bits) * 16777619u;
+		}
+		return hash ^ (hash >> 15);
+	}
+}
+
+unsigned int MeshOptimiser::Weld(Vector * a_verts, Vector * a_normals, TexCoord * a_uvs, unsigned int a_numVerts, unsigned int * a_indices_OUT)
+{
+	// Open addressed table of unique vertex indices at least twice the size of the input
+	unsigned int tableSize = 1;
+	while (tableSize < a_numVerts * 2)
+	{
+		tableSize <<= 1;
+	}
+	const unsigned int empty = 0xFFFFFFFF;
+	unsigned int * table = (unsigned int *)malloc(sizeof(unsigned int) * tableSize);
+	memset(table, 0xFF, sizeof(unsigned int) * tableSize);
+
+	unsigned int numUnique = 0;
+	for (unsigned int i = 0; i < a_numVerts; ++i)
+	{
+		const float key[8] = {	a_verts[i].GetX(), a_verts[i].GetY(), a_verts[i].GetZ(),
+								a_normals[i].GetX(), a_normals[i].GetY(), a_normals[i].GetZ(),
+								a_uvs[i].GetX(), a_uvs[i].GetY() };
+		unsigned int slot = HashFloats(key, 8) & (tableSize - 1);
+		while (table[slot] != empty)
+		{
+			// Compare bit patterns so the result matches exactly what the GPU would receive
+			const unsigned int u = table[slot];
+			if (memcmp(&a_verts[u], &a_verts[i], sizeof(Vector)) == 0 &&
+				memcmp(&a_normals[u], &a_normals[i], sizeof(Vector)) == 0 &&
+				memcmp(&a_uvs[u], &a_uvs[i], sizeof(TexCoord)) == 0)
+			{
+				break;
+			}
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (table[slot] == empty)
+		{
+			// Unique vertices are compacted to the front, the write never passes the read
+			table[slot] = numUnique;
+			a_verts[numUnique] = a_verts[i];
+			a_normals[numUnique] = a_normals[i];
+			a_uvs[numUnique] = a_uvs[i];
+			++numUnique;
+		}
+		a_indices_OUT[i] = table[slot];
+	}
+
+	free(table);
+	return numUnique;
+}
+
+void MeshOptimiser::OptimiseVertexCache(unsigned int * a_indices, unsigned int a_numIndices, unsigned int a_numVerts)
+{
+	const unsigned int numTris = a_numIndices / 3;
+	if (numTris == 0 || a_numVerts == 0)
+	{
+		return;
+	}
+
+	// Build the list of triangles using each vertex
+	unsigned int * vertTriCount = (unsigned int *)calloc(a_numVerts, sizeof(unsigned int));
+	unsigned int * vertTriOffset = (unsigned int *)malloc(sizeof(unsigned int) * a_numVerts);
+	unsigned int * vertTris = (unsigned int *)malloc(sizeof(unsigned int) * numTris * 3);
+	int * vertCachePos = (int *)malloc(sizeof(int) * a_numVerts);
+	float * vertScore = (float *)malloc(sizeof(float) * a_numVerts);
+	float * triScore = (float *)malloc(sizeof(float) * numTris);
+	bool * triAdded = (bool *)calloc(numTris, sizeof(bool));
+	unsigned int * outIndices = (unsigned int *)malloc(sizeof(unsigned int) * numTris * 3);
+
+	for (unsigned int i = 0; i < numTris * 3; ++i)
+	{
+		++vertTriCount[a_indices[i]];
+	}
+	unsigned int offset = 0;
+	for (unsigned int v = 0; v < a_numVerts; ++v)
+	{
+		vertTriOffset[v] = offset;
+		offset += vertTriCount[v];
+		vertTriCount[v] = 0;
+	}
+	for (unsigned int t = 0; t < numTris; ++t)
+	{
+		for (unsigned int c = 0; c < 3; ++c)
+		{
+			const unsigned int v = a_indices[t * 3 + c];
+			vertTris[vertTriOffset[v] + vertTriCount[v]++] = t;
+		}
+	}
+
+	// Initial scores with an empty cache
+	for (unsigned int v = 0; v < a_numVerts; ++v)
+	{
+		vertCachePos[v] = -1;
+		vertScore[v] = ScoreVertex(-1, vertTriCount[v]);
+	}
+	int bestTri = -1;
+	float bestScore = -1.0f;
+	for (unsigned int t = 0; t < numTris; ++t)
+	{
+		triScore[t] = vertScore[a_indices[t * 3]] + vertScore[a_indices[t * 3 + 1]] + vertScore[a_indices[t * 3 + 2]];
+		if (triScore[t] > bestScore)
+		{
+			bestScore = triScore[t];
+			bestTri = (int)t;
+		}
+	}
+
+	int cache[s_forsythCacheSize + 3];
+	int newCache[s_forsythCacheSize + 3];
+	int cacheCount = 0;
+	unsigned int scanCursor = 0;
+	for (unsigned int n = 0; n < numTris; ++n)
+	{
+		// Nothing in the cache is useful so start again from the next untouched triangle
+		if (bestTri < 0)
+		{
+			while (triAdded[scanCursor])
+			{
+				++scanCursor;
+			}
+			bestTri = (int)scanCursor;
+		}
+
+		triAdded[bestTri] = true;
+		const unsigned int * tri = &a_indices[bestTri * 3];
+		outIndices[n * 3] = tri[0];
+		outIndices[n * 3 + 1] = tri[1];
+		outIndices[n * 3 + 2] = tri[2];
+
+		// The emitted triangle no longer counts towards its vertices' valence
+		for (unsigned int c = 0; c < 3; ++c)
+		{
+			const unsigned int v = tri[c];
+			unsigned int * tris = &vertTris[vertTriOffset[v]];
+			const unsigned int count = vertTriCount[v];
+			for (unsigned int i = 0; i < count; ++i)
+			{
+				if (tris[i] == (unsigned int)bestTri)
+				{
+					tris[i] = tris[count - 1];
+					tris[count - 1] = bestTri;
+					--vertTriCount[v];
+					break;
+				}
+			}
+		}
+
+		// Push the triangle's verts to the front of the LRU cache
+		int newCount = 0;
+		for (unsigned int c = 0; c < 3; ++c)
+		{
+			newCache[newCount++] = (int)tri[c];
+		}
+		for (int i = 0; i < cacheCount; ++i)
+		{
+			const int v = cache[i];
+			if (v != (int)tri[0] && v != (int)tri[1] && v != (int)tri[2])
+			{
+				newCache[newCount++] = v;
+			}
+		}
+
+		// Rescore everything that moved, verts pushed off the end lose their cache bonus
+		for (int i = 0; i < newCount; ++i)
+		{
+			const int v = newCache[i];
+			vertCachePos[v] = i < s_forsythCacheSize ? i : -1;
+			vertScore[v] = ScoreVertex(vertCachePos[v], vertTriCount[v]);
+		}
+
+		bestTri = -1;
+		bestScore = -1.0f;
+		for (int i = 0; i < newCount; ++i)
+		{
+			const int v = newCache[i];
+			const unsigned int * tris = &vertTris[vertTriOffset[v]];
+			for (unsigned int j = 0; j < vertTriCount[v]; ++j)
+			{
+				const unsigned int t = tris[j];
+				const float score = vertScore[a_indices[t * 3]] + vertScore[a_indices[t * 3 + 1]] + vertScore[a_indices[t * 3 + 2]];
+				triScore[t] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTri = (int)t;
+				}
+			}
+		}
+
+		cacheCount = newCount < s_forsythCacheSize ? newCount : s_forsythCacheSize;
+		memcpy(cache, newCache, sizeof(int) * cacheCount);
+	}
+
+	memcpy(a_indices, outIndices, sizeof(unsigned int) * numTris * 3);
+
+	free(vertTriCount);
+	free(vertTriOffset);
+	free(vertTris);
+	free(vertCachePos);
+	free(vertScore);
+	free(triScore);
+	free(triAdded);
+	free(outIndices);
+}
+
+void MeshOptimiser::OptimiseVertexFetch(Vector * a_verts, Vector * a_normals, TexCoord * a_uvs, unsigned int a_numVerts, unsigned int * a_indices, unsigned int a_numIndices)
+{
+	if (a_numVerts == 0)
+	{
+		return;
+	}
+
+	const unsigned int unused = 0xFFFFFFFF;
+	unsigned int * remap = (unsigned int *)malloc(sizeof(unsigned int) * a_numVerts);
+	memset(remap, 0xFF, sizeof(unsigned int) * a_numVerts);
+	unsigned int next = 0;
+	for (unsigned int i = 0; i < a_numIndices; ++i)
+	{
+		unsigned int & newIndex = remap[a_indices[i]];
+		if (newIndex == unused)
+		{
+			newIndex = next++;
+		}
+		a_indices[i] = newIndex;
+	}
+
+	// Any vertex the indices never reference goes on the end
+	for (unsigned int v = 0; v < a_numVerts; ++v)
+	{
+		if (remap[v] == unused)
+		{
+			remap[v] = next++;
+		}
+	}
+
+	Vector * verts = (Vector *)malloc(sizeof(Vector) * a_numVerts);
+	Vector * normals = (Vector *)malloc(sizeof(Vector) * a_numVerts);
+	TexCoord * uvs = (TexCoord *)malloc(sizeof(TexCoord) * a_numVerts);
+	for (unsigned int v = 0; v < a_numVerts; ++v)
+	{
+		verts[remap[v]] = a_verts[v];
+		normals[remap[v]] = a_normals[v];
+		uvs[remap[v]] = a_uvs[v];
+	}
+	memcpy(a_verts, verts, sizeof(Vector) * a_numVerts);
+	memcpy(a_normals, normals, sizeof(Vector) * a_numVerts);
+	memcpy(a_uvs, uvs, sizeof(TexCoord) * a_numVerts);
+
+	free(verts);
+	free(normals);
+	free(uvs);
+	free(remap);
+}
+
+float MeshOptimiser::CalculateACMR(const unsigned int * a_indices, unsigned int a_numIndices, unsigned int a_numVerts)
+{
+	const unsigned int numTris = a_numIndices / 3;
+	if (numTris == 0)
+	{
+		return 0.0f;
+	}
+
+	// A vertex is still cached if fewer than cache size misses have happened since it was loaded
+	const unsigned int notCached = 0xFFFFFFFF;
+	unsigned int * loadedAt = (unsigned int *)malloc(sizeof(unsigned int) * a_numVerts);
+	memset(loadedAt, 0xFF, sizeof(unsigned int) * a_numVerts);
+	unsigned int misses = 0;
+	for (unsigned int i = 0; i < a_numIndices; ++i)
+	{
+		const unsigned int v = a_indices[i];
+		if (loadedAt[v] == notCached || misses - loadedAt[v] >= s_vertexCacheSize)
+		{
+			loadedAt[v] = misses++;
+		}
+	}
+	free(loadedAt);
+
+	return (float)misses / (float)numTris;
+}
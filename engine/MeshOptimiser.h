@@ -0,0 +1,37 @@
+#ifndef _ENGINE_MESH_OPTIMISER_H_
+#define _ENGINE_MESH_OPTIMISER_H_
+#pragma once
+
+#include "../core/Vector.h"
+
+//\brief Load time processing of triangle lists to reduce the work the GPU does drawing them
+class MeshOptimiser
+{
+public:
+
+	static const unsigned int s_vertexCacheSize = 16;		///< Post transform cache size used when measuring ACMR, conservative for current hardware
+	static const unsigned int s_maxShortIndex = 0xFFFF;		///< Meshes with vertex counts up to this can use 16 bit indices
+
+	//\brief Merge vertices with identical position, normal and uv so each unique vertex is stored once
+	//\param a_verts, a_normals and a_uvs are a triangle list that is compacted in place, unique vertices are moved to the front
+	//\param a_numVerts is the number of vertices in the triangle list
+	//\param a_indices_OUT receives a_numVerts indices referencing the unique vertices
+	//\return the number of unique vertices
+	static unsigned int Weld(Vector * a_verts, Vector * a_normals, TexCoord * a_uvs, unsigned int a_numVerts, unsigned int * a_indices_OUT);
+
+	//\brief Reorder triangles so vertices shared between neighbouring triangles are likely to still be in the post transform cache
+	//		 Greedy triangle selection scored on cache position and remaining valence as described by Tom Forsyth.
+	//\param a_indices is the index list to reorder in place
+	//\param a_numIndices is a multiple of three
+	//\param a_numVerts is one more than the largest index
+	static void OptimiseVertexCache(unsigned int * a_indices, unsigned int a_numIndices, unsigned int a_numVerts);
+
+	//\brief Renumber vertices in the order the index list first uses them so vertex fetches walk forward through memory
+	static void OptimiseVertexFetch(Vector * a_verts, Vector * a_normals, TexCoord * a_uvs, unsigned int a_numVerts, unsigned int * a_indices, unsigned int a_numIndices);
+
+	//\brief Average cache miss ratio, the number of vertices transformed per triangle with a FIFO cache of s_vertexCacheSize
+	//\return a value between 0.5 for an ideal grid and 3.0 when no vertices are shared
+	static float CalculateACMR(const unsigned int * a_indices, unsigned int a_numIndices, unsigned int a_numVerts);
+};
+
+#endif // _ENGINE_MESH_OPTIMISER_H_
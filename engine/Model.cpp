@@ -1,7 +1,10 @@
 #include <iostream>
 #include <fstream>
 
+#include "../core/MathUtils.h"
+
 #include "Log.h"
+#include "MeshOptimiser.h"
 #include "TextureManager.h"
 #include "StringUtils.h"
 
@@ -45,14 +48,17 @@ bool Model::Unload()
 	{
 		// Deallocate memory allocated during mode load
 		Object * curObject = curObjectNode->GetData();
+		curObject->ClearBvh();
 
 		free(curObject->GetVertices());
 		free(curObject->GetNormals());
 		free(curObject->GetUvs());
+		free(curObject->GetIndices());
 
 		curObject->SetVertices(nullptr);
 		curObject->SetNormals(nullptr);
 		curObject->SetUvs(nullptr);
+		curObject->SetIndices(nullptr);
 
 		// Deallocate memory for the object storage in the model list
 		ObjectNode * next = curObjectNode->GetNext();
@@ -64,6 +70,123 @@ bool Model::Unload()
 	return true;
 }
 
+void Model::CalculateBounds()
+{
+	ObjectNode * curObjectNode = m_objects.GetHead();
+	if (curObjectNode == nullptr)
+	{
+		m_boundsMin = Vector::Zero();
+		m_boundsMax = Vector::Zero();
+		m_boundsCentre = Vector::Zero();
+		m_boundsRadius = 0.0f;
+		return;
+	}
+
+	// Union of every object's box
+	m_boundsMin = curObjectNode->GetData()->GetBoundsMin();
+	m_boundsMax = curObjectNode->GetData()->GetBoundsMax();
+	for (ObjectNode * node = curObjectNode->GetNext(); node != nullptr; node = node->GetNext())
+	{
+		const Vector & objMin = node->GetData()->GetBoundsMin();
+		const Vector & objMax = node->GetData()->GetBoundsMax();
+		m_boundsMin = Vector(MathUtils::GetMin(m_boundsMin.GetX(), objMin.GetX()), MathUtils::GetMin(m_boundsMin.GetY(), objMin.GetY()), MathUtils::GetMin(m_boundsMin.GetZ(), objMin.GetZ()));
+		m_boundsMax = Vector(MathUtils::GetMax(m_boundsMax.GetX(), objMax.GetX()), MathUtils::GetMax(m_boundsMax.GetY(), objMax.GetY()), MathUtils::GetMax(m_boundsMax.GetZ(), objMax.GetZ()));
+	}
+	m_boundsCentre = (m_boundsMin + m_boundsMax) * 0.5f;
+
+	// Sphere around the box centre that encloses every object's sphere
+	m_boundsRadius = 0.0f;
+	for (ObjectNode * node = curObjectNode; node != nullptr; node = node->GetNext())
+	{
+		const Object * obj = node->GetData();
+		const float reach = (obj->GetBoundingSphereCentre() - m_boundsCentre).Length() + obj->GetBoundingSphereRadius();
+		m_boundsRadius = MathUtils::GetMax(m_boundsRadius, reach);
+	}
+}
+
+void Object::BuildBvh(const char * a_modelName)
+{
+	m_bvh.Build(m_verts, m_indices, m_numIndices);
+	if (m_bvh.IsBuilt())
+	{
+		Log::Get().Write(LogLevel::Info, LogCategory::Engine, "Model %s object %s collision tree has %u nodes over %u triangles in %u bytes", 
+			a_modelName, m_name, m_bvh.GetNumNodes(), m_bvh.GetNumTriangles(), (unsigned int)m_bvh.GetMemorySize());
+	}
+}
+
+void Object::BuildIndices(const char * a_modelName)
+{
+	if (m_verts == nullptr || m_normals == nullptr || m_uvs == nullptr || m_numVertices == 0)
+	{
+		return;
+	}
+
+	// Every face was expanded to its own three vertices while loading
+	const unsigned int numTriangleVerts = m_numVertices;
+	unsigned int * indices = (unsigned int *)malloc(sizeof(unsigned int) * numTriangleVerts);
+	if (indices == nullptr)
+	{
+		Log::Get().Write(LogLevel::Error, LogCategory::Engine, "Cannot allocate memory for the indices of model %s", a_modelName);
+		return;
+	}
+
+	const unsigned int numUnique = MeshOptimiser::Weld(m_verts, m_normals, m_uvs, numTriangleVerts, indices);
+	const float weldedACMR = MeshOptimiser::CalculateACMR(indices, numTriangleVerts, numUnique);
+	MeshOptimiser::OptimiseVertexCache(indices, numTriangleVerts, numUnique);
+	MeshOptimiser::OptimiseVertexFetch(m_verts, m_normals, m_uvs, numUnique, indices, numTriangleVerts);
+	const float optimisedACMR = MeshOptimiser::CalculateACMR(indices, numTriangleVerts, numUnique);
+
+	// Give back the storage for the duplicates, shrinking in place can't fail in a way that loses the data
+	if (Vector * verts = (Vector *)realloc(m_verts, sizeof(Vector) * numUnique))
+	{
+		m_verts = verts;
+	}
+	if (Vector * normals = (Vector *)realloc(m_normals, sizeof(Vector) * numUnique))
+	{
+		m_normals = normals;
+	}
+	if (TexCoord * uvs = (TexCoord *)realloc(m_uvs, sizeof(TexCoord) * numUnique))
+	{
+		m_uvs = uvs;
+	}
+	m_indices = indices;
+	m_numIndices = numTriangleVerts;
+	m_numVertices = numUnique;
+
+	Log::Get().Write(LogLevel::Info, LogCategory::Engine, "Model %s object %s indexed %u verts to %u with %d bit indices, ACMR 3.00 to %.2f (%.2f before reordering)", 
+		a_modelName, m_name, numTriangleVerts, numUnique, numUnique <= MeshOptimiser::s_maxShortIndex ? 16 : 32, optimisedACMR, weldedACMR);
+}
+
+void Object::CalculateBounds()
+{
+	if (m_verts == nullptr || m_numVertices == 0)
+	{
+		m_boundsMin = Vector::Zero();
+		m_boundsMax = Vector::Zero();
+		m_boundsCentre = Vector::Zero();
+		m_boundsRadius = 0.0f;
+		return;
+	}
+
+	m_boundsMin = m_verts[0];
+	m_boundsMax = m_verts[0];
+	for (unsigned int i = 1; i < m_numVertices; ++i)
+	{
+		const Vector & v = m_verts[i];
+		m_boundsMin = Vector(MathUtils::GetMin(m_boundsMin.GetX(), v.GetX()), MathUtils::GetMin(m_boundsMin.GetY(), v.GetY()), MathUtils::GetMin(m_boundsMin.GetZ(), v.GetZ()));
+		m_boundsMax = Vector(MathUtils::GetMax(m_boundsMax.GetX(), v.GetX()), MathUtils::GetMax(m_boundsMax.GetY(), v.GetY()), MathUtils::GetMax(m_boundsMax.GetZ(), v.GetZ()));
+	}
+	m_boundsCentre = (m_boundsMin + m_boundsMax) * 0.5f;
+
+	// Furthest vertex from the box centre gives a tighter sphere than the box corners
+	float maxDistSq = 0.0f;
+	for (unsigned int i = 0; i < m_numVertices; ++i)
+	{
+		maxDistSq = MathUtils::GetMax(maxDistSq, (m_verts[i] - m_boundsCentre).LengthSquared());
+	}
+	m_boundsRadius = sqrtf(maxDistSq);
+}
+
 bool Material::Load(const char * a_materialFileName, const char * a_materialName)
 {
 	// Early out for no file case
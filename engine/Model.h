@@ -3,8 +3,10 @@
 
 #include "../core/Colour.h"
 #include "../core/LinearAllocator.h"
+#include "../core/MeshBvh.h"
 #include "../core/Vector.h"
 
+#include "Log.h"
 #include "TextureManager.h"
 
 class DataPack;
@@ -34,6 +36,7 @@ public:
 		, m_specular(0.5f)
 		, m_emission(0.0f)
 		, m_shininess(512)
+		, m_opacity(1.0f)
 		, m_diffuseTex(nullptr)
 		, m_normalTex(nullptr)
 		, m_specularTex(nullptr) { m_name[0] = '\0'; }
@@ -52,12 +55,14 @@ public:
 	inline Texture * GetDiffuseTexture() const { return m_diffuseTex; }
 	inline Texture * GetNormalTexture() const { return m_normalTex; }
 	inline Texture * GetSpecularTexture() const { return m_specularTex; }
+	inline bool IsTransparent() const { return m_opacity < 1.0f; }
 
 	Colour m_ambient;								///< Ambient light value
 	Colour m_diffuse;
 	Colour m_specular;
 	Colour m_emission;
 	int m_shininess;
+	float m_opacity;								///< Dissolve value, anything less than 1 is drawn back to front after opaque models
 
 private:
 
@@ -182,6 +187,17 @@ private:
 						sscanf(line, "Ns %f", &shininess);
 						m_shininess = (int)shininess;
 					}
+					// Dissolve and its inverse transparency
+					else if (line[0] == 'd' && line[1] == ' ')
+					{
+						sscanf(line, "d %f", &m_opacity);
+					}
+					else if (line[0] == 'T' && line[1] == 'r' && line[2] == ' ')
+					{
+						float transparency = 0.0f;
+						sscanf(line, "Tr %f", &transparency);
+						m_opacity = 1.0f - transparency;
+					}
 				}
 			}
 			a_input.close();
@@ -215,11 +231,13 @@ public:
 
 	Object()
 		: m_material(nullptr)
-		, m_vertexBufferId(-1)
+		, m_meshId(-1)
 		, m_verts(nullptr)
 		, m_normals(nullptr)
 		, m_uvs(nullptr)
-		, m_numVertices(0) { m_name[0] = '\0'; }
+		, m_indices(nullptr)
+		, m_numVertices(0)
+		, m_numIndices(0) { m_name[0] = '\0'; }
 
 	inline const char * GetName() { return m_name; }
 	inline void SetName(const char * a_name) { strncpy(m_name, a_name, strlen(a_name) + 1); }
@@ -231,11 +249,31 @@ public:
 	inline Vector * GetVertices() const { return m_verts; }
 	inline Vector * GetNormals() const { return m_normals; }
 	inline TexCoord * GetUvs() const { return m_uvs; }
+	inline void SetIndices(unsigned int * a_indices) { m_indices = a_indices; }
+	inline unsigned int GetNumIndices() const { return m_numIndices; }
+	inline unsigned int * GetIndices() const { return m_indices; }
+
+	//\brief Weld the loaded triangle list into unique vertices and an index list ordered for the post transform cache
+	//\param a_modelName is used to report the savings in the log
+	void BuildIndices(const char * a_modelName);
+
+	//\brief Model space bounding volumes of the object's vertices, calculated once the vertices are loaded
+	void CalculateBounds();
+	inline const Vector & GetBoundsMin() const { return m_boundsMin; }
+	inline const Vector & GetBoundsMax() const { return m_boundsMax; }
+	inline const Vector & GetBoundingSphereCentre() const { return m_boundsCentre; }
+	inline float GetBoundingSphereRadius() const { return m_boundsRadius; }
+
+	//\brief Sort the object's triangles into a tree for collision and ray queries, built once the indices are final
+	//\param a_modelName is used to report the size of the tree in the log
+	void BuildBvh(const char * a_modelName);
+	inline void ClearBvh() { m_bvh.Clear(); }
+	inline const MeshBvh & GetBvh() const { return m_bvh; }
 
 	//\brief Accessors for rendering buffer Ids
-	inline bool HasVertexBuffer() const { return m_vertexBufferId >= 0; }
-	inline unsigned int GetVertexBufferId() const { return m_vertexBufferId; }
-	inline void SetVertexBufferId(int a_bufferId) { m_vertexBufferId = a_bufferId; }
+	inline bool HasMesh() const { return m_meshId >= 0; }
+	inline int GetMeshId() const { return m_meshId; }
+	inline void SetMeshId(int a_meshId) { m_meshId = a_meshId; }
 	
 	//\brief Accessors for material data
 	inline void SetMaterial(Material * a_material) { m_material = a_material; }
@@ -252,12 +290,20 @@ private:
 	char m_name[StringUtils::s_maxCharsPerName];	///< Name of the object as referenced by the model file
 	Material * m_material;							///< Material properties loaded from file
 
-	unsigned int m_numVertices;						///< All indexed by vertex
-	int m_vertexBufferId;							///< Assigned by the render manager when added for rendering
+	unsigned int m_numVertices;						///< Unique vertices once indices are built
+	unsigned int m_numIndices;						///< Three per triangle
+	int m_meshId;									///< Assigned by the render manager when first added for rendering
 
 	Vector * m_verts;								///< Storage for the verts of the model
 	Vector * m_normals;								///< Storage for the normals
 	TexCoord * m_uvs;								///< Storage for the diffuse tex coords
+	unsigned int * m_indices;						///< Triangle list referencing the unique vertices
+
+	Vector m_boundsMin{ 0.0f };						///< Corners of the box enclosing every vertex
+	Vector m_boundsMax{ 0.0f };
+	Vector m_boundsCentre{ 0.0f };					///< Centre of the box, also used as the centre of the sphere
+	float m_boundsRadius{ 0.0f };					///< Distance from the centre to the furthest vertex
+	MeshBvh m_bvh;									///< Model space tree over the triangles, refers to the verts and indices above
 };
 
 //\brief A model data pool is a neat way to pass around the memory pools required to load a model
@@ -310,6 +356,12 @@ public:
 		}
 		return curObject->GetData();
 	}
+	//\brief Model space bounding volumes enclosing all of the model's objects
+	inline const Vector & GetBoundsMin() const { return m_boundsMin; }
+	inline const Vector & GetBoundsMax() const { return m_boundsMax; }
+	inline const Vector & GetBoundingSphereCentre() const { return m_boundsCentre; }
+	inline float GetBoundingSphereRadius() const { return m_boundsRadius; }
+
 	static const unsigned int s_vertsPerTri = 3;	///< Seems silly to have a variable for the number of sides to a triangle but it's instructional when reading code that references it
 
 private:
@@ -481,10 +533,10 @@ private:
 					objectReadPass = ObjectReadPass::ReadFaces;
 					if (!a_input.good())
 					{
-						a_input.seekg(0, ios::beg);
+						a_input.seekg(0, std::ios::beg);
 						a_input.clear();
 					}
-					a_input.seekg((int)currentObjectOffset, ios::beg);
+					a_input.seekg((int)currentObjectOffset, std::ios::beg);
 					a_input.getline(line, StringUtils::s_maxCharsPerLine);
 
 					// If using object names, read an extra line to get to the verts
@@ -644,6 +696,9 @@ private:
 						currentObject->SetVertices(objectVerts);
 						currentObject->SetNormals(objectNormals);
 						currentObject->SetUvs(objectUvs);
+						currentObject->BuildIndices(m_name);
+						currentObject->CalculateBounds();
+						currentObject->BuildBvh(m_name);
 						ObjectNode * newObject = new ObjectNode();
 						newObject->SetData(currentObject);
 						m_objects.Insert(newObject);
@@ -685,12 +740,20 @@ private:
 
 		// Model data loaded succesfully
 		a_input.close();
+		CalculateBounds();
 		return m_objects.GetLength() > 0;
 	}
 
+	//\brief Combine the bounds of all loaded objects into bounds for the whole model
+	void CalculateBounds();
+
 	char m_name[StringUtils::s_maxCharsPerName];				///< Name of the model as referenced by the game
 	char m_materialFileName[StringUtils::s_maxCharsPerName];	///< Name of the material file referenced by the model game
 	ObjectList m_objects;										///< List of pointers to the objects that are loaded
+	Vector m_boundsMin{ 0.0f };									///< Corners of the box enclosing every object
+	Vector m_boundsMax{ 0.0f };
+	Vector m_boundsCentre{ 0.0f };								///< Centre of the box, also used as the centre of the sphere
+	float m_boundsRadius{ 0.0f };								///< Distance from the centre to the furthest point of any object's sphere
 };
 
 #endif /* _ENGINE_MODEL_H_ */
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "DataPack.h"
 #include "FileManager.h"
 #include "Log.h"
+#include "RenderManager.h"
 
 #include "ModelManager.h"
 
@@ -33,6 +34,9 @@ bool ModelManager::Startup(const char * a_modelPath, DataPack * a_dataPack)
 	m_objectPool.Init(s_objectPoolSize);
 	m_materialPool.Init(s_materialPoolSize);
 
+	// The pool caps how many models there can be so size the map once instead of growing it while loading
+	m_modelMap.Reserve(s_modelPoolSize / sizeof(ManagedModel));
+
 	// Init temporary loading pools
 	m_loadingVertPool.Init(s_loadingVertPoolSize * sizeof(Vector));
 	m_loadingNormalPool.Init(s_loadingNormalPoolSize * sizeof(Vector));
@@ -130,6 +134,7 @@ bool ModelManager::Update(float a_dt)
 				}
 
 				ModelDataPool mdp(m_objectPool, m_loadingVertPool, m_loadingNormalPool, m_loadingUvPool, m_materialPool);
+				RenderManager::Get().ReleaseModel(&curModel->m_model);
 				if (!curModel->m_model.Unload())
 				{
 					Log::Get().Write(LogLevel::Info, LogCategory::Engine, "Cannot unload model.");
@@ -172,6 +177,7 @@ bool ModelManager::ReloadModelsWithTexture(Texture * a_texture)
 		if (modelNeedsReload)
 		{
 			ModelDataPool mdp(m_objectPool, m_loadingVertPool, m_loadingNormalPool, m_loadingUvPool, m_materialPool);
+			RenderManager::Get().ReleaseModel(&curModel->m_model);
 			if (!curModel->m_model.Unload())
 			{
 				Log::Get().Write(LogLevel::Info, LogCategory::Engine, "Cannot unload model.");
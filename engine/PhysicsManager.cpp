@@ -1,16 +1,87 @@
+#include <algorithm>
 #include <unordered_map>
 
 #include "CollisionUtils.h"
 #include "DebugMenu.h"
 #include "FontManager.h"
 #include "GameObject.h"
+#include "JobManager.h"
 #include "Log.h"
+#include "Model.h"
 #include "RenderManager.h"
 
 #include "PhysicsManager.h"
 
 template<> PhysicsManager * Singleton<PhysicsManager>::s_instance = nullptr;
 
+namespace
+{
+	//\brief Moves queries between world space and the model space of a mesh collision object so the triangles never need transforming
+	//		 The axes of the world matrix carry the object's scale and are assumed to be perpendicular
+	struct MeshSpace
+	{
+		explicit MeshSpace(GameObject * a_gameObj)
+		{
+			const Matrix & worldMat = a_gameObj->GetWorldMat();
+			m_pos = a_gameObj->GetPos();
+			m_axes[0] = worldMat.GetRight();
+			m_axes[1] = worldMat.GetLook();
+			m_axes[2] = worldMat.GetUp();
+			for (int i = 0; i < 3; ++i)
+			{
+				const float lengthSq = m_axes[i].LengthSquared();
+				m_inverseAxes[i] = lengthSq > 0.0f ? m_axes[i] * (1.0f / lengthSq) : Vector::Zero();
+			}
+		}
+
+		inline Vector ToWorld(const Vector & a_modelPos) const
+		{
+			return m_pos + m_axes[0] * a_modelPos.GetX() + m_axes[1] * a_modelPos.GetY() + m_axes[2] * a_modelPos.GetZ();
+		}
+		inline Vector ToModelDir(const Vector & a_worldDir) const
+		{
+			return Vector(a_worldDir.Dot(m_inverseAxes[0]), a_worldDir.Dot(m_inverseAxes[1]), a_worldDir.Dot(m_inverseAxes[2]));
+		}
+		inline Vector ToModel(const Vector & a_worldPos) const { return ToModelDir(a_worldPos - m_pos); }
+
+		//\brief Box in the destination space that encloses a box in the source space given its centre and half size
+		static Vector GetExtents(const Vector * a_axes, const Vector & a_halfSize)
+		{
+			const float halfSize[3] = { a_halfSize.GetX(), a_halfSize.GetY(), a_halfSize.GetZ() };
+			Vector extents(0.0f);
+			for (int i = 0; i < 3; ++i)
+			{
+				const Vector axis = a_axes[i];
+				extents += Vector(fabsf(axis.GetX()), fabsf(axis.GetY()), fabsf(axis.GetZ())) * halfSize[i];
+			}
+			return extents;
+		}
+		void ToWorldBounds(const Vector & a_modelMin, const Vector & a_modelMax, Vector & a_min_OUT, Vector & a_max_OUT) const
+		{
+			const Vector centre = ToWorld((a_modelMin + a_modelMax) * 0.5f);
+			const Vector extents = GetExtents(m_axes, (a_modelMax - a_modelMin) * 0.5f);
+			a_min_OUT = centre - extents;
+			a_max_OUT = centre + extents;
+		}
+		void ToModelBounds(const Vector & a_worldMin, const Vector & a_worldMax, Vector & a_min_OUT, Vector & a_max_OUT) const
+		{
+			// Rows of the inverse rotation are the columns of the inverse axes
+			const Vector inverseRows[3] = { 
+				Vector(m_inverseAxes[0].GetX(), m_inverseAxes[1].GetX(), m_inverseAxes[2].GetX()),
+				Vector(m_inverseAxes[0].GetY(), m_inverseAxes[1].GetY(), m_inverseAxes[2].GetY()),
+				Vector(m_inverseAxes[0].GetZ(), m_inverseAxes[1].GetZ(), m_inverseAxes[2].GetZ()) };
+			const Vector centre = ToModel((a_worldMin + a_worldMax) * 0.5f);
+			const Vector extents = GetExtents(inverseRows, (a_worldMax - a_worldMin) * 0.5f);
+			a_min_OUT = centre - extents;
+			a_max_OUT = centre + extents;
+		}
+
+		Vector m_pos;
+		Vector m_axes[3];
+		Vector m_inverseAxes[3];
+	};
+}
+
 bool PhysicsManager::Startup(const GameFile & a_config)
 {
 	// Setup collision groups and flags from config file
@@ -68,6 +139,16 @@ bool PhysicsManager::Startup(const GameFile & a_config)
 		{
 			SetGravity(gravProp->GetVector());
 		}
+		if (GameFile::Property * stepRateProp = physConfig->FindProperty("fixedStepRate"))
+		{
+			GameFile::Property * subStepsProp = physConfig->FindProperty("maxSubSteps");
+			SetFixedStepRate(stepRateProp->GetFloat(), subStepsProp != nullptr ? subStepsProp->GetInt() : s_defaultMaxSubSteps);
+		}
+		if (GameFile::Property * sleepTimeProp = physConfig->FindProperty("sleepTime"))
+		{
+			GameFile::Property * sleepSpeedProp = physConfig->FindProperty("sleepSpeed");
+			SetSleeping(sleepSpeedProp != nullptr ? sleepSpeedProp->GetFloat() : s_defaultSleepSpeed, sleepTimeProp->GetFloat());
+		}
 	}
 
 	return true;
@@ -75,181 +156,538 @@ bool PhysicsManager::Startup(const GameFile & a_config)
 
 bool PhysicsManager::Shutdown()
 {
-	m_physicsWorld.clear();
+	for (unsigned int i = 0; i < m_physicsWorld.GetCount(); ++i)
+	{
+		static_cast<GameObject*>(m_physicsWorld.GetOwner(i))->SetPhysics(0);
+	}
+	m_physicsWorld.Clear();
 	m_collisionWorld.clear();
+	m_contacts.clear();
+	m_prevContacts.clear();
+	m_contactEvents.clear();
+	m_islandLinks.clear();
+	m_broadphase.Clear();
+	m_broadphasePairs.clear();
+	m_collisionTree.Clear();
+	m_collisionProxies.clear();
 	return true;
 }
 
-void PhysicsManager::UpdateCollisionWorld(const float& a_dt)
+void PhysicsManager::Update(float a_dt)
+{
+	m_stats = PhysicsStats();
+	if (m_fixedStep > 0.0f)
+	{
+		// Stop catching up after a few steps so a long hitch can't make the following frames even slower
+		m_accumulator += a_dt;
+		int numSteps = 0;
+		while (m_accumulator >= m_fixedStep && numSteps < m_maxSubSteps)
+		{
+			// Collisions from every step this frame are reported, and tested against where the sim is rather than the blend drawn last frame
+			if (numSteps == 0)
+			{
+				ClearCollisionWorld();
+			}
+			UpdateGameObjects(1.0f);
+			m_physicsWorld.StorePreviousPositions();
+			UpdateCollisionWorld(m_fixedStep);
+			UpdatePhysicsWorld(m_fixedStep);
+			m_accumulator -= m_fixedStep;
+			++numSteps;
+		}
+		if (m_accumulator >= m_fixedStep)
+		{
+			m_accumulator = fmodf(m_accumulator, m_fixedStep);
+		}
+
+		// Contacts stay as they were when no step ran, so nothing has changed to report
+		if (numSteps > 0)
+		{
+			UpdateContactEvents();
+			UpdateSleeping(m_fixedStep * numSteps);
+		}
+		else
+		{
+			m_contactEvents.clear();
+		}
+		UpdateGameObjects(m_accumulator / m_fixedStep);
+	}
+	else
+	{
+		const float p_dt = MathUtils::Clamp(s_minPhysicsStep, a_dt, s_maxPhysicsStep);
+		ClearCollisionWorld();
+		UpdateCollisionWorld(p_dt);
+		UpdatePhysicsWorld(p_dt);
+		UpdateGameObjects(1.0f);
+		UpdateContactEvents();
+		UpdateSleeping(p_dt);
+	}
+	UpdateCollisionTree();
+	UpdateDebugRender(a_dt);
+	m_stats.m_numAwakeBodies = m_physicsWorld.GetAwakeCount();
+}
+
+void PhysicsManager::SetFixedStepRate(float a_stepsPerSecond, int a_maxSubSteps)
 {
-	// Clear all collision each frame
-	for (const auto& objA : m_collisionWorld)
+	m_fixedStep = a_stepsPerSecond > 0.0f ? 1.0f / a_stepsPerSecond : 0.0f;
+	m_maxSubSteps = MathUtils::GetMax(a_maxSubSteps, 1);
+	m_accumulator = 0.0f;
+}
+
+void PhysicsManager::ClearCollisionWorld()
+{
+	// Keep last frame's contacts to compare against, both arrays hold on to their memory
+	m_prevContacts.swap(m_contacts);
+	m_contacts.clear();
+	m_islandLinks.clear();
+}
+
+void PhysicsManager::UpdateContactEvents()
+{
+	// Fixed steps can find the same contact more than once a frame
+	std::sort(m_contacts.begin(), m_contacts.end());
+	m_contacts.erase(std::unique(m_contacts.begin(), m_contacts.end()), m_contacts.end());
+
+	// Walk both sorted frames together, a contact in only one of them has begun or ended
+	m_contactEvents.clear();
+	auto cur = m_contacts.begin();
+	auto prev = m_prevContacts.begin();
+	while (cur != m_contacts.end() || prev != m_prevContacts.end())
 	{
-		ClearCollisions(objA);
+		Contact contactEvent;
+		if (prev == m_prevContacts.end() || (cur != m_contacts.end() && *cur < *prev))
+		{
+			contactEvent = *cur++;
+			contactEvent.m_state = ContactState::Begin;
+		}
+		else if (cur == m_contacts.end() || *prev < *cur)
+		{
+			contactEvent = *prev++;
+			contactEvent.m_state = ContactState::End;
+		}
+		else
+		{
+			contactEvent = *cur++;
+			contactEvent.m_state = ContactState::Stay;
+			++prev;
+		}
+		m_contactEvents.push_back(contactEvent);
 	}
+}
 
-	// Solve collisions
-	for (const auto& objA : m_collisionWorld)
+void PhysicsManager::UpdateCollisionWorld(const float& a_dt)
+{
+	// Find the pairs whose bounds overlap, each pair is only tested once
+	UpdateBroadphase();
+	m_broadphase.FindPairs(m_broadphasePairs);
+
+	// Test the pairs on the job threads, each thread keeps what it finds in its own buffer so nothing is shared
+	JobManager & jobMan = JobManager::Get();
+	const unsigned int numBuffers = MathUtils::GetMax(jobMan.GetNumThreads(), 1u);
+	if (m_threadContacts.size() != numBuffers)
+	{
+		m_threadContacts.resize(numBuffers);
+	}
+	for (auto & buffer : m_threadContacts)
+	{
+		buffer.m_contacts.clear();
+	}
+	jobMan.ParallelFor(0, (unsigned int)m_broadphasePairs.size(), s_narrowphaseGrainSize, [this](unsigned int a_begin, unsigned int a_end)
 	{
-		for (const auto& objB : m_collisionWorld)
+		const unsigned int threadIndex = JobSystem::GetThreadIndex();
+		assert(threadIndex < m_threadContacts.size());
+		std::vector<PairContact> & contacts = m_threadContacts[threadIndex].m_contacts;
+		for (unsigned int i = a_begin; i < a_end; ++i)
 		{
-			if (objA == objB)
+			const auto & pair = m_broadphasePairs[i];
+			PairContact contact;
+			if (IntersectPair(static_cast<GameObject*>(pair.m_userDataA), static_cast<GameObject*>(pair.m_userDataB), contact))
 			{
-				continue;
+				contacts.push_back(contact);
 			}
+		}
+	});
 
-			const int groupA = objA->GetClipGroupId();
-			const int groupB = objB->GetClipGroupId();
-			if (!m_collisionFilters[groupA].IsBitSet(groupB) &&
-				!m_collisionFilters[groupB].IsBitSet(groupA))
+	// Which thread found a contact depends on scheduling, putting them in id order means the impulses below
+	// are applied in the same order and give the same result however many threads there are
+	m_pairContacts.clear();
+	for (const auto & buffer : m_threadContacts)
+	{
+		m_pairContacts.insert(m_pairContacts.end(), buffer.m_contacts.begin(), buffer.m_contacts.end());
+	}
+	std::sort(m_pairContacts.begin(), m_pairContacts.end());
+	++m_stats.m_numSteps;
+	m_stats.m_numPairTests += (unsigned int)m_broadphasePairs.size();
+	m_stats.m_numContacts += (unsigned int)m_pairContacts.size();
+
+	for (const PairContact & contact : m_pairContacts)
+	{
+		GameObject * objA = contact.m_gameObjA;
+		GameObject * objB = contact.m_gameObjB;
+		const Vector & colNormal = contact.m_normal;
+		const float colDepth = contact.m_depth;
+		AddCollision(objA, objB);
+		AddCollision(objB, objA);
+		if (objA->HasPhysics() && objB->HasPhysics())
+		{
+			m_islandLinks.push_back(std::make_pair(objA->GetPhysics(), objB->GetPhysics()));
+		}
+
+		// The normal points from A to B, so each body is pushed along the normal facing away from the other
+		auto collisionResponse = [this, &colDepth](unsigned int a_body, GameObject * a_gameObj, const Vector & a_normal)
+		{
+			const auto vel = m_physicsWorld.GetVelocity(a_body);
+			const auto restitution = (1.0f + a_gameObj->GetPhysicsElasticity());
+			const auto colDir = vel.Dot(a_normal);
+			
+			// Only accept the collision if the object is moving towards the collider
+			if (colDir < 0)
 			{
-				continue;
+				// Add penetration depth offset to keep objects from sinking into each other
+				const auto pVec = a_normal * colDepth;
+				auto incident = (a_normal * colDir * restitution) - (pVec * 1.0f);
+				m_physicsWorld.AddImpulse(a_body, -incident);
+				
 			}
+		};
+
+		// Sleeping bodies hold still, if the other body is moving the island wakes at the end of the frame
+		const unsigned int bodyA = m_physicsWorld.GetIndex(objA->GetPhysics());
+		if (bodyA != DynamicBodies::s_invalidIndex && m_physicsWorld.IsAwake(bodyA))
+		{
+			collisionResponse(bodyA, objA, -colNormal);
+		}
+		const unsigned int bodyB = m_physicsWorld.GetIndex(objB->GetPhysics());
+		if (bodyB != DynamicBodies::s_invalidIndex && m_physicsWorld.IsAwake(bodyB))
+		{
+			collisionResponse(bodyB, objB, colNormal);
+		}
+	}
+}
 
-			bool colResult = false;
-			Vector colPos = Vector::Zero();
-			float colDepth = 0.0f;
-			Vector colNormal = Vector::Zero();
-			const auto objAPos = objA->GetPos() + objA->GetClipOffset();
-			const auto objBPos = objB->GetPos() + objB->GetClipOffset();
-			switch (objA->GetClipType())
+bool PhysicsManager::PairContact::operator < (const PairContact & a_other) const
+{
+	const SlotHandle idA = m_gameObjA->GetId();
+	const SlotHandle otherIdA = a_other.m_gameObjA->GetId();
+	return idA < otherIdA || (idA == otherIdA && m_gameObjB->GetId() < a_other.m_gameObjB->GetId());
+}
+
+bool PhysicsManager::IntersectPair(GameObject * a_gameObjA, GameObject * a_gameObjB, PairContact & a_contact_OUT)
+{
+	// The intersection tests between spheres and boxes expect the box first, so order each pair by shape then by id
+	const auto getShapeOrder = [](const ClipType a_clipType)
+	{
+		switch (a_clipType)
+		{
+			case ClipType::Mesh: return 3;
+			case ClipType::AxisBox: return 2;
+			case ClipType::Box: return 1;
+			default: return 0;
+		}
+	};
+
+	GameObject * objA = a_gameObjA;
+	GameObject * objB = a_gameObjB;
+	const int shapeOrderA = getShapeOrder(objA->GetClipType());
+	const int shapeOrderB = getShapeOrder(objB->GetClipType());
+	if (shapeOrderB > shapeOrderA || (shapeOrderB == shapeOrderA && objB->GetId() < objA->GetId()))
+	{
+		std::swap(objA, objB);
+	}
+
+	bool colResult = false;
+	Vector colPos = Vector::Zero();
+	float colDepth = 0.0f;
+	Vector colNormal = Vector::Zero();
+	const auto objAPos = objA->GetPos() + objA->GetClipOffset();
+	const auto objBPos = objB->GetPos() + objB->GetClipOffset();
+	switch (objA->GetClipType())
+	{
+		case ClipType::Mesh:
+		{
+			colResult = IntersectMesh(objA, objB, colPos, colNormal, colDepth);
+			break;
+		}
+		case ClipType::Sphere:
+		{
+			if (objB->GetClipType() == ClipType::Sphere)
 			{
-				case ClipType::Sphere:
+				if (CollisionUtils::IntersectSpheres(objAPos, objA->GetClipSize().GetX(), objBPos, objB->GetClipSize().GetX(), colPos, colNormal))
 				{
-					if (objB->GetClipType() == ClipType::Sphere)
-					{
-						if (CollisionUtils::IntersectSpheres(objAPos, objA->GetClipSize().GetX(), objBPos, objB->GetClipSize().GetX(), colPos, colNormal))
-						{
-							colResult = true;
-							const auto toCol = colPos - objAPos;
-							colDepth = MathUtils::GetMax(objA->GetClipSize().GetX() - toCol.Length(), 0.0f);
-						}
-					}
-					break;
+					colResult = true;
+					const auto toCol = colPos - objAPos;
+					colDepth = MathUtils::GetMax(objA->GetClipSize().GetX() - toCol.Length(), 0.0f);
 				}
-				case ClipType::AxisBox:
+			}
+			break;
+		}
+		case ClipType::AxisBox:
+		{
+			if (objB->GetClipType() == ClipType::Sphere)
+			{
+				if (CollisionUtils::IntersectAxisBoxSphere(objBPos, objB->GetClipSize().GetX(), objAPos, objA->GetClipSize(), colPos, colNormal))
 				{
-					if (objB->GetClipType() == ClipType::Sphere)
-					{
-						if (CollisionUtils::IntersectAxisBoxSphere(objBPos, objB->GetClipSize().GetX(), objAPos, objA->GetClipSize(), colPos, colNormal))
-						{
-							colResult = true;
-							const auto toCol = colPos - objBPos;
-							colDepth = MathUtils::GetMax(objB->GetClipSize().GetX() - toCol.Length(), 0.0f);
-						}
-					}
-					else if (objB->GetClipType() == ClipType::Box)
-					{
-						if (CollisionUtils::IntersectAxisBoxes(objBPos, objB->GetClipSize(), objAPos, objA->GetClipSize()))
-						{
-							colResult = true;
-							colDepth = (objAPos - objBPos).Length();
-						}
-					}
-					break;
+					// Measured along the normal so a sphere whose centre has sunk into the box is pushed all the way out
+					colResult = true;
+					colDepth = MathUtils::GetMax(objB->GetClipSize().GetX() - (objBPos - colPos).Dot(colNormal), 0.0f);
 				}
-				case ClipType::Box:
+			}
+			else if (objB->GetClipType() == ClipType::Box)
+			{
+				if (CollisionUtils::IntersectAxisBoxes(objBPos, objB->GetClipSize(), objAPos, objA->GetClipSize()))
 				{
-					if (objB->GetClipType() == ClipType::Sphere)
-					{
-						if (CollisionUtils::IntersectBoxSphere(objBPos, objB->GetClipSize().GetX(), objAPos, objA->GetClipSize(), objA->GetRot(), colPos, colNormal))
-						{
-							colResult = true;
-							const auto toCol = colPos - objBPos;
-							colDepth = MathUtils::GetMax(objB->GetClipSize().GetX() - toCol.Length(), 0.0f);
-						}
-					}
-					else if (objB->GetClipType() == ClipType::Box)
-					{
-						if (CollisionUtils::IntersectAxisBoxes(objBPos, objB->GetClipSize(), objAPos, objA->GetClipSize()))
-						{
-							colResult = true;
-							colDepth = (objAPos - objBPos).Length();
-						}
-					}
-					break;
+					colResult = true;
+					colDepth = (objAPos - objBPos).Length();
 				}
-				default: break;
 			}
-
-			if (colResult)
+			break;
+		}
+		case ClipType::Box:
+		{
+			if (objB->GetClipType() == ClipType::Sphere)
 			{
-				AddCollision(objA, objB);
-				AddCollision(objB, objA);
-
-				auto collisionResponse = [&colNormal, &colDepth](auto a_physObj, auto a_gameObj)
+				if (CollisionUtils::IntersectBoxSphere(objBPos, objB->GetClipSize().GetX(), objAPos, objA->GetClipSize(), objA->GetRot(), colPos, colNormal))
 				{
-					const auto vel = a_physObj->GetVelocity();
-					const auto restitution = (1.0f + a_gameObj->GetPhysicsElasticity());
-					const auto colDir = vel.Dot(colNormal);
-					
-					// Only accept the collision if the object is moving towards the collider
-					if (colDir < 0)
-					{
-						// Add penetration depth offset to keep objects from sinking into each other
-						const auto pVec = colNormal * colDepth;
-						auto incident = (colNormal * colDir * restitution) - (pVec * 1.0f);
-						a_physObj->AddLinearImpulse(-incident, a_gameObj->GetPhysicsMass());
-						
-					}
-				};
-
-				if (auto physA = objA->GetPhysics())
-				{
-					collisionResponse(physA, objA);
+					colResult = true;
+					const auto toCol = colPos - objBPos;
+					colDepth = MathUtils::GetMax(objB->GetClipSize().GetX() - toCol.Length(), 0.0f);
 				}
-				if (auto physB = objB->GetPhysics())
+			}
+			else if (objB->GetClipType() == ClipType::Box)
+			{
+				// The box test only checks the corners of the first box so try both ways round
+				if (CollisionUtils::IntersectAxisBoxes(objBPos, objB->GetClipSize(), objAPos, objA->GetClipSize()) ||
+					CollisionUtils::IntersectAxisBoxes(objAPos, objA->GetClipSize(), objBPos, objB->GetClipSize()))
 				{
-					collisionResponse(physB, objB);
+					colResult = true;
+					colDepth = (objAPos - objBPos).Length();
 				}
 			}
+			break;
 		}
+		default: break;
 	}
+
+	a_contact_OUT.m_gameObjA = objA;
+	a_contact_OUT.m_gameObjB = objB;
+	a_contact_OUT.m_pos = colPos;
+	a_contact_OUT.m_normal = colNormal;
+	a_contact_OUT.m_depth = colDepth;
+	return colResult;
 }
 
-void PhysicsManager::UpdatePhysicsWorld(const float& a_dt)
+void PhysicsManager::UpdateSleeping(float a_dt)
 {
-	// Step the dynamic physics sim
-	const float p_dt = MathUtils::Clamp(s_minPhysicsStep, a_dt, s_maxPhysicsStep);
-	for (auto& physObj : m_physicsWorld)
+	if (m_sleepTime <= 0.0f)
+	{
+		return;
+	}
+	m_physicsWorld.UpdateSleepTimes(m_sleepSpeed, a_dt);
+
+	// Join the bodies that touched this frame into islands, contact with static objects doesn't join anything
+	const unsigned int numBodies = m_physicsWorld.GetCount();
+	m_islandParents.resize(numBodies);
+	for (unsigned int i = 0; i < numBodies; ++i)
+	{
+		m_islandParents[i] = i;
+	}
+	for (const auto & link : m_islandLinks)
+	{
+		const unsigned int bodyA = m_physicsWorld.GetIndex(link.first);
+		const unsigned int bodyB = m_physicsWorld.GetIndex(link.second);
+		if (bodyA != DynamicBodies::s_invalidIndex && bodyB != DynamicBodies::s_invalidIndex)
+		{
+			m_islandParents[FindIsland(bodyA)] = FindIsland(bodyB);
+		}
+	}
+
+	// One body that hasn't settled keeps its whole island awake, including any sleeping bodies it touched
+	m_islandAwake.assign(numBodies, 0);
+	for (unsigned int i = 0; i < m_physicsWorld.GetAwakeCount(); ++i)
 	{
-		auto gameObj = physObj.m_gameObject;
-		const float mass = gameObj->GetPhysicsMass();
-		const auto lDrag = gameObj->GetPhysicsLinearDrag();
-		const auto aDrag = gameObj->GetPhysicsAngularDrag();
-		if (m_type == PhysicsIntegrationType::Euler)
+		if (m_physicsWorld.GetSleepTime(i) < m_sleepTime)
 		{
-			// Semi-implicit euler
-			physObj.AddLinearImpulse(m_gravity * p_dt * Vector::Up(), mass);
-			physObj.m_vel += (physObj.m_force * (1.0f / mass)) * p_dt;
-			physObj.m_rot *= Quaternion(physObj.m_torque, physObj.m_inertia * p_dt * (aDrag + 1.0f));
-			physObj.m_vel *= 1.0f / (1.0f + p_dt * lDrag);
-			physObj.m_pos += physObj.m_vel * p_dt;
+			m_islandAwake[FindIsland(i)] = 1;
 		}
-		else if (m_type == PhysicsIntegrationType::Verlet)
+	}
+
+	// Sleeping and waking reorders the bodies so find them by handle once every island is decided
+	m_islandChanges.clear();
+	for (unsigned int i = 0; i < numBodies; ++i)
+	{
+		if ((m_islandAwake[FindIsland(i)] != 0) != m_physicsWorld.IsAwake(i))
 		{
-			physObj.m_lastAcc = physObj.m_acc;
-			physObj.m_pos += physObj.m_vel * p_dt + (physObj.m_lastAcc * 0.5f * (p_dt * p_dt));
-			physObj.m_acc = (physObj.m_force + m_gravity) / mass;
-			physObj.m_avgAcc = (physObj.m_lastAcc + physObj.m_acc) * 0.5f;
-			physObj.m_vel += physObj.m_avgAcc * p_dt;
+			m_islandChanges.push_back(m_physicsWorld.GetHandle(i));
 		}
-		else if (m_type == PhysicsIntegrationType::RungeKutta)
+	}
+	for (const SlotHandle handle : m_islandChanges)
+	{
+		const unsigned int body = m_physicsWorld.GetIndex(handle);
+		if (m_physicsWorld.IsAwake(body))
+		{
+			// The object was last drawn blended between steps, leave it exactly where the body stopped
+			const unsigned int sleptBody = m_physicsWorld.Sleep(body);
+			GameObject * gameObj = static_cast<GameObject*>(m_physicsWorld.GetOwner(sleptBody));
+			gameObj->SetPos(m_physicsWorld.GetPos(sleptBody) + gameObj->GetClipOffset());
+		}
+		else
+		{
+			m_physicsWorld.Wake(body);
+		}
+	}
+}
+
+unsigned int PhysicsManager::FindIsland(unsigned int a_body)
+{
+	// Halve the path on the way up so later finds are shorter
+	while (m_islandParents[a_body] != a_body)
+	{
+		m_islandParents[a_body] = m_islandParents[m_islandParents[a_body]];
+		a_body = m_islandParents[a_body];
+	}
+	return a_body;
+}
+
+void PhysicsManager::UpdateBroadphase()
+{
+	for (unsigned int i = 0; i < m_broadphase.GetNumProxies(); ++i)
+	{
+		GameObject * gameObj = static_cast<GameObject*>(m_broadphase.GetUserData(i));
+		Vector boundsMin, boundsMax;
+		GetClipBounds(gameObj, boundsMin, boundsMax);
+
+		// Objects without a volume to test stay in the broadphase but never pair
+		const int groupId = gameObj->GetClipGroupId();
+		const bool canCollide = groupId >= 0 && groupId < s_maxCollisionGroups && gameObj->GetClipType() != ClipType::None;
+		const unsigned int groupBits = canCollide ? (1u << groupId) : 0u;
+		const unsigned int collidesWith = canCollide ? m_collisionFilters[groupId].GetBits() : 0u;
+		m_broadphase.UpdateProxy(i, boundsMin, boundsMax, groupBits, collidesWith);
+	}
+}
+
+void PhysicsManager::UpdateCollisionTree()
+{
+	for (unsigned int i = 0; i < m_collisionWorld.size(); ++i)
+	{
+		Vector boundsMin, boundsMax;
+		GetClipBounds(m_collisionWorld[i], boundsMin, boundsMax);
+		m_collisionTree.MoveProxy(m_collisionProxies[i], boundsMin, boundsMax);
+	}
+}
+
+void PhysicsManager::GetClipBounds(GameObject * a_gameObj, Vector & a_min_OUT, Vector & a_max_OUT)
+{
+	const Vector centre = a_gameObj->GetPos() + a_gameObj->GetClipOffset();
+	const Vector clipSize = a_gameObj->GetClipSize();
+	Vector extents = Vector::Zero();
+	switch (a_gameObj->GetClipType())
+	{
+		// Clip size is the radius
+		case ClipType::Sphere: extents = Vector(fabsf(clipSize.GetX())); break;
+
+		// The box tests disagree on whether clip size is the full or half size, the larger covers both
+		case ClipType::AxisBox: extents = Vector(fabsf(clipSize.GetX()), fabsf(clipSize.GetY()), fabsf(clipSize.GetZ())); break;
+
+		// Any rotation of the box fits inside the sphere through its corners
+		case ClipType::Box: extents = Vector(clipSize.Length()); break;
+
+		// The model's box carried through the object's transform, clip size and offset don't apply to triangles
+		case ClipType::Mesh:
 		{
-			// TODO!
+			const Model * model = a_gameObj->GetModel();
+			if (model != nullptr)
+			{
+				MeshSpace(a_gameObj).ToWorldBounds(model->GetBoundsMin(), model->GetBoundsMax(), a_min_OUT, a_max_OUT);
+				return;
+			}
+			break;
 		}
+		default: break;
+	}
+	a_min_OUT = centre - extents;
+	a_max_OUT = centre + extents;
+}
+
+bool PhysicsManager::IntersectMesh(GameObject * a_meshObj, GameObject * a_gameObj, Vector & a_colPos_OUT, Vector & a_colNormal_OUT, float & a_colDepth_OUT)
+{
+	Model * model = a_meshObj->GetModel();
+	const ClipType clipType = a_gameObj->GetClipType();
+	if (model == nullptr || (clipType != ClipType::Sphere && clipType != ClipType::AxisBox && clipType != ClipType::Box))
+	{
+		return false;
+	}
+
+	// Only the bounds of the other shape go into model space to find candidate triangles, which are then tested in world space
+	const MeshSpace meshSpace(a_meshObj);
+	Vector worldMin, worldMax, modelMin, modelMax;
+	GetClipBounds(a_gameObj, worldMin, worldMax);
+	meshSpace.ToModelBounds(worldMin, worldMax, modelMin, modelMax);
+
+	const Vector clipPos = a_gameObj->GetPos() + a_gameObj->GetClipOffset();
+	const Vector clipSize = a_gameObj->GetClipSize();
+	const Quaternion clipRot = clipType == ClipType::Box ? a_gameObj->GetRot() : Quaternion();
+	bool colResult = false;
+	a_colDepth_OUT = -1.0f;
+	for (unsigned int i = 0; i < model->GetNumObjects(); ++i)
+	{
+		const MeshBvh & bvh = model->GetObjectAtIndex(i)->GetBvh();
+		bvh.Query(modelMin, modelMax, [&](unsigned int a_triIndex)
+		{
+			Vector vertA, vertB, vertC;
+			bvh.GetTriangle(a_triIndex, vertA, vertB, vertC);
+			vertA = meshSpace.ToWorld(vertA);
+			vertB = meshSpace.ToWorld(vertB);
+			vertC = meshSpace.ToWorld(vertC);
+
+			Vector triPos, triNormal;
+			float triDepth = 0.0f;
+			bool triResult = false;
+			switch (clipType)
+			{
+				case ClipType::Sphere: triResult = CollisionUtils::IntersectSphereTriangle(clipPos, clipSize.GetX(), vertA, vertB, vertC, triPos, triNormal, triDepth); break;
+				case ClipType::AxisBox: triResult = CollisionUtils::IntersectAxisBoxTriangle(clipPos, clipSize, vertA, vertB, vertC, triPos, triNormal, triDepth); break;
+				case ClipType::Box: triResult = CollisionUtils::IntersectBoxTriangle(clipPos, clipSize, clipRot, vertA, vertB, vertC, triPos, triNormal, triDepth); break;
+				default: break;
+			}
+
+			// Resolve against the triangle pushing in the furthest, the rest are dealt with on later frames
+			if (triResult && triDepth > a_colDepth_OUT)
+			{
+				colResult = true;
+				a_colPos_OUT = triPos;
+				a_colNormal_OUT = triNormal;
+				a_colDepth_OUT = triDepth;
+			}
+		});
+	}
+	a_colDepth_OUT = MathUtils::GetMax(a_colDepth_OUT, 0.0f);
+	return colResult;
+}
+
+void PhysicsManager::UpdatePhysicsWorld(const float& a_dt)
+{
+	// Step the dynamic physics sim, the step has already been clamped or fixed
+	if (m_type == PhysicsIntegrationType::Euler)
+	{
+		m_physicsWorld.IntegrateEuler(m_gravity, a_dt);
+	}
+	else if (m_type == PhysicsIntegrationType::Verlet)
+	{
+		m_physicsWorld.IntegrateVerlet(m_gravity, a_dt);
+	}
+	else if (m_type == PhysicsIntegrationType::RungeKutta)
+	{
+		// TODO!
 	}
 }
 
-void PhysicsManager::UpdateGameObjects(const float & a_dt)
+void PhysicsManager::UpdateGameObjects(float a_alpha)
 {
-	for (const auto& curPhys : m_physicsWorld)
+	for (unsigned int i = 0; i < m_physicsWorld.GetAwakeCount(); ++i)
 	{
-		// Apply physics world transform to game object and collision state
-		auto gameObj = curPhys.m_gameObject;
-		Matrix gameObjMat = gameObj->GetWorldMat();
-		gameObjMat.SetPos(curPhys.GetPos() + gameObj->GetClipOffset());
-		gameObj->SetWorldMat(gameObjMat);
+		// Apply physics world position to game object and collision state, blended between the last two steps
+		auto gameObj = static_cast<GameObject*>(m_physicsWorld.GetOwner(i));
+		gameObj->SetPos(MathUtils::LerpVector(m_physicsWorld.GetPrevPos(i), m_physicsWorld.GetPos(i), a_alpha) + gameObj->GetClipOffset());
 	}
 }
 
@@ -259,11 +697,12 @@ void PhysicsManager::UpdateDebugRender(const float& a_dt)
 	return;
 #endif
 
-	RenderManager& rMan = RenderManager::Get();
-	FontManager& fMan = FontManager::Get();
-	char pString[StringUtils::s_maxCharsPerName];
-	if (DebugMenu::Get().IsPhysicsDebuggingOn())
+	// Physics can run without the rest of the engine, like in tests, so don't make a debug menu to ask
+	if (DebugMenu::IsCreated() && DebugMenu::Get().IsPhysicsDebuggingOn())
 	{
+		RenderManager& rMan = RenderManager::Get();
+		FontManager& fMan = FontManager::Get();
+		char pString[StringUtils::s_maxCharsPerName];
 		const auto drawDebugClipping = [&rMan](const ClipType a_type, const Vector& a_pos, const Quaternion & a_rot, const Vector& a_size, const Colour& a_col)
 		{
 			Matrix t;
@@ -279,14 +718,15 @@ void PhysicsManager::UpdateDebugRender(const float& a_dt)
 			}
 		};
 
-		std::unordered_map<unsigned int, bool> alreadyDrawn;
-		for (const auto& curPhys : m_physicsWorld)
+		std::unordered_map<SlotHandle, bool> alreadyDrawn;
+		for (unsigned int i = 0; i < m_physicsWorld.GetCount(); ++i)
 		{
-			auto gameObj = curPhys.m_gameObject;
-			drawDebugClipping(gameObj->GetClipType(), curPhys.GetPos(), curPhys.GetRot(), gameObj->GetClipSize(), sc_colourPurple);
-			curPhys.GetVelocity().GetString(pString);
-			fMan.DrawDebugString3D(pString, curPhys.GetPos(), sc_colourBlue);
-			alreadyDrawn.insert(std::pair<unsigned int, bool>(gameObj->GetId(), true));
+			auto gameObj = static_cast<GameObject*>(m_physicsWorld.GetOwner(i));
+			const Vector bodyPos = m_physicsWorld.GetPos(i);
+			drawDebugClipping(gameObj->GetClipType(), bodyPos, gameObj->GetRot(), gameObj->GetClipSize(), m_physicsWorld.IsAwake(i) ? sc_colourPurple : sc_colourGrey);
+			m_physicsWorld.GetVelocity(i).GetString(pString);
+			fMan.DrawDebugString3D(pString, bodyPos, sc_colourBlue);
+			alreadyDrawn.insert(std::pair<SlotHandle, bool>(gameObj->GetId(), true));
 		}
 
 		auto pDebugColour = sc_colourOrange;
@@ -307,13 +747,17 @@ bool PhysicsManager::AddCollisionObject(GameObject * a_gameObj)
 		return false;
 	}
 
-	if (a_gameObj->GetClipType() == ClipType::Mesh)
+	if (a_gameObj->GetClipType() == ClipType::Mesh && (a_gameObj->GetModel() == nullptr || !a_gameObj->GetModel()->IsLoaded()))
 	{
-		Log::Get().Write(LogLevel::Error, LogCategory::Game, "Mesh collision is no longer supported for game object %s!", a_gameObj->GetName());
+		Log::Get().Write(LogLevel::Error, LogCategory::Game, "Mesh collision needs a loaded model for game object %s!", a_gameObj->GetName());
 		return false;
 	}
 
+	Vector boundsMin, boundsMax;
+	GetClipBounds(a_gameObj, boundsMin, boundsMax);
 	m_collisionWorld.push_back(a_gameObj);
+	m_collisionProxies.push_back(m_collisionTree.CreateProxy(boundsMin, boundsMax, a_gameObj));
+	m_broadphase.Add(a_gameObj);
 	return m_collisionWorld.back() == a_gameObj;
 }
 
@@ -325,42 +769,37 @@ bool PhysicsManager::AddPhysicsObject(GameObject * a_gameObj)
 	}
 
 	// Set up a new physics object
- 	if (a_gameObj->GetPhysics() == nullptr)
+	if (!a_gameObj->HasPhysics())
 	{
- 		m_physicsWorld.emplace_back(a_gameObj);
+		a_gameObj->SetPhysics(m_physicsWorld.Add(a_gameObj, a_gameObj->GetPos(), a_gameObj->GetPhysicsMass(), a_gameObj->GetPhysicsLinearDrag()));
 	}
 	return true;
 }
 
-PhysicsObject* PhysicsManager::GetAddPhysicsObject(GameObject* a_gameObj)
+void PhysicsManager::UpdatePhysicsProperties(GameObject * a_gameObj)
 {
-	if (a_gameObj == nullptr)
-	{
-		return nullptr;
-	}
-	if (a_gameObj->GetPhysics() == nullptr)
+	const unsigned int body = m_physicsWorld.GetIndex(a_gameObj->GetPhysics());
+	if (body != DynamicBodies::s_invalidIndex)
 	{
-		AddPhysicsObject(a_gameObj);
+		m_physicsWorld.SetMass(body, a_gameObj->GetPhysicsMass());
+		m_physicsWorld.SetLinearDrag(body, a_gameObj->GetPhysicsLinearDrag());
 	}
-	return a_gameObj->GetPhysics();
 }
 
 bool PhysicsManager::RemoveCollisionObject(GameObject* a_gameObj)
 {
 	if (a_gameObj != nullptr)
 	{
-		ClearCollisions(a_gameObj);
-		for (auto it = m_collisionWorld.begin(); it != m_collisionWorld.end();)
+		for (unsigned int i = 0; i < m_collisionWorld.size(); ++i)
 		{
-			if (*it == a_gameObj)
+			if (m_collisionWorld[i] == a_gameObj)
 			{
-				it = m_collisionWorld.erase(it);
+				m_collisionTree.DestroyProxy(m_collisionProxies[i]);
+				m_collisionWorld.erase(m_collisionWorld.begin() + i);
+				m_collisionProxies.erase(m_collisionProxies.begin() + i);
+				m_broadphase.Remove(a_gameObj);
 				return true;
 			}
-			else
-			{
-				++it;
-			}
 		}
 	}
 	return false;
@@ -368,32 +807,26 @@ bool PhysicsManager::RemoveCollisionObject(GameObject* a_gameObj)
 
 bool PhysicsManager::RemovePhysicsObject(GameObject * a_gameObj)
 {
-	if (a_gameObj != nullptr)
+	if (a_gameObj != nullptr && m_physicsWorld.Remove(a_gameObj->GetPhysics()))
 	{
-		auto existingPhys = a_gameObj->GetPhysics();
-		for (auto it = m_physicsWorld.begin(); it != m_physicsWorld.end();)
-		{
-			if (it->m_gameObject == a_gameObj)
-			{
-				it = m_physicsWorld.erase(it);
-				return true;
-			}
-			else
-			{
-				++it;
-			}
-		}
+		a_gameObj->SetPhysics(0);
+		return true;
 	}
 	return false;
 }
 
 bool PhysicsManager::ApplyForce(GameObject * a_gameObj, const Vector & a_force)
 {
-	if (a_gameObj && a_gameObj->GetPhysics() != nullptr)
+	if (a_gameObj != nullptr)
 	{
-		if (PhysicsObject * phys = a_gameObj->GetPhysics())
+		unsigned int body = m_physicsWorld.GetIndex(a_gameObj->GetPhysics());
+		if (body != DynamicBodies::s_invalidIndex)
 		{
-			phys->AddLinearImpulse(a_force, a_gameObj->GetPhysicsMass());
+			if (!m_physicsWorld.IsAwake(body))
+			{
+				body = m_physicsWorld.Wake(body);
+			}
+			m_physicsWorld.AddImpulse(body, a_force);
 			return true;
 		}
 	}
@@ -402,45 +835,151 @@ bool PhysicsManager::ApplyForce(GameObject * a_gameObj, const Vector & a_force)
 
 Vector PhysicsManager::GetVelocity(GameObject * a_gameObj) const
 {
-	if (a_gameObj && a_gameObj->GetPhysics() != nullptr)
+	if (a_gameObj != nullptr)
 	{
-		return a_gameObj->GetPhysics()->GetVelocity();
+		const unsigned int body = m_physicsWorld.GetIndex(a_gameObj->GetPhysics());
+		if (body != DynamicBodies::s_invalidIndex)
+		{
+			return m_physicsWorld.GetVelocity(body);
+		}
 	}
 	return Vector::Zero();
 }
 
 bool PhysicsManager::RayCast(const Vector & a_rayStart, const Vector & a_rayEnd, Vector & a_worldHit_OUT, Vector & a_worldNormal_OUT)
 {
-	// TODO!
+	RayHit hit;
+	if (RayCast(a_rayStart, a_rayEnd, hit))
+	{
+		a_worldHit_OUT = hit.m_pos;
+		a_worldNormal_OUT = hit.m_normal;
+		return true;
+	}
 	return false;
 }
 
-int PhysicsManager::GetCollisionGroupId(StringHash a_colGroupHash) const
+bool PhysicsManager::RayCast(const Vector & a_rayStart, const Vector & a_rayEnd, RayHit & a_hit_OUT)
 {
-	for (int i = 1; i < s_maxCollisionGroups; ++i)
+	return RayCastBatch(&a_rayStart, &a_rayEnd, 1, &a_hit_OUT) > 0;
+}
+
+unsigned int PhysicsManager::RayCastBatch(const Vector * a_rayStarts, const Vector * a_rayEnds, unsigned int a_numRays, RayHit * a_hits_OUT)
+{
+	m_rays.resize(a_numRays);
+	for (unsigned int i = 0; i < a_numRays; ++i)
 	{
-		if (m_collisionGroups[i] == a_colGroupHash)
+		AabbTree::Ray & ray = m_rays[i];
+		ray.m_start = a_rayStarts[i];
+		ray.m_dir = a_rayEnds[i] - a_rayStarts[i];
+		ray.m_length = ray.m_dir.Length();
+		ray.m_dir.Normalise();
+		a_hits_OUT[i] = RayHit();
+	}
+
+	// Each hit clips its ray so only closer objects are tested after it
+	const std::vector<AabbTree::Ray> & rays = m_rays;
+	m_collisionTree.RayCast(m_rays.data(), a_numRays, [&rays, a_hits_OUT](unsigned int a_rayIndex, void * a_userData, float a_rayLength)
+	{
+		GameObject * gameObj = static_cast<GameObject*>(a_userData);
+		const AabbTree::Ray & ray = rays[a_rayIndex];
+		float distance = 0.0f;
+		Vector normal(0.0f);
+		if (RayCastObject(gameObj, ray, a_rayLength, distance, normal))
 		{
-			return i;
+			RayHit & hit = a_hits_OUT[a_rayIndex];
+			hit.m_pos = ray.m_start + ray.m_dir * distance;
+			hit.m_normal = normal;
+			hit.m_distance = distance;
+			hit.m_gameObject = gameObj;
+			return distance;
+		}
+		return a_rayLength;
+	});
+
+	unsigned int numHits = 0;
+	for (unsigned int i = 0; i < a_numRays; ++i)
+	{
+		if (a_hits_OUT[i].m_gameObject != nullptr)
+		{
+			++numHits;
 		}
 	}
-	return -1;
+	return numHits;
 }
 
-void PhysicsManager::ClearCollisions(GameObject * a_gameObj)
+bool PhysicsManager::RayCastObject(GameObject * a_gameObj, const AabbTree::Ray & a_ray, float a_rayLength, float & a_distance_OUT, Vector & a_normal_OUT)
 {
-	// Iterate through all objects in this file and clean up memory
-	GameObject::CollisionList * colList = a_gameObj->GetCollisions();
-	auto cur = colList->GetHead();
-	while(cur != nullptr)
+	const Vector clipPos = a_gameObj->GetPos() + a_gameObj->GetClipOffset();
+	const Vector clipSize = a_gameObj->GetClipSize();
+	switch (a_gameObj->GetClipType())
 	{
-		// Cache off next pointer and remove and deallocate memory
-		auto next = cur->GetNext();
-		colList->Remove(cur);
-		delete cur;
+		case ClipType::Sphere: return CollisionUtils::IntersectRaySphere(a_ray.m_start, a_ray.m_dir, a_rayLength, clipPos, clipSize.GetX(), a_distance_OUT, a_normal_OUT);
+		case ClipType::AxisBox: return CollisionUtils::IntersectRayAxisBox(a_ray.m_start, a_ray.m_dir, a_rayLength, clipPos, clipSize, a_distance_OUT, a_normal_OUT);
+		case ClipType::Box: return CollisionUtils::IntersectRayBox(a_ray.m_start, a_ray.m_dir, a_rayLength, clipPos, clipSize, a_gameObj->GetRot(), a_distance_OUT, a_normal_OUT);
+		case ClipType::Mesh: return RayCastMesh(a_gameObj, a_ray, a_rayLength, a_distance_OUT, a_normal_OUT);
+		default: return false;
+	}
+}
+
+bool PhysicsManager::RayCastMesh(GameObject * a_meshObj, const AabbTree::Ray & a_ray, float a_rayLength, float & a_distance_OUT, Vector & a_normal_OUT)
+{
+	Model * model = a_meshObj->GetModel();
+	if (model == nullptr)
+	{
+		return false;
+	}
+
+	// The direction keeps the object's scale in model space so distances along the ray still come out in world units
+	const MeshSpace meshSpace(a_meshObj);
+	const Vector modelStart = meshSpace.ToModel(a_ray.m_start);
+	const Vector modelDir = meshSpace.ToModelDir(a_ray.m_dir);
+	float nearest = a_rayLength;
+	const MeshBvh * hitBvh = nullptr;
+	unsigned int hitTri = 0;
+	for (unsigned int i = 0; i < model->GetNumObjects(); ++i)
+	{
+		const MeshBvh & bvh = model->GetObjectAtIndex(i)->GetBvh();
+		bvh.RayCast(modelStart, modelDir, nearest, [&](unsigned int a_triIndex, float a_curLength)
+		{
+			Vector vertA, vertB, vertC;
+			bvh.GetTriangle(a_triIndex, vertA, vertB, vertC);
+			float distance = 0.0f;
+			if (CollisionUtils::IntersectRayTriangle(modelStart, modelDir, a_curLength, vertA, vertB, vertC, distance) && distance < nearest)
+			{
+				nearest = distance;
+				hitBvh = &bvh;
+				hitTri = a_triIndex;
+				return distance;
+			}
+			return a_curLength;
+		});
+	}
+	if (hitBvh == nullptr)
+	{
+		return false;
+	}
 
-		cur = next;
+	// Face the normal back at the ray whichever side of the triangle was hit
+	Vector vertA, vertB, vertC;
+	hitBvh->GetTriangle(hitTri, vertA, vertB, vertC);
+	vertA = meshSpace.ToWorld(vertA);
+	Vector normal = (meshSpace.ToWorld(vertB) - vertA).Cross(meshSpace.ToWorld(vertC) - vertA);
+	normal.Normalise();
+	a_normal_OUT = normal.Dot(a_ray.m_dir) > 0.0f ? normal * -1.0f : normal;
+	a_distance_OUT = nearest;
+	return true;
+}
+
+int PhysicsManager::GetCollisionGroupId(StringHash a_colGroupHash) const
+{
+	for (int i = 1; i < s_maxCollisionGroups; ++i)
+	{
+		if (m_collisionGroups[i] == a_colGroupHash)
+		{
+			return i;
+		}
 	}
+	return -1;
 }
 
 void PhysicsManager::AddCollision(GameObject * a_gameObjA, GameObject * a_gameObjB)
@@ -450,8 +989,23 @@ void PhysicsManager::AddCollision(GameObject * a_gameObjA, GameObject * a_gameOb
 		return;
 	}
 
-	GameObject::CollisionList * colList = a_gameObjA->GetCollisions();
-	GameObject::Collider * collider = new GameObject::Collider();
-	collider->SetData(a_gameObjB);
-	colList->Insert(collider);
+	Contact contact;
+	contact.m_gameObjId = a_gameObjA->GetId();
+	contact.m_otherId = a_gameObjB->GetId();
+	m_contacts.push_back(contact);
+}
+
+const Contact * PhysicsManager::GetContacts(const GameObject * a_gameObj, unsigned int & a_numContacts_OUT) const
+{
+	// The contacts of an object are next to each other once sorted, the other id of zero sorts first
+	Contact key;
+	key.m_gameObjId = a_gameObj->GetId();
+	auto first = std::lower_bound(m_contacts.begin(), m_contacts.end(), key);
+	auto last = first;
+	while (last != m_contacts.end() && last->m_gameObjId == key.m_gameObjId)
+	{
+		++last;
+	}
+	a_numContacts_OUT = (unsigned int)(last - first);
+	return a_numContacts_OUT > 0 ? &(*first) : nullptr;
 }
@@ -2,8 +2,11 @@
 #define _ENGINE_PHYSICS_MANAGER
 #pragma once
 
-#include "..\core\BitSet.h"
-#include "..\core\LinkedList.h"
+#include "../core/AabbTree.h"
+#include "../core/BitSet.h"
+#include "../core/DynamicBodies.h"
+#include "../core/LinkedList.h"
+#include "../core/SweepAndPrune.h"
 
 #include "GameFile.h"
 #include "Singleton.h"
@@ -19,82 +22,41 @@ enum class PhysicsIntegrationType : unsigned char
 	RungeKutta,
 };
 
-//\ brief Grouping of collision and physics states, can have multiple objects and shapes
-class PhysicsObject
+//\brief Where a ray first touched the collision world
+struct RayHit
 {
-	friend class PhysicsManager;
-public:
-	PhysicsObject(GameObject* a_owner) : m_gameObject(a_owner) 
-	{
-		InitialiseFromGameObject();
-	}
-	PhysicsObject() = delete;
-	~PhysicsObject()
-	{
-		m_gameObject->SetPhysics(nullptr);
-		m_gameObject = nullptr;
-	}
-	// Copy 
-	PhysicsObject(PhysicsObject& a_other) 
-	{
-		m_gameObject = a_other.m_gameObject;
-		m_gameObject->SetPhysics(this);
-	};
-	// Move
-	PhysicsObject(PhysicsObject&& a_other) noexcept
-	{
-		m_gameObject = a_other.m_gameObject;
-		m_gameObject->SetPhysics(this);
-	}
-	// Copy assignment 
-	PhysicsObject& operator =(PhysicsObject& a_other) noexcept
-	{
-		m_gameObject = a_other.m_gameObject;
-		m_gameObject->SetPhysics(this);
-		return *this;
-	};
-	// Move assignment 
-	PhysicsObject& operator =(PhysicsObject&& a_other) noexcept
-	{
-		m_gameObject = a_other.m_gameObject;
-		m_gameObject->SetPhysics(this);
-		return *this;
-	};
+	Vector m_pos{ 0.0f };						///< Worldspace position of the hit
+	Vector m_normal{ 0.0f };					///< Surface direction of the shape that was hit
+	float m_distance{ 0.0f };					///< How far along the ray the hit is
+	GameObject * m_gameObject{ nullptr };		///< The object that was hit, null if the ray hit nothing
+};
 
-	inline bool HasCollision() const { return false; }
-	inline Vector GetVelocity() const  { return m_vel; }
-	inline Vector GetPos() const { return m_pos; }
-	inline Quaternion GetRot() const { return m_rot; }
-	inline Vector GetForce() const { return m_force; }
+//\brief How a pair of touching objects has changed since the frame before
+enum class ContactState : unsigned char
+{
+	Begin,		///< Touching now but not the frame before
+	Stay,		///< Touching in both frames
+	End,		///< Touching the frame before but not now
+};
 
-	inline void SetForce(const Vector& a_newForce) { m_force = a_newForce; }
-	inline void AddLinearForce(const Vector& a_newForce, const float& a_mass) { m_force += a_newForce + a_mass; }
-	inline void AddLinearImpulse(const Vector& a_newImpulse, const float& a_mass) { m_vel += a_newImpulse * (1.0f / a_mass); }
-	inline void SetVelocity(const Vector& a_newVel) { m_vel = a_newVel; }
+//\brief One object touching another, each pair is stored from both sides so all of an object's contacts sit together
+struct Contact
+{
+	SlotHandle m_gameObjId{ 0 };					///< Object the contact belongs to
+	SlotHandle m_otherId{ 0 };						///< Object it is touching, may have been destroyed since
+	ContactState m_state{ ContactState::Begin };	///< Only meaningful for contact events
 
-protected:
-	GameObject* m_gameObject{ nullptr };		///< The object that is controlled by this physics object
-	Vector m_pos{};								///< Position just for simulations
-	Quaternion m_rot{};							///< Angular torque affects the rotation
-	Vector m_torque{};							///< Rotational force applied at a point
-	Vector m_inertia{};							///< TODO: Like m_acc?
-	Vector m_force{};							///< Force to be applied each sim step
-	Vector m_vel{};								///< The resulting velocity
-	Vector m_acc{};								///< Acceleration is accumulation of force
-	Vector m_avgAcc{};
-	Vector m_lastAcc{};
+	inline bool operator < (const Contact & a_other) const { return m_gameObjId < a_other.m_gameObjId || (m_gameObjId == a_other.m_gameObjId && m_otherId < a_other.m_otherId); }
+	inline bool operator == (const Contact & a_other) const { return m_gameObjId == a_other.m_gameObjId && m_otherId == a_other.m_otherId; }
+};
 
-private:
-	inline void InitialiseFromGameObject()
-	{
-		if (m_gameObject == nullptr)
-		{
-			return;
-		}
-		m_pos = m_gameObject->GetPos();
-		m_rot = m_gameObject->GetRot();
-		m_gameObject->SetPhysics(this);
-	}
+//\brief Counts of the work done by the last update, for profiling
+struct PhysicsStats
+{
+	unsigned int m_numSteps{ 0 };				///< Sim steps run, can be zero or several with a fixed step rate
+	unsigned int m_numPairTests{ 0 };			///< Pairs the broadphase handed to the narrowphase over every step
+	unsigned int m_numContacts{ 0 };			///< Pairs found touching over every step
+	unsigned int m_numAwakeBodies{ 0 };			///< Bodies still being simulated at the end of the update
 };
 
 class PhysicsManager : public Singleton<PhysicsManager>
@@ -110,18 +72,27 @@ public:
 	//\brief In order of operations:	1. Solve collision world, calculate restitution and report back to the game object's collision lists
 	//									2. Integrate dynamic physics and store in physics object register
 	//									3. Update game object transform
-	inline void Update(float a_dt)
-	{
-		UpdateCollisionWorld(a_dt);
-		UpdatePhysicsWorld(a_dt);
-		UpdateGameObjects(a_dt);
-		UpdateDebugRender(a_dt);
-	}
+	//									4. Put islands of touching bodies that have settled to sleep, wake ones touched by moving bodies
+	//									5. Refit the tree that ray casts are tested against
+	//		 With a fixed step rate steps 1 and 2 run as many times as fit in the time built up since the last
+	//		 step and step 3 blends between the last two steps, so the sim is the same at any frame rate
+	void Update(float a_dt);
 	
 	//\brief Set the constant force to be applied throughout the simulation, usually done from the game config file
 	inline void SetGravity(const Vector& a_gravity) { m_gravity = a_gravity; }
 	inline Vector GetGravity() const { return m_gravity; }
 
+	//\brief Step the sim at a fixed rate instead of once per frame, usually done from the game config file
+	//\param a_stepsPerSecond how often to step, zero to step once a frame with the frame time
+	//\param a_maxSubSteps how many steps a frame can run before the remaining time is dropped
+	void SetFixedStepRate(float a_stepsPerSecond, int a_maxSubSteps);
+	inline bool IsFixedStep() const { return m_fixedStep > 0.0f; }
+
+	//\brief Bodies moving slower than a speed for long enough stop being simulated until something wakes them
+	//\param a_sleepSpeed the speed in units per second to count as settled
+	//\param a_sleepTime seconds a body and everything touching it must stay settled before sleeping, zero never sleeps
+	inline void SetSleeping(float a_sleepSpeed, float a_sleepTime) { m_sleepSpeed = a_sleepSpeed; m_sleepTime = a_sleepTime; }
+
 	//\brief Add a bullet collision object
 	//\param a_gameObj pointer to the game object to change
 	//\return true if an object was added to the simulation
@@ -131,7 +102,9 @@ public:
 	//\param a_gameObj pointer to the game object to change
 	//\return true if an object was added to the simulation
 	bool AddPhysicsObject(GameObject * a_gameObj);
-	PhysicsObject * GetAddPhysicsObject(GameObject* a_gameObj);
+
+	//\brief Copy the mass and drag of a game object into its dynamic body after they change
+	void UpdatePhysicsProperties(GameObject * a_gameObj);
 
 	//\brief Remove dynamic physics for an object from the world
 	//\param a_gameObj pointer to the game object to change
@@ -163,39 +136,136 @@ public:
 	//\return true if the ray hit some collision object, false if not
 	bool RayCast(const Vector & a_rayStart, const Vector & a_rayEnd, Vector & a_worldHit_OUT, Vector & a_worldNormal_OUT);
 
+	//\brief Cast a ray at the collision world and retrieve the closest hit
+	//\param a_hit_OUT will be written to with the position, normal, distance and object of the first hit
+	//\return true if the ray hit some collision object, false if not
+	bool RayCast(const Vector & a_rayStart, const Vector & a_rayEnd, RayHit & a_hit_OUT);
+
+	//\brief Cast many rays at the collision world in one go, much cheaper than casting them one at a time
+	//		 when there are lots of them like line of sight and sensing rays for AI
+	//\param a_rayStarts array of the start points in worldspace of each ray
+	//\param a_rayEnds array of the end points in worldspace of each ray
+	//\param a_numRays how many rays are in each array
+	//\param a_hits_OUT array with room for a hit per ray, rays that hit nothing get a hit with a null game object
+	//\return the number of rays that hit something
+	unsigned int RayCastBatch(const Vector * a_rayStarts, const Vector * a_rayEnds, unsigned int a_numRays, RayHit * a_hits_OUT);
+
 	//\brief Get the group ID matching the name of a collision group
 	//\return Collision group id, -1 means not found, 0 means nothing, > 0 is a valid group
 	int GetCollisionGroupId(StringHash a_colGroupHash) const;
 	inline int GetCollisionGroupId(const char * a_colGroupName) const { return GetCollisionGroupId(StringHash(a_colGroupName)); }
 
-	//\brief Remove all entries from a game object collision list, called once a frame
-	//		 before the physics world is queried
-	//\param a_gameObj the object to affect
-	void ClearCollisions(GameObject * a_gameObj);
+	//\brief Find the objects a game object was touching in the last frame that stepped the sim
+	//\param a_numContacts_OUT will be written to with how many contacts follow the returned one
+	//\return the first contact of the object, null if it isn't touching anything
+	const Contact * GetContacts(const GameObject * a_gameObj, unsigned int & a_numContacts_OUT) const;
+	inline bool HasContacts(const GameObject * a_gameObj) const { unsigned int numContacts = 0; return GetContacts(a_gameObj, numContacts) != nullptr; }
+
+	//\brief Every contact that began, stayed or ended this frame sorted by object, empty if the sim didn't step
+	inline const std::vector<Contact> & GetContactEvents() const { return m_contactEvents; }
+
+	//\brief How much work the last update did
+	inline const PhysicsStats & GetStats() const { return m_stats; }
 
 protected:
 
-	//\brief Add a collision between objects
+	//\brief Add a contact between objects for this frame, duplicates are removed when the frame's contacts are sorted
 	void AddCollision(GameObject * a_gameObjA, GameObject * a_gameObjB);
 
 private:
 
+	//\brief A touching pair found by the narrowphase, held until the response to it is applied
+	struct PairContact
+	{
+		GameObject * m_gameObjA{ nullptr };		///< The object the normal points away from
+		GameObject * m_gameObjB{ nullptr };
+		Vector m_pos{ 0.0f };
+		Vector m_normal{ 0.0f };
+		float m_depth{ 0.0f };
+
+		//\brief Ordered by the ids of the pair, which are unique and don't depend on which thread found the contact
+		bool operator < (const PairContact & a_other) const;
+	};
+
+	//\brief Contacts found by one job thread, kept a cache line apart from the other threads' so adding to them doesn't contend
+	struct alignas(64) ContactBuffer
+	{
+		std::vector<PairContact> m_contacts;
+	};
+
 	//\brief Helper functions to run the steps of the dynamics equation
+	//		 Collision tests run on the job threads, the response to each contact is applied afterwards in a fixed order
 	void UpdateCollisionWorld(const float & a_dt);
 	void UpdatePhysicsWorld(const float& a_dt);
-	void UpdateGameObjects(const float& a_dt);
+	//\brief Write body positions back to their game objects in one pass, blended between the last two steps
+	void UpdateGameObjects(float a_alpha);
+	void ClearCollisionWorld();
+
+	//\brief Sort the contacts found this frame and compare them with last frame's to find what began and ended
+	void UpdateContactEvents();
+
+	//\brief Group bodies touching each other into islands, an island sleeps and wakes as one
+	void UpdateSleeping(float a_dt);
+	unsigned int FindIsland(unsigned int a_body);
 	void UpdateDebugRender(const float& a_dt);
 
+	//\brief Refresh the broadphase with the world bounds and group filter of every collision object
+	void UpdateBroadphase();
+
+	//\brief Move the ray cast proxies of collision objects that have moved outside their fattened bounds
+	void UpdateCollisionTree();
+
+	//\brief Test a ray against the exact shape of a collision object
+	static bool RayCastObject(GameObject * a_gameObj, const AabbTree::Ray & a_ray, float a_rayLength, float & a_distance_OUT, Vector & a_normal_OUT);
+
+	//\brief Test a ray against the triangles of a mesh collision object
+	static bool RayCastMesh(GameObject * a_meshObj, const AabbTree::Ray & a_ray, float a_rayLength, float & a_distance_OUT, Vector & a_normal_OUT);
+
+	//\brief Run the test for a pair of clip volumes, only reads the objects so pairs can be tested on any thread
+	//\return true if the objects touch, the contact is ordered with the shape the normal points away from first
+	static bool IntersectPair(GameObject * a_gameObjA, GameObject * a_gameObjB, PairContact & a_contact_OUT);
+
+	//\brief Find the deepest contact between the triangles of a mesh collision object and the primitive clip volume of another
+	//\param a_colNormal_OUT points from the mesh towards the other object
+	static bool IntersectMesh(GameObject * a_meshObj, GameObject * a_gameObj, Vector & a_colPos_OUT, Vector & a_colNormal_OUT, float & a_colDepth_OUT);
+
+	//\brief Conservative world space box around an object's clip volume
+	static void GetClipBounds(GameObject * a_gameObj, Vector & a_min_OUT, Vector & a_max_OUT);
+
 	static constexpr int s_maxCollisionGroups = 16;
 	static constexpr float s_minPhysicsStep = 1.0f / 500.0f;
 	static constexpr float s_maxPhysicsStep = 1.0f / 30.0f;
+	static constexpr int s_defaultMaxSubSteps = 4;
+	static constexpr float s_defaultSleepSpeed = 0.5f;
+	static constexpr float s_defaultSleepTime = 1.0f;
+	static constexpr unsigned int s_narrowphaseGrainSize = 64;			///< Pairs tested per job, enough sphere and box tests to outweigh scheduling
 
 	StringHash m_collisionGroups[s_maxCollisionGroups];						///< Set of hashes of the user defined groups that collide
 	BitSet m_collisionFilters[s_maxCollisionGroups];						///< Precomputed bitmask to determine if two objects should collide
 	PhysicsIntegrationType m_type{ PhysicsIntegrationType::Euler };			///< What type of integration algorith will be used for the sim
-	Vector m_gravity{ 0.0f, 0.0f, 0.0f };									///< Constant force applied to world wide sim
+	Vector m_gravity{ 0.0f, 0.0f, 0.0f };									///< Constant acceleration applied to world wide sim
+	float m_fixedStep{ 0.0f };												///< Seconds per sim step, zero steps once per frame with a clamped frame time
+	float m_accumulator{ 0.0f };											///< Frame time not yet simulated in fixed step mode
+	int m_maxSubSteps{ s_defaultMaxSubSteps };								///< Most fixed steps a frame will run to catch up
+	float m_sleepSpeed{ s_defaultSleepSpeed };								///< Bodies slower than this count towards sleeping
+	float m_sleepTime{ s_defaultSleepTime };								///< Seconds an island must be settled before it sleeps, zero disables sleeping
 	std::vector<GameObject*> m_collisionWorld{ };							///< Every object that is checking collisions against itself
-	std::vector<PhysicsObject> m_physicsWorld{ };							///< Every object we simulate dynamics with	
+	SweepAndPrune m_broadphase;												///< Finds the pairs in the collision world that are close enough to test
+	std::vector<SweepAndPrune::Pair> m_broadphasePairs{ };					///< Overlapping pairs found this frame, kept to avoid reallocating
+	std::vector<ContactBuffer> m_threadContacts{ };							///< Contacts found by each job thread during the narrowphase
+	std::vector<PairContact> m_pairContacts{ };								///< Every thread's contacts merged and sorted so the response is applied in the same order
+	AabbTree m_collisionTree;												///< Bounds of every collision object for ray casts
+	std::vector<int> m_collisionProxies{ };									///< Tree proxy of each object in the collision world, same order
+	std::vector<AabbTree::Ray> m_rays{ };									///< Rays of the current cast, kept to avoid reallocating
+	std::vector<Contact> m_contacts{ };										///< Contacts of the last frame that stepped, sorted once the frame is done
+	std::vector<Contact> m_prevContacts{ };									///< Contacts of the frame before, storage swaps with m_contacts each frame
+	std::vector<Contact> m_contactEvents{ };								///< Contacts that changed or persisted between the last two frames
+	std::vector<std::pair<SlotHandle, SlotHandle>> m_islandLinks{ };		///< Bodies of each pair of dynamic objects that touched this frame
+	std::vector<unsigned int> m_islandParents{ };							///< Union find forest over body indices, the root names the island
+	std::vector<unsigned char> m_islandAwake{ };							///< Per island root, if anything in the island is still moving
+	std::vector<SlotHandle> m_islandChanges{ };								///< Bodies to sleep or wake once every island has been decided
+	DynamicBodies m_physicsWorld;											///< Every object we simulate dynamics with, owned by its game object
+	PhysicsStats m_stats;													///< Counted over each update
 };
 
 #endif //_ENGINE_PHYSICS_MANAGER
\ No newline at end of file
@@ -5,11 +5,14 @@
 #include <SDL.h>
 
 #include "../core/MathUtils.h"
+#include "../core/RadixSort.h"
 
 #include "CameraManager.h"
 #include "DataPack.h"
 #include "DebugMenu.h"
 #include "Log.h"
+#include "MeshOptimiser.h"
+#include "RenderState.h"
 #include "Texture.h"
 #include "WorldManager.h"
 
@@ -35,14 +38,27 @@ const float RenderManager::s_nearClipPlane = 1.0f;
 const float RenderManager::s_farClipPlane = 1000.0f;
 const float RenderManager::s_fovAngleY = 55.0f;
 float RenderManager::s_renderDepth2D = -1.0f;
+const unsigned int RenderManager::s_quadIndices[6] = { 0, 1, 2, 2, 1, 3 };
+const Vector RenderManager::s_debugBoxVerts[RenderManager::s_numDebugBoxVerts] =
+{
+	Vector(-0.5f, -0.5f, -0.5f), Vector(-0.5f, -0.5f, 0.5f), Vector(0.5f, -0.5f, 0.5f), Vector(0.5f, -0.5f, -0.5f),
+	Vector(-0.5f, 0.5f, -0.5f), Vector(-0.5f, 0.5f, 0.5f), Vector(0.5f, 0.5f, 0.5f), Vector(0.5f, 0.5f, -0.5f),
+};
+const unsigned int RenderManager::s_debugBoxIndices[RenderManager::s_numDebugBoxIndices] =
+{
+	0, 1, 1, 2, 2, 3, 3, 0,		// Bottom face
+	4, 5, 5, 6, 6, 7, 7, 4,		// Top face
+	0, 4, 1, 5, 2, 6, 3, 7,		// Sides
+};
+const unsigned int RenderManager::s_debugTransformIndices[RenderManager::s_numDebugTransformVerts] = { 0, 1, 2, 3, 4, 5 };
 const int RenderManager::s_maxObjects[(int)RenderObjectType::Count] =
 {
 	 512, // Tri
 	 512, // Quad
 	 512, // Line
-	 512, // DebugBox
-	 512, // DebugSphere
-	 1024, // DebugTransform
+	 2048, // DebugBox
+	 1024, // DebugSphere
+	 4096, // DebugTransform
 	 1024, // Model
 	 8096 // FontChar
 };
@@ -51,7 +67,7 @@ void RenderManager::VertexBuffer::Bind()
 {
 	unsigned int glErrorEnum = glGetError();
 	glGenVertexArrays(1, &m_vertexArrayId);
-	glBindVertexArray(m_vertexArrayId);
+	RenderState::BindVertexArray(m_vertexArrayId);
 	glGenBuffers(1, &m_vertexBufferId);
 	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
 	glBufferData(GL_ARRAY_BUFFER, m_numVerts * sizeof(Vertex), m_verts, GL_STATIC_DRAW);
@@ -73,6 +89,55 @@ void RenderManager::VertexBuffer::Bind()
 	glErrorEnum = glGetError();
 }
 
+void RenderManager::ModelVertex::Set(const Vector & a_pos, const Vector & a_normal, const TexCoord & a_uv)
+{
+	m_pos = a_pos;
+	const Vector2 octNormal = MathUtils::EncodeOctahedral(a_normal);
+	m_normal[0] = (int16_t)roundf(MathUtils::Clamp(-1.0f, octNormal.GetX(), 1.0f) * 32767.0f);
+	m_normal[1] = (int16_t)roundf(MathUtils::Clamp(-1.0f, octNormal.GetY(), 1.0f) * 32767.0f);
+	m_uv[0] = MathUtils::FloatToHalf(a_uv.GetX());
+	m_uv[1] = MathUtils::FloatToHalf(a_uv.GetY());
+}
+
+void RenderManager::MeshArena::Init()
+{
+	glGenVertexArrays(1, &m_vertexArrayId);
+	RenderState::BindVertexArray(m_vertexArrayId);
+	glGenBuffers(1, &m_vertexBufferId);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
+	glBufferData(GL_ARRAY_BUFFER, s_meshArenaVerts * sizeof(ModelVertex), nullptr, GL_STATIC_DRAW);
+
+	// Colour and the float normal are left disabled so shaders read the constant white colour and decode the packed normal
+	glEnableVertexAttribArray(0);  // Vertex position
+	glEnableVertexAttribArray(2);  // Texture coordinates
+	glEnableVertexAttribArray(Shader::s_vertexOctNormalAttrib);
+	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(ModelVertex), 0);
+	glVertexAttribPointer(2, 2, GL_HALF_FLOAT, false, sizeof(ModelVertex), (unsigned char*)nullptr + offsetof(ModelVertex, m_uv));
+	glVertexAttribPointer(Shader::s_vertexOctNormalAttrib, 2, GL_SHORT, true, sizeof(ModelVertex), (unsigned char*)nullptr + offsetof(ModelVertex, m_normal));
+
+	glGenBuffers(1, &m_indexBufferId);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferId);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, s_meshArenaIndexUnits * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+	m_vertexAllocator.Init(s_meshArenaVerts);
+	m_indexAllocator.Init(s_meshArenaIndexUnits);
+}
+
+void RenderManager::MeshArena::Shutdown()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDeleteBuffers(1, &m_vertexBufferId);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glDeleteBuffers(1, &m_indexBufferId);
+	RenderState::ForgetVertexArray(m_vertexArrayId);
+	glDeleteVertexArrays(1, &m_vertexArrayId);
+	m_vertexArrayId = 0;
+	m_vertexBufferId = 0;
+	m_indexBufferId = 0;
+	m_vertexAllocator.Init(0);
+	m_indexAllocator.Init(0);
+}
+
 void RenderManager::VertexBuffer::Rebind()
 {
 	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
@@ -89,15 +154,105 @@ void RenderManager::VertexBuffer::Unbind()
 	glDeleteBuffers(1, &m_vertexBufferId);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	glDeleteBuffers(1, &m_indexBufferId);
-	glBindVertexArray(0);
+	RenderState::BindVertexArray(0);
+	glDeleteVertexArrays(1, &m_vertexArrayId);
+}
+
+RenderManager::Vertex * RenderManager::DynamicGeometry::AddPrimitive(unsigned int a_numVerts, const unsigned int * a_indices, unsigned int a_numIndices, int a_textureId, Shader * a_shader)
+{
+	// Stream is full for this frame
+	if (m_numVerts + a_numVerts > m_maxVerts || m_numIndices + a_numIndices > m_maxIndices)
+	{
+		return nullptr;
+	}
+
+	// Only start a new batch when the state needed to draw the primitive changes
+	DynamicBatch * batch = m_numBatches > 0 ? &m_batches[m_numBatches - 1] : nullptr;
+	if (batch == nullptr || batch->m_textureId != a_textureId || batch->m_shader != a_shader)
+	{
+		if (m_numBatches >= m_maxBatches)
+		{
+			return nullptr;
+		}
+		batch = &m_batches[m_numBatches++];
+		batch->m_shader = a_shader;
+		batch->m_textureId = a_textureId;
+		batch->m_firstIndex = m_numIndices;
+		batch->m_numIndices = 0;
+	}
+
+	// Indices are supplied relative to the primitive so offset them into the stream
+	for (unsigned int i = 0; i < a_numIndices; ++i)
+	{
+		m_indicies[m_numIndices++] = m_numVerts + a_indices[i];
+	}
+	batch->m_numIndices += a_numIndices;
+
+	Vertex * firstVert = m_verts + m_numVerts;
+	m_numVerts += a_numVerts;
+	++m_numPrimitives;
+	m_uploaded = false;
+	return firstVert;
+}
+
+void RenderManager::DynamicGeometry::Bind()
+{
+	glGenVertexArrays(1, &m_vertexArrayId);
+	RenderState::BindVertexArray(m_vertexArrayId);
+	glGenBuffers(1, &m_vertexBufferId);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
+	glBufferData(GL_ARRAY_BUFFER, m_maxVerts * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+	glEnableVertexAttribArray(0);  // Vertex position
+	glEnableVertexAttribArray(1);  // Vertex color
+	glEnableVertexAttribArray(2);  // Texture coordinates
+	glEnableVertexAttribArray(3);  // Normals
+	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex), 0);
+	glVertexAttribPointer(1, 4, GL_FLOAT, false, sizeof(Vertex), (unsigned char*)nullptr + sizeof(Vector));
+	glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(Vertex), (unsigned char*)nullptr + sizeof(Vector) + sizeof(Colour));
+	glVertexAttribPointer(3, 3, GL_FLOAT, true, sizeof(Vertex), (unsigned char*)nullptr + sizeof(Vector) + sizeof(Colour) + sizeof(TexCoord));
+	glGenBuffers(1, &m_indexBufferId);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferId);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_maxIndices * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+	RenderState::BindVertexArray(0);
+}
+
+void RenderManager::DynamicGeometry::Upload()
+{
+	// Rendering the same frame more than once (VR) does not need another upload
+	if (m_uploaded || m_numVerts == 0)
+	{
+		return;
+	}
+
+	// Orphan the previous frame's storage so the driver does not stall waiting for the GPU to finish with it
+	RenderState::BindVertexArray(m_vertexArrayId);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
+	glBufferData(GL_ARRAY_BUFFER, m_maxVerts * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_numVerts * sizeof(Vertex), m_verts);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferId);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_maxIndices * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, m_numIndices * sizeof(unsigned int), m_indicies);
+	m_uploaded = true;
+}
+
+void RenderManager::DynamicGeometry::Unbind()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDeleteBuffers(1, &m_vertexBufferId);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glDeleteBuffers(1, &m_indexBufferId);
+	RenderState::BindVertexArray(0);
 	glDeleteVertexArrays(1, &m_vertexArrayId);
+	m_vertexArrayId = 0;
+	m_vertexBufferId = 0;
+	m_indexBufferId = 0;
 }
 
 void RenderManager::ParticleEmitter::Bind()
 {
 	unsigned int glErrorEnum = glGetError();
 	glGenVertexArrays(1, &m_vertexArrayId);
-	glBindVertexArray(m_vertexArrayId);
+	RenderState::BindVertexArray(m_vertexArrayId);
 	glGenBuffers(1, &m_vertexBufferId);
 	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
 	glBufferData(GL_ARRAY_BUFFER, m_numParticles * sizeof(Particle), m_particles, GL_STATIC_DRAW);
@@ -143,7 +298,7 @@ void RenderManager::ParticleEmitter::Unbind()
 	glDeleteBuffers(1, &m_vertexBufferId);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	glDeleteBuffers(1, &m_indexBufferId);
-	glBindVertexArray(0);
+	RenderState::BindVertexArray(0);
 	glDeleteVertexArrays(1, &m_vertexArrayId);
 }
 
@@ -172,10 +327,10 @@ bool RenderManager::Startup(const Colour & a_clearColour, const char * a_shaderP
 	glEnable(GL_LINE_SMOOTH);
 
     // Depth testing and alpha blending
-    glEnable(GL_DEPTH_TEST);
+    RenderState::SetDepthTest(true);
 	glDepthFunc(GL_LEQUAL);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	RenderState::SetBlend(true);
+	RenderState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	
 	const Colour debugWhite(1.0f, 1.0f, 1.0f, 1.0f);
 	m_fullscreenQuad.SetVert2D(0, Vector(-1.0f, -1.0f, s_renderDepth2D), debugWhite, TexCoord(0.0f, 0.0f));
@@ -184,79 +339,62 @@ bool RenderManager::Startup(const Colour & a_clearColour, const char * a_shaderP
 	m_fullscreenQuad.SetVert2D(3, Vector(1.0f, 1.0f, s_renderDepth2D), debugWhite, TexCoord(1.0f, 1.0f));
 	m_fullscreenQuad.Bind();
 
-	m_debugBoxBuffer.Alloc(s_numDebugBoxVerts);
-	const Vector halfSize = 0.5f;
-	m_debugBoxBuffer.SetVertBasic(0, Vector(-halfSize.GetX(), -halfSize.GetY(), -halfSize.GetZ()), debugWhite);
-	m_debugBoxBuffer.SetVertBasic(1, Vector(-halfSize.GetX(), -halfSize.GetY(), halfSize.GetZ()), debugWhite);
-	m_debugBoxBuffer.SetVertBasic(2, Vector(halfSize.GetX(), -halfSize.GetY(), halfSize.GetZ()), debugWhite);
-	m_debugBoxBuffer.SetVertBasic(3, Vector(halfSize.GetX(), -halfSize.GetY(), -halfSize.GetZ()), debugWhite);
-	m_debugBoxBuffer.SetVertBasic(4, Vector(-halfSize.GetX(), halfSize.GetY(), -halfSize.GetZ()), debugWhite);
-	m_debugBoxBuffer.SetVertBasic(5, Vector(-halfSize.GetX(), halfSize.GetY(), halfSize.GetZ()), debugWhite);
-	m_debugBoxBuffer.SetVertBasic(6, Vector(halfSize.GetX(), halfSize.GetY(), halfSize.GetZ()), debugWhite);
-	m_debugBoxBuffer.SetVertBasic(7, Vector(halfSize.GetX(), halfSize.GetY(), -halfSize.GetZ()), debugWhite);
-	m_debugBoxBuffer.Bind();
-
-	m_debugSphereBuffer.Alloc(s_numDebugSphereVerts);
-	const int axisMax = 3;
-	const int numSegments = s_numDebugSphereVerts / axisMax / 2;
-	Vector lineStart = Vector(0.0f);
-	Vector lineEnd = Vector(0.0f);
-	int vertCount = 0;
-	for (int axisCount = 0; axisCount < axisMax; ++axisCount)
-	{
-		for (int i = 0; i < numSegments; ++i)
+	// Unit sphere rings for debug spheres, each segment is a line between neighbouring verts on a ring
+	for (int ring = 0; ring < 3; ++ring)
+	{
+		for (int i = 0; i < s_numDebugSphereSegments; ++i)
 		{
-			const float rFactor = ((float)i / (float)numSegments)*TAU;
-			const float rFactorNext = ((float)(i + 1) / (float)numSegments)*TAU;
-			switch (axisCount)
+			const float angle = ((float)i / (float)s_numDebugSphereSegments) * TAU;
+			const float sinAngle = sinf(angle);
+			const float cosAngle = cosf(angle);
+			const int vertId = ring * s_numDebugSphereSegments + i;
+			switch (ring)
 			{
-				case 0: // X axis 
-				{
-					lineStart = Vector(sin(rFactor), cos(rFactor), 0.0f);
-					lineEnd = Vector(sin(rFactorNext), cos(rFactorNext), 0.0f);
-					break;
-				}
-				case 1: // Y axis 
-				{
-					lineStart = Vector(0.0f, sin(rFactor), cos(rFactor));
-					lineEnd = Vector(0.0f, sin(rFactorNext), cos(rFactorNext));
-					break;
-				}
-				case 2: // Z axis 
-				{
-					lineStart = Vector(sin(rFactor), 0.0f, cos(rFactor));
-					lineEnd = Vector(sin(rFactorNext), 0.0f, cos(rFactorNext));
-					break;
-				}
-				default: break;
+				case 0: m_debugSphereVerts[vertId] = Vector(sinAngle, cosAngle, 0.0f); break;
+				case 1: m_debugSphereVerts[vertId] = Vector(0.0f, sinAngle, cosAngle); break;
+				default: m_debugSphereVerts[vertId] = Vector(sinAngle, 0.0f, cosAngle); break;
 			}
-			m_debugSphereBuffer.SetVertBasic(vertCount++, lineStart, debugWhite);
-			m_debugSphereBuffer.SetVertBasic(vertCount++, lineEnd, debugWhite);
+			m_debugSphereIndices[vertId * 2] = vertId;
+			m_debugSphereIndices[vertId * 2 + 1] = ring * s_numDebugSphereSegments + ((i + 1) % s_numDebugSphereSegments);
 		}
 	}
-	m_debugSphereBuffer.Bind();
+	m_numPersistentDebug = 0;
 
-	m_debugTransformBuffer.Alloc(s_numDebugTransformVerts);
-	m_debugTransformBuffer.SetVertBasic(0, Vector(0.0f), sc_colourRed);	// Red for X right axis left to right
-	m_debugTransformBuffer.SetVertBasic(1, Vector(1.0f, 0.0f, 0.0f), sc_colourRed);
-	m_debugTransformBuffer.SetVertBasic(2, Vector(0.0f), sc_colourGreen);	// Green for Y axis look forward
-	m_debugTransformBuffer.SetVertBasic(3, Vector(0.0f, 1.0f, 0.0f), sc_colourGreen);
-	m_debugTransformBuffer.SetVertBasic(4, Vector(0.0f), sc_colourBlue);	// Blue for Z axis up
-	m_debugTransformBuffer.SetVertBasic(5, Vector(0.0f, 0.0f, 1.0f), sc_colourBlue);
-	m_debugTransformBuffer.Bind();
+	// Font runs draw each character as a fan of two triangles
+	static const unsigned int fontCharIndices[] = { 0, 1, 2, 0, 2, 3 };
+	for (int i = 0; i < s_maxFontRunGlyphs; ++i)
+	{
+		for (int j = 0; j < 6; ++j)
+		{
+			m_fontRunIndices[i * 6 + j] = i * 4 + fontCharIndices[j];
+		}
+	}
 
 	// Storage for all the primitives
 	bool renderLayerAlloc = true;
+	const int maxTris = s_maxObjects[(int)RenderObjectType::Tris];
+	const int maxQuads = s_maxObjects[(int)RenderObjectType::Quads];
+	const int maxLines = s_maxObjects[(int)RenderObjectType::Lines];
+	const int maxDebugVerts =	s_maxObjects[(int)RenderObjectType::DebugBoxes] * s_numDebugBoxVerts +
+								s_maxObjects[(int)RenderObjectType::DebugSpheres] * s_numDebugSphereVerts +
+								s_maxObjects[(int)RenderObjectType::DebugTransforms] * s_numDebugTransformVerts;
+	const int maxDebugIndices =	s_maxObjects[(int)RenderObjectType::DebugBoxes] * s_numDebugBoxIndices +
+								s_maxObjects[(int)RenderObjectType::DebugSpheres] * s_numDebugSphereIndices +
+								s_maxObjects[(int)RenderObjectType::DebugTransforms] * s_numDebugTransformVerts;
+	const int maxFontChars = s_maxObjects[(int)RenderObjectType::FontChars];
 	for (unsigned int i = 0; i < static_cast<int>(RenderLayer::Count); ++i)
 	{
-		m_tris[i] = new Tri[s_maxObjects[(int)RenderObjectType::Tris]];
-		m_quads[i] = new Quad[s_maxObjects[(int)RenderObjectType::Quads]];
-		m_lines[i] = new Line[s_maxObjects[(int)RenderObjectType::Lines]];
-		m_debugBoxes[i] = new DebugBox[s_maxObjects[(int)RenderObjectType::DebugBoxes]];
-		m_debugSpheres[i] = new DebugSphere[s_maxObjects[(int)RenderObjectType::DebugSpheres]];
-		m_debugTransforms[i] = new DebugTransform[s_maxObjects[(int)RenderObjectType::DebugTransforms]];
+		// Worst case for batches is every primitive having a different texture to the last
+		m_triGeometry[i].Alloc((maxTris * 3) + (maxQuads * 4), (maxTris * 3) + (maxQuads * 6), maxTris + maxQuads);
+		m_triGeometry[i].Bind();
+		m_fontGeometry[i].Alloc(maxFontChars * 4, maxFontChars * 6, maxFontChars);
+		m_fontGeometry[i].Bind();
+
+		// Debug shapes are expanded into the Debug3D line stream so it has room for them on top of plain lines
+		const bool debugLayer = i == static_cast<int>(RenderLayer::Debug3D);
+		m_lineGeometry[i].Alloc(maxLines * 2 + (debugLayer ? maxDebugVerts : 0), maxLines * 2 + (debugLayer ? maxDebugIndices : 0), 1);
+		m_lineGeometry[i].Bind();
 		m_models[i] = new RenderModel[s_maxObjects[(int)RenderObjectType::Models]];
-		m_fontChars[i] = new FontChar[s_maxObjects[(int)RenderObjectType::FontChars]];
 
 		// Reset the counts for all types
 		for (int j = 0; j < static_cast<int>(RenderObjectType::Count); ++j)
@@ -266,8 +404,29 @@ bool RenderManager::Startup(const Colour & a_clearColour, const char * a_shaderP
 	}
 
 	const int numModels = s_maxObjects[(int)RenderObjectType::Models];
-	m_sortedRenderModelPool = new SortedRenderModel[numModels];
-	m_sortedRenderNodePool = new SortedRenderNode[numModels];
+	m_modelSortKeys = new uint64_t[numModels];
+	m_modelSortKeysTemp = new uint64_t[numModels];
+	m_modelSortIds = new int[numModels];
+	m_modelSortIdsTemp = new int[numModels];
+	m_instanceData = new InstanceData[numModels];
+
+	// One stream of per instance attributes, each instanced draw points its attributes at a range inside it
+	glGenBuffers(1, &m_instanceBufferId);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferId);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * numModels, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Mesh ids are handed out from the bottom of the stack first, arenas are created on demand
+	m_numFreeMeshIds = 0;
+	for (int i = s_maxMeshes - 1; i >= 0; --i)
+	{
+		m_freeMeshIds[m_numFreeMeshIds++] = i;
+	}
+
+	// Attributes a vertex array leaves disabled read these constants, model buffers have no colour and
+	// every other buffer has no packed normal so the shader falls back to the float normal when w is zero
+	glVertexAttrib4f(1, 1.0f, 1.0f, 1.0f, 1.0f);
+	glVertexAttrib4f(Shader::s_vertexOctNormalAttrib, 0.0f, 0.0f, 0.0f, 0.0f);
 
 	// Alert if memory allocation failed
 	if (!renderLayerAlloc)
@@ -275,12 +434,16 @@ bool RenderManager::Startup(const Colour & a_clearColour, const char * a_shaderP
 		Log::Get().Write(LogLevel::Error, LogCategory::Engine, "RenderManager failed to allocate renderLayer/primitive memory!");
 	}
 
+	// Uniform blocks are shared by all shaders so must exist before any are created
+	const bool uniformBuffersOk = Shader::InitUniformBuffers();
+
 	// Setup default shaders
 	#include "Shaders/post.vsh.h"
 	#include "Shaders/post.fsh.h"
 	#include "Shaders/colour.vsh.h"
 	#include "Shaders/colour.fsh.h"
 	#include "Shaders/texture.vsh.h"
+	#include "Shaders/textureInstanced.vsh.h"
 	#include "Shaders/texture.fsh.h"
 	#include "Shaders/lighting.vsh.h"
 	#include "Shaders/lighting.fsh.h"
@@ -301,6 +464,10 @@ bool RenderManager::Startup(const Colour & a_clearColour, const char * a_shaderP
 	{
 		m_textureShader->Init(textureVertexShader, textureFragmentShader);
 	}
+	if (m_textureInstancedShader = new Shader("textureInstanced"))
+	{
+		m_textureInstancedShader->Init(textureInstancedVertexShader, textureFragmentShader);
+	}
 	if (m_lightingShader = new Shader("lighting"))
 	{
 		m_lightingShader->Init(lightingVertexShader, lightingFragmentShader);
@@ -393,15 +560,18 @@ bool RenderManager::Startup(const Colour & a_clearColour, const char * a_shaderP
 	m_vr = a_vr;
 
     return renderLayerAlloc && 
+			uniformBuffersOk &&
 			m_postShader != nullptr &&
 			m_colourShader != nullptr &&
 			m_textureShader != nullptr &&
+			m_textureInstancedShader != nullptr &&
 			m_lightingShader != nullptr &&
 			m_particleShader != nullptr &&
 			m_finalShader != nullptr &&
 			m_postShader->IsCompiled() &&
 			m_colourShader->IsCompiled() && 
 			m_textureShader->IsCompiled() && 
+			m_textureInstancedShader->IsCompiled() &&
 			m_lightingShader->IsCompiled() &&
 			m_particleShader->IsCompiled() &&
 			m_finalShader->IsCompiled();
@@ -410,66 +580,37 @@ bool RenderManager::Startup(const Colour & a_clearColour, const char * a_shaderP
 bool RenderManager::Shutdown()
 {
 	m_fullscreenQuad.Unbind();
-	m_debugBoxBuffer.Unbind();
-	m_debugSphereBuffer.Unbind();
-
 	m_fullscreenQuad.Dealloc();
-	m_debugBoxBuffer.Dealloc();
-	m_debugSphereBuffer.Dealloc();
+	m_numPersistentDebug = 0;
 
 	// Clean up shared vertex storage
-	for (int i = 0; i < s_maxModelBuffers; ++i)
+	for (int i = 0; i < m_numMeshArenas; ++i)
 	{
-		RenderModelBuffer * r = &m_modelBuffers[i];
-		if (r->m_vertexArrayId == 0 && r->m_vertexBufferId == 0 && r->m_indexBufferId == 0)
-		{
-			r->Unbind();
-		}
+		m_meshArenas[i].Shutdown();
+	}
+	m_numMeshArenas = 0;
+	for (int i = 0; i < s_maxMeshes; ++i)
+	{
+		m_meshes[i] = MeshAllocation();
 	}
 
 	// Clean up storage for all primitives
 	for (unsigned int i = 0; i < static_cast<int>(RenderLayer::Count); ++i)
 	{
-		for (int j = 0; j < s_maxObjects[(int)RenderObjectType::Tris]; ++j)
+		DynamicGeometry * layerGeometry[] = { &m_triGeometry[i], &m_fontGeometry[i], &m_lineGeometry[i] };
+		for (DynamicGeometry * geometry : layerGeometry)
 		{
-			Tri * t = m_tris[i] + j;
-			if (t->m_vertexArrayId == 0 && t->m_vertexBufferId == 0 && t->m_indexBufferId == 0)
+			if (geometry->m_vertexArrayId != 0)
 			{
-				t->Unbind();
-			}
-		}
-
-		for (int j = 0; j < s_maxObjects[(int)RenderObjectType::Quads]; ++j)
-		{
-			Quad * q = m_quads[i] + j;
-			if (q->m_vertexArrayId == 0 && q->m_vertexBufferId == 0 && q->m_indexBufferId == 0)
-			{
-				q->Unbind();
-			}
-		}
-
-		for (int j = 0; j < s_maxObjects[(int)RenderObjectType::Lines]; ++j)
-		{
-			Line * l = m_lines[i] + j;
-			if (l->m_vertexArrayId == 0 && l->m_vertexBufferId == 0 && l->m_indexBufferId == 0)
-			{
-				l->Unbind();
+				geometry->Unbind();
 			}
+			geometry->Dealloc();
 		}
 
 		for (int j = 0; j < s_maxObjects[(int)RenderObjectType::Models]; ++j)
 		{
 			RenderModel * r = m_models[i] + j;
-			r->m_buffer = nullptr;
-		}
-
-		for (int j = 0; j < s_maxObjects[(int)RenderObjectType::FontChars]; ++j)
-		{
-			FontChar * fc = m_fontChars[i] + j;
-			if (fc->m_vertexArrayId == 0 && fc->m_vertexBufferId == 0 && fc->m_indexBufferId == 0)
-			{
-				fc->Unbind();
-			}
+			r->m_meshId = -1;
 		}
 
 		for (int j = 0; j < static_cast<int>(RenderObjectType::Count); ++j)
@@ -480,18 +621,16 @@ bool RenderManager::Shutdown()
 
 	for (unsigned int i = 0; i < static_cast<int>(RenderLayer::Count); ++i)
 	{
-		delete[] m_tris[i];
-		delete[] m_quads[i];
-		delete[] m_lines[i];
-		delete[] m_debugBoxes[i];
-		delete[] m_debugSpheres[i];
-		delete[] m_debugTransforms[i];
 		delete[] m_models[i];
-		delete[] m_fontChars[i];
 	}
 
-	delete[] m_sortedRenderModelPool;
-	delete[] m_sortedRenderNodePool;
+	delete[] m_modelSortKeys;
+	delete[] m_modelSortKeysTemp;
+	delete[] m_modelSortIds;
+	delete[] m_modelSortIdsTemp;
+	delete[] m_instanceData;
+	glDeleteBuffers(1, &m_instanceBufferId);
+	m_instanceBufferId = 0;
 
 	// Clean up all emitters
 	for (unsigned int i = 0; i < s_maxParticleEmitters; ++i)
@@ -523,6 +662,10 @@ bool RenderManager::Shutdown()
 	{
 		delete m_textureShader;
 	}
+	if (m_textureInstancedShader != nullptr)
+	{
+		delete m_textureInstancedShader;
+	}
 	if (m_lightingShader != nullptr)
 	{
 		delete m_lightingShader;
@@ -540,6 +683,8 @@ bool RenderManager::Shutdown()
 	for (int i = 0; i < static_cast<int>(RenderStage::Count); ++i)
 	{
 		glDeleteFramebuffers(1, &m_frameBuffers[i]);
+		RenderState::ForgetTexture(m_colourBuffers[i]);
+		RenderState::ForgetTexture(m_depthBuffers[i]);
 		glDeleteTextures(1, &m_colourBuffers[i]);
 		glDeleteTextures(1, &m_depthBuffers[i]);
 	}
@@ -547,6 +692,7 @@ bool RenderManager::Shutdown()
 	// And render targets
 	for (int i = 0; i < s_numRenderTargets; ++i)
 	{
+		RenderState::ForgetTexture(m_renderTargets[i]);
 		glDeleteTextures(1, &m_renderTargets[i]);
 	}
 
@@ -561,6 +707,7 @@ bool RenderManager::Shutdown()
 	{
 		m_shaders.Remove(cur);
 	});
+	Shader::ShutdownUniformBuffers();
 	
 	return true;
 }
@@ -570,6 +717,32 @@ bool RenderManager::Update(float a_dt)
 	m_lastRenderTime = a_dt;
 	m_renderTime += a_dt;
 	m_drawCallCounter = 0;
+	m_batchCounter = 0;
+	m_batchedPrimitiveCounter = 0;
+	RenderState::ResetCounters();
+
+	// Expire persistent debug shapes then queue the rest for this frame
+	int persistentId = 0;
+	while (persistentId < m_numPersistentDebug)
+	{
+		const PersistentDebugPrimitive & prim = m_persistentDebug[persistentId];
+		if (m_renderTime > prim.m_expiryTime)
+		{
+			m_persistentDebug[persistentId] = m_persistentDebug[--m_numPersistentDebug];
+			continue;
+		}
+
+		switch (prim.m_type)
+		{
+			case PersistentDebugPrimitive::Type::Line:		AddDebugLine(prim.m_pos, prim.m_size, prim.m_colour); break;
+			case PersistentDebugPrimitive::Type::AxisBox:	AddDebugAxisBox(prim.m_pos, prim.m_size, prim.m_colour); break;
+			case PersistentDebugPrimitive::Type::Box:		AddDebugBox(prim.m_mat, prim.m_size, prim.m_colour); break;
+			case PersistentDebugPrimitive::Type::Sphere:	AddDebugSphere(prim.m_pos, prim.m_size.GetX(), prim.m_colour); break;
+			case PersistentDebugPrimitive::Type::Transform:	AddDebugTransform(prim.m_mat); break;
+			default: break;
+		}
+		++persistentId;
+	}
 
 	// Update and recycle particle systems from the end
 	if (m_numParticleEmitters > 0)
@@ -750,12 +923,11 @@ bool RenderManager::Resize(unsigned int a_viewWidth, unsigned int a_viewHeight,
 	{
 		// Generate whole scene render targets
 		glGenFramebuffers(1, &m_frameBuffers[i]);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[i]);
+		RenderState::BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[i]);
 		glGenTextures(1, &m_colourBuffers[i]);       
 
 		// Colour parameters
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_colourBuffers[i]);
+		RenderState::BindTexture(0, m_colourBuffers[i]);
  		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_viewWidth, m_viewHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
@@ -764,12 +936,12 @@ bool RenderManager::Resize(unsigned int a_viewWidth, unsigned int a_viewHeight,
 	}
 
 	// Create render targets for general use and attach them to colour attachments after 0
-	glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[static_cast<int>(RenderStage::Scene)]);
+	RenderState::BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[static_cast<int>(RenderStage::Scene)]);
 	m_mrtAttachments[0] = GL_COLOR_ATTACHMENT0;
 	for (int i = 0; i < s_numRenderTargets; ++i)
 	{
 		glGenTextures(1, &m_renderTargets[i]);
-		glBindTexture(GL_TEXTURE_2D, m_renderTargets[i]);
+		RenderState::BindTexture(0, m_renderTargets[i]);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_viewWidth, m_viewHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
@@ -782,19 +954,19 @@ bool RenderManager::Resize(unsigned int a_viewWidth, unsigned int a_viewHeight,
 	for (int i = 0; i < static_cast<int>(RenderStage::Count); ++i)
 	{
 		glGenTextures(1, &m_depthBuffers[i]);
-		glBindTexture(GL_TEXTURE_2D, m_depthBuffers[i]);
+		RenderState::BindTexture(0, m_depthBuffers[i]);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, m_viewWidth, m_viewHeight, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, 0);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[i]);
+		RenderState::BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[i]);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthBuffers[i], 0);
 	}
 	framebuffersOk |= glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	RenderState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 	return framebuffersOk;
 }
 
@@ -809,24 +981,25 @@ void RenderManager::DrawToScreen(Matrix & a_viewMatrix)
 	shaderData.m_depthBuffer = m_depthBuffers[static_cast<int>(RenderStage::Scene)];
 
 	// Do offscreen rendering pass to first stage framebuffer
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, 0);         
-	glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[static_cast<int>(RenderStage::Scene)]);		//<< Render to first stage render buffer
+	RenderState::BindTexture(0, 0);         
+	RenderState::BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[static_cast<int>(RenderStage::Scene)]);		//<< Render to first stage render buffer
 	glDrawBuffers(s_numRenderTargets + 1, m_mrtAttachments);					//<< Enable drawing into all colour attachments
 	
 	// The game's shaders will write into all the MRT's called GBuffer(1-9)Colour
 	RenderScene(a_viewMatrix);
 
 	// Start rendering to the first render stage
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_colourBuffers[static_cast<int>(RenderStage::Scene)]);			//<< Render using first stage buffer
-	glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[static_cast<int>(RenderStage::PostFX)]);		//<< Render to first stage colour
+	RenderState::BindTexture(0, m_colourBuffers[static_cast<int>(RenderStage::Scene)]);			//<< Render using first stage buffer
+	RenderState::BindFramebuffer(GL_FRAMEBUFFER, m_frameBuffers[static_cast<int>(RenderStage::PostFX)]);		//<< Render to first stage colour
 
 	glViewport(0, 0, (GLint)m_viewWidth, (GLint)m_viewHeight);
-    glDisable(GL_DEPTH_TEST);
+    RenderState::SetDepthTest(false);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	// Rendering the scene left the last layer's view and lights in the frame block, the full screen passes share one set
+	Shader::SetFrameData(shaderData);
+
 	// Now render with full scene shader if specified which will compile the influence of GBuffer(1-9)Colour into FragmentColour
 	bool bUseDefaultShader = true;
 	if (Scene * pCurScene = WorldManager::Get().GetCurrentScene())
@@ -855,18 +1028,17 @@ void RenderManager::DrawToScreen(Matrix & a_viewMatrix)
 	RenderFramebuffer();
 	
 	// Now draw framebuffer to screen, buffer index 0 breaks the existing binding 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	RenderState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 	glDrawBuffers(1, m_mrtAttachments);
 
-    glDisable(GL_DEPTH_TEST);
+    RenderState::SetDepthTest(false);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	m_finalShader->UseShader(shaderData);
 
 	// Output of the previous pass goes in the DiffuseTexture slot for the final render
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_colourBuffers[static_cast<int>(RenderStage::PostFX)]);
+	RenderState::BindTexture(0, m_colourBuffers[static_cast<int>(RenderStage::PostFX)]);
 
 	RenderFramebuffer();
 
@@ -881,10 +1053,10 @@ void RenderManager::DrawToScreen(Matrix & a_viewMatrix)
 			const GLint rtSizeY = (GLint)m_viewHeight / s_numRenderTargets;
 			for (int i = 0; i < s_numRenderTargets; ++i)
 			{
-				glBindFramebuffer(GL_READ_FRAMEBUFFER, m_colourBuffers[static_cast<int>(RenderStage::Scene)]);
+				RenderState::BindFramebuffer(GL_READ_FRAMEBUFFER, m_colourBuffers[static_cast<int>(RenderStage::Scene)]);
 				glDrawBuffers(1, m_mrtAttachments);
 				glReadBuffer(GL_COLOR_ATTACHMENT1 + i);
-				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+				RenderState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 				GLint xImageStart = borderSize + (i * (rtSizeX + borderSize));
 				glBlitFramebuffer(0, 0, (GLint)m_viewWidth, (GLint)m_viewHeight, xImageStart, borderSize, xImageStart + rtSizeX, rtSizeY, GL_COLOR_BUFFER_BIT, GL_LINEAR);
 			}
@@ -893,13 +1065,20 @@ void RenderManager::DrawToScreen(Matrix & a_viewMatrix)
 #endif
 	
 	// Unbind shader
-    glUseProgram(0);
-    glEnable(GL_DEPTH_TEST);
+    RenderState::UseProgram(0);
+    RenderState::SetDepthTest(true);
+}
+
+Matrix RenderManager::GetPerspectiveMatrix() const
+{
+	// Built from the view size rather than the cached aspect so render targets sized without Resize match too
+	const float aspect = m_viewHeight > 0 ? (float)m_viewWidth / (float)m_viewHeight : 1.0f;
+	return Matrix::Perspective(s_fovAngleY, aspect, s_nearClipPlane, s_farClipPlane);
 }
 
 void RenderManager::RenderScene(Matrix & a_viewMatrix, bool a_flushBuffers)
 {
-	Matrix perspectiveMatrix = Matrix::Perspective(s_fovAngleY, 1.33334f /*m_aspect*/, s_nearClipPlane, s_farClipPlane);
+	Matrix perspectiveMatrix = GetPerspectiveMatrix();
 	RenderScene(a_viewMatrix, perspectiveMatrix, a_flushBuffers, true);
 }
 
@@ -917,25 +1096,20 @@ void RenderManager::RenderScene(Matrix & a_viewMatrix, Matrix & a_perspectiveMat
 	}
 	shaderData.m_depthBuffer = m_depthBuffers[static_cast<int>(RenderStage::Scene)];
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_colourBuffers[static_cast<int>(RenderStage::Scene)]);	// Diffuse
-
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_2D, m_renderTargets[0]);					// GBuffers follow
-	glActiveTexture(GL_TEXTURE4);
-	glBindTexture(GL_TEXTURE_2D, m_renderTargets[1]);
-	glActiveTexture(GL_TEXTURE5);
-	glBindTexture(GL_TEXTURE_2D, m_renderTargets[2]);
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, m_renderTargets[3]);
-	glActiveTexture(GL_TEXTURE7);
-	glBindTexture(GL_TEXTURE_2D, m_renderTargets[4]);
-	glActiveTexture(GL_TEXTURE8);
-	glBindTexture(GL_TEXTURE_2D, m_renderTargets[5]);
-
-	glActiveTexture(GL_TEXTURE9);
-	glBindTexture(GL_TEXTURE_2D, m_depthBuffers[static_cast<int>(RenderStage::Scene)]);
+	RenderState::BindTexture(0, m_colourBuffers[static_cast<int>(RenderStage::Scene)]);	// Diffuse
+
+	RenderState::BindTexture(3, m_renderTargets[0]);					// GBuffers follow
+	RenderState::BindTexture(4, m_renderTargets[1]);
+	RenderState::BindTexture(5, m_renderTargets[2]);
+	RenderState::BindTexture(6, m_renderTargets[3]);
+	RenderState::BindTexture(7, m_renderTargets[4]);
+	RenderState::BindTexture(8, m_renderTargets[5]);
+
+	RenderState::BindTexture(9, m_depthBuffers[static_cast<int>(RenderStage::Scene)]);
 	
+	// Models are depth sorted by distance from the camera, the view matrix is the inverse of the camera
+	const Vector viewPos = a_viewMatrix.GetInverse().GetPos();
+
 	// Set the lights in the scene for the shader
 	Scene * curScene = WorldManager::Get().GetCurrentScene();
 	if (curScene != nullptr && curScene->HasLights())
@@ -959,6 +1133,9 @@ void RenderManager::RenderScene(Matrix & a_viewMatrix, Matrix & a_perspectiveMat
 				{
 					m_objectCount[i][j] = 0;
 				}
+				m_triGeometry[i].Reset();
+				m_fontGeometry[i].Reset();
+				m_lineGeometry[i].Reset();
 			}
 			return;
 		}
@@ -1025,122 +1202,26 @@ void RenderManager::RenderScene(Matrix & a_viewMatrix, Matrix & a_perspectiveMat
 			//glClear(GL_DEPTH_BUFFER_BIT);
 		}
 
-		// Use the texture shader on world objects
-		Shader * pLastShader = m_textureShader;
+		// View, projection and lights are the same for every draw in the layer
+		Shader::SetFrameData(shaderData);
 
-		// Submit the tris
-		Tri * t = m_tris[i];
-		for (int j = 0; j < m_objectCount[i][static_cast<int>(RenderObjectType::Tris)]; ++j)
-		{
-			// Draw a tri with a texture
-			if (t->m_textureId >= 0)
-			{
-				if (pLastShader != m_textureShader)
-				{
-					pLastShader = m_textureShader;
-				}
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, t->m_textureId);
-			}
-			else // Flat colour triangles
-			{
-				if (pLastShader != m_colourShader)
-				{
-					pLastShader = m_colourShader;
-				}
-			}
-			
-			pLastShader->UseShader(shaderData);
-
-			glBindVertexArray(t->m_vertexArrayId);
-			glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, 0);
-
-			++t;
-			++m_drawCallCounter;
-		}
-
-		// Submit the quads
-		Quad * q = m_quads[i];
+		// Submit the tris and quads, one draw for each run that shares a texture and shader
 		shaderData.m_objectMatrix = &m_shaderIdentityMat;
-		for (int j = 0; j < m_objectCount[i][static_cast<int>(RenderObjectType::Quads)]; ++j)
-		{
-			// Draw a quad with a texture
-			if (q->m_textureId >= 0)
-			{
-				if (pLastShader != m_textureShader)
-				{
-					pLastShader = m_textureShader;
-				}
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, q->m_textureId);
-			}
-			else // Flat colour quads
-			{
-				if (pLastShader != m_colourShader)
-				{
-					pLastShader = m_colourShader;
-				}
-			}
-
-			pLastShader->UseShader(shaderData);
-			glBindVertexArray(q->m_vertexArrayId);
-			glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, 0);
-			
-			++q;
-			++m_drawCallCounter;
-		}
+		DrawDynamicGeometry(m_triGeometry[i], GL_TRIANGLES, shaderData);
 		
-		// Generate sorted list of models
-		LinkedList<SortedRenderModel> modelSort;
-		for (int j = 0; j < m_objectCount[i][static_cast<int>(RenderObjectType::Models)]; ++j)
+		// Draw models in sort key order so state changes are minimised and identical models share instanced draws
+		if (m_objectCount[i][static_cast<int>(RenderObjectType::Models)] > 0)
 		{
-			RenderModel * rm = m_models[i] + j;
-			SortedRenderModel * curSortedModel = m_sortedRenderModelPool + j;
-			SortedRenderNode * curSortedNode = m_sortedRenderNodePool + j;
-			const float dist = (rm->m_mat->GetPos() - shaderData.m_viewMatrix->GetPos()).LengthSquared();
-			curSortedModel->m_id = j;
-			curSortedModel->m_distance = dist;
-			m_sortedRenderNodePool[j].SetData(curSortedModel);
-			modelSort.Insert(curSortedNode);
-		}
-
-		// Draw models by calling their VBOs
-		Shader * pLastModelShader = nullptr;	
-		SortedRenderNode * curNode = modelSort.GetHead();
-		while (curNode != nullptr)
-		{
-			RenderModel * rm = m_models[i] + curNode->GetData()->m_id;
-			pLastModelShader = rm->m_shader == nullptr ? m_textureShader : rm->m_shader;
 			shaderData.m_projectionMatrix = &a_perspectiveMat;
 			shaderData.m_viewMatrix = &a_viewMatrix;
-			shaderData.m_objectMatrix = rm->m_mat;
-			shaderData.m_lifeTime = rm->m_lifeTime;
-			shaderData.m_materialShininess = rm->m_shininess;
-			shaderData.m_materialAmbient = rm->m_ambient;
-			shaderData.m_materialDiffuse = rm->m_diffuse;
-			shaderData.m_materialSpecular = rm->m_specular;
-			shaderData.m_materialEmission = rm->m_emission;
-			shaderData.m_shaderData = rm->m_shaderData;
-			pLastModelShader->UseShader(shaderData);
-
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, rm->m_diffuseTexId);
-			glActiveTexture(GL_TEXTURE1);
-			glBindTexture(GL_TEXTURE_2D, rm->m_normalTexId);
-			glActiveTexture(GL_TEXTURE2);
-			glBindTexture(GL_TEXTURE_2D, rm->m_specularTexId);
-
-			glBindVertexArray(rm->m_buffer->m_vertexArrayId);
-			glDrawElements(GL_TRIANGLES, rm->m_buffer->m_numVerts, GL_UNSIGNED_INT, 0);
-			curNode = curNode->GetNext();
-
-			++m_drawCallCounter;
+			Shader::SetFrameData(shaderData);
+			DrawModels(i, viewPos, shaderData);
 		}
 		
 		// Draw particles by calling their VBOs but make sure it's after all the world geo
 		if (i == static_cast<int>(RenderLayer::World))
 		{
-			pLastShader = m_particleShader;
+			Shader * pLastShader = m_particleShader;
 			Matrix particleMat = Matrix::Identity();
 			for (int j = 0; j < m_numParticleEmitters; ++j)
 			{
@@ -1152,107 +1233,186 @@ void RenderManager::RenderScene(Matrix & a_viewMatrix, Matrix & a_perspectiveMat
 					particleMat.SetPos(em.m_position);
 					shaderData.m_objectMatrix = &particleMat;
 					pLastShader->UseShader(shaderData);
-					glBindVertexArray(em.m_vertexArrayId);
+					RenderState::BindVertexArray(em.m_vertexArrayId);
 					glDrawElements(GL_POINTS, em.m_numParticles, GL_UNSIGNED_INT, 0);
 				}
 				++m_drawCallCounter;
 			}
 		}
 		
-		// Draw font chars by calling their VBOs
-		if (pLastShader != m_textureShader && m_objectCount[i][static_cast<int>(RenderObjectType::FontChars)] > 0)
+		// Draw font chars, they are already positioned and scaled so share the identity transform
+		shaderData.m_objectMatrix = &m_shaderIdentityMat;
+		DrawDynamicGeometry(m_fontGeometry[i], GL_TRIANGLES, shaderData);
+		
+		// Draw lines and debug shapes in the current renderLayer, they are always in a single colour shader batch with colour in the verts
+		shaderData.m_materialAmbient = Vector(1.0f);
+		DrawDynamicGeometry(m_lineGeometry[i], GL_LINES, shaderData);
+		
+		// Flush the renderLayers if we are not rendering more than once
+		if (a_flushBuffers)
 		{
-			pLastShader = m_textureShader;
+			for (int j = 0; j < static_cast<int>(RenderObjectType::Count); ++j)
+			{
+				m_objectCount[i][j] = 0;
+			}
+			m_triGeometry[i].Reset();
+			m_fontGeometry[i].Reset();
+			m_lineGeometry[i].Reset();
 		}
+	}
+}
 
-		FontChar * fc = m_fontChars[i];
-		Matrix fontCharMat = Matrix::Identity();
-		for (int j = 0; j < m_objectCount[i][static_cast<int>(RenderObjectType::FontChars)]; ++j)
-		{
-			fontCharMat.SetIdentity();
-			fontCharMat.SetPos(fc->m_pos);
-			fontCharMat.SetScale(fc->m_scale);
-			shaderData.m_objectMatrix = &fontCharMat;
+void RenderManager::DrawModels(int a_layer, const Vector & a_viewPos, Shader::UniformData & a_shaderData)
+{
+	const int numModels = m_objectCount[a_layer][static_cast<int>(RenderObjectType::Models)];
+	if (numModels <= 0)
+	{
+		return;
+	}
 
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, fc->m_textureId);
+	// Build a key for every model then sort them all at once
+	RenderModel * models = m_models[a_layer];
+	for (int i = 0; i < numModels; ++i)
+	{
+		const RenderModel & rm = models[i];
+		const Shader * modelShader = rm.m_shader == nullptr ? m_textureInstancedShader : rm.m_shader;
+		const bool transparent = rm.m_material != nullptr && rm.m_material->IsTransparent();
+		const float depth = (rm.m_mat->GetPos() - a_viewPos).Length();
+		m_modelSortKeys[i] = MakeModelSortKey(a_layer, transparent, modelShader->GetSortId(), rm.m_diffuseTexId, rm.m_meshId, depth);
+		m_modelSortIds[i] = i;
+	}
+	RadixSort::Sort(m_modelSortKeys, m_modelSortIds, m_modelSortKeysTemp, m_modelSortIdsTemp, numModels);
 
-			pLastShader->UseShader(shaderData);
+	// Pack the per instance data in draw order and upload it all at once
+	for (int i = 0; i < numModels; ++i)
+	{
+		const RenderModel & rm = models[m_modelSortIds[i]];
+		InstanceData & inst = m_instanceData[i];
+		memcpy(&inst.m_mat[0], rm.m_mat->GetTranspose().GetValues(), sizeof(inst.m_mat));
+		inst.m_shaderData = rm.m_shaderData;
+		inst.m_lifeTime = rm.m_lifeTime;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferId);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * s_maxObjects[(int)RenderObjectType::Models], nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(InstanceData) * numModels, m_instanceData);
 
-			glBindVertexArray(fc->m_vertexArrayId);
-			glDrawElements(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_INT, 0);
-			++fc;
-		}
-		
-		// Switch to colour shader for things made of lines as they cannot be textured
-		shaderData.m_objectMatrix->SetIdentity();
-		m_colourShader->UseShader(shaderData);
-		
-		// Draw lines in the current renderLayer
-		Line * l = m_lines[i];
-		Matrix lineMat = Matrix::Identity();
-		for (int j = 0; j < m_objectCount[i][static_cast<int>(RenderObjectType::Lines)]; ++j)
+	// Walk runs of models that share a mesh, shader and texture set
+	int runStart = 0;
+	while (runStart < numModels)
+	{
+		const RenderModel & first = models[m_modelSortIds[runStart]];
+		int runEnd = runStart + 1;
+		while (runEnd < numModels)
 		{
-			glBindVertexArray(l->m_vertexArrayId);
-			glDrawElements(GL_LINES, 2, GL_UNSIGNED_INT, 0);
-			++l;
+			const RenderModel & cur = models[m_modelSortIds[runEnd]];
+			if (cur.m_meshId != first.m_meshId || cur.m_shader != first.m_shader ||
+				cur.m_diffuseTexId != first.m_diffuseTexId || cur.m_normalTexId != first.m_normalTexId || cur.m_specularTexId != first.m_specularTexId)
+			{
+				break;
+			}
+			++runEnd;
 		}
 
-		// Draw lines in the current renderLayer
-		DebugBox * b = m_debugBoxes[i];
-		Matrix debugBoxMat = Matrix::Identity();
-		for (int j = 0; j < m_objectCount[i][static_cast<int>(RenderObjectType::DebugBoxes)]; ++j)
+		RenderState::BindTexture(0, first.m_diffuseTexId);
+		RenderState::BindTexture(1, first.m_normalTexId);
+		RenderState::BindTexture(2, first.m_specularTexId);
+		const MeshAllocation & mesh = m_meshes[first.m_meshId];
+		const void * indexOffset = (unsigned char*)nullptr + mesh.m_indexOffset * sizeof(unsigned int);
+		RenderState::BindVertexArray(m_meshArenas[mesh.m_arena].m_vertexArrayId);
+
+		Shader * runShader = first.m_shader == nullptr ? m_textureInstancedShader : first.m_shader;
+		if (runShader->IsInstanced())
 		{
-			debugBoxMat.SetScale(b->m_scale);
-			debugBoxMat.SetPos(b->m_pos);
-			shaderData.m_objectMatrix = &debugBoxMat;
-			shaderData.m_materialAmbient = b->m_colour;
-			m_colourShader->UseShader(shaderData);
-			glBindVertexArray(m_debugBoxBuffer.m_vertexArrayId);
-			glDrawElements(GL_LINE_LOOP, s_numDebugBoxVerts, GL_UNSIGNED_INT, 0);
-			++b;
+			// Uniforms that are the same for every instance come from the first model in the run
+			SetModelShaderData(first, a_shaderData);
+			runShader->UseShader(a_shaderData);
+
+			// GL 4.0 has no base instance so point the instance attributes of the mesh VAO at the start of the run
+			glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferId);
+			const size_t runOffset = sizeof(InstanceData) * runStart;
+			for (int col = 0; col < 4; ++col)
+			{
+				const int attrib = Shader::s_instanceMatrixAttrib + col;
+				glEnableVertexAttribArray(attrib);
+				glVertexAttribPointer(attrib, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(runOffset + offsetof(InstanceData, m_mat) + sizeof(float) * 4 * col));
+				glVertexAttribDivisor(attrib, 1);
+			}
+			glEnableVertexAttribArray(Shader::s_instanceShaderDataAttrib);
+			glVertexAttribPointer(Shader::s_instanceShaderDataAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(runOffset + offsetof(InstanceData, m_shaderData)));
+			glVertexAttribDivisor(Shader::s_instanceShaderDataAttrib, 1);
+			glEnableVertexAttribArray(Shader::s_instanceLifeTimeAttrib);
+			glVertexAttribPointer(Shader::s_instanceLifeTimeAttrib, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(runOffset + offsetof(InstanceData, m_lifeTime)));
+			glVertexAttribDivisor(Shader::s_instanceLifeTimeAttrib, 1);
+
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.m_numIndices, mesh.m_indexType, indexOffset, runEnd - runStart, mesh.m_baseVertex);
+			++m_drawCallCounter;
 		}
-
-		// Draw spheres in the current renderLayer
-		DebugSphere * s = m_debugSpheres[i];
-		Matrix debugSphereMat = Matrix::Identity();
-		for (int j = 0; j < m_objectCount[i][static_cast<int>(RenderObjectType::DebugSpheres)]; ++j)
+		else
 		{
-			debugSphereMat.SetScale(s->m_scale);
-			debugSphereMat.SetPos(s->m_pos);
-			shaderData.m_objectMatrix = &debugSphereMat;
-			shaderData.m_materialAmbient = s->m_colour;
-			m_colourShader->UseShader(shaderData);
-			glBindVertexArray(m_debugSphereBuffer.m_vertexArrayId);
-			glDrawElements(GL_LINE_LOOP, s_numDebugSphereVerts, GL_UNSIGNED_INT, 0);
-			++s;
+			// Shaders that read the object matrix uniform need a draw per model but the mesh and textures stay bound
+			for (int i = runStart; i < runEnd; ++i)
+			{
+				SetModelShaderData(models[m_modelSortIds[i]], a_shaderData);
+				runShader->UseShader(a_shaderData);
+				glDrawElementsBaseVertex(GL_TRIANGLES, mesh.m_numIndices, mesh.m_indexType, indexOffset, mesh.m_baseVertex);
+				++m_drawCallCounter;
+			}
 		}
 
-		// Draw transforms in the current renderLayer
-		DebugTransform * tr = m_debugTransforms[i];
-		for (int j = 0; j < m_objectCount[i][static_cast<int>(RenderObjectType::DebugTransforms)]; ++j)
+		runStart = runEnd;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void RenderManager::SetModelShaderData(const RenderModel & a_model, Shader::UniformData & a_shaderData_OUT)
+{
+	a_shaderData_OUT.m_objectMatrix = a_model.m_mat;
+	a_shaderData_OUT.m_lifeTime = a_model.m_lifeTime;
+	a_shaderData_OUT.m_materialShininess = a_model.m_shininess;
+	a_shaderData_OUT.m_materialAmbient = a_model.m_ambient;
+	a_shaderData_OUT.m_materialDiffuse = a_model.m_diffuse;
+	a_shaderData_OUT.m_materialSpecular = a_model.m_specular;
+	a_shaderData_OUT.m_materialEmission = a_model.m_emission;
+	a_shaderData_OUT.m_shaderData = a_model.m_shaderData;
+}
+
+void RenderManager::DrawDynamicGeometry(DynamicGeometry & a_geometry, unsigned int a_primitiveType, Shader::UniformData & a_shaderData)
+{
+	if (a_geometry.IsEmpty())
+	{
+		return;
+	}
+
+	// Only upload once per frame no matter how many times the scene is rendered
+	a_geometry.Upload();
+	RenderState::BindVertexArray(a_geometry.m_vertexArrayId);
+
+	Shader * pLastShader = nullptr;
+	for (unsigned int i = 0; i < a_geometry.m_numBatches; ++i)
+	{
+		const DynamicBatch & batch = a_geometry.m_batches[i];
+		if (batch.m_shader != pLastShader)
 		{
-			shaderData.m_objectMatrix = &tr->m_mat;
-			m_colourShader->UseShader(shaderData);
-			glBindVertexArray(m_debugTransformBuffer.m_vertexArrayId);
-			glDrawElements(GL_LINES, s_numDebugTransformVerts, GL_UNSIGNED_INT, 0);
-			++tr;
+			batch.m_shader->UseShader(a_shaderData);
+			pLastShader = batch.m_shader;
 		}
-		
-		// Flush the renderLayers if we are not rendering more than once
-		if (a_flushBuffers)
+
+		if (batch.m_textureId >= 0)
 		{
-			for (int j = 0; j < static_cast<int>(RenderObjectType::Count); ++j)
-			{
-				m_objectCount[i][j] = 0;
-			}
+			RenderState::BindTexture(0, batch.m_textureId);
 		}
+
+		glDrawElements(a_primitiveType, batch.m_numIndices, GL_UNSIGNED_INT, (unsigned char*)nullptr + (batch.m_firstIndex * sizeof(unsigned int)));
+		++m_drawCallCounter;
 	}
+
+	m_batchCounter += a_geometry.m_numBatches;
+	m_batchedPrimitiveCounter += a_geometry.m_numPrimitives;
 }
 
 void RenderManager::RenderFramebuffer()
 {
-	glBindVertexArray(m_fullscreenQuad.m_vertexArrayId);
+	RenderState::BindVertexArray(m_fullscreenQuad.m_vertexArrayId);
 	glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, 0);
 }
 
@@ -1275,21 +1435,17 @@ void RenderManager::AddLine(RenderLayer a_renderLayer, Vector a_point1, Vector a
 		return;
 	}
 
-	// Copy params to next queue item
-	Line * l = m_lines[lId];
-	l += m_objectCount[lId][static_cast<int>(RenderObjectType::Lines)]++;
-
-	l->SetVertBasic(0, a_point1, a_tint);
-	l->SetVertBasic(1, a_point2, a_tint);
-
-	if (l->m_vertexArrayId == 0 && l->m_vertexBufferId == 0 && l->m_indexBufferId == 0)
-	{
-		l->Bind();
-	}
-	else // This is super slow
+	// Append to the layer's line stream
+	static const unsigned int lineIndices[] = { 0, 1 };
+	Vertex * verts = m_lineGeometry[lId].AddPrimitive(2, lineIndices, 2, -1, m_colourShader);
+	if (verts == nullptr)
 	{
-		l->Rebind();
+		return;
 	}
+	++m_objectCount[lId][static_cast<int>(RenderObjectType::Lines)];
+
+	SetVertBasic(verts[0], a_point1, a_tint);
+	SetVertBasic(verts[1], a_point2, a_tint);
 }
 
 void RenderManager::AddQuad2D(RenderLayer a_renderLayer, Vector2 a_topLeft, Vector2 a_size, Texture * a_tex, TextureOrientation::Enum a_orient, Colour a_tint)
@@ -1328,23 +1484,19 @@ void RenderManager::AddQuad2D(RenderLayer a_renderLayer, Vector2 * a_verts, Text
 		Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Quad submitted without a texture");
 	}
 
-	// Copy params to next queue item
-	Quad * q = m_quads[lId];
-	q += m_objectCount[lId][static_cast<int>(RenderObjectType::Quads)]++;
-
-	if (a_tex)
+	// Append to the layer's stream, quads are a strip of two triangles
+	const int textureId = a_tex != nullptr ? a_tex->GetId() : -1;
+	Vertex * verts = m_triGeometry[lId].AddPrimitive(4, s_quadIndices, 6, textureId, textureId >= 0 ? m_textureShader : m_colourShader);
+	if (verts == nullptr)
 	{
-		q->m_textureId = a_tex->GetId();
-	}
-	else
-	{
-		q->m_textureId = -1;
+		return;
 	}
+	++m_objectCount[lId][static_cast<int>(RenderObjectType::Quads)];
 
 	// Setup verts for clockwise drawing 
 	for (int i = 0; i < 4; ++i)
 	{
-		q->SetVertBasic(i, Vector(a_verts[i].GetX(), a_verts[i].GetY(), s_renderDepth2D), a_tint);
+		SetVertBasic(verts[i], Vector(a_verts[i].GetX(), a_verts[i].GetY(), s_renderDepth2D), a_tint);
 	}
 	
 	// Set texcoords based on orientation
@@ -1354,10 +1506,10 @@ void RenderManager::AddQuad2D(RenderLayer a_renderLayer, Vector2 * a_verts, Text
 		{
 			case TextureOrientation::Normal:
 			{
-				q->m_verts[0].m_uv = TexCoord(a_texCoord.GetX(),					1.0f - a_texSize.GetY() - a_texCoord.GetY());
-				q->m_verts[1].m_uv = TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texSize.GetY() - a_texCoord.GetY());
-				q->m_verts[2].m_uv = TexCoord(a_texCoord.GetX(),					1.0f - a_texCoord.GetY());
-				q->m_verts[3].m_uv = TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texCoord.GetY());
+				verts[0].m_uv = TexCoord(a_texCoord.GetX(),						1.0f - a_texSize.GetY() - a_texCoord.GetY());
+				verts[1].m_uv = TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texSize.GetY() - a_texCoord.GetY());
+				verts[2].m_uv = TexCoord(a_texCoord.GetX(),						1.0f - a_texCoord.GetY());
+				verts[3].m_uv = TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texCoord.GetY());
 				break;
 			}
 			case TextureOrientation::FlipVert:
@@ -1379,15 +1531,6 @@ void RenderManager::AddQuad2D(RenderLayer a_renderLayer, Vector2 * a_verts, Text
 			default: break;
 		}
 	}
-
-	if (q->m_vertexArrayId == 0 && q->m_vertexBufferId == 0 && q->m_indexBufferId == 0)
-	{
-		q->Bind();
-	}
-	else // This is super slow
-	{
-		q->Rebind();
-	}
 }
 
 void RenderManager::AddQuad3D(RenderLayer a_renderLayer, Vector * a_verts, Texture * a_tex, Colour a_tint)
@@ -1406,37 +1549,28 @@ void RenderManager::AddQuad3D(RenderLayer a_renderLayer, Vector * a_verts, Textu
 		Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "3D Quad submitted without a texture");
 	}
 
-	// Copy params to next queue item
-	Quad * q = m_quads[lId];
-	q += m_objectCount[lId][static_cast<int>(RenderObjectType::Quads)]++;
-
-	if (a_tex)
-	{
-		q->m_textureId = a_tex->GetId();
-	}
-	else
+	// Append to the layer's stream, quads are a strip of two triangles
+	const int textureId = a_tex != nullptr ? a_tex->GetId() : -1;
+	Vertex * verts = m_triGeometry[lId].AddPrimitive(4, s_quadIndices, 6, textureId, textureId >= 0 ? m_textureShader : m_colourShader);
+	if (verts == nullptr)
 	{
-		q->m_textureId = -1;
+		return;
 	}
+	++m_objectCount[lId][static_cast<int>(RenderObjectType::Quads)];
 	
 	// Setup verts for clockwise drawing 
 	for (int i = 0; i < 4; ++i)
 	{
-		q->SetVertBasic(i, a_verts[i], a_tint);
+		SetVertBasic(verts[i], a_verts[i], a_tint);
 	}
 	
 	// Only one tex coord style for now
 	if (a_tex)
 	{
-		q->m_verts[0].m_uv = TexCoord(0.0f,	1.0f);
-		q->m_verts[1].m_uv = TexCoord(1.0f,	1.0f);
-		q->m_verts[2].m_uv = TexCoord(1.0f,	0.0f);
-		q->m_verts[3].m_uv = TexCoord(0.0f,	0.0f);
-	}
-
-	if (q->m_vertexArrayId == 0 && q->m_vertexBufferId == 0 && q->m_indexBufferId == 0)
-	{
-		q->Bind();
+		verts[0].m_uv = TexCoord(0.0f,	1.0f);
+		verts[1].m_uv = TexCoord(1.0f,	1.0f);
+		verts[2].m_uv = TexCoord(1.0f,	0.0f);
+		verts[3].m_uv = TexCoord(0.0f,	0.0f);
 	}
 }
 
@@ -1456,28 +1590,20 @@ void RenderManager::AddTri(RenderLayer a_renderLayer, Vector a_point1, Vector a_
 		Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Tri submitted without a texture");
 	}
 
-	// Copy params to next queue item
-	Tri * t = m_tris[lId];
-	t += m_objectCount[lId][static_cast<int>(RenderObjectType::Tris)]++;
-
-	if (a_tex)
+	// Append to the layer's stream
+	static const unsigned int triIndices[] = { 0, 1, 2 };
+	const int textureId = a_tex != nullptr ? a_tex->GetId() : -1;
+	Vertex * verts = m_triGeometry[lId].AddPrimitive(3, triIndices, 3, textureId, textureId >= 0 ? m_textureShader : m_colourShader);
+	if (verts == nullptr)
 	{
-		t->m_textureId = a_tex->GetId();
-	}
-	else
-	{
-		t->m_textureId = -1;
+		return;
 	}
+	++m_objectCount[lId][static_cast<int>(RenderObjectType::Tris)];
 	
 	// Setup verts for clockwise drawing
-	t->SetVert2D(0, a_point1, a_tint, a_txc1);
-	t->SetVert2D(1, a_point1, a_tint, a_txc2);
-	t->SetVert2D(2, a_point1, a_tint, a_txc3);
-
-	if (t->m_vertexArrayId == 0 && t->m_vertexBufferId == 0 && t->m_indexBufferId == 0)
-	{
-		t->Bind();
-	}
+	SetVert2D(verts[0], a_point1, a_tint, a_txc1);
+	SetVert2D(verts[1], a_point2, a_tint, a_txc2);
+	SetVert2D(verts[2], a_point3, a_tint, a_txc3);
 }
 
 void RenderManager::AddModel(RenderLayer a_renderLayer, Model * a_model, Matrix * a_mat, Shader * a_shader, const Vector & a_shaderData, float a_lifeTime)
@@ -1498,59 +1624,28 @@ void RenderManager::AddModel(RenderLayer a_renderLayer, Model * a_model, Matrix
 		r += m_objectCount[lId][static_cast<int>(RenderObjectType::Models)]++;
 
 		Object * obj = a_model->GetObjectAtIndex(i);
-		unsigned int numVertices = obj->GetNumVertices();
 		Material * modelMat = obj->GetMaterial();
-		Vector * verts = obj->GetVertices();
-		Vector * normals = obj->GetNormals();
-		TexCoord * uvs = obj->GetUvs();
 		Texture * diffuseTex = modelMat->GetDiffuseTexture();
 		Texture * normalTex = modelMat->GetNormalTexture();
 		Texture * specularTex = modelMat->GetSpecularTexture();
 
-		bool bind = false;
-		bool rebind = false;
-		int vertexBufferId = obj->GetVertexBufferId();
-		RenderModelBuffer * vertexBuffer = nullptr;
-		if (obj->HasVertexBuffer())
+		// Upload the mesh into an arena the first time the object is drawn
+		int meshId = obj->GetMeshId();
+		if (!obj->HasMesh())
 		{
-			vertexBuffer = &m_modelBuffers[vertexBufferId];
-		}
-		else
-		{
-			for (int j = 0; j < s_maxModelBuffers; ++j)
+			meshId = AllocateMesh(a_model, obj);
+			if (meshId < 0)
 			{
-				if (m_modelBuffers[j].m_model == nullptr && m_modelBuffers[j].m_object == nullptr)
-				{
-					vertexBuffer = &m_modelBuffers[j];
-					vertexBufferId = j;
-					bind = true;
-					break;
-				}
+				--m_objectCount[lId][static_cast<int>(RenderObjectType::Models)];
+				continue;
 			}
-		}
-			
-		if (bind)
-		{
-			unsigned int numVertices = obj->GetNumVertices();
-			vertexBuffer->m_model = a_model;
-			vertexBuffer->m_object = obj;
-			vertexBuffer->Alloc(numVertices);
-			vertexBuffer->m_numVerts = numVertices;
-			obj->SetVertexBufferId(vertexBufferId);
-			bind = true;
-		}
-		
-		// Make sure the VBO has enough storage for the verts of the model
-		if (rebind)
-		{
-			Log::Get().Write(LogLevel::Info, LogCategory::Engine, "Model %s being reallocated, if this happens frequently your game will be slow.", a_model->GetName());
-			vertexBuffer->Realloc(numVertices);
-			vertexBuffer->m_numVerts = numVertices;
+			obj->SetMeshId(meshId);
 		}
 
-		r->m_buffer = vertexBuffer;
+		r->m_meshId = meshId;
 		r->m_mat = a_mat;
 		r->m_shader = a_shader;
+		r->m_material = modelMat;
 		r->m_lifeTime = a_lifeTime;
 		r->m_shaderData = a_shaderData;
 		if (diffuseTex == nullptr)
@@ -1572,75 +1667,231 @@ void RenderManager::AddModel(RenderLayer a_renderLayer, Model * a_model, Matrix
 			Log::Get().WriteOnce(LogLevel::Error, LogCategory::Engine, "No material loaded for model with name %s",  a_model->GetName());
 			return;
 		}
+	}
+	
+	// Show the local matrix in debug mode
+	if (DebugMenu::Get().IsDebugMenuEnabled())
+	{
+		AddDebugTransform(*a_mat);
+	}
+}
+
+void RenderManager::ReleaseModel(Model * a_model)
+{
+	const int numObjects = a_model->GetNumObjects();
+	for (int i = 0; i < numObjects; ++i)
+	{
+		Object * obj = a_model->GetObjectAtIndex(i);
+		if (!obj->HasMesh())
+		{
+			continue;
+		}
 
-		// Pump verts from model data into VBO
-		if (bind || rebind)
+		// Neighbouring free ranges merge so the space can be reused by a larger mesh
+		const int meshId = obj->GetMeshId();
+		MeshAllocation & mesh = m_meshes[meshId];
+		if (mesh.m_arena >= 0)
 		{
-			for (unsigned int j = 0; j < numVertices; ++j)
-			{
-				vertexBuffer->SetVert(j, verts[j], Colour(1.0f, 1.0f, 1.0f, 1.0f), uvs[j], normals[j]);
-			}
+			MeshArena & arena = m_meshArenas[mesh.m_arena];
+			arena.m_vertexAllocator.Free(mesh.m_baseVertex);
+			arena.m_indexAllocator.Free(mesh.m_indexOffset);
+		}
+		mesh = MeshAllocation();
+		m_freeMeshIds[m_numFreeMeshIds++] = meshId;
+		obj->SetMeshId(-1);
+	}
+}
+
+int RenderManager::GetMeshArenaStats(unsigned int & a_usedVerts_OUT, unsigned int & a_totalVerts_OUT, float & a_fragmentation_OUT) const
+{
+	a_usedVerts_OUT = 0;
+	a_totalVerts_OUT = 0;
+	a_fragmentation_OUT = 0.0f;
+	unsigned int freeVerts = 0;
+	unsigned int largestFree = 0;
+	for (int i = 0; i < m_numMeshArenas; ++i)
+	{
+		const FreeListAllocator & verts = m_meshArenas[i].m_vertexAllocator;
+		a_usedVerts_OUT += verts.GetUsedSize();
+		a_totalVerts_OUT += verts.GetSize();
+		freeVerts += verts.GetFreeSize();
+		largestFree = MathUtils::GetMax(largestFree, verts.GetLargestFreeRange());
+	}
+	if (freeVerts > 0)
+	{
+		a_fragmentation_OUT = 1.0f - (float)largestFree / (float)freeVerts;
+	}
+	return s_maxMeshes - m_numFreeMeshIds;
+}
+
+int RenderManager::AllocateMesh(Model * a_model, Object * a_object)
+{
+	if (m_numFreeMeshIds <= 0)
+	{
+		Log::Get().WriteOnce(LogLevel::Error, LogCategory::Engine, "Too many unique meshes for rendering, max is %d", s_maxMeshes);
+		return -1;
+	}
+
+	const unsigned int numVerts = a_object->GetNumVertices();
+	const unsigned int numIndices = a_object->GetNumIndices();
+	const bool shortIndices = numVerts <= MeshOptimiser::s_maxShortIndex;
+	const unsigned int indexSize = shortIndices ? sizeof(unsigned short) : sizeof(unsigned int);
+	const unsigned int indexUnits = (numIndices * indexSize + sizeof(unsigned int) - 1) / sizeof(unsigned int);
+	if (numVerts > s_meshArenaVerts || indexUnits > s_meshArenaIndexUnits)
+	{
+		Log::Get().WriteOnce(LogLevel::Error, LogCategory::Engine, "Model %s with %u verts is too large for a mesh arena", a_model->GetName(), numVerts);
+		return -1;
+	}
+
+	// First fit across the arenas, only create a new one when every existing arena is full
+	int arenaId = -1;
+	unsigned int baseVertex = FreeListAllocator::s_invalidOffset;
+	unsigned int indexOffset = FreeListAllocator::s_invalidOffset;
+	for (int i = 0; i < s_maxMeshArenas && arenaId < 0; ++i)
+	{
+		if (i == m_numMeshArenas)
+		{
+			m_meshArenas[i].Init();
+			++m_numMeshArenas;
 		}
 
-		if (bind)
+		MeshArena & arena = m_meshArenas[i];
+		baseVertex = arena.m_vertexAllocator.Allocate(numVerts);
+		if (baseVertex == FreeListAllocator::s_invalidOffset)
 		{
-			vertexBuffer->Bind();
+			continue;
 		}
-		else if (rebind)
+		indexOffset = arena.m_indexAllocator.Allocate(indexUnits);
+		if (indexOffset == FreeListAllocator::s_invalidOffset)
 		{
-			vertexBuffer->Rebind();
+			arena.m_vertexAllocator.Free(baseVertex);
+			continue;
 		}
+		arenaId = i;
 	}
-	
-	// Show the local matrix in debug mode
-	if (DebugMenu::Get().IsDebugMenuEnabled())
+
+	if (arenaId < 0)
 	{
-		AddDebugTransform(*a_mat);
+		Log::Get().WriteOnce(LogLevel::Error, LogCategory::Engine, "No room in the mesh arenas for model %s with %u verts", a_model->GetName(), numVerts);
+		return -1;
+	}
+
+	const int meshId = m_freeMeshIds[--m_numFreeMeshIds];
+	MeshAllocation & mesh = m_meshes[meshId];
+	mesh.m_model = a_model;
+	mesh.m_object = a_object;
+	mesh.m_arena = arenaId;
+	mesh.m_baseVertex = baseVertex;
+	mesh.m_numVerts = numVerts;
+	mesh.m_indexOffset = indexOffset;
+	mesh.m_numIndices = numIndices;
+	mesh.m_indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	// Pack verts from model data into the arena, indices stay relative to the mesh and are offset by the base vertex when drawn
+	const Vector * verts = a_object->GetVertices();
+	const Vector * normals = a_object->GetNormals();
+	const TexCoord * uvs = a_object->GetUvs();
+	ModelVertex * packedVerts = new ModelVertex[numVerts];
+	for (unsigned int i = 0; i < numVerts; ++i)
+	{
+		packedVerts[i].Set(verts[i], normals[i], uvs[i]);
+	}
+	const MeshArena & arena = m_meshArenas[arenaId];
+	glBindBuffer(GL_ARRAY_BUFFER, arena.m_vertexBufferId);
+	glBufferSubData(GL_ARRAY_BUFFER, baseVertex * sizeof(ModelVertex), numVerts * sizeof(ModelVertex), packedVerts);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	delete[] packedVerts;
+
+	// The element buffer binding belongs to the VAO so bind the arena before touching it
+	RenderState::BindVertexArray(arena.m_vertexArrayId);
+	const unsigned int * indices = a_object->GetIndices();
+	if (shortIndices)
+	{
+		// Half the index memory and bandwidth for the common case
+		unsigned short * packedIndices = new unsigned short[numIndices];
+		for (unsigned int i = 0; i < numIndices; ++i)
+		{
+			packedIndices[i] = (unsigned short)indices[i];
+		}
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset * sizeof(unsigned int), numIndices * sizeof(unsigned short), packedIndices);
+		delete[] packedIndices;
 	}
+	else
+	{
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset * sizeof(unsigned int), numIndices * sizeof(unsigned int), indices);
+	}
+
+	return meshId;
 }
 
 void RenderManager::AddFontChar(RenderLayer a_renderLayer, const Vector2& a_charSize, const TexCoord & a_texSize, const TexCoord & a_texCoord, Texture * a_texture, const Vector2 & a_size, Vector a_pos, Colour a_colour)
+{
+	const bool is2D = a_renderLayer == RenderLayer::Gui || a_renderLayer == RenderLayer::Debug2D;
+	FontGlyph glyph;
+	SetFontGlyph(glyph, is2D, a_charSize, a_texSize, a_texCoord, a_size, Vector::Zero());
+	AddFontRun(a_renderLayer, &glyph, 1, a_texture, a_pos, a_colour);
+}
+
+void RenderManager::AddFontRun(RenderLayer a_renderLayer, const FontGlyph * a_glyphs, unsigned int a_numGlyphs, Texture * a_texture, const Vector & a_pos, Colour a_colour)
 {
 	const int lId = static_cast<int>(a_renderLayer);
+	const int typeId = static_cast<int>(RenderObjectType::FontChars);
+
 	// Don't add more font characters than have been allocated for
-	if (m_objectCount[lId][static_cast<int>(RenderObjectType::FontChars)] >= s_maxObjects[(int)RenderObjectType::FontChars])
+	const unsigned int remaining = (unsigned int)(s_maxObjects[typeId] - m_objectCount[lId][typeId]);
+	if (a_numGlyphs > remaining)
 	{
-		Log::Get().WriteOnce(LogLevel::Error, LogCategory::Engine, "Too many font characters added for renderLayer %d, max is %d", lId, s_maxObjects[(int)RenderObjectType::FontChars]);
-		return;
+		Log::Get().WriteOnce(LogLevel::Error, LogCategory::Engine, "Too many font characters added for renderLayer %d, max is %d", lId, s_maxObjects[typeId]);
+		a_numGlyphs = remaining;
 	}
 
-	FontChar * fc = m_fontChars[lId];
-	fc += m_objectCount[lId][static_cast<int>(RenderObjectType::FontChars)]++;
-	
-	const bool is2D = a_renderLayer == RenderLayer::Gui || a_renderLayer == RenderLayer::Debug2D;
-
-	if (is2D)
-	{
-		fc->SetVert2D(0, Vector(0.0f,				0.0f,				s_renderDepth2D),	a_colour, TexCoord(a_texCoord.GetX(),						1.0f - a_texCoord.GetY()));
-		fc->SetVert2D(1, Vector(a_charSize.GetX(),	0.0f,				s_renderDepth2D),	a_colour, TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texCoord.GetY()));
-		fc->SetVert2D(2, Vector(a_charSize.GetX(),	-a_charSize.GetY(),	s_renderDepth2D),	a_colour, TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texCoord.GetY() - a_texSize.GetY()));
-		fc->SetVert2D(3, Vector(0.0f,				-a_charSize.GetY(),	s_renderDepth2D),	a_colour, TexCoord(a_texCoord.GetX(),						1.0f - a_texCoord.GetY() - a_texSize.GetY()));
-	}
-	else
+	// Scale and position are baked into the verts so the whole stream can be drawn without a transform per character
+	const int textureId = a_texture->GetId();
+	for (unsigned int runStart = 0; runStart < a_numGlyphs; runStart += s_maxFontRunGlyphs)
 	{
-		fc->SetVert2D(0, Vector(0.0f,				0.0f,	0.0f),		a_colour, TexCoord(a_texCoord.GetX(),						1.0f - a_texCoord.GetY()));
-		fc->SetVert2D(1, Vector(a_charSize.GetX(),	0.0f,	0.0f),		a_colour, TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texCoord.GetY()));
-		fc->SetVert2D(2, Vector(a_charSize.GetX(),	0.0f,	-a_charSize.GetY()),	a_colour, TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texCoord.GetY() - a_texSize.GetY()));
-		fc->SetVert2D(3, Vector(0.0f,				0.0f,	-a_charSize.GetY()),	a_colour, TexCoord(a_texCoord.GetX(),						1.0f - a_texCoord.GetY() - a_texSize.GetY()));
+		const unsigned int runLength = MathUtils::GetMin(a_numGlyphs - runStart, (unsigned int)s_maxFontRunGlyphs);
+		Vertex * verts = m_fontGeometry[lId].AddPrimitive(runLength * 4, m_fontRunIndices, runLength * 6, textureId, m_textureShader);
+		if (verts == nullptr)
+		{
+			return;
+		}
+		m_objectCount[lId][typeId] += runLength;
+
+		for (unsigned int i = 0; i < runLength; ++i)
+		{
+			const FontGlyph & glyph = a_glyphs[runStart + i];
+			for (int corner = 0; corner < 4; ++corner)
+			{
+				SetVert2D(*verts++, glyph.m_corners[corner] + a_pos, a_colour, glyph.m_uvs[corner]);
+			}
+		}
 	}
+}
 
-	if (fc->m_vertexArrayId == 0 && fc->m_vertexBufferId == 0 && fc->m_indexBufferId == 0)
+void RenderManager::SetFontGlyph(FontGlyph & a_glyph_OUT, bool a_is2D, const Vector2 & a_charSize, const TexCoord & a_texSize, const TexCoord & a_texCoord, const Vector2 & a_size, const Vector & a_offset)
+{
+	// 2D characters face the screen at the 2D depth, 3D characters stand up along world Z
+	const Vector scale(a_size.GetX(), a_size.GetY(), a_is2D ? 1.0f : a_size.GetY());
+	const float width = a_charSize.GetX();
+	const float height = a_charSize.GetY();
+	if (a_is2D)
 	{
-		fc->Bind();
+		a_glyph_OUT.m_corners[0] = Vector(0.0f,		0.0f,		s_renderDepth2D) * scale + a_offset;
+		a_glyph_OUT.m_corners[1] = Vector(width,	0.0f,		s_renderDepth2D) * scale + a_offset;
+		a_glyph_OUT.m_corners[2] = Vector(width,	-height,	s_renderDepth2D) * scale + a_offset;
+		a_glyph_OUT.m_corners[3] = Vector(0.0f,		-height,	s_renderDepth2D) * scale + a_offset;
 	}
 	else
 	{
-		fc->Rebind();
+		a_glyph_OUT.m_corners[0] = Vector(0.0f,		0.0f,	0.0f) * scale + a_offset;
+		a_glyph_OUT.m_corners[1] = Vector(width,	0.0f,	0.0f) * scale + a_offset;
+		a_glyph_OUT.m_corners[2] = Vector(width,	0.0f,	-height) * scale + a_offset;
+		a_glyph_OUT.m_corners[3] = Vector(0.0f,		0.0f,	-height) * scale + a_offset;
 	}
-
-	fc->m_textureId = a_texture->GetId();
-	fc->m_pos = a_pos;
-	fc->m_scale = Vector(a_size.GetX(), a_size.GetY(), is2D ? 1.0f : a_size.GetY());
+	a_glyph_OUT.m_uvs[0] = TexCoord(a_texCoord.GetX(),						1.0f - a_texCoord.GetY());
+	a_glyph_OUT.m_uvs[1] = TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texCoord.GetY());
+	a_glyph_OUT.m_uvs[2] = TexCoord(a_texCoord.GetX() + a_texSize.GetX(),	1.0f - a_texCoord.GetY() - a_texSize.GetY());
+	a_glyph_OUT.m_uvs[3] = TexCoord(a_texCoord.GetX(),						1.0f - a_texCoord.GetY() - a_texSize.GetY());
 }
 
 int RenderManager::AddParticleEmitter(int a_numParticles, float a_emissionRate, float a_lifeTime, const Vector & a_emitterPos, const ParticleDefinition & a_def)
@@ -1779,60 +2030,165 @@ void RenderManager::AddDebugArrow2D(Vector2 a_start, Vector2 a_end, Colour a_tin
 	AddLine2D(RenderLayer::Debug2D, a_end, arrowPointY, a_tint);
 }
 
-void RenderManager::AddDebugTransform(const Matrix & a_mat)
+void RenderManager::AddDebugLine(Vector a_point1, Vector a_point2, Colour a_tint, float a_lifeTime)
 {
 #ifndef _RELEASE
-	if (m_objectCount[static_cast<int>(RenderLayer::Debug3D)][static_cast<int>(RenderObjectType::DebugTransforms)] >= s_maxObjects[(int)RenderObjectType::DebugTransforms])
+	if (a_lifeTime > 0.0f)
+	{
+		PersistentDebugPrimitive prim;
+		prim.m_type = PersistentDebugPrimitive::Type::Line;
+		prim.m_pos = a_point1;
+		prim.m_size = a_point2;
+		prim.m_colour = a_tint;
+		AddPersistentDebugPrimitive(prim, a_lifeTime);
+		return;
+	}
+#endif
+	AddLine(RenderLayer::Debug3D, a_point1, a_point2, a_tint);
+}
+
+void RenderManager::AddDebugTransform(const Matrix & a_mat, float a_lifeTime)
+{
+#ifndef _RELEASE
+	if (a_lifeTime > 0.0f)
 	{
-		Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Too many DebugTransforms primitives added for renderLayer %d, max is %d", (int)RenderObjectType::DebugTransforms, s_maxObjects[(int)RenderObjectType::DebugTransforms]);
+		PersistentDebugPrimitive prim;
+		prim.m_type = PersistentDebugPrimitive::Type::Transform;
+		prim.m_mat = a_mat;
+		AddPersistentDebugPrimitive(prim, a_lifeTime);
 		return;
 	}
-	DebugTransform * t = m_debugTransforms[static_cast<int>(RenderLayer::Debug3D)];
-	t += m_objectCount[static_cast<int>(RenderLayer::Debug3D)][static_cast<int>(RenderObjectType::DebugTransforms)]++;
-	t->m_mat = a_mat;
+
+	Vertex * verts = AddDebugLines(RenderObjectType::DebugTransforms, s_numDebugTransformVerts, s_debugTransformIndices, s_numDebugTransformVerts);
+	if (verts == nullptr)
+	{
+		return;
+	}
+
+	// Red for X right axis, green for Y look forward and blue for Z up
+	const Vector pos = a_mat.GetPos();
+	SetVertBasic(verts[0], pos, sc_colourRed);
+	SetVertBasic(verts[1], pos + a_mat.GetRight(), sc_colourRed);
+	SetVertBasic(verts[2], pos, sc_colourGreen);
+	SetVertBasic(verts[3], pos + a_mat.GetLook(), sc_colourGreen);
+	SetVertBasic(verts[4], pos, sc_colourBlue);
+	SetVertBasic(verts[5], pos + a_mat.GetUp(), sc_colourBlue);
 #endif
 }
 
-void RenderManager::AddDebugSphere(const Vector & a_worldPos, const float & a_radius, Colour a_colour)
+void RenderManager::AddDebugSphere(const Vector & a_worldPos, const float & a_radius, Colour a_colour, float a_lifeTime)
 {
 #ifndef _RELEASE
-	if (m_objectCount[static_cast<int>(RenderLayer::Debug3D)][static_cast<int>(RenderObjectType::DebugSpheres)] >= s_maxObjects[(int)RenderObjectType::DebugSpheres])
+	if (a_lifeTime > 0.0f)
+	{
+		PersistentDebugPrimitive prim;
+		prim.m_type = PersistentDebugPrimitive::Type::Sphere;
+		prim.m_pos = a_worldPos;
+		prim.m_size = Vector(a_radius);
+		prim.m_colour = a_colour;
+		AddPersistentDebugPrimitive(prim, a_lifeTime);
+		return;
+	}
+
+	Vertex * verts = AddDebugLines(RenderObjectType::DebugSpheres, s_numDebugSphereVerts, m_debugSphereIndices, s_numDebugSphereIndices);
+	if (verts == nullptr)
 	{
-		Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Too many DebugSphere primitives added for renderLayer %d, max is %d", (int)RenderObjectType::DebugSpheres, s_maxObjects[(int)RenderObjectType::DebugSpheres]);
 		return;
 	}
-	DebugSphere * t = m_debugSpheres[static_cast<int>(RenderLayer::Debug3D)];
-	t += m_objectCount[static_cast<int>(RenderLayer::Debug3D)][static_cast<int>(RenderObjectType::DebugSpheres)]++;
-	t->m_pos = a_worldPos;
-	t->m_scale = Vector(a_radius);
-	t->m_colour = Vector(a_colour.GetValues());
+	for (int i = 0; i < s_numDebugSphereVerts; ++i)
+	{
+		SetVertBasic(verts[i], a_worldPos + m_debugSphereVerts[i] * a_radius, a_colour);
+	}
 #endif
 }
 
-void RenderManager::AddDebugAxisBox(const Vector & a_worldPos, const Vector & a_dimensions, Colour a_colour)
+void RenderManager::AddDebugAxisBox(const Vector & a_worldPos, const Vector & a_dimensions, Colour a_colour, float a_lifeTime)
 {
 #ifndef _RELEASE
-	if (m_objectCount[static_cast<int>(RenderLayer::Debug3D)][static_cast<int>(RenderObjectType::DebugBoxes)] >= s_maxObjects[(int)RenderObjectType::DebugBoxes])
+	if (a_lifeTime > 0.0f)
+	{
+		PersistentDebugPrimitive prim;
+		prim.m_type = PersistentDebugPrimitive::Type::AxisBox;
+		prim.m_pos = a_worldPos;
+		prim.m_size = a_dimensions;
+		prim.m_colour = a_colour;
+		AddPersistentDebugPrimitive(prim, a_lifeTime);
+		return;
+	}
+
+	Vertex * verts = AddDebugLines(RenderObjectType::DebugBoxes, s_numDebugBoxVerts, s_debugBoxIndices, s_numDebugBoxIndices);
+	if (verts == nullptr)
 	{
-		Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Too many DebugBox primitives added for renderLayer %d, max is %d", (int)RenderObjectType::DebugBoxes, s_maxObjects[(int)RenderObjectType::DebugBoxes]);
 		return;
 	}
-	DebugBox * t = m_debugBoxes[static_cast<int>(RenderLayer::Debug3D)];
-	t += m_objectCount[static_cast<int>(RenderLayer::Debug3D)][static_cast<int>(RenderObjectType::DebugBoxes)]++;
-	t->m_pos = a_worldPos;
-	t->m_scale = a_dimensions;
-	t->m_colour = Vector(a_colour.GetValues());
+	for (int i = 0; i < s_numDebugBoxVerts; ++i)
+	{
+		SetVertBasic(verts[i], a_worldPos + s_debugBoxVerts[i] * a_dimensions, a_colour);
+	}
 #endif
 }
 
-void RenderManager::AddDebugBox(const Matrix & a_worldMat, const Vector & a_dimensions, Colour a_colour)
+void RenderManager::AddDebugBox(const Matrix & a_worldMat, const Vector & a_dimensions, Colour a_colour, float a_lifeTime)
 {
 #ifndef _RELEASE
-	// TODO
-	AddDebugAxisBox(a_worldMat.GetPos(), a_dimensions);
+	if (a_lifeTime > 0.0f)
+	{
+		PersistentDebugPrimitive prim;
+		prim.m_type = PersistentDebugPrimitive::Type::Box;
+		prim.m_mat = a_worldMat;
+		prim.m_size = a_dimensions;
+		prim.m_colour = a_colour;
+		AddPersistentDebugPrimitive(prim, a_lifeTime);
+		return;
+	}
+
+	Vertex * verts = AddDebugLines(RenderObjectType::DebugBoxes, s_numDebugBoxVerts, s_debugBoxIndices, s_numDebugBoxIndices);
+	if (verts == nullptr)
+	{
+		return;
+	}
+
+	// Corners are rotated into the box's orientation on the CPU so the whole stream shares one transform
+	Matrix boxMat = a_worldMat;
+	const Vector pos = a_worldMat.GetPos();
+	for (int i = 0; i < s_numDebugBoxVerts; ++i)
+	{
+		SetVertBasic(verts[i], pos + boxMat.Transform(s_debugBoxVerts[i] * a_dimensions), a_colour);
+	}
 #endif
 }
 
+RenderManager::Vertex * RenderManager::AddDebugLines(RenderObjectType a_type, unsigned int a_numVerts, const unsigned int * a_indices, unsigned int a_numIndices)
+{
+	const int lId = static_cast<int>(RenderLayer::Debug3D);
+	const int typeId = static_cast<int>(a_type);
+	if (m_objectCount[lId][typeId] >= s_maxObjects[typeId])
+	{
+		Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Too many debug primitives of type %d added, max is %d", typeId, s_maxObjects[typeId]);
+		return nullptr;
+	}
+
+	Vertex * verts = m_lineGeometry[lId].AddPrimitive(a_numVerts, a_indices, a_numIndices, -1, m_colourShader);
+	if (verts != nullptr)
+	{
+		++m_objectCount[lId][typeId];
+	}
+	return verts;
+}
+
+void RenderManager::AddPersistentDebugPrimitive(const PersistentDebugPrimitive & a_primitive, float a_lifeTime)
+{
+	if (m_numPersistentDebug >= s_maxPersistentDebugPrimitives)
+	{
+		Log::Get().WriteOnce(LogLevel::Warning, LogCategory::Engine, "Too many persistent debug primitives added, max is %d", s_maxPersistentDebugPrimitives);
+		return;
+	}
+
+	PersistentDebugPrimitive & prim = m_persistentDebug[m_numPersistentDebug++];
+	prim = a_primitive;
+	prim.m_expiryTime = m_renderTime + a_lifeTime;
+}
+
 void RenderManager::ManageShader(GameObject * a_gameObject, const char * a_shaderName)
 {
 	bool shaderReferenced = false;
@@ -2,6 +2,8 @@
 #define _ENGINE_RENDER_MANAGER_
 #pragma once
 
+#include <stdint.h>
+
 #include "FileManager.h"
 #include "Model.h"
 #include "Singleton.h"
@@ -9,6 +11,7 @@
 #include "Texture.h"
 
 #include "../core/Colour.h"
+#include "../core/FreeListAllocator.h"
 #include "../core/LinkedList.h"
 #include "../core/Matrix.h"
 #include "../core/Range.h"
@@ -118,6 +121,13 @@ class RenderManager : public Singleton<RenderManager>
 {
 public:
 
+    //\brief The corners of a character quad relative to the start of its string, laid out once and drawn many times
+    struct FontGlyph
+    {
+        Vector m_corners[4];
+        TexCoord m_uvs[4];
+    };
+
     //\brief No work done in the constructor, only Init
     explicit RenderManager(float a_updateFreq = s_updateFreq) 
                     : m_renderTime(0.0f)
@@ -128,13 +138,12 @@ public:
                     , m_postShader(nullptr)
                     , m_colourShader(nullptr)
                     , m_textureShader(nullptr)
+                    , m_textureInstancedShader(nullptr)
                     , m_lightingShader(nullptr)
                     , m_particleShader(nullptr)
                     , m_finalShader(nullptr)
                     , m_fullscreenQuad()
                     , m_numParticleEmitters(0)
-                    , m_debugBoxBuffer()
-                    , m_debugSphereBuffer()
                     , m_viewWidth(0)
                     , m_viewHeight(0)
                     , m_bpp(0)
@@ -146,14 +155,7 @@ public:
 
         for (int i = 0; i < static_cast<int>(RenderLayer::Count); ++i)
         {
-            m_tris[i] = nullptr;
-            m_quads[i] = nullptr;
-            m_lines[i] = nullptr;
-            m_debugBoxes[i] = nullptr;
-            m_debugSpheres[i] = nullptr;
-            m_debugTransforms[i] = nullptr;
             m_models[i] = nullptr;
-            m_fontChars[i] = nullptr;
             for (int j = 0; j < static_cast<int>(RenderObjectType::Count); ++j)
             {
                 m_objectCount[i][j] = 0;
@@ -192,6 +194,10 @@ public:
     void RenderScene(Matrix & a_viewMatrix, bool a_flushBuffers = true);
     void RenderScene(Matrix & a_viewMatrix, Matrix & a_perspectiveMat, bool a_flushBuffers, bool a_clear);
     void RenderFramebuffer();
+
+    //\brief The projection used for the world layer when rendering to the screen, also used to cull objects outside the view
+    //\return a projection matching the aspect ratio of the current view size
+    Matrix GetPerspectiveMatrix() const;
     
     //\brief Change the render mode
     //\param a_renderMode the new mode to set
@@ -239,12 +245,24 @@ public:
     //\param a_life is how old the object that owns the model is, in seconds
     void AddModel(RenderLayer a_layer, Model * a_model, Matrix * a_mat, Shader * a_shader, const Vector & a_shaderData, float a_lifeTime);
 
+    //\brief Give back the GPU storage of every object in a model, must be called before a model is unloaded or reloaded
+    void ReleaseModel(Model * a_model);
+
     //\brief Add a font character for drawing
     //\param a_renderLayer is the rendering group to draw the model in
     //\param a_fontCharId is the display list ID of the character to call
     //\param a_size is the size multiplier to use
     //\param a_pos is the position in 3D space to draw. If a 2D renderLayer is used, the Z component will be ignored
-    void AddFontChar(RenderLayer a_renderLayer, const Vector2& a_charSize, const TexCoord & a_texSize, const TexCoord & a_texCoord, Texture * a_texture, const Vector2 & a_size, Vector a_pos, Colour a_colour = sc_colourWhite);					 
+    void AddFontChar(RenderLayer a_renderLayer, const Vector2& a_charSize, const TexCoord & a_texSize, const TexCoord & a_texCoord, Texture * a_texture, const Vector2 & a_size, Vector a_pos, Colour a_colour = sc_colourWhite);
+
+    //\brief Add a laid out string to the font stream as one primitive instead of one per character
+    //\param a_glyphs are character quads that all use a_texture
+    //\param a_pos is the start of the string that the glyph corners are relative to
+    void AddFontRun(RenderLayer a_renderLayer, const FontGlyph * a_glyphs, unsigned int a_numGlyphs, Texture * a_texture, const Vector & a_pos, Colour a_colour = sc_colourWhite);
+
+    //\brief Lay out a character quad the same way AddFontChar draws it
+    //\param a_offset is the position of the character relative to the start of its string
+    static void SetFontGlyph(FontGlyph & a_glyph_OUT, bool a_is2D, const Vector2 & a_charSize, const TexCoord & a_texSize, const TexCoord & a_texCoord, const Vector2 & a_size, const Vector & a_offset);					 
     
     //\brief Add a particle emitter
     //\param a_numParticles the maximum particles that can be alive at once for this emitter
@@ -259,7 +277,8 @@ public:
     //\param Vector a_point1 start of the line
     //\param Vector a_point2 end of the line
     //\param Colour a_tint the colour of the line
-    inline void AddDebugLine(Vector a_point1, Vector a_point2, Colour a_tint = sc_colourWhite) { AddLine(RenderLayer::Debug3D, a_point1, a_point2, a_tint); }
+    //\param a_lifeTime is how many seconds the line stays on screen without being added again, zero for this frame only
+    void AddDebugLine(Vector a_point1, Vector a_point2, Colour a_tint = sc_colourWhite, float a_lifeTime = 0.0f);
     inline void AddDebugLine2D(Vector2 a_point1, Vector2 a_point2, Colour a_tint = sc_colourWhite) { AddLine2D(RenderLayer::Debug2D, a_point1, a_point2, a_tint); }
     inline void AddDebugQuad2D(Vector2 a_topLeft, Vector2 a_size, Colour a_tint = sc_colourWhite) { AddQuad2D(RenderLayer::Debug2D, a_topLeft, a_size, nullptr, TextureOrientation::Normal, a_tint); }
     
@@ -269,18 +288,19 @@ public:
 
     //\brief A transform is position and orientation displayed with coloured lines
     //\param a const ref of the matrix containing the position and orientation to display
-    void AddDebugTransform(const Matrix & a_mat);
+    //\param a_lifeTime optional number of seconds to keep drawing the transform, zero for this frame only
+    void AddDebugTransform(const Matrix & a_mat, float a_lifeTime = 0.0f);
 
     //\brief A sphere is a position and radius displayed with lines
     //\param a_colour optional argument for the colour of the box
-    void AddDebugSphere(const Vector & a_worldPos, const float & a_radius, Colour a_colour = sc_colourWhite);
+    void AddDebugSphere(const Vector & a_worldPos, const float & a_radius, Colour a_colour = sc_colourWhite, float a_lifeTime = 0.0f);
 
     //\brief A box aligned to the world's axis
     //\param a_worldPos the centre of the box
     //\param a_dimensions the size of the box in x,y,z order
     //\param a_colour optional argument for the colour of the box
-    void AddDebugAxisBox(const Vector & a_worldPos, const Vector & a_dimensions, Colour a_colour = sc_colourWhite);
-    void AddDebugBox(const Matrix & a_worldMat, const Vector & a_dimensions, Colour a_colour = sc_colourWhite);
+    void AddDebugAxisBox(const Vector & a_worldPos, const Vector & a_dimensions, Colour a_colour = sc_colourWhite, float a_lifeTime = 0.0f);
+    void AddDebugBox(const Matrix & a_worldMat, const Vector & a_dimensions, Colour a_colour = sc_colourWhite, float a_lifeTime = 0.0f);
 
     //\brief Add and remove a shader to the list for hotloading on file modification
     void ManageShader(GameObject * a_gameObject, const char * a_shaderName);
@@ -291,6 +311,18 @@ public:
     //\brief Get the number of non-debug menu draw calls happening. Only valid after drawing and before update
     inline int GetDrawCallCount() { return m_drawCallCounter; }
 
+    //\brief Get the number of dynamic geometry batches and how many primitives were merged into them, same validity as the draw count
+    inline int GetDrawCallCount(int & a_numBatches_OUT, int & a_numBatchedPrimitives_OUT) 
+    { 
+        a_numBatches_OUT = m_batchCounter; 
+        a_numBatchedPrimitives_OUT = m_batchedPrimitiveCounter; 
+        return m_drawCallCounter; 
+    }
+
+    //\brief Get how much of the mesh arenas are in use and how fragmented the free vertex space is
+    //\return the number of resident meshes
+    int GetMeshArenaStats(unsigned int & a_usedVerts_OUT, unsigned int & a_totalVerts_OUT, float & a_fragmentation_OUT) const;
+
     //\brief Helper function to setup a new shader based on the contents of files and the global preamble
     //\param a_shaderToCreate_OUT is pointer to a shader that will be allocated
     //\param a_shaderFileName pointer to a cstring containing the path to the shaders with .fsh and .vsh extensions assumed
@@ -322,6 +354,19 @@ private:
         Vector m_normal;
     };
 
+    //\brief Packed vertex for model meshes, models are always white so there is no colour
+    struct ModelVertex
+    {
+        ModelVertex()
+            : m_pos(0.0f, 0.0f, 0.0f)
+            , m_normal{ 0, 0 }
+            , m_uv{ 0, 0 } {}
+        void Set(const Vector & a_pos, const Vector & a_normal, const TexCoord & a_uv);
+        Vector m_pos;
+        int16_t m_normal[2];        ///< Octahedral encoded normal as snorm, decoded in the vertex shader
+        uint16_t m_uv[2];           ///< Half float texture coordinates
+    };
+
     struct VertexBuffer
     {
         VertexBuffer()
@@ -409,61 +454,174 @@ private:
         int m_numVerts;
     };
 
-    //\brief Fixed size structure for queing line primitives
-    struct Line : VertexBuffer
+    //\brief Fixed size structure for full screen render primitives
+    struct Quad : VertexBuffer
     {
-        Line() : VertexBuffer(2) {}
+        Quad() : VertexBuffer(4) {}
     };
 
-    //\brief Fixed size structure for queing render primitices
-    struct Tri : VertexBuffer
+    //\brief A run of consecutive indices in a dynamic geometry stream that share a texture and shader
+    struct DynamicBatch
     {
-        Tri() : VertexBuffer(3) {}
+        DynamicBatch()
+            : m_shader(nullptr)
+            , m_textureId(-1)
+            , m_firstIndex(0)
+            , m_numIndices(0) {}
+        Shader * m_shader;
+        int m_textureId;
+        unsigned int m_firstIndex;
+        unsigned int m_numIndices;
     };
 
-    //\brief Fixed size structure for queing render primitives
-    struct Quad : VertexBuffer
+    //\brief Small primitives like quads, tris, lines and font characters are appended into one large 
+    //       CPU side vertex array per layer. A new batch is only started when the texture or shader 
+    //       changes and the whole stream is uploaded to the GPU once per frame.
+    struct DynamicGeometry
     {
-        Quad() : VertexBuffer(4) {}
-    };
+        DynamicGeometry()
+            : m_vertexArrayId(0)
+            , m_vertexBufferId(0)
+            , m_indexBufferId(0)
+            , m_verts(nullptr)
+            , m_indicies(nullptr)
+            , m_batches(nullptr)
+            , m_maxVerts(0)
+            , m_maxIndices(0)
+            , m_maxBatches(0)
+            , m_numVerts(0)
+            , m_numIndices(0)
+            , m_numBatches(0)
+            , m_numPrimitives(0)
+            , m_uploaded(false) {}
+        ~DynamicGeometry() 
+        { 
+            if (m_maxVerts > 0) 
+            { 
+                Dealloc(); 
+            } 
+        }
+        inline void Alloc(unsigned int a_maxVerts, unsigned int a_maxIndices, unsigned int a_maxBatches)
+        {
+            if (m_maxVerts > 0)
+            {
+                Dealloc();
+            }
+            m_maxVerts = a_maxVerts;
+            m_maxIndices = a_maxIndices;
+            m_maxBatches = a_maxBatches;
+            m_verts = new Vertex[a_maxVerts];
+            m_indicies = new unsigned int[a_maxIndices];
+            m_batches = new DynamicBatch[a_maxBatches];
+            Reset();
+        }
+        void Dealloc()
+        {
+            m_maxVerts = 0;
+            m_maxIndices = 0;
+            m_maxBatches = 0;
+            delete[] m_verts;
+            delete[] m_indicies;
+            delete[] m_batches;
+            m_verts = nullptr;
+            m_indicies = nullptr;
+            m_batches = nullptr;
+            Reset();
+        }
+        inline void Reset()
+        {
+            m_numVerts = 0;
+            m_numIndices = 0;
+            m_numBatches = 0;
+            m_numPrimitives = 0;
+            m_uploaded = false;
+        }
+        inline bool IsEmpty() const { return m_numBatches == 0; }
 
-    struct DebugBox
-    {
-        DebugBox() : m_pos(0.0f), m_scale(0.0f) {}
-        Vector m_pos;
-        Vector m_scale;
-        Vector m_colour;
+        //\brief Reserve space for a primitive at the end of the stream, joining the last batch if the texture and shader match
+        //\param a_indices are relative to the first vertex of the primitive and are offset into the stream
+        //\return a pointer to the first of a_numVerts vertices for the caller to fill out, nullptr if the stream is full
+        Vertex * AddPrimitive(unsigned int a_numVerts, const unsigned int * a_indices, unsigned int a_numIndices, int a_textureId, Shader * a_shader);
+        void Bind();
+        void Upload();
+        void Unbind();
+
+        unsigned int m_vertexArrayId;
+        unsigned int m_vertexBufferId;
+        unsigned int m_indexBufferId;
+        Vertex * m_verts;
+        unsigned int * m_indicies;
+        DynamicBatch * m_batches;
+        unsigned int m_maxVerts;
+        unsigned int m_maxIndices;
+        unsigned int m_maxBatches;
+        unsigned int m_numVerts;
+        unsigned int m_numIndices;
+        unsigned int m_numBatches;
+        unsigned int m_numPrimitives;
+        bool m_uploaded;
     };
 
-    struct DebugSphere
+    //\brief A debug shape that is expanded into the debug line stream every frame until it expires
+    struct PersistentDebugPrimitive
     {
-        DebugSphere() : m_pos(0.0f), m_scale(0.0f) {}
-        Vector m_pos;
-        Vector m_scale;
-        Vector m_colour;
+        enum class Type : unsigned char
+        {
+            Line,
+            AxisBox,
+            Box,
+            Sphere,
+            Transform,
+        };
+
+        PersistentDebugPrimitive()
+            : m_type(Type::Line)
+            , m_mat()
+            , m_pos(0.0f)
+            , m_size(0.0f)
+            , m_colour(sc_colourWhite)
+            , m_expiryTime(0.0f) {}
+
+        Type m_type;
+        Matrix m_mat;                   ///< Orientation of boxes and transforms
+        Vector m_pos;                   ///< Centre of the shape or start of a line
+        Vector m_size;                  ///< Dimensions of a box, radius of a sphere or end of a line
+        Colour m_colour;
+        float m_expiryTime;             ///< Render time after which the primitive is removed
     };
 
-    struct DebugTransform
+    //\brief Large shared vertex and index buffers in the packed model vertex format that meshes are suballocated from
+    //        Every mesh in an arena uses the same VAO so consecutive meshes draw with base vertex offsets and no VAO switch.
+    struct MeshArena
     {
-        DebugTransform() : m_mat() {}
-        Matrix m_mat;
+        void Init();
+        void Shutdown();
+
+        unsigned int m_vertexArrayId{ 0 };
+        unsigned int m_vertexBufferId{ 0 };
+        unsigned int m_indexBufferId{ 0 };
+        FreeListAllocator m_vertexAllocator;    ///< Allocates in vertices
+        FreeListAllocator m_indexAllocator;     ///< Allocates in 4 byte units so 16 and 32 bit index lists can share the buffer
     };
 
-    // Buffer data for a model
-    struct RenderModelBuffer : VertexBuffer
+    //\brief Where an object's mesh lives in the arenas
+    struct MeshAllocation
     {
-        RenderModelBuffer()
-            : m_model(nullptr)
-            , m_object(nullptr) {}
-        Model * m_model;
-        Object * m_object;
+        Model * m_model{ nullptr };
+        Object * m_object{ nullptr };
+        int m_arena{ -1 };
+        unsigned int m_baseVertex{ 0 };         ///< Added to every index when drawing
+        unsigned int m_numVerts{ 0 };
+        unsigned int m_indexOffset{ 0 };        ///< Position of the first index in 4 byte units
+        unsigned int m_numIndices{ 0 };
+        unsigned int m_indexType{ 0 };          ///< GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
     };
 
     //\brief Fixed size structure for queing render models
     struct RenderModel
     {
         RenderModel()
-            : m_buffer(nullptr)
+            : m_meshId(-1)
             , m_mat(nullptr)
             , m_shader(nullptr)
             , m_material(nullptr)
@@ -478,7 +636,7 @@ private:
             , m_normalTexId(0)
             , m_specularTexId(0) {}
         
-        RenderModelBuffer * m_buffer;
+        int m_meshId;
         Matrix * m_mat;
         Shader * m_shader;
         Material * m_material;
@@ -494,12 +652,12 @@ private:
         unsigned int m_specularTexId;
     };
 
-    //\brief Fixes size structure for queing font characters that are just a display list
-    struct FontChar : VertexBuffer
+    //\brief Per instance attributes streamed alongside a shared model buffer, matches the Instance* shader inputs
+    struct InstanceData
     {
-        FontChar() : VertexBuffer(4) {}
-        Vector m_pos;
-        Vector m_scale;
+        float m_mat[16];											///< Object matrix transposed so each row feeds one column of the InstanceMatrix attribute
+        Vector m_shaderData;
+        float m_lifeTime;
     };
 
     //\brief Data associated with each particle owned by an emitter
@@ -578,17 +736,35 @@ private:
         ParticleDefinition m_particleDef;
     };
 
-    //\brief Container for sorting render models before drawing
-    struct SortedRenderModel
+    //\brief Pack the state of a render model into a key that sorts into draw order, from most to least significant bits:
+    //        Opaque:      layer(3) transparent(1) shader(12) texture(12) mesh(12) depth(24)
+    //        Transparent: layer(3) transparent(1) inverse depth(24) shader(12) texture(12) mesh(12)
+    //        Opaque models draw front to back grouped by state, transparent models draw back to front after them
+    static inline uint64_t MakeModelSortKey(int a_layer, bool a_transparent, unsigned short a_shaderId, unsigned int a_textureId, int a_meshId, float a_depth)
     {
-        SortedRenderModel() : m_id(0), m_distance(0.0f) {}
-        SortedRenderModel(int a_id, float a_distance) : m_id(a_id), m_distance(a_distance) {}
-        bool operator > (const SortedRenderModel & a_rhs) { return m_distance > a_rhs.m_distance; }
-        bool operator < (const SortedRenderModel & a_rhs) { return m_distance < a_rhs.m_distance; }
-        int m_id;
-        float m_distance;
-    };
-    typedef LinkedListNode<SortedRenderModel> SortedRenderNode;
+        const float depthNorm = a_depth <= 0.0f ? 0.0f : a_depth >= s_farClipPlane ? 1.0f : a_depth / s_farClipPlane;
+        const uint64_t depth = (uint64_t)(depthNorm * (float)s_sortDepthMask) & s_sortDepthMask;
+        const uint64_t shader = (uint64_t)a_shaderId & 0xFFF;
+        const uint64_t texture = (uint64_t)a_textureId & 0xFFF;
+        const uint64_t mesh = (uint64_t)a_meshId & 0xFFF;
+        uint64_t key = ((uint64_t)a_layer & 0x7) << 61;
+        if (a_transparent)
+        {
+            key |= 1ull << 60;
+            key |= (s_sortDepthMask - depth) << 36;
+            key |= shader << 24;
+            key |= texture << 12;
+            key |= mesh;
+        }
+        else
+        {
+            key |= shader << 48;
+            key |= texture << 36;
+            key |= mesh << 24;
+            key |= depth;
+        }
+        return key;
+    }
 
     //\brief A managed shader contains a reference to the shader and the file to reload on change for hot reloading
     struct ManagedShader
@@ -609,35 +785,86 @@ private:
     void AddManagedShader(ManagedShader * a_newManShader);
     Shader * GetShader(const char * a_shaderName);
 
+    //\brief Helpers to fill out vertices reserved in a dynamic geometry stream
+    static inline void SetVert2D(Vertex & a_vert_OUT, const Vector & a_pos, const Colour & a_colour, const TexCoord & a_uv)
+    {
+        a_vert_OUT.m_pos = a_pos;
+        a_vert_OUT.m_colour = a_colour;
+        a_vert_OUT.m_uv = a_uv;
+        a_vert_OUT.m_normal = Vector(0.0, 0.0, -1.0f);
+    }
+    static inline void SetVertBasic(Vertex & a_vert_OUT, const Vector & a_pos, const Colour & a_colour)
+    {
+        SetVert2D(a_vert_OUT, a_pos, a_colour, TexCoord(0.0f, 0.0f));
+    }
+
+    //\brief Sort all the models in a render layer by key and draw them, runs that share a mesh, shader
+    //        and texture set are one instanced draw if the shader supports it
+    //\param a_viewPos is the world position of the camera for depth sorting
+    void DrawModels(int a_layer, const Vector & a_viewPos, Shader::UniformData & a_shaderData);
+
+    //\brief Copy the uniforms that are per model into the shader data
+    void SetModelShaderData(const RenderModel & a_model, Shader::UniformData & a_shaderData_OUT);
+
+    //\brief Upload a stream of dynamic geometry if it has changed and issue one draw per batch
+    //\param a_primitiveType is the GL primitive that all indices in the stream describe
+    void DrawDynamicGeometry(DynamicGeometry & a_geometry, unsigned int a_primitiveType, Shader::UniformData & a_shaderData);
+
+    //\brief Reserve vertices for a debug shape in the Debug3D line stream
+    //\param a_type is the debug primitive type counted against its own limit
+    //\param a_indices are pairs of line end points relative to the shape's first vertex
+    //\return the vertices to fill out or nullptr if the limit for the type or the stream is reached
+    Vertex * AddDebugLines(RenderObjectType a_type, unsigned int a_numVerts, const unsigned int * a_indices, unsigned int a_numIndices);
+
+    //\brief Store a debug shape to be drawn each frame until its lifetime runs out
+    void AddPersistentDebugPrimitive(const PersistentDebugPrimitive & a_primitive, float a_lifeTime);
+
+    //\brief Find room for an object's mesh in the arenas and upload it, creating a new arena if none have space
+    //\return the mesh id or -1 if there is no space
+    int AllocateMesh(Model * a_model, Object * a_object);
+
     static const int s_maxObjects[(int)RenderObjectType::Count];	///< The amount of storage amount for all types of primitives
-    static const int s_maxModelBuffers = 512;						///< Storage for vertex buffers across all layers, unique meshes share buffers
+    static const int s_maxMeshes = 4096;							///< Unique meshes that can be resident at once, ids fit the sort key
+    static const int s_maxMeshArenas = 4;							///< Arenas are created as earlier ones fill up
+    static const unsigned int s_meshArenaVerts = 1 << 20;			///< Vertices in each arena, 20MB in the packed format
+    static const unsigned int s_meshArenaIndexUnits = 1 << 21;		///< 4 byte index units in each arena, 8MB
     static const int s_maxParticleEmitters = 256;					///< Storage for VBOs that have particles in them
     static const int s_maxParticles = 1024 * 4;						///< The number of verts per particle buffer
     static const int s_numDebugBoxVerts = 8;
-    static const int s_numDebugSphereVerts = 96;
+    static const int s_numDebugBoxIndices = 24;						///< Twelve edges
+    static const int s_numDebugSphereSegments = 16;					///< Lines in each of the three rings
+    static const int s_numDebugSphereVerts = s_numDebugSphereSegments * 3;
+    static const int s_numDebugSphereIndices = s_numDebugSphereVerts * 2;
     static const int s_numDebugTransformVerts = 6;
+    static const int s_maxPersistentDebugPrimitives = 1024;			///< Debug shapes with a lifetime that are redrawn each frame
+    static const int s_maxFontRunGlyphs = 256;						///< Longer strings are split into several font stream primitives
+    static const uint64_t s_sortDepthMask = 0xFFFFFF;				///< Model depth is quantized to 24 bits in sort keys
+    static const unsigned int s_quadIndices[6];						///< Two triangles matching the strip order quads are authored in
+    static const Vector s_debugBoxVerts[s_numDebugBoxVerts];		///< Corners of a unit cube centred on the origin
+    static const unsigned int s_debugBoxIndices[s_numDebugBoxIndices];	///< Edges of the cube as a line list
+    static const unsigned int s_debugTransformIndices[s_numDebugTransformVerts];
     static const float s_updateFreq;								///< How often the render manager should check for shader updates
     static const float s_nearClipPlane;								///< Distance from the viewer to the near clipping plane (always positive) 
     static const float s_farClipPlane;								///< Distance from the viewer to the far clipping plane (always positive).
     static const float s_fovAngleY;									///< Field of view angle, in degrees, in the y direction
     static float s_renderDepth2D;									///< Z value for ortho rendered primitives
 
-    SortedRenderModel* m_sortedRenderModelPool{ nullptr };			///< Storage for pointers to objects and their render distances
-    SortedRenderNode * m_sortedRenderNodePool{ nullptr };			///< Storage for the above in a list for sorting
+    uint64_t * m_modelSortKeys{ nullptr };							///< Sort key for each model in the layer being drawn
+    uint64_t * m_modelSortKeysTemp{ nullptr };						///< Scratch storage for the radix sort
+    int * m_modelSortIds{ nullptr };								///< Index of the model each sort key was made from
+    int * m_modelSortIdsTemp{ nullptr };							///< Scratch storage for the radix sort
+    InstanceData * m_instanceData{ nullptr };						///< CPU side copy of the per instance attributes for a render layer
+    unsigned int m_instanceBufferId{ 0 };							///< Per instance attribute buffer shared by all instanced draws
 
     float m_renderTime{ 0.0f };										///< How long the game has been rendering frames for (accumulated frame delta)
     float m_lastRenderTime{ 0.0f };									///< How long the last frame took
 
     static constexpr unsigned char s_maxLayers = (unsigned char)RenderLayer::Count;
     static constexpr unsigned char s_maxStages = (unsigned char)RenderStage::Count;
-    Tri	 * m_tris[s_maxLayers]{ nullptr };							///< Pointer to a pool of memory for tris
-    Quad * m_quads[s_maxLayers]{ nullptr };							///< Pointer to a pool of memory for quads
-    Line * m_lines[s_maxLayers]{ nullptr };							///< Lines for each renderLayer
-    DebugBox * m_debugBoxes[s_maxLayers]{ nullptr };				///< Debug boxes made of lines
-    DebugSphere * m_debugSpheres[s_maxLayers]{ nullptr };			///< Debug spheres made of lines
-    DebugTransform * m_debugTransforms[s_maxLayers]{ nullptr };		///< Debug transforms made of 3 coloured lines
+    DynamicGeometry m_triGeometry[s_maxLayers];						///< Tris and quads for each renderLayer streamed into one buffer
+    DynamicGeometry m_fontGeometry[s_maxLayers];					///< Characters of all display strings for each renderLayer
+    DynamicGeometry m_lineGeometry[s_maxLayers];					///< Lines for each renderLayer
     RenderModel * m_models[s_maxLayers]{ nullptr };					///< Models for each renderLayer
-    FontChar * m_fontChars[s_maxLayers]{ nullptr };					///< Characters of a display string
     ParticleEmitter m_particleEmitters[s_maxParticleEmitters]{};	///< BUffer containing a vert for each particle
     int m_numParticleEmitters{ 0 };
     int m_objectCount[s_maxLayers][(int)RenderObjectType::Count];	///< How many of each object are batched, resets every frame
@@ -650,10 +877,16 @@ private:
 
     Quad m_fullscreenQuad;											///< Used for drawing full screen buffers
     Quad m_particleBuffer;											///< Single VBO for all world particles
-    VertexBuffer m_debugBoxBuffer;									///< One set of vertices for all boxes
-    VertexBuffer m_debugSphereBuffer;								///< Same concept for spheres
-    VertexBuffer m_debugTransformBuffer;							///< Three coloured lines for transforms
-    RenderModelBuffer m_modelBuffers[s_maxModelBuffers];			///< Storage for model vertex data, one per unique mesh across all render stages
+    Vector m_debugSphereVerts[s_numDebugSphereVerts];				///< Three rings around a unit sphere, built on startup
+    unsigned int m_debugSphereIndices[s_numDebugSphereIndices];		///< Segments of the rings as a line list
+    PersistentDebugPrimitive m_persistentDebug[s_maxPersistentDebugPrimitives];	///< Debug shapes that live for longer than a frame
+    int m_numPersistentDebug{ 0 };
+    unsigned int m_fontRunIndices[s_maxFontRunGlyphs * 6];			///< Two triangles per glyph for the longest font run, built on startup
+    MeshArena m_meshArenas[s_maxMeshArenas];						///< Shared GPU storage for all model meshes
+    int m_numMeshArenas{ 0 };										///< How many arenas have been created
+    MeshAllocation m_meshes[s_maxMeshes];							///< Location of each resident mesh, indexed by mesh id
+    int m_freeMeshIds[s_maxMeshes];									///< Stack of mesh ids not in use
+    int m_numFreeMeshIds{ 0 };
 
     Matrix m_shaderOrthoMat;
     Matrix m_shaderIdentityMat;
@@ -661,6 +894,7 @@ private:
     Shader * m_postShader{ nullptr };								///< Shader used to draw the gbuffers each frame
     Shader * m_colourShader{ nullptr };								///< Vertex and pixel shader used when no shader is specified in a scene or model
     Shader * m_textureShader{ nullptr };							///< Shader for textured objects when no shader specified
+    Shader * m_textureInstancedShader{ nullptr };					///< Shader for textured models when no shader specified, transform comes per instance
     Shader * m_lightingShader{ nullptr };							///< Shader for objects in scenes with lights specified
     Shader * m_particleShader{ nullptr };							///< Shader that updates the position, scale, colour and lifetime of particles and renders them
     Shader * m_finalShader{ nullptr };								///< Shader that draws from the diffuse texture directly to the colour buffer FragmentColour
@@ -685,6 +919,8 @@ private:
     float m_updateFreq{ 0.0f };										///< How often the render manager should check for changes to shaders
     float m_updateTimer{ 0.0f };									///< If we are due for a scan and update of shaders
     int m_drawCallCounter{ -1 };									///< Consumed by the debug menu, set during drawing, cleared during update
+    int m_batchCounter{ 0 };										///< How many batches of dynamic geometry were drawn, cleared during update
+    int m_batchedPrimitiveCounter{ 0 };								///< How many quads, tris, lines and font chars were merged into those batches
 };
 
 #endif // _ENGINE_RENDER_MANAGER
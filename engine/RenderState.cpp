@@ -0,0 +1,178 @@
+#include <glad/gl.h>
+
+#include "RenderState.h"
+
+unsigned int RenderState::s_program = RenderState::s_unknown;
+unsigned int RenderState::s_vertexArray = RenderState::s_unknown;
+unsigned int RenderState::s_readFramebuffer = RenderState::s_unknown;
+unsigned int RenderState::s_drawFramebuffer = RenderState::s_unknown;
+unsigned int RenderState::s_activeTextureUnit = RenderState::s_unknown;
+unsigned int RenderState::s_textures[RenderState::s_maxTextureUnits] =
+{
+	s_unknown, s_unknown, s_unknown, s_unknown, s_unknown, s_unknown, s_unknown, s_unknown,
+	s_unknown, s_unknown, s_unknown, s_unknown, s_unknown, s_unknown, s_unknown, s_unknown
+};
+unsigned int RenderState::s_depthTest = RenderState::s_unknown;
+unsigned int RenderState::s_blend = RenderState::s_unknown;
+unsigned int RenderState::s_blendSrcFactor = RenderState::s_unknown;
+unsigned int RenderState::s_blendDstFactor = RenderState::s_unknown;
+int RenderState::s_issuedCount = 0;
+int RenderState::s_filteredCount = 0;
+
+void RenderState::UseProgram(unsigned int a_program)
+{
+	if (Changed(s_program, a_program))
+	{
+		glUseProgram(a_program);
+	}
+}
+
+void RenderState::BindVertexArray(unsigned int a_vertexArray)
+{
+	if (Changed(s_vertexArray, a_vertexArray))
+	{
+		glBindVertexArray(a_vertexArray);
+	}
+}
+
+void RenderState::BindFramebuffer(unsigned int a_target, unsigned int a_framebuffer)
+{
+	if (a_target == GL_READ_FRAMEBUFFER)
+	{
+		if (Changed(s_readFramebuffer, a_framebuffer))
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, a_framebuffer);
+		}
+	}
+	else if (a_target == GL_DRAW_FRAMEBUFFER)
+	{
+		if (Changed(s_drawFramebuffer, a_framebuffer))
+		{
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, a_framebuffer);
+		}
+	}
+	else if (s_readFramebuffer != a_framebuffer || s_drawFramebuffer != a_framebuffer)
+	{
+		// Binding both targets at once is only redundant if both already match
+		s_readFramebuffer = a_framebuffer;
+		s_drawFramebuffer = a_framebuffer;
+		glBindFramebuffer(GL_FRAMEBUFFER, a_framebuffer);
+		++s_issuedCount;
+	}
+	else
+	{
+		++s_filteredCount;
+	}
+}
+
+void RenderState::BindTexture(int a_unit, unsigned int a_texture)
+{
+	if (a_unit < 0 || a_unit >= s_maxTextureUnits)
+	{
+		return;
+	}
+
+	if (Changed(s_textures[a_unit], a_texture))
+	{
+		if (Changed(s_activeTextureUnit, (unsigned int)a_unit))
+		{
+			glActiveTexture(GL_TEXTURE0 + a_unit);
+		}
+		glBindTexture(GL_TEXTURE_2D, a_texture);
+	}
+}
+
+void RenderState::SetDepthTest(bool a_enabled)
+{
+	if (Changed(s_depthTest, a_enabled ? 1u : 0u))
+	{
+		if (a_enabled)
+		{
+			glEnable(GL_DEPTH_TEST);
+		}
+		else
+		{
+			glDisable(GL_DEPTH_TEST);
+		}
+	}
+}
+
+void RenderState::SetBlend(bool a_enabled)
+{
+	if (Changed(s_blend, a_enabled ? 1u : 0u))
+	{
+		if (a_enabled)
+		{
+			glEnable(GL_BLEND);
+		}
+		else
+		{
+			glDisable(GL_BLEND);
+		}
+	}
+}
+
+void RenderState::SetBlendFunc(unsigned int a_srcFactor, unsigned int a_dstFactor)
+{
+	if (s_blendSrcFactor != a_srcFactor || s_blendDstFactor != a_dstFactor)
+	{
+		s_blendSrcFactor = a_srcFactor;
+		s_blendDstFactor = a_dstFactor;
+		glBlendFunc(a_srcFactor, a_dstFactor);
+		++s_issuedCount;
+	}
+	else
+	{
+		++s_filteredCount;
+	}
+}
+
+void RenderState::Invalidate()
+{
+	s_program = s_unknown;
+	s_vertexArray = s_unknown;
+	s_readFramebuffer = s_unknown;
+	s_drawFramebuffer = s_unknown;
+	s_activeTextureUnit = s_unknown;
+	for (int i = 0; i < s_maxTextureUnits; ++i)
+	{
+		s_textures[i] = s_unknown;
+	}
+	s_depthTest = s_unknown;
+	s_blend = s_unknown;
+	s_blendSrcFactor = s_unknown;
+	s_blendDstFactor = s_unknown;
+}
+
+void RenderState::ForgetProgram(unsigned int a_program)
+{
+	if (s_program == a_program)
+	{
+		s_program = s_unknown;
+	}
+}
+
+void RenderState::ForgetVertexArray(unsigned int a_vertexArray)
+{
+	if (s_vertexArray == a_vertexArray)
+	{
+		s_vertexArray = s_unknown;
+	}
+}
+
+void RenderState::ForgetTexture(unsigned int a_texture)
+{
+	for (int i = 0; i < s_maxTextureUnits; ++i)
+	{
+		if (s_textures[i] == a_texture)
+		{
+			s_textures[i] = s_unknown;
+		}
+	}
+}
+
+void RenderState::ResetCounters()
+{
+	s_issuedCount = 0;
+	s_filteredCount = 0;
+}
@@ -0,0 +1,72 @@
+#ifndef _ENGINE_RENDER_STATE_
+#define _ENGINE_RENDER_STATE_
+#pragma once
+
+//\brief Thin cache in front of the GL state the engine changes while drawing, redundant calls never reach the driver.
+//		 All engine code should change these states through here so the cache always matches the context.
+class RenderState
+{
+public:
+
+	static const int s_maxTextureUnits = 16;	///< Units tracked for 2D texture bindings, the engine uses 0 to 9
+
+	//\brief Bind a program, vertex array or framebuffer if it is not already bound
+	static void UseProgram(unsigned int a_program);
+	static void BindVertexArray(unsigned int a_vertexArray);
+	static void BindFramebuffer(unsigned int a_target, unsigned int a_framebuffer);
+
+	//\brief Bind a 2D texture to a unit, the active texture unit is only changed when the binding changes
+	static void BindTexture(int a_unit, unsigned int a_texture);
+
+	//\brief Fixed function state toggles
+	static void SetDepthTest(bool a_enabled);
+	static void SetBlend(bool a_enabled);
+	static void SetBlendFunc(unsigned int a_srcFactor, unsigned int a_dstFactor);
+
+	//\brief Forget everything that is cached, the next request for each state will always be issued.
+	//		 Call after anything outside the engine changes GL state, like a new context or the VR compositor submit
+	static void Invalidate();
+
+	//\brief Forget an object that is about to be deleted as GL may reuse its name
+	static void ForgetProgram(unsigned int a_program);
+	static void ForgetVertexArray(unsigned int a_vertexArray);
+	static void ForgetTexture(unsigned int a_texture);
+
+	//\brief Per frame statistics of state changes sent to the driver and those dropped as redundant
+	static void ResetCounters();
+	static inline int GetIssuedCount() { return s_issuedCount; }
+	static inline int GetFilteredCount() { return s_filteredCount; }
+
+private:
+
+	static const unsigned int s_unknown = 0xFFFFFFFF;	///< Cached value that never matches a real request
+
+	//\brief Record a request for a state and return true if it needs to be sent to GL
+	template <typename TState>
+	static inline bool Changed(TState & a_cached, const TState & a_requested)
+	{
+		if (a_cached == a_requested)
+		{
+			++s_filteredCount;
+			return false;
+		}
+		a_cached = a_requested;
+		++s_issuedCount;
+		return true;
+	}
+
+	static unsigned int s_program;								///< Currently bound program
+	static unsigned int s_vertexArray;							///< Currently bound VAO
+	static unsigned int s_readFramebuffer;						///< Framebuffers can be bound for reading and drawing separately
+	static unsigned int s_drawFramebuffer;
+	static unsigned int s_activeTextureUnit;					///< Unit that glBindTexture will affect
+	static unsigned int s_textures[s_maxTextureUnits];			///< 2D texture bound to each unit
+	static unsigned int s_depthTest;							///< Enable state stored as unsigned so unknown can be represented
+	static unsigned int s_blend;
+	static unsigned int s_blendSrcFactor;
+	static unsigned int s_blendDstFactor;
+	static int s_issuedCount;									///< Calls made to GL since the counters were reset
+	static int s_filteredCount;									///< Calls dropped because the state was already set
+};
+
+#endif // _ENGINE_RENDER_STATE_
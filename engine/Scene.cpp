@@ -1,6 +1,8 @@
+#include "CameraManager.h"
 #include "CollisionUtils.h"
 #include "DebugMenu.h"
 #include "FontManager.h"
+#include "JobManager.h"
 #include "ModelManager.h"
 #include "PhysicsManager.h"
 #include "RenderManager.h"
@@ -9,8 +11,6 @@
 
 #include "Scene.h"
 
-template<> WorldManager * Singleton<WorldManager>::s_instance = nullptr;
-
 const float Scene::s_updateFreq = 1.0f;								///< How often the scene should check it's config on disk for updates
 
 Scene::Scene() 
@@ -27,11 +27,19 @@ Scene::Scene()
 	// Allocate memory for the scene's object pool
 	m_objects.Init(s_numObjects, sizeof(GameObject));
 	sprintf(m_name, "defaultScene");
+
+	// Scratch space for culling objects against the view each draw
+	m_cullBounds.Init(s_numObjects);
+	m_cullObjects = new GameObject*[m_cullBounds.GetCapacity()];
+	m_cullVisible = new bool[m_cullBounds.GetCapacity()];
 }
 
 Scene::~Scene()
 {
 	Reset();
+
+	delete[] m_cullObjects;
+	delete[] m_cullVisible;
 }
 
 void Scene::Reset()
@@ -53,7 +61,7 @@ void Scene::Reset()
 	}
 
 	m_numLights = 0;
-	m_objects.Reset();
+	ReleaseObjects();
 }
 
 bool Scene::InitFromConfig()
@@ -228,6 +236,13 @@ GameObject * Scene::AddObject()
 	return newGameObject;
 }
 
+void Scene::ReleaseObjects()
+{
+	// Storage is about to be reused so nothing may resolve to it
+	WorldManager::Get().RemoveSceneObjects(this);
+	m_objects.Reset();
+}
+
 bool Scene::AddLight(const char * a_name, const Vector & a_pos, const Quaternion & a_dir, const Colour & a_ambient, const Colour & a_diffuse, const Colour & a_specular)
 {
 	if (m_numLights < Shader::s_maxLights)
@@ -376,7 +391,7 @@ void Scene::RemoveAllObjects(bool a_destroyScriptOwned)
 	}
 
 	m_numLights = 0;
-	m_objects.Reset();
+	ReleaseObjects();
 }
 
 void Scene::RemoveAllScriptOwnedObjects(bool a_destroyScriptBindings)
@@ -391,7 +406,7 @@ void Scene::RemoveAllScriptOwnedObjects(bool a_destroyScriptBindings)
 	}
 
 	m_numLights = 0;
-	m_objects.Reset();
+	ReleaseObjects();
 
 	// Load scene front scratch so we are back with just scene objects and no script objects
 	if (m_sourceFile.Load(m_filePath))
@@ -402,17 +417,53 @@ void Scene::RemoveAllScriptOwnedObjects(bool a_destroyScriptBindings)
 
 bool Scene::Update(float a_dt)
 {
-	// Iterate through all objects in the scene and update state
-	bool updateSuccess = true;
-	for (unsigned int i = 0; i < m_objects.GetCount(); ++i)
+	const unsigned int numObjects = m_objects.GetCount();
+	bool updateObjects = true;
+#ifndef _RELEASE
+	// Don't update game objects while debugging or if time is paused
+	DebugMenu & debugMenu = DebugMenu::Get();
+	updateObjects = !debugMenu.IsDebugMenuEnabled() && !debugMenu.IsTimePaused();
+
+	// Template reloads touch files and other managers so are done here before the objects are handed out
+	if (updateObjects)
 	{
-		if (GameObject * gameObj = m_objects.Get(i))
+		for (unsigned int i = 0; i < numObjects; ++i)
 		{
-			updateSuccess &= gameObj->Update(a_dt);
+			if (GameObject * gameObj = m_objects.Get(i))
+			{
+				gameObj->UpdateTemplate();
+			}
 		}
 	}
+#endif
+
+	// Objects only change their own state when updating so ranges of them are spread over the workers,
+	// the bounds for culling are calculated in the same pass while the object is still in cache
+	std::atomic<bool> updateSuccess(true);
+	JobManager::Get().ParallelFor(0, numObjects, s_updateGrainSize, [this, a_dt, updateObjects, &updateSuccess](unsigned int a_begin, unsigned int a_end)
+	{
+		bool rangeSuccess = true;
+		for (unsigned int i = a_begin; i < a_end; ++i)
+		{
+			if (GameObject * gameObj = m_objects.Get(i))
+			{
+				if (updateObjects)
+				{
+					rangeSuccess &= gameObj->Update(a_dt);
+				}
+				if (gameObj->IsActive())
+				{
+					gameObj->UpdateWorldBounds();
+				}
+			}
+		}
+		if (!rangeSuccess)
+		{
+			updateSuccess.store(false, std::memory_order_relaxed);
+		}
+	});
 
-	// Now state and position have been updated, submit resources to be rendered
+	// Now state and position have been updated, submit resources to be rendered in object order
 	bool drawSuccess = Draw();
 
 	DataPack & dataPack = DataPack::Get();
@@ -449,7 +500,7 @@ bool Scene::Update(float a_dt)
 	}
 #endif
 
-	return updateSuccess && drawSuccess;
+	return updateSuccess.load(std::memory_order_relaxed) && drawSuccess;
 }
 
 void Scene::Serialise()
@@ -507,16 +558,36 @@ void Scene::Serialise()
 
 bool Scene::Draw()
 {
-	// Iterate through all objects in the scene and update state
+	// Gather the world bounds calculated during the update for every active object with a model, anything else is drawn straight away
 	bool drawSuccess = true;
+	m_cullBounds.Clear();
 	for (unsigned int i = 0; i < m_objects.GetCount(); ++i)
 	{
 		if (GameObject * gameObj = m_objects.Get(i))
 		{
-			drawSuccess &= gameObj->Draw();
+			if (gameObj->IsActive() && gameObj->HasWorldBounds() && 
+				m_cullBounds.Add(gameObj->GetWorldBoundsCentre(), gameObj->GetWorldBoundsExtents(), gameObj->GetWorldBoundsRadius()))
+			{
+				m_cullObjects[m_cullBounds.GetCount() - 1] = gameObj;
+			}
+			else
+			{
+				drawSuccess &= gameObj->Draw();
+			}
 		}
 	}
 
+	// Test the gathered bounds against the camera view in batches and only submit models that can be seen
+	Frustum frustum;
+	frustum.Extract(CameraManager::Get().GetCameraMatrix().GetInverse(), RenderManager::Get().GetPerspectiveMatrix());
+	const int numCullObjects = m_cullBounds.GetCount();
+	m_numVisible = frustum.Cull(m_cullBounds, m_cullVisible);
+	m_numCulled = numCullObjects - m_numVisible;
+	for (int i = 0; i < numCullObjects; ++i)
+	{
+		drawSuccess &= m_cullObjects[i]->Draw(m_cullVisible[i]);
+	}
+
 	// Draw all the lights in the scene when debug menu is up
 	if (DebugMenu::Get().IsDebugMenuEnabled())
 	{
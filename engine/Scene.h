@@ -8,6 +8,7 @@
 #include "GameFile.h"
 #include "GameObject.h"
 #include "FileManager.h"
+#include "Frustum.h"
 #include "Shader.h"
 #include "StringUtils.h"
 
@@ -118,6 +119,10 @@ public:
 	//\brief Get the number of objects in the scene
 	//\return uint of the number of objects
 	inline unsigned int GetNumObjects() const { return m_objects.GetCount(); }
+
+	//\brief Get how many objects with models were inside and outside the view the last time the scene was drawn
+	inline int GetNumVisible() const { return m_numVisible; }
+	inline int GetNumCulled() const { return m_numCulled; }
 	
 	//\brief Resource mutators and accessors
 	inline void SetName(const char * a_name) { strncpy(m_name, a_name, StringUtils::s_maxCharsPerName); }
@@ -135,15 +140,24 @@ private:
 	//\brief Load the scene's internal state from the config file
 	bool InitFromConfig();
 
+	//\brief Empty the object storage and make any handles to the objects stale
+	void ReleaseObjects();
+
 	//\brief Draw will cause active objects in the scene to submit resources to the render manager
 	//\return true if resources were submitted without issue
 	bool Draw();
 
 	static const int s_numObjects = 16000;							///< Each GameObject is about 500 bytes, should be less than 16M
+	static const unsigned int s_updateGrainSize = 128;				///< Objects updated per job, enough animation work to outweigh scheduling
 	static const float s_updateFreq;								///< How often the scene should check it's config on disk for updates
 
 	GameFile m_sourceFile;											///< Configuration of the scene
 	PageAllocator<GameObject> m_objects;							///< Pointer to memory allocated for contiguous game objects
+	CullBounds m_cullBounds;										///< World bounds of objects with models gathered each draw for frustum tests
+	GameObject ** m_cullObjects{ nullptr };							///< The object each entry in the cull bounds belongs to
+	bool * m_cullVisible{ nullptr };								///< Result of the frustum test for each entry in the cull bounds
+	int m_numVisible{ 0 };											///< Objects with models that were inside the view last draw
+	int m_numCulled{ 0 };											///< Objects with models that were skipped last draw
 	char m_name[StringUtils::s_maxCharsPerName];					///< Scene name for serialization
 	char m_filePath[StringUtils::s_maxCharsPerLine];				///< Path of the scene for reloading
 	FileManager::Timestamp m_timeStamp{ };							///< When the scene file was last edited
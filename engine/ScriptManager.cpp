@@ -98,6 +98,7 @@ const luaL_Reg ScriptManager::s_gameObjectMethods[] = {
     {"GetVelocity", GetGameObjectVelocity},
     {"HasCollisions", TestGameObjectCollisions},
     {"GetCollisions", GetGameObjectCollisions},
+    {"SetCollisionCallback", SetGameObjectCollisionCallback},
     {"GetRayCollision", RayCollisionTest},
     {"PlayAnimation", PlayGameObjectAnimation},
     {"GetTransformedPos", GetGameObjectTransformedPos},
@@ -333,6 +334,7 @@ bool ScriptManager::Update(float a_dt)
     // Call back to LUA main thread
     if (m_gameLua != nullptr)
     {
+        DispatchContactEvents();
         lua_resume(m_gameLua, nullptr, 0);
         return true;
     }
@@ -416,6 +418,7 @@ bool ScriptManager::Update(float a_dt)
     // Call back to LUA main thread
     if (m_gameLua != nullptr)
     {
+        DispatchContactEvents();
         int yieldResult = lua_resume(m_gameLua, nullptr, 0);
         if (yieldResult != LUA_YIELD)
         {
@@ -447,6 +450,47 @@ void ScriptManager::DestroyObjectScriptBindings(GameObject * a_gameObject)
         lua_settable(m_globalLua, LUA_REGISTRYINDEX);
         a_gameObject->SetScriptReference(-1);
     }
+    if (a_gameObject->HasCollisionCallback())
+    {
+        luaL_unref(m_globalLua, LUA_REGISTRYINDEX, a_gameObject->GetCollisionCallback());
+        a_gameObject->SetCollisionCallback(-1);
+    }
+}
+
+void ScriptManager::DispatchContactEvents()
+{
+    // Scripts only hear about contacts that began or ended, anything still touching can be found with GetCollisions
+    WorldManager & worldMan = WorldManager::Get();
+    for (const Contact & contact : PhysicsManager::Get().GetContactEvents())
+    {
+        if (contact.m_state == ContactState::Stay)
+        {
+            continue;
+        }
+
+        GameObject * gameObj = worldMan.GetGameObject(contact.m_gameObjId);
+        if (gameObj == nullptr || !gameObj->HasCollisionCallback())
+        {
+            continue;
+        }
+
+        // Call the function with the object, the object it touched and whether the contact began or ended
+        lua_rawgeti(m_globalLua, LUA_REGISTRYINDEX, gameObj->GetCollisionCallback());
+        const SlotHandle objIds[2] = { contact.m_gameObjId, contact.m_otherId };
+        for (const SlotHandle objId : objIds)
+        {
+            SlotHandle * userData = (SlotHandle*)lua_newuserdata(m_globalLua, sizeof(SlotHandle));
+            *userData = objId;
+            luaL_getmetatable(m_globalLua, "GameObject.Registry");
+            lua_setmetatable(m_globalLua, -2);
+        }
+        lua_pushstring(m_globalLua, contact.m_state == ContactState::Begin ? "begin" : "end");
+        if (lua_pcall(m_globalLua, 3, 0, 0) != LUA_OK)
+        {
+            Log::Get().Write(LogLevel::Error, LogCategory::Game, "Script error in collision callback: %s", lua_tostring(m_globalLua, -1));
+            lua_pop(m_globalLua, 1);
+        }
+    }
 }
 
 bool ScriptManager::OnWidgetAction(Widget * a_widget)
@@ -484,7 +528,7 @@ GameObject * ScriptManager::CheckGameObject(lua_State * a_luaState, unsigned int
 {
     // Retrieve the object from a userdata reference
     luaL_checktype(a_luaState, a_argumentId, LUA_TUSERDATA);
-    unsigned int * objId = (unsigned int*)(lua_touserdata(a_luaState, a_argumentId));
+    SlotHandle * objId = (SlotHandle*)(lua_touserdata(a_luaState, a_argumentId));
     return WorldManager::Get().GetGameObject(*objId);	
 }
 
@@ -527,7 +571,7 @@ int ScriptManager::CreateGameObject(lua_State * a_luaState)
     if (GameObject * newGameObject = worldMan.CreateObject(templatePath, sceneToAddTo))
     {
         // Allocate memory for an push userdata onto the stack
-        unsigned int * userData = (unsigned int*)lua_newuserdata(a_luaState, sizeof(unsigned int));
+        SlotHandle * userData = (SlotHandle*)lua_newuserdata(a_luaState, sizeof(SlotHandle));
         *userData = newGameObject->GetId();
 
         // Push the metatable where gameobject functions are stored onto the stack
@@ -554,32 +598,37 @@ int ScriptManager::GetGameObject(lua_State * a_luaState)
         return -1;
     }
 
-    // Make sure an id has been supplied
+    // Make sure a name or id has been supplied
     int numArgs = lua_gettop(a_luaState);
-    if (numArgs != 2) 
+    if (numArgs != 2 && numArgs != 3) 
     {
-        LogScriptError(a_luaState, "GetGameObject", "GameObject:Get error, expecting 2 argument: class (before the scope operator) then name or ID of the game object.");
+        LogScriptError(a_luaState, "GetGameObject", "GameObject:Get error, expecting class (before the scope operator) then the name of the game object or the index and generation returned by GetId.");
         lua_pushnil(a_luaState);
         return 1;
     }  
 
-    // Get the object by name or ID
+    // Get the object by name or by the two halves of its ID
     GameObject * gameObj = nullptr;
-    size_t stringLen  = 0;
-    const char * objName = luaL_checklstring(a_luaState, 2, &stringLen);
-    if (objName != nullptr)
+    if (numArgs == 2)
     {
-        gameObj = WorldManager::Get().GetGameObject(objName);
+        size_t stringLen  = 0;
+        const char * objName = luaL_checklstring(a_luaState, 2, &stringLen);
+        if (objName != nullptr)
+        {
+            gameObj = WorldManager::Get().GetGameObject(objName);
+        }
     }
     else
     {
-        gameObj = WorldManager::Get().GetGameObject((unsigned int)lua_tonumber(a_luaState, 1));
+        const unsigned int slotIndex = (unsigned int)luaL_checknumber(a_luaState, 2);
+        const unsigned int generation = (unsigned int)luaL_checknumber(a_luaState, 3);
+        gameObj = WorldManager::Get().GetGameObject(SlotMap<void *>::MakeHandle(slotIndex, generation));
     }
 
     if (gameObj != nullptr)
     {
         // Allocate memory for an push userdata onto the stack
-        unsigned int * userData = (unsigned int*)lua_newuserdata(a_luaState, sizeof(unsigned int));
+        SlotHandle * userData = (SlotHandle*)lua_newuserdata(a_luaState, sizeof(SlotHandle));
         *userData = gameObj->GetId();
 
         // Push the metatable where gameobject functions are stored onto the stack
@@ -1019,8 +1068,8 @@ int ScriptManager::RayCollisionTest(lua_State * a_luaState)
             lua_pushnumber(a_luaState, worldHit.GetY());
             lua_pushnumber(a_luaState, worldHit.GetZ());
             lua_pushnumber(a_luaState, worldNormal.GetX());
-            lua_pushnumber(a_luaState, worldNormal.GetX());
-            lua_pushnumber(a_luaState, worldNormal.GetX());
+            lua_pushnumber(a_luaState, worldNormal.GetY());
+            lua_pushnumber(a_luaState, worldNormal.GetZ());
             return 6;
         }
     }
@@ -2253,8 +2302,11 @@ int ScriptManager::GetGameObjectId(lua_State * a_luaState)
     {
         if (GameObject * gameObj = CheckGameObject(a_luaState))
         {
-            lua_pushnumber(a_luaState, gameObj->GetId());
-            return 1;
+            // Lua numbers are doubles that can't hold every 64 bit handle, each half fits exactly
+            const SlotHandle objId = gameObj->GetId();
+            lua_pushnumber(a_luaState, (lua_Number)SlotMap<void *>::GetSlotIndex(objId));
+            lua_pushnumber(a_luaState, (lua_Number)SlotMap<void *>::GetGeneration(objId));
+            return 2;
         }
         else
         {
@@ -3100,8 +3152,7 @@ int ScriptManager::TestGameObjectCollisions(lua_State * a_luaState)
     {
         if (GameObject * gameObj = CheckGameObject(a_luaState))
         {
-            GameObject::CollisionList * colList = gameObj->GetCollisions();
-            foundCollisions = !colList->IsEmpty();
+            foundCollisions = PhysicsManager::Get().HasContacts(gameObj);
         }
         else
         {
@@ -3129,25 +3180,22 @@ int ScriptManager::GetGameObjectCollisions(lua_State * a_luaState)
             // Push a new table
             lua_newtable(a_luaState);
 
-            int numCollisions = 0;
-            GameObject::CollisionList * colList = gameObj->GetCollisions();
-            GameObject::Collider * curCol = colList->GetHead();
-            while (curCol != nullptr)
+            unsigned int numContacts = 0;
+            const Contact * contacts = PhysicsManager::Get().GetContacts(gameObj, numContacts);
+            for (unsigned int i = 0; i < numContacts; ++i)
             {
                 // Push the key for a table entry
-                lua_pushnumber(a_luaState, ++numCollisions);
+                lua_pushnumber(a_luaState, i + 1);
                 
-                // Push the value - a unsigned int wrapped as user data (our LUA game object)
-                unsigned int * userData = (unsigned int*)lua_newuserdata(a_luaState, sizeof(unsigned int));
-                *userData = curCol->GetData()->GetId();
+                // Push the value - a handle wrapped as user data (our LUA game object)
+                SlotHandle * userData = (SlotHandle*)lua_newuserdata(a_luaState, sizeof(SlotHandle));
+                *userData = contacts[i].m_otherId;
 
                 // Associate the metatable with the userdata
                 luaL_getmetatable(a_luaState, "GameObject.Registry");
                 lua_setmetatable(a_luaState, -2);
 
                 lua_settable(a_luaState, -3);
-
-                curCol = curCol->GetNext();
             }
         }
         else
@@ -3163,6 +3211,37 @@ int ScriptManager::GetGameObjectCollisions(lua_State * a_luaState)
     return 1;
 }
 
+int ScriptManager::SetGameObjectCollisionCallback(lua_State * a_luaState)
+{
+    // Store a reference to the function so it can be called when contacts change, nil clears it
+    if (lua_gettop(a_luaState) == 2)
+    {
+        if (GameObject * gameObj = CheckGameObject(a_luaState))
+        {
+            if (gameObj->HasCollisionCallback())
+            {
+                luaL_unref(a_luaState, LUA_REGISTRYINDEX, gameObj->GetCollisionCallback());
+                gameObj->SetCollisionCallback(-1);
+            }
+            if (!lua_isnil(a_luaState, 2))
+            {
+                luaL_checktype(a_luaState, 2, LUA_TFUNCTION);
+                lua_pushvalue(a_luaState, 2);
+                gameObj->SetCollisionCallback(luaL_ref(a_luaState, LUA_REGISTRYINDEX));
+            }
+        }
+        else
+        {
+            LogScriptError(a_luaState, "SetCollisionCallback", "cannot find the game object referred to.");
+        }
+    }
+    else
+    {
+        LogScriptError(a_luaState, "SetCollisionCallback", "expects a function or nil.");
+    }
+    return 0;
+}
+
 int ScriptManager::PlayGameObjectAnimation(lua_State * a_luaState)
 {
     bool playedAnim = false;
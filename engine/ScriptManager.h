@@ -62,6 +62,9 @@ private:
 	//\param a_message the reason the script created an error
 	static void LogScriptError(lua_State * a_luaState, const char * a_callingFunctionName, const char * a_message);
 
+	//\brief Call the collision callbacks of objects whose contacts began or ended in the last physics update
+	void DispatchContactEvents();
+
 	//\brief Called by LUA during each update to allow the game to run
 	static int YieldLuaEnvironment(lua_State * a_luaState);
 
@@ -189,6 +192,7 @@ private:
 	static int GetGameObjectVelocity(lua_State * a_luaState);
 	static int TestGameObjectCollisions(lua_State * a_luaState);
 	static int GetGameObjectCollisions(lua_State * a_luaState);
+	static int SetGameObjectCollisionCallback(lua_State * a_luaState);
 	static int PlayGameObjectAnimation(lua_State * a_luaState);
 	static int GetGameObjectTransformedPos(lua_State * a_luaState);
 	static int DestroyGameObject(lua_State * a_luaState);
@@ -3,18 +3,26 @@
 #include "Shader.h"
 
 #include "Log.h"
+#include "RenderState.h"
 
 // The size the light is drawn in the in game editor
 const float Light::s_lightDrawSize = 0.1f;		
 
-// Light data is written to shader in an array of floats
-float Shader::s_lightingData[Shader::s_numLightFloats];
+// Uniform block storage shared between all shaders
+const char * Shader::s_uniformBlockNames[(int)Shader::UniformBlock::Count] = { "FrameData", "MaterialData", "ObjectData" };
+GLuint Shader::s_uniformBuffers[(int)Shader::UniformBlock::Count] = { 0, 0, 0 };
+Shader::FrameBlock Shader::s_frameBlock;
+Shader::MaterialBlock Shader::s_materialBlock;
+
+unsigned short Shader::s_nextSortId = 0;
 
 Shader::Shader(const char * a_name)
 : m_vertexShader(0)
 , m_fragmentShader(0)
 , m_geometryShader(0)
 , m_shader(0)
+, m_instanced(false)
+, m_sortId(s_nextSortId++)
 {
 	if (a_name != nullptr || a_name[0] != '\0')
 	{
@@ -26,6 +34,7 @@ Shader::Shader(const char * a_name)
 
 Shader::~Shader() 
 {
+	RenderState::ForgetProgram(m_shader);
 	glDetachShader(m_shader, m_vertexShader);
 	glDetachShader(m_shader, m_fragmentShader);
 	glDeleteProgram(m_shader);
@@ -71,23 +80,7 @@ bool Shader::Init(const char * a_vertexSource, const char * a_fragmentSource, co
 		glBindAttribLocation(m_shader, 5, "ParticleBirthTime");
 
 		glLinkProgram(m_shader);
-
-		// Other particle shader inputs
-		m_diffuseTexture.Init(m_shader, "DiffuseTexture");
-		m_gBuffer1.Init(m_shader, "GBuffer1");
-		m_gBuffer2.Init(m_shader, "GBuffer2");
-		m_gBuffer3.Init(m_shader, "GBuffer3");
-		m_gBuffer4.Init(m_shader, "GBuffer4");
-		m_gBuffer5.Init(m_shader, "GBuffer5");
-		m_gBuffer6.Init(m_shader, "GBuffer6");
-		m_time.Init(m_shader, "Time");
-		m_lifeTime.Init(m_shader, "LifeTime");
-		m_birthTime.Init(m_shader, "BirthTime");
-		m_shaderData.Init(m_shader, "ShaderData");
-		m_objectMatrix.Init(m_shader, "ObjectMatrix");
-		m_viewMatrix.Init(m_shader, "ViewMatrix");
-		m_projectionMatrix.Init(m_shader, "ProjectionMatrix");
-		m_lights.Init(m_shader, "Lights");
+		BindUniforms();
 		return true;
 	}
 	else if (m_vertexShader > 0 && m_fragmentShader > 0)
@@ -100,38 +93,18 @@ bool Shader::Init(const char * a_vertexSource, const char * a_fragmentSource, co
 		glBindAttribLocation(m_shader, 0, "VertexPosition");
 		glBindAttribLocation(m_shader, 1, "VertexColour");
 		glBindAttribLocation(m_shader, 2, "VertexUV");
-		glBindAttribLocation(m_shader, 3, "VertexNormal");
+		glBindAttribLocation(m_shader, 3, "VertexFloatNormal");
+		glBindAttribLocation(m_shader, s_vertexOctNormalAttrib, "VertexOctNormal");
+		glBindAttribLocation(m_shader, s_instanceMatrixAttrib, "InstanceMatrix");
+		glBindAttribLocation(m_shader, s_instanceShaderDataAttrib, "InstanceShaderData");
+		glBindAttribLocation(m_shader, s_instanceLifeTimeAttrib, "InstanceLifeTime");
 
 		glLinkProgram(m_shader);
 
-		// Set up the standard uniforms
-		m_diffuseTexture.Init(m_shader, "DiffuseTexture");
-		m_normalTexture.Init(m_shader, "NormalTexture");
-		m_specularTexture.Init(m_shader, "SpecularTexture");
-		m_gBuffer1.Init(m_shader, "GBuffer1");
-		m_gBuffer2.Init(m_shader, "GBuffer2");
-		m_gBuffer3.Init(m_shader, "GBuffer3");
-		m_gBuffer4.Init(m_shader, "GBuffer4");
-		m_gBuffer5.Init(m_shader, "GBuffer5");
-		m_gBuffer6.Init(m_shader, "GBuffer6");
-		m_depthBuffer.Init(m_shader, "DepthBuffer");
-		m_materialShininess.Init(m_shader, "MaterialShininess");
-		m_numActiveLights.Init(m_shader, "NumActiveLights");
-		m_time.Init(m_shader, "Time");
-		m_lifeTime.Init(m_shader, "LifeTime");
-		m_birthTime.Init(m_shader, "BirthTime");
-		m_frameTime.Init(m_shader, "FrameTime");
-		m_viewWidth.Init(m_shader, "ViewWidth");
-		m_viewHeight.Init(m_shader, "ViewHeight");
-		m_materialAmbient.Init(m_shader, "MaterialAmbient");
-		m_materialDiffuse.Init(m_shader, "MaterialDiffuse");
-		m_materialSpecular.Init(m_shader, "MaterialSpecular");
-		m_materialEmission.Init(m_shader, "MaterialEmission");
-		m_shaderData.Init(m_shader, "ShaderData");
-		m_objectMatrix.Init(m_shader, "ObjectMatrix");
-		m_viewMatrix.Init(m_shader, "ViewMatrix");
-		m_projectionMatrix.Init(m_shader, "ProjectionMatrix");
-		m_lights.Init(m_shader, "Lights");
+		// Unused attributes are stripped by the linker so only shaders that actually read the instance transform draw instanced
+		m_instanced = glGetAttribLocation(m_shader, "InstanceMatrix") >= 0;
+
+		BindUniforms();
 		return true;
 	}
 	return false;
@@ -174,78 +147,154 @@ unsigned int Shader::Compile(GLuint type, const char * a_src)
     return shader;
 }
 
+int Shader::GetUniformLocation(GLuint a_program, const char * a_name)
+{
+	return glGetUniformLocation(a_program, a_name);
+}
+
+void Shader::BindUniforms()
+{
+	// Samplers always read from the same texture units so they only need setting once
+	m_diffuseTexture.Init(m_shader, "DiffuseTexture");
+	m_normalTexture.Init(m_shader, "NormalTexture");
+	m_specularTexture.Init(m_shader, "SpecularTexture");
+	m_gBuffer1.Init(m_shader, "GBuffer1");
+	m_gBuffer2.Init(m_shader, "GBuffer2");
+	m_gBuffer3.Init(m_shader, "GBuffer3");
+	m_gBuffer4.Init(m_shader, "GBuffer4");
+	m_gBuffer5.Init(m_shader, "GBuffer5");
+	m_gBuffer6.Init(m_shader, "GBuffer6");
+	m_depthBuffer.Init(m_shader, "DepthBuffer");
+
+	RenderState::UseProgram(m_shader);
+	glUniform1i(m_diffuseTexture.m_id, 0);
+	glUniform1i(m_normalTexture.m_id, 1);
+	glUniform1i(m_specularTexture.m_id, 2);
+	glUniform1i(m_gBuffer1.m_id, 3);
+	glUniform1i(m_gBuffer2.m_id, 4);
+	glUniform1i(m_gBuffer3.m_id, 5);
+	glUniform1i(m_gBuffer4.m_id, 6);
+	glUniform1i(m_gBuffer5.m_id, 7);
+	glUniform1i(m_gBuffer6.m_id, 8);
+	glUniform1i(m_depthBuffer.m_id, 9);
+
+	// Blocks the program doesn't reference are stripped by the linker
+	for (int i = 0; i < (int)UniformBlock::Count; ++i)
+	{
+		const GLuint blockIndex = glGetUniformBlockIndex(m_shader, s_uniformBlockNames[i]);
+		if (blockIndex != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(m_shader, blockIndex, i);
+		}
+	}
+}
+
+bool Shader::InitUniformBuffers()
+{
+	const size_t blockSizes[(int)UniformBlock::Count] = { sizeof(FrameBlock), sizeof(MaterialBlock), sizeof(ObjectBlock) };
+	memset(&s_frameBlock, 0, sizeof(FrameBlock));
+	memset(&s_materialBlock, 0, sizeof(MaterialBlock));
+
+	// Buffers start zeroed to match the CPU copies and stay bound to their binding point for the life of the context
+	glGenBuffers((int)UniformBlock::Count, &s_uniformBuffers[0]);
+	for (int i = 0; i < (int)UniformBlock::Count; ++i)
+	{
+		void * zeroData = calloc(1, blockSizes[i]);
+		glBindBuffer(GL_UNIFORM_BUFFER, s_uniformBuffers[i]);
+		glBufferData(GL_UNIFORM_BUFFER, blockSizes[i], zeroData, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, i, s_uniformBuffers[i]);
+		free(zeroData);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	return s_uniformBuffers[0] > 0;
+}
+
+void Shader::ShutdownUniformBuffers()
+{
+	glDeleteBuffers((int)UniformBlock::Count, &s_uniformBuffers[0]);
+	for (int i = 0; i < (int)UniformBlock::Count; ++i)
+	{
+		s_uniformBuffers[i] = 0;
+	}
+}
+
+template <typename TBlock>
+void Shader::UploadBlock(UniformBlock a_block, const TBlock & a_data, TBlock & a_uploaded)
+{
+	if (memcmp(&a_data, &a_uploaded, sizeof(TBlock)) != 0)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, s_uniformBuffers[(int)a_block]);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(TBlock), &a_data);
+		a_uploaded = a_data;
+	}
+}
+
 void Shader::UseShader() 
 { 
-	glUseProgram(m_shader); 
-	glActiveTexture(GL_TEXTURE0); 
+	RenderState::UseProgram(m_shader);
 }
 
-void Shader::UseShader(const UniformData & a_data)
+void Shader::SetFrameData(const UniformData & a_data)
 {
-	// Write the lighting data into the static memory location for the shader to reference
+	// Lights are written as an array of floats, each element is padded out to a vec4
+	FrameBlock frame;
+	memset(&frame, 0, sizeof(FrameBlock));
+	memcpy(&frame.m_viewMatrix[0], a_data.m_viewMatrix->GetValues(), sizeof(frame.m_viewMatrix));
+	memcpy(&frame.m_projectionMatrix[0], a_data.m_projectionMatrix->GetValues(), sizeof(frame.m_projectionMatrix));
+	frame.m_time = a_data.m_time;
+	frame.m_frameTime = a_data.m_frameTime;
+	frame.m_viewWidth = a_data.m_viewWidth;
+	frame.m_viewHeight = a_data.m_viewHeight;
 	int lightValCount = 0;
-	int numActiveLights = 0;
 	for (int i = 0; i < s_maxLights; ++i)
 	{
+		const Light & light = a_data.m_lights[i];
 		// Enabled
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_enabled ? 1.0f : 0.0f;
+		frame.m_lights[lightValCount++][0] = light.m_enabled ? 1.0f : 0.0f;
 		// Position
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_pos.GetX();
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_pos.GetY();
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_pos.GetZ();
+		frame.m_lights[lightValCount++][0] = light.m_pos.GetX();
+		frame.m_lights[lightValCount++][0] = light.m_pos.GetY();
+		frame.m_lights[lightValCount++][0] = light.m_pos.GetZ();
 		// Ambient
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_ambient.GetR();
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_ambient.GetG();
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_ambient.GetB();
+		frame.m_lights[lightValCount++][0] = light.m_ambient.GetR();
+		frame.m_lights[lightValCount++][0] = light.m_ambient.GetG();
+		frame.m_lights[lightValCount++][0] = light.m_ambient.GetB();
 		// Diffuse
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_diffuse.GetR();
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_diffuse.GetG();
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_diffuse.GetB();
-		//Specular
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_specular.GetR();
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_specular.GetG();
-		s_lightingData[lightValCount++] = a_data.m_lights[i].m_specular.GetB();
-
-		numActiveLights += a_data.m_lights[i].m_enabled ? 1 : 0;
+		frame.m_lights[lightValCount++][0] = light.m_diffuse.GetR();
+		frame.m_lights[lightValCount++][0] = light.m_diffuse.GetG();
+		frame.m_lights[lightValCount++][0] = light.m_diffuse.GetB();
+		// Specular
+		frame.m_lights[lightValCount++][0] = light.m_specular.GetR();
+		frame.m_lights[lightValCount++][0] = light.m_specular.GetG();
+		frame.m_lights[lightValCount++][0] = light.m_specular.GetB();
+
+		frame.m_numActiveLights += light.m_enabled ? 1 : 0;
 	}
-	glUseProgram(m_shader);
-	glActiveTexture(GL_TEXTURE0);
-	glUniform1i(m_diffuseTexture.m_id, 0);
-	glActiveTexture(GL_TEXTURE1);
-	glUniform1i(m_normalTexture.m_id, 1);
-	glActiveTexture(GL_TEXTURE2);
-	glUniform1i(m_specularTexture.m_id, 2);
-	
-	glActiveTexture(GL_TEXTURE3);
-	glUniform1i(m_gBuffer1.m_id, a_data.m_gBufferIds[0]);
-	glActiveTexture(GL_TEXTURE4);
-	glUniform1i(m_gBuffer2.m_id, a_data.m_gBufferIds[1]);
-	glActiveTexture(GL_TEXTURE5);
-	glUniform1i(m_gBuffer3.m_id, a_data.m_gBufferIds[2]);
-	glActiveTexture(GL_TEXTURE6);
-	glUniform1i(m_gBuffer4.m_id, a_data.m_gBufferIds[3]);
-	glActiveTexture(GL_TEXTURE7);
-	glUniform1i(m_gBuffer5.m_id, a_data.m_gBufferIds[4]);
-	glActiveTexture(GL_TEXTURE8);
-	glUniform1i(m_gBuffer6.m_id, a_data.m_gBufferIds[5]);
-	glActiveTexture(GL_TEXTURE9);
-	glUniform1i(m_depthBuffer.m_id, a_data.m_depthBuffer);
-
-	glUniform1i(m_materialShininess.m_id, a_data.m_materialShininess);
-	glUniform1i(m_numActiveLights.m_id, numActiveLights);
-	glUniform1f(m_time.m_id, a_data.m_time);
-	glUniform1f(m_lifeTime.m_id, a_data.m_lifeTime);
-	glUniform1f(m_birthTime.m_id, a_data.m_birthTime);
-	glUniform1f(m_frameTime.m_id, a_data.m_frameTime);
-	glUniform1f(m_viewWidth.m_id, a_data.m_viewWidth);
-	glUniform1f(m_viewHeight.m_id, a_data.m_viewHeight);
-	glUniform3f(m_materialAmbient.m_id, a_data.m_materialAmbient.GetX(), a_data.m_materialAmbient.GetY(), a_data.m_materialAmbient.GetZ());
-	glUniform3f(m_materialDiffuse.m_id, a_data.m_materialDiffuse.GetX(), a_data.m_materialDiffuse.GetY(), a_data.m_materialDiffuse.GetZ());
-	glUniform3f(m_materialSpecular.m_id, a_data.m_materialSpecular.GetX(), a_data.m_materialSpecular.GetY(), a_data.m_materialSpecular.GetZ());
-	glUniform3f(m_materialEmission.m_id, a_data.m_materialEmission.GetX(), a_data.m_materialEmission.GetY(), a_data.m_materialEmission.GetZ());
-	glUniform3f(m_shaderData.m_id, a_data.m_shaderData.GetX(), a_data.m_shaderData.GetY(), a_data.m_shaderData.GetZ());
-	glUniform1fv(m_lights.m_id, s_maxLights * s_numLightFloats, &s_lightingData[0]);
-	glUniformMatrix4fv(m_objectMatrix.m_id, 1, GL_TRUE, a_data.m_objectMatrix->GetValues());
-	glUniformMatrix4fv(m_viewMatrix.m_id, 1, GL_TRUE, a_data.m_viewMatrix->GetValues());
-	glUniformMatrix4fv(m_projectionMatrix.m_id, 1, GL_TRUE, a_data.m_projectionMatrix->GetValues());
+	UploadBlock(UniformBlock::Frame, frame, s_frameBlock);
+}
+
+void Shader::UseShader(const UniformData & a_data)
+{
+	UseShader();
+
+	MaterialBlock material;
+	memset(&material, 0, sizeof(MaterialBlock));
+	memcpy(&material.m_ambient[0], &a_data.m_materialAmbient, sizeof(float) * 3);
+	memcpy(&material.m_diffuse[0], &a_data.m_materialDiffuse, sizeof(float) * 3);
+	memcpy(&material.m_specular[0], &a_data.m_materialSpecular, sizeof(float) * 3);
+	memcpy(&material.m_emission[0], &a_data.m_materialEmission, sizeof(float) * 3);
+	material.m_shininess = a_data.m_materialShininess;
+	UploadBlock(UniformBlock::Material, material, s_materialBlock);
+
+	ObjectBlock object;
+	memset(&object, 0, sizeof(ObjectBlock));
+	memcpy(&object.m_objectMatrix[0], a_data.m_objectMatrix->GetValues(), sizeof(object.m_objectMatrix));
+	memcpy(&object.m_shaderData[0], &a_data.m_shaderData, sizeof(float) * 3);
+	object.m_lifeTime = a_data.m_lifeTime;
+	object.m_birthTime = a_data.m_birthTime;
+
+	// Object data is different for almost every draw so comparing against the last upload isn't worth it
+	glBindBuffer(GL_UNIFORM_BUFFER, s_uniformBuffers[(int)UniformBlock::Object]);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ObjectBlock), &object);
 }
@@ -43,6 +43,23 @@ public:
 
 	static const int s_maxLights = 4; ///< Maximum amount of light data passed to lighting shaders
 
+	// Per instance vertex attributes follow the four per vertex attributes, a mat4 takes four consecutive locations
+	static const int s_instanceMatrixAttrib = 4;
+	static const int s_instanceShaderDataAttrib = 8;
+	static const int s_instanceLifeTimeAttrib = 9;
+
+	// Model vertices carry an octahedral packed normal in place of the float normal, the w component is one only when it is present
+	static const int s_vertexOctNormalAttrib = 10;
+
+	//\brief Uniforms are grouped by how often they change into blocks that are shared by every program
+	enum class UniformBlock : unsigned char
+	{
+		Frame = 0,	///< Time, view, projection and lights, changes per render layer
+		Material,	///< Material colours and shininess, changes per material
+		Object,		///< Object matrix, shader data and lifetimes, changes per draw
+		Count,
+	};
+
 	//\brief Useful collection of uniform name, location and value data
 	template <typename TDataType>
 	struct Uniform
@@ -60,7 +77,7 @@ public:
 			if (a_name != nullptr && a_name[0] != '\0')
 			{
 				strncpy(m_name, a_name, sizeof(char) * strlen(a_name) + 1);
-				m_id = glGetUniformLocation(a_sourceShader, m_name);
+				m_id = Shader::GetUniformLocation(a_sourceShader, m_name);
 				m_output = a_output;
 			}
 			return m_id >= 0;
@@ -143,11 +160,27 @@ public:
 	inline GLuint GetShader() { return m_shader; }
 	inline const char * GetName() { return &m_name[0]; }
 	inline bool IsCompiled() { return m_vertexShader > 0 && m_fragmentShader > 0 && m_shader > 0; }
+
+	//\brief A shader is instancing aware if it reads the InstanceMatrix attribute instead of the ObjectMatrix uniform
+	inline bool IsInstanced() const { return m_instanced; }
+
+	//\brief Small sequential identifier used to group draws by shader in render sort keys
+	inline unsigned short GetSortId() const { return m_sortId; }
 	
-	//\brief Bind the shader and setup the uniforms
+	//\brief Bind the shader and setup the material and object uniforms, the material block is only uploaded when it changes
 	void UseShader();
 	void UseShader(const UniformData & a_data);
 
+	//\brief Fill and upload the frame block that every shader shares, called once per render layer before any UseShader
+	static void SetFrameData(const UniformData & a_data);
+
+	//\brief Create and destroy the buffers behind the shared uniform blocks, called by the render manager
+	static bool InitUniformBuffers();
+	static void ShutdownUniformBuffers();
+
+	//\brief Look up a uniform in a linked program, wraps the GL call so this header doesn't need the GL headers
+	static int GetUniformLocation(GLuint a_program, const char * a_name);
+
 private:
 
 	// Lighting parameters are written to shader as an array of floats
@@ -155,19 +188,61 @@ private:
 	static const int s_numFloatsPerParameter = 3;
 	static const int s_numLightFloats = s_maxLights * ((s_numLightParameters * s_numFloatsPerParameter) + 1);
 
-	//\brief Static data to write light parameter floats into
-	static float s_lightingData[s_numLightFloats];
+	//\brief CPU side copies of the uniform blocks laid out to match std140 rules
+	struct FrameBlock
+	{
+		float m_viewMatrix[16];
+		float m_projectionMatrix[16];
+		float m_time;
+		float m_frameTime;
+		float m_viewWidth;
+		float m_viewHeight;
+		int m_numActiveLights;
+		float m_pad[3];
+		float m_lights[s_numLightFloats][4];		///< Elements of a float array are each aligned to a vec4
+	};
+	struct MaterialBlock
+	{
+		float m_ambient[4];
+		float m_diffuse[4];
+		float m_specular[4];
+		float m_emission[3];
+		int m_shininess;
+	};
+	struct ObjectBlock
+	{
+		float m_objectMatrix[16];
+		float m_shaderData[3];
+		float m_lifeTime;
+		float m_birthTime;
+		float m_pad[3];
+	};
+
+	//\brief Write a block to its uniform buffer if it differs from what the buffer already holds
+	template <typename TBlock>
+	static void UploadBlock(UniformBlock a_block, const TBlock & a_data, TBlock & a_uploaded);
+
+	static const char * s_uniformBlockNames[(int)UniformBlock::Count];	///< Names of the blocks as declared in GLSL
+	static GLuint s_uniformBuffers[(int)UniformBlock::Count];			///< One buffer per block, bound to the binding point matching the block enum
+	static FrameBlock s_frameBlock;										///< Last data uploaded for the blocks that are compared before upload
+	static MaterialBlock s_materialBlock;
+	static unsigned short s_nextSortId;									///< Incremented for each shader created
 
 	//\brief Compile the shader given the source code
     unsigned int Compile(GLuint type, const char * a_src);
+
+	//\brief After linking, point the samplers at their texture units and the uniform blocks at their binding points
+	void BindUniforms();
 	
 	char m_name[StringUtils::s_maxCharsPerName];	///< Name of the files minus .fsh and .vsh extensions
 	GLuint m_vertexShader;							///< Program to transform vertices
 	GLuint m_fragmentShader;						///< Pixel shader
 	GLuint m_geometryShader;						///< Geometry shader
 	GLuint m_shader;								///< Linked program
+	bool m_instanced;								///< If the program reads object transforms from per instance attributes
+	unsigned short m_sortId;						///< Render sort key id, unique per shader
 
-	Uniform<int> m_diffuseTexture;					///< Standard set of uniforms follow
+	Uniform<int> m_diffuseTexture;					///< Samplers are the only uniforms outside of blocks, their units never change
 	Uniform<int> m_normalTexture;
 	Uniform<int> m_specularTexture;
 	Uniform<int> m_gBuffer1;
@@ -177,23 +252,6 @@ private:
 	Uniform<int> m_gBuffer5;
 	Uniform<int> m_gBuffer6;
 	Uniform<int> m_depthBuffer;
-	Uniform<int> m_materialShininess;
-	Uniform<int> m_numActiveLights;
-	Uniform<float> m_time;
-	Uniform<float> m_lifeTime;
-	Uniform<float> m_birthTime;
-	Uniform<float> m_frameTime;
-	Uniform<float> m_viewWidth;
-	Uniform<float> m_viewHeight;
-	Uniform<Vector> m_materialAmbient;
-	Uniform<Vector> m_materialDiffuse;
-	Uniform<Vector> m_materialSpecular;
-	Uniform<Vector> m_materialEmission;
-	Uniform<Vector> m_shaderData;
-	Uniform<Matrix> m_objectMatrix;
-	Uniform<Matrix> m_viewMatrix;
-	Uniform<Matrix> m_projectionMatrix;
-	Uniform<Light> m_lights;
 };
 
 #endif // _ENGINE_RENDER_MANAGER
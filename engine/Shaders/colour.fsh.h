@@ -1,7 +1,14 @@
 const char * colourFragmentShader = R"(
 #version 400
 in vec4 Colour;
-uniform vec3 MaterialAmbient; 
+layout(std140) uniform MaterialData
+{
+	vec3 MaterialAmbient;
+	vec3 MaterialDiffuse;
+	vec3 MaterialSpecular;
+	vec3 MaterialEmission;
+	int MaterialShininess;
+};
 layout(location = 0) out vec4 FragmentColour;
 layout(location = 1) out vec4 GBuffer1Colour;
 layout(location = 2) out vec4 GBuffer2Colour;
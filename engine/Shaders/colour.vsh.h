@@ -5,9 +5,24 @@ in vec4 VertexColour;
 in vec2 VertexUV;
 in vec3 VertexNormal;
 out vec4 Colour;
-uniform mat4 ObjectMatrix;
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
+layout(std140, row_major) uniform FrameData
+{
+	mat4 ViewMatrix;
+	mat4 ProjectionMatrix;
+	float Time;
+	float FrameTime;
+	float ViewWidth;
+	float ViewHeight;
+	int NumActiveLights;
+	float Lights[4*((4*3)+1)];
+};
+layout(std140, row_major) uniform ObjectData
+{
+	mat4 ObjectMatrix;
+	vec3 ShaderData;
+	float LifeTime;
+	float BirthTime;
+};
 void main()
 {
 	gl_Position = vec4(VertexPosition, 1.0) * ObjectMatrix * ViewMatrix * ProjectionMatrix;
@@ -10,22 +10,32 @@ uniform sampler2D GBuffer4;
 uniform sampler2D GBuffer5; 
 uniform sampler2D GBuffer6; 
 uniform sampler2D DepthBuffer; 
-uniform int MaterialShininess; 
-uniform int NumActiveLights; 
-uniform vec3 MaterialAmbient; 
-uniform vec3 MaterialDiffuse; 
-uniform vec3 MaterialSpecular; 
-uniform vec3 MaterialEmission; 
-uniform float Time; 
-uniform float LifeTime; 
-uniform float FrameTime; 
-uniform float ViewWidth; 
-uniform float ViewHeight; 
-uniform vec3 ShaderData; 
-uniform mat4 ObjectMatrix; 
-uniform mat4 ViewMatrix; 
-uniform mat4 ProjectionMatrix; 
-uniform float Lights[4*((4*3)+1)]; 
+layout(std140, row_major) uniform FrameData
+{
+	mat4 ViewMatrix;
+	mat4 ProjectionMatrix;
+	float Time;
+	float FrameTime;
+	float ViewWidth;
+	float ViewHeight;
+	int NumActiveLights;
+	float Lights[4*((4*3)+1)];
+};
+layout(std140) uniform MaterialData
+{
+	vec3 MaterialAmbient;
+	vec3 MaterialDiffuse;
+	vec3 MaterialSpecular;
+	vec3 MaterialEmission;
+	int MaterialShininess;
+};
+layout(std140, row_major) uniform ObjectData
+{
+	mat4 ObjectMatrix;
+	vec3 ShaderData;
+	float LifeTime;
+	float BirthTime;
+};
 layout(location = 0) out vec4 FragmentColour;
 layout(location = 1) out vec4 GBuffer1Colour;
 layout(location = 2) out vec4 GBuffer2Colour;
@@ -3,16 +3,39 @@ const char * globalVertexShader = R"(
 in vec3 VertexPosition;
 in vec4 VertexColour;
 in vec2 VertexUV;
-in vec3 VertexNormal;
-uniform float Time;  
-uniform float LifeTime; 
-uniform float FrameTime; 
-uniform float ViewWidth; 
-uniform float ViewHeight; 
-uniform vec3 ShaderData; 
-uniform mat4 ObjectMatrix; 
-uniform mat4 ViewMatrix; 
-uniform mat4 ProjectionMatrix; 
+in vec3 VertexFloatNormal;
+in vec4 VertexOctNormal;
+in mat4 InstanceMatrix;
+in vec3 InstanceShaderData;
+in float InstanceLifeTime;
+layout(std140, row_major) uniform FrameData
+{
+	mat4 ViewMatrix;
+	mat4 ProjectionMatrix;
+	float Time;
+	float FrameTime;
+	float ViewWidth;
+	float ViewHeight;
+	int NumActiveLights;
+	float Lights[4*((4*3)+1)];
+};
+layout(std140, row_major) uniform ObjectData
+{
+	mat4 ObjectMatrix;
+	vec3 ShaderData;
+	float LifeTime;
+	float BirthTime;
+};
+vec3 OctDecode(vec2 e)
+{
+	vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	if (v.z < 0.0)
+	{
+		v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(v);
+}
+#define VertexNormal (VertexOctNormal.w > 0.5 ? OctDecode(VertexOctNormal.xy) : VertexFloatNormal)
 float rand(vec2 co) 
 { 
 	return fract(sin(dot(co.xy ,vec2(12.9898,78.233))) * 43758.5453); 
@@ -6,16 +6,25 @@ in vec3 LightVertexNormal;
 uniform sampler2D DiffuseTexture; 
 uniform sampler2D NormalTexture; 
 uniform sampler2D SpecularTexture; 
-uniform int MaterialShininess; 
-uniform int NumActiveLights; 
-uniform vec3 MaterialAmbient; 
-uniform vec3 MaterialDiffuse; 
-uniform vec3 MaterialSpecular; 
-uniform vec3 MaterialEmission; 
-uniform mat4 ObjectMatrix; 
-uniform mat4 ViewMatrix; 
-uniform mat4 ProjectionMatrix; 
-uniform float Lights[4*((4*3)+1)]; 
+layout(std140, row_major) uniform FrameData
+{
+	mat4 ViewMatrix;
+	mat4 ProjectionMatrix;
+	float Time;
+	float FrameTime;
+	float ViewWidth;
+	float ViewHeight;
+	int NumActiveLights;
+	float Lights[4*((4*3)+1)];
+};
+layout(std140) uniform MaterialData
+{
+	vec3 MaterialAmbient;
+	vec3 MaterialDiffuse;
+	vec3 MaterialSpecular;
+	vec3 MaterialEmission;
+	int MaterialShininess;
+};
 layout(location = 0) out vec4 FragmentColour;
 layout(location = 1) out vec4 GBuffer1Colour;
 void main(void) 
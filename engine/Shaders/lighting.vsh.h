@@ -3,18 +3,43 @@ const char * lightingVertexShader = R"(
 in vec3 VertexPosition;
 in vec4 VertexColour;
 in vec2 VertexUV;
-in vec3 VertexNormal;
+in vec3 VertexFloatNormal;
+in vec4 VertexOctNormal;
 out vec2 OutTexCoord;
 out vec4 LightVertexPos; 
 out vec3 LightVertexNormal; 
-uniform mat4 ObjectMatrix;
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
+layout(std140, row_major) uniform FrameData
+{
+	mat4 ViewMatrix;
+	mat4 ProjectionMatrix;
+	float Time;
+	float FrameTime;
+	float ViewWidth;
+	float ViewHeight;
+	int NumActiveLights;
+	float Lights[4*((4*3)+1)];
+};
+layout(std140, row_major) uniform ObjectData
+{
+	mat4 ObjectMatrix;
+	vec3 ShaderData;
+	float LifeTime;
+	float BirthTime;
+};
 out vec4 Colour;
+vec3 OctDecode(vec2 e)
+{
+	vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	if (v.z < 0.0)
+	{
+		v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(v);
+}
 void main(void)  
 { 
 	LightVertexPos = vec4(VertexPosition, 1.0) * ObjectMatrix;
-	LightVertexNormal = VertexNormal;
+	LightVertexNormal = VertexOctNormal.w > 0.5 ? OctDecode(VertexOctNormal.xy) : VertexFloatNormal;
 	OutTexCoord = VertexUV;
 	gl_Position = vec4(VertexPosition, 1.0) * ObjectMatrix * ViewMatrix * ProjectionMatrix;
 }
@@ -2,8 +2,17 @@ const char * particleGeometryShader = R"(
 #version 400
 layout (points) in;
 layout (triangle_strip, max_vertices = 4) out;
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
+layout(std140, row_major) uniform FrameData
+{
+	mat4 ViewMatrix;
+	mat4 ProjectionMatrix;
+	float Time;
+	float FrameTime;
+	float ViewWidth;
+	float ViewHeight;
+	int NumActiveLights;
+	float Lights[4*((4*3)+1)];
+};
 in Particle 
 { 
 	vec3 Position;
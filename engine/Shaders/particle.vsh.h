@@ -1,8 +1,23 @@
 const char * particleVertexShader = R"(
 #version 400
-uniform float Time; 
-uniform float LifeTime; 
-uniform mat4 ObjectMatrix;
+layout(std140, row_major) uniform FrameData
+{
+	mat4 ViewMatrix;
+	mat4 ProjectionMatrix;
+	float Time;
+	float FrameTime;
+	float ViewWidth;
+	float ViewHeight;
+	int NumActiveLights;
+	float Lights[4*((4*3)+1)];
+};
+layout(std140, row_major) uniform ObjectData
+{
+	mat4 ObjectMatrix;
+	vec3 ShaderData;
+	float LifeTime;
+	float BirthTime;
+};
 in vec3 ParticlePosition;
 in vec3 ParticleVelocity;
 in vec4 ParticleColour;
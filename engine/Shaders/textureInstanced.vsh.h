@@ -0,0 +1,26 @@
+const char * textureInstancedVertexShader = R"(
+#version 400
+in vec3 VertexPosition;
+in vec4 VertexColour;
+in vec2 VertexUV;
+in mat4 InstanceMatrix;
+out vec4 Colour;
+out vec2 OutTexCoord;
+layout(std140, row_major) uniform FrameData
+{
+	mat4 ViewMatrix;
+	mat4 ProjectionMatrix;
+	float Time;
+	float FrameTime;
+	float ViewWidth;
+	float ViewHeight;
+	int NumActiveLights;
+	float Lights[4*((4*3)+1)];
+};
+void main() 
+{ 
+	gl_Position = vec4(VertexPosition, 1.0) * InstanceMatrix * ViewMatrix * ProjectionMatrix;
+	Colour = VertexColour;
+	OutTexCoord = VertexUV;
+}
+)";
\ No newline at end of file
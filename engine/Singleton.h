@@ -35,6 +35,9 @@ public:
 		return *s_instance;
 	}
 
+	//\brief Check for an instance without making one, for systems that are optional when running headless
+	static bool IsCreated() { return s_instance != nullptr; }
+
 protected:
 	Singleton() {}
 	virtual ~Singleton() {}
@@ -144,7 +144,7 @@ const char * StringUtils::ExtractFileNameFromPath(const char * a_buffer)
 void StringUtils::TrimFileNameFromPath(char * a_buffer_OUT)
 {
 	unsigned int  bufLength = strlen(a_buffer_OUT);
-	if (a_buffer_OUT > 0)
+	if (a_buffer_OUT != nullptr)
 	{
 		// Work backwards through the string until a slash is encountered
 		for (unsigned int i = bufLength; i > 0; --i)
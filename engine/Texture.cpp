@@ -7,6 +7,7 @@
 #include "SDL.h"
 
 #include "Log.h"
+#include "RenderState.h"
 
 using namespace std;
 
@@ -91,7 +92,7 @@ bool Texture::LoadFromMemoryAndFree(int a_width, int a_height, int a_bpp, void *
 	if (textureData == nullptr)
 	{
 		printf("Malloc failed in texture load from blank\n");
-		return nullptr;
+		return false;
 	}
 
 	return GenerateTexture(a_width, a_height, a_bpp, a_useLinearFilter, textureData);
@@ -118,8 +119,22 @@ bool Texture::RegenerateTexture(int a_width, int a_height, int a_bpp, void * a_t
 	return true;
 }
 
+void Texture::Unload()
+{
+	if (IsLoaded())
+	{
+		GLuint textureID = m_textureId;
+		RenderState::ForgetTexture(textureID);
+		glDeleteTextures(1, &textureID);
+		m_textureId = -1;
+	}
+}
+
 bool Texture::GenerateTexture(int a_x, int a_y, int a_bpp, bool a_useLinearFilter, GLubyte * textureData)
 {
+	// Reloading replaces the texture so let go of the old one first
+	Unload();
+
 	GLuint textureID;
 	GLenum texFormat, intTexFormat;
     switch (a_bpp) 
@@ -146,7 +161,7 @@ bool Texture::GenerateTexture(int a_x, int a_y, int a_bpp, bool a_useLinearFilte
     
 	const int numMips = 8;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    RenderState::BindTexture(0, textureID);
 	glTexStorage2D(GL_TEXTURE_2D, numMips, GL_UNSIGNED_BYTE, a_x, a_y);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
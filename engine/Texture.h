@@ -49,6 +49,9 @@ public:
 	//\brief Reload a texture from a buffer of raw OpenGL format pixel data
 	bool RegenerateTexture(int a_width, int a_height, int a_bpp, void * a_textureData);
 
+	//\brief Release the graphics resources of a loaded texture, it can be loaded again after
+	void Unload();
+
 	//\brief Utility methods for texture member data for convenience
 	inline bool IsLoaded() { return m_textureId >= 0; }
 	inline unsigned int GetId() { return m_textureId; }
@@ -57,6 +57,9 @@ bool TextureManager::Init(bool a_useLinearTextureFilter)
 		{
 			// This can be removed in all but DEBUG configuration, but its nice when viewing memory
 			memset(m_texturePool[i].GetHead(), 0, m_texturePool[i].GetAllocationSizeBytes());
+
+			// The pool caps how many textures there can be so size the map once instead of growing it while loading
+			m_textureMap[i].Reserve(s_texurePoolSize[i] / sizeof(ManagedTexture));
 		}
 		else // Allocation of the pool failed in Init
 		{
@@ -73,9 +76,16 @@ bool TextureManager::Init(bool a_useLinearTextureFilter)
 
 bool TextureManager::Shutdown()
 {
-	// Cleanup memory
+	// Cleanup graphics resources and memory
 	for (unsigned int i = 0; i < static_cast<unsigned int>(TextureCategory::Count); ++i)
 	{
+		ManagedTexture * curTex = nullptr;
+		auto textureIterator = m_textureMap[i].GetIterator();
+		while (m_textureMap[i].GetNext(textureIterator, curTex) && curTex != nullptr)
+		{
+			curTex->m_texture.Unload();
+		}
+		m_textureMap[i].Clear();
 		m_texturePool[i].Done();
 	}
 
@@ -16,9 +16,6 @@ bool WorldManager::Startup(const char * a_templatePath, const char * a_scenePath
 	memset(&m_templatePath, 0 , StringUtils::s_maxCharsPerLine);
 	strncpy(m_templatePath, a_templatePath, sizeof(char) * strlen(a_templatePath) + 1);
 
-	// Allocate memory for the global world lookup directory
-	m_objectLookup.Init(s_numLookup, sizeof(ObjectLookup));
-
 	// Generate list to iterate through all scenes in the scenepath and load them
 	memset(&m_scenePath, 0 , StringUtils::s_maxCharsPerLine);
 	strncpy(m_scenePath, a_scenePath, sizeof(char) * strlen(a_scenePath) + 1);
@@ -187,10 +184,10 @@ GameObject * WorldManager::CreateObject(const char * a_templatePath, Scene * a_s
 
 	// Add a new game object to the scene
 	GameObject * newGameObject = sceneToAddObjectTo->AddObject();
-	ObjectLookup * lookup = m_objectLookup.Add(m_totalGameObjects);
-	lookup->m_scene = sceneToAddObjectTo;
-	lookup->m_storageId = sceneToAddObjectTo->GetNumObjects() - 1;
-	newGameObject->SetId(m_totalGameObjects++);
+	ObjectLookup lookup;
+	lookup.m_scene = sceneToAddObjectTo;
+	lookup.m_storageId = sceneToAddObjectTo->GetNumObjects() - 1;
+	newGameObject->SetId(m_objectLookup.Add(lookup));
 
 	// Template paths are either fully qualified or relative to the config template dir
 	ModelManager & modelMan = ModelManager::Get();
@@ -379,7 +376,7 @@ GameObject * WorldManager::CreateObject(const char * a_templatePath, Scene * a_s
 	return newGameObject;
 }
 
-bool WorldManager::DestroyObject(unsigned int a_objectId, bool a_destroyScriptBindings) 
+bool WorldManager::DestroyObject(SlotHandle a_objectId, bool a_destroyScriptBindings) 
 { 
 	if (GameObject * obj = GetGameObject(a_objectId))
 	{
@@ -389,6 +386,9 @@ bool WorldManager::DestroyObject(unsigned int a_objectId, bool a_destroyScriptBi
 			ScriptManager::Get().DestroyObjectScriptBindings(obj);
 		}
 
+		// Any handles still held by script or other objects resolve to null from now on
+		m_objectLookup.Remove(a_objectId);
+
 		// Remove itself from any scenes
 		return obj->Shutdown();
 	}
@@ -399,7 +399,6 @@ bool WorldManager::DestroyObject(unsigned int a_objectId, bool a_destroyScriptBi
 void WorldManager::DestroyAllObjects(bool a_destroyScriptOwned)
 {
 	// Iterate through all scenes and destroy objects
-	m_totalGameObjects = 0;
 	SceneNode * next = m_scenes.GetHead();
 	while(next != nullptr)
 	{
@@ -411,7 +410,6 @@ void WorldManager::DestroyAllObjects(bool a_destroyScriptOwned)
 void WorldManager::DestroyAllScriptOwnedObjects(bool a_destroyScriptBindings)
 {
 	// Iterate through all scenes and destroy objects
-	m_totalGameObjects = 0;
 	SceneNode * next = m_scenes.GetHead();
 	while(next != nullptr)
 	{
@@ -420,9 +418,9 @@ void WorldManager::DestroyAllScriptOwnedObjects(bool a_destroyScriptBindings)
 	}
 }
 
-GameObject * WorldManager::GetGameObject(unsigned int a_objectId)
+GameObject * WorldManager::GetGameObject(SlotHandle a_objectId)
 {
-	// Use the lookup to reference the scene and object directly
+	// Use the lookup to reference the scene and object directly, stale handles fail the generation check
 	if (ObjectLookup * lookup = m_objectLookup.Get(a_objectId))
 	{
 		return lookup->m_scene->GetSceneObject(lookup->m_storageId);
@@ -432,6 +430,18 @@ GameObject * WorldManager::GetGameObject(unsigned int a_objectId)
 	return nullptr;
 }
 
+void WorldManager::RemoveSceneObjects(Scene * a_scene)
+{
+	// Walk backwards so the object swapped into a removed entry has already been visited
+	for (unsigned int i = m_objectLookup.GetCount(); i > 0; --i)
+	{
+		if (m_objectLookup.GetValue(i - 1).m_scene == a_scene)
+		{
+			m_objectLookup.Remove(m_objectLookup.GetHandle(i - 1));
+		}
+	}
+}
+
 Scene * WorldManager::GetScene(const char * a_sceneName)
 {
 	SceneNode * next = m_scenes.GetHead();
@@ -4,7 +4,7 @@
 #include <fstream>
 
 #include "../core/LinkedList.h"
-#include "../core/PageAllocator.h"
+#include "../core/SlotMap.h"
 
 #include "GameObject.h"
 #include "Scene.h"
@@ -23,8 +23,7 @@ public:
 
 	//\brief Ctor calls through to startup
 	WorldManager() 
-		: m_totalGameObjects(0)
-		, m_currentScene(nullptr) { m_templatePath[0] = '\0'; m_scenePath[0] = '\0'; }
+		: m_currentScene(nullptr) { m_templatePath[0] = '\0'; m_scenePath[0] = '\0'; }
 	~WorldManager() { Shutdown(); }
 
 	//\brief Initialise memory pools on startup, cleanup worlds objects on shutdown
@@ -47,7 +46,7 @@ public:
 	//\brief Remove a created object from the world
 	//\param a_destroyScriptBindings true if the script management bindings should be killed
 	//\return true if an object is destroyed
-	bool DestroyObject(unsigned int a_objectId, bool a_destroyScriptBindings = false);
+	bool DestroyObject(SlotHandle a_objectId, bool a_destroyScriptBindings = false);
 
 	//\brief Destroy all objects in the current scene
 	//\param a_destroyScriptOwned bool to specify destruction of scripts owned objects
@@ -60,9 +59,9 @@ public:
 	void DestroyAllScriptOwnedObjects(bool a_destroyScriptBindings = true);
 
 	//\brief Get a pointer to an existing object in the world.
-	//\param a_objectId the unique game id for this object
-	//\return Pointer to a game object in the world
-	GameObject * GetGameObject(unsigned int a_objectId);
+	//\param a_objectId the handle returned by GameObject::GetId
+	//\return Pointer to a game object in the world or nullptr if the object has since been destroyed
+	GameObject * GetGameObject(SlotHandle a_objectId);
 	GameObject * GetGameObject(const char * a_objName);
 
 	//\brief Get the scene that the world is currently showing
@@ -73,6 +72,12 @@ public:
 	void SetCurrentScene(const char * a_sceneName);
 	void SetNewScene(const char * a_sceneName);
 
+	//\brief Called by a scene when it throws away its object storage so handles to those objects go stale
+	void RemoveSceneObjects(Scene * a_scene);
+
+	//\brief Number of live objects across all scenes
+	inline unsigned int GetNumObjects() const { return m_objectLookup.GetCount(); }
+
 	//\brief Accessor for the relative paths
 	inline const char * GetTemplatePath() { return m_templatePath; }
 	inline const char * GetScenePath() { return m_scenePath; }
@@ -87,14 +92,11 @@ private:
 		unsigned int m_storageId;	///< The position in the scene's storage array of the object
 	};
 
-	static const int s_numLookup = 655360;					///< Each ObjectLookup is about 48 bits, 20M of total lookup storage
-
 	//\brief Alias to refer to a group of objects
 	typedef LinkedListNode<Scene> SceneNode;
-	PageAllocator<ObjectLookup> m_objectLookup;				///< Collection of lookups for finding game objects in O(1) time
+	SlotMap<ObjectLookup> m_objectLookup;					///< Handle to scene storage for finding game objects in O(1) time, grows with the live object count
 	LinkedList<Scene> m_scenes;								///< All the currently loaded scenes are added to this list
 	Scene * m_currentScene;									///< The currently active scene
-	unsigned int m_totalGameObjects;						///< Total object count across all scenes, drives ID creation
 	char m_templatePath[StringUtils::s_maxCharsPerLine];	///< Path for templates
 	char m_scenePath[StringUtils::s_maxCharsPerLine];		///< Path for scene files
 };
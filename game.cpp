@@ -26,12 +26,14 @@
 #include "engine/GameFile.h"
 #include "engine/Gui.h"
 #include "engine/InputManager.h"
+#include "engine/JobManager.h"
 #include "engine/Log.h"
 #include "engine/ModelManager.h"
 #if ENABLE_VR
 #include "engine/VRManager.h"
 #endif
 #include "engine/RenderManager.h"
+#include "engine/RenderState.h"
 #include "engine/ScriptManager.h"
 #include "engine/StringUtils.h"
 #include "engine/TextureManager.h"
@@ -244,6 +246,9 @@ int main(int argc, char *argv[])
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
 	SDL_GLContext glcontext = SDL_GL_CreateContext(sdlWindow);
+
+	// A new context starts with default GL state so nothing in the render state cache applies to it
+	RenderState::Invalidate();
 	
 	// Go as fast as we can nyoom
 	SDL_GL_SetSwapInterval(0);
@@ -279,6 +284,7 @@ int main(int argc, char *argv[])
 	FontManager::Get().Startup(fontPath, &dataPack);
 	InputManager::Get().Startup(fullScreen);
 	ModelManager::Get().Startup(modelPath, &dataPack);
+	JobManager::Get().Startup(gameConfig);
 	PhysicsManager::Get().Startup(gameConfig);
 	AnimationManager::Get().Startup(modelPath, &dataPack);
 	WorldManager::Get().Startup(templatePath, scenePath, &dataPack);
@@ -293,6 +299,7 @@ int main(int argc, char *argv[])
 	FontManager::Get().Startup(fontPath);
 	InputManager::Get().Startup(fullScreen);
 	ModelManager::Get().Startup(modelPath, NULL);
+	JobManager::Get().Startup(gameConfig);
 	PhysicsManager::Get().Startup(gameConfig);
 	AnimationManager::Get().Startup(modelPath, NULL);
 	WorldManager::Get().Startup(templatePath, scenePath, NULL);
@@ -419,18 +426,22 @@ int main(int argc, char *argv[])
 #endif
 		
 		// Only swap the buffers at the end of all the rendering passes
+		Matrix viewMatrix = CameraManager::Get().GetCameraMatrix().GetInverse();
 #if ENABLE_VR
 		if (useVr)
 		{
-			if (!VRManager::Get().DrawToHMD())
+			// The compositor submit changes GL state behind the render state cache's back
+			const bool drawnToHmd = VRManager::Get().DrawToHMD();
+			RenderState::Invalidate();
+			if (!drawnToHmd)
 			{
-				RenderManager::Get().DrawToScreen(CameraManager::Get().GetCameraMatrix().GetInverse());
+				RenderManager::Get().DrawToScreen(viewMatrix);
 			}
 		}
 		else
 #endif
 		{
-			RenderManager::Get().DrawToScreen(CameraManager::Get().GetCameraMatrix().GetInverse());
+			RenderManager::Get().DrawToScreen(viewMatrix);
 		}
 
 #ifndef _RELEASE
@@ -470,6 +481,7 @@ int main(int argc, char *argv[])
 	RenderManager::Get().Shutdown();
 	InputManager::Get().Shutdown();
 	SoundManager::Get().Shutdown();
+	JobManager::Get().Shutdown();
 
 #if ENABLE_VR
 	if (useVr)
@@ -0,0 +1,263 @@
+// Benchmark for core/SweepAndPrune.h against testing every pair of colliders
+// Moves bodies around a wide, flat level like the collision world sees each frame and times finding the
+// overlapping pairs. Compares the pairs against the brute force result every so often so it can run as
+// a smoke test for the broadphase.
+//
+// Build: bazel build -c opt //tests:bench_broadphase
+// Run:   bazel-bin/tests/bench_broadphase
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../core/SweepAndPrune.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedNs(Clock::time_point a_start, Clock::time_point a_end)
+{
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(a_end - a_start).count();
+}
+
+static const int s_numGroups = 4;
+
+struct Body
+{
+	Vector m_pos;
+	Vector m_vel;
+	float m_radius;
+	int m_group;
+};
+
+// Each group collides with itself and the next one along, so some overlapping pairs get filtered out
+static unsigned int GetCollidesWith(int a_group)
+{
+	return (1u << a_group) | (1u << ((a_group + 1) % s_numGroups));
+}
+
+static void GetBounds(const Body & a_body, Vector & a_min_OUT, Vector & a_max_OUT)
+{
+	a_min_OUT = a_body.m_pos - Vector(a_body.m_radius);
+	a_max_OUT = a_body.m_pos + Vector(a_body.m_radius);
+}
+
+// Bodies bounce around inside the level bounds
+static void MoveBodies(std::vector<Body> & a_bodies, Vector a_levelSize, float a_dt)
+{
+	const float * size = a_levelSize.GetValues();
+	for (Body & body : a_bodies)
+	{
+		body.m_pos += body.m_vel * a_dt;
+		float * pos = body.m_pos.GetValues();
+		float * vel = body.m_vel.GetValues();
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if ((pos[axis] < 0.0f && vel[axis] < 0.0f) || (pos[axis] > size[axis] && vel[axis] > 0.0f))
+			{
+				vel[axis] = -vel[axis];
+			}
+		}
+	}
+}
+
+typedef std::pair<unsigned int, unsigned int> IndexPair;
+
+static IndexPair MakeIndexPair(unsigned int a_indexA, unsigned int a_indexB)
+{
+	return a_indexA < a_indexB ? IndexPair(a_indexA, a_indexB) : IndexPair(a_indexB, a_indexA);
+}
+
+// What UpdateCollisionWorld used to do, minus testing each pair a second time the other way round
+static void FindPairsBruteForce(const std::vector<Body> & a_bodies, std::vector<IndexPair> & a_pairs_OUT)
+{
+	a_pairs_OUT.clear();
+	const unsigned int numBodies = (unsigned int)a_bodies.size();
+	for (unsigned int i = 0; i < numBodies; ++i)
+	{
+		Vector minA, maxA;
+		GetBounds(a_bodies[i], minA, maxA);
+		for (unsigned int j = i + 1; j < numBodies; ++j)
+		{
+			const int groupA = a_bodies[i].m_group;
+			const int groupB = a_bodies[j].m_group;
+			if ((GetCollidesWith(groupA) & (1u << groupB)) == 0 && (GetCollidesWith(groupB) & (1u << groupA)) == 0)
+			{
+				continue;
+			}
+			Vector minB, maxB;
+			GetBounds(a_bodies[j], minB, maxB);
+			if (minA.GetX() <= maxB.GetX() && minB.GetX() <= maxA.GetX() &&
+				minA.GetY() <= maxB.GetY() && minB.GetY() <= maxA.GetY() &&
+				minA.GetZ() <= maxB.GetZ() && minB.GetZ() <= maxA.GetZ())
+			{
+				a_pairs_OUT.push_back(IndexPair(i, j));
+			}
+		}
+	}
+}
+
+static void UpdateProxies(SweepAndPrune & a_broadphase)
+{
+	for (unsigned int i = 0; i < a_broadphase.GetNumProxies(); ++i)
+	{
+		const Body & body = *static_cast<const Body *>(a_broadphase.GetUserData(i));
+		Vector boundsMin, boundsMax;
+		GetBounds(body, boundsMin, boundsMax);
+		a_broadphase.UpdateProxy(i, boundsMin, boundsMax, 1u << body.m_group, GetCollidesWith(body.m_group));
+	}
+}
+
+struct BenchResult
+{
+	double m_firstFrameMs = 0.0;	// Includes sorting from scratch
+	double m_sapFrameMs = 0.0;		// Per frame after the first
+	double m_bruteFrameMs = 0.0;	// Per frame that was checked
+	double m_avgSwaps = 0.0;
+	double m_avgPairs = 0.0;
+	bool m_matched = true;
+};
+
+static BenchResult BenchBodies(unsigned int a_numBodies, int a_numFrames, int a_checkEvery)
+{
+	// Keep the density the same whatever the body count, a level is much wider than it is tall
+	const float spacing = 3.0f;
+	const float side = sqrtf((float)a_numBodies / 4.0f) * spacing;
+	const Vector levelSize(side * 2.0f, side * 2.0f, 4.0f * spacing);
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<Body> bodies(a_numBodies);
+	for (unsigned int i = 0; i < a_numBodies; ++i)
+	{
+		Body & body = bodies[i];
+		body.m_pos = Vector(unit(rng) * levelSize.GetX(), unit(rng) * levelSize.GetY(), unit(rng) * levelSize.GetZ());
+		body.m_vel = Vector(unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f) * 8.0f;
+		body.m_radius = 0.5f + unit(rng);
+		body.m_group = (int)(i % s_numGroups);
+	}
+
+	SweepAndPrune broadphase;
+	for (Body & body : bodies)
+	{
+		broadphase.Add(&body);
+	}
+
+	BenchResult result;
+	std::vector<SweepAndPrune::Pair> pairs;
+	std::vector<IndexPair> sapPairs;
+	std::vector<IndexPair> brutePairs;
+	int numChecks = 0;
+	const float dt = 1.0f / 60.0f;
+	for (int frame = 0; frame < a_numFrames; ++frame)
+	{
+		MoveBodies(bodies, levelSize, dt);
+
+		const Clock::time_point start = Clock::now();
+		UpdateProxies(broadphase);
+		broadphase.FindPairs(pairs);
+		const double frameMs = ElapsedNs(start, Clock::now()) / 1000000.0;
+		if (frame == 0)
+		{
+			result.m_firstFrameMs = frameMs;
+		}
+		else
+		{
+			result.m_sapFrameMs += frameMs;
+			result.m_avgSwaps += broadphase.GetNumSwaps();
+		}
+		result.m_avgPairs += pairs.size();
+
+		if (frame % a_checkEvery == 0 || frame == a_numFrames - 1)
+		{
+			const Clock::time_point bruteStart = Clock::now();
+			FindPairsBruteForce(bodies, brutePairs);
+			result.m_bruteFrameMs += ElapsedNs(bruteStart, Clock::now()) / 1000000.0;
+			++numChecks;
+
+			sapPairs.clear();
+			for (const SweepAndPrune::Pair & pair : pairs)
+			{
+				const unsigned int indexA = (unsigned int)(static_cast<Body *>(pair.m_userDataA) - bodies.data());
+				const unsigned int indexB = (unsigned int)(static_cast<Body *>(pair.m_userDataB) - bodies.data());
+				sapPairs.push_back(MakeIndexPair(indexA, indexB));
+			}
+			std::sort(sapPairs.begin(), sapPairs.end());
+			if (sapPairs != brutePairs || std::adjacent_find(sapPairs.begin(), sapPairs.end()) != sapPairs.end())
+			{
+				result.m_matched = false;
+			}
+		}
+	}
+
+	result.m_sapFrameMs /= (a_numFrames - 1);
+	result.m_avgSwaps /= (a_numFrames - 1);
+	result.m_avgPairs /= a_numFrames;
+	result.m_bruteFrameMs /= numChecks;
+	return result;
+}
+
+// Removing and adding proxies mid simulation must not lose or duplicate pairs
+static bool CheckMembershipChanges()
+{
+	std::vector<Body> bodies(64);
+	for (unsigned int i = 0; i < bodies.size(); ++i)
+	{
+		bodies[i].m_pos = Vector((float)i, 0.0f, 0.0f);
+		bodies[i].m_vel = Vector::Zero();
+		bodies[i].m_radius = 0.75f;
+		bodies[i].m_group = 0;
+	}
+
+	SweepAndPrune broadphase;
+	for (Body & body : bodies)
+	{
+		broadphase.Add(&body);
+	}
+	std::vector<SweepAndPrune::Pair> pairs;
+	UpdateProxies(broadphase);
+	broadphase.FindPairs(pairs);
+	if (pairs.size() != bodies.size() - 1)
+	{
+		return false;
+	}
+
+	// Take every other body out then put one back, only its neighbours should pair with it
+	for (unsigned int i = 0; i < bodies.size(); i += 2)
+	{
+		broadphase.Remove(&bodies[i]);
+	}
+	broadphase.Add(&bodies[10]);
+	UpdateProxies(broadphase);
+	broadphase.FindPairs(pairs);
+	return pairs.size() == 2 && broadphase.GetNumProxies() == bodies.size() / 2 + 1 && !broadphase.Remove(&bodies[0]);
+}
+
+int main()
+{
+	bool passed = CheckMembershipChanges();
+	if (!passed)
+	{
+		printf("FAIL: pairs wrong after adding and removing proxies\n");
+	}
+
+	printf("%-8s %12s %12s %12s %10s %10s %9s\n", "bodies", "first frame", "sap frame", "brute frame", "swaps", "pairs", "speedup");
+	const unsigned int bodyCounts[] = { 1000, 5000, 20000 };
+	for (unsigned int numBodies : bodyCounts)
+	{
+		const BenchResult result = BenchBodies(numBodies, 120, numBodies > 5000 ? 60 : 20);
+		printf("%-8u %10.3fms %10.3fms %10.3fms %10.0f %10.0f %8.1fx\n", numBodies, result.m_firstFrameMs, result.m_sapFrameMs,
+			result.m_bruteFrameMs, result.m_avgSwaps, result.m_avgPairs, result.m_bruteFrameMs / result.m_sapFrameMs);
+		if (!result.m_matched)
+		{
+			printf("  FAIL: pairs differ from brute force with %u bodies\n", numBodies);
+			passed = false;
+		}
+	}
+
+	printf("\n=== %s ===\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
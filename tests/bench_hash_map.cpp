@@ -0,0 +1,250 @@
+// Benchmark for core/HashMap.h against std::unordered_map
+// Uses the key patterns the engine relies on: CRC32 hashes of model paths, texture paths cast to int
+// and log message hashes that are mostly looked up and rarely inserted
+//
+// Build: bazel build -c opt //tests:bench_hash_map
+// Run:   bazel-bin/tests/bench_hash_map
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "../core/HashMap.h"
+
+// Same CRC32 as StringHash::GenerateCRC so the keys match what the managers see
+static unsigned int s_crcTable[256];
+
+static void InitCRCTable()
+{
+	for (unsigned int i = 0; i < 256; ++i)
+	{
+		unsigned int crc = i;
+		for (int bit = 0; bit < 8; ++bit)
+		{
+			crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+		}
+		s_crcTable[i] = crc;
+	}
+}
+
+static unsigned int GenerateCRC(const char * a_string)
+{
+	unsigned int crc = 0xFFFFFFFFu;
+	for (const char * c = a_string; *c != '\0'; ++c)
+	{
+		const unsigned char lower = (unsigned char)((*c >= 'A' && *c <= 'Z') ? *c + 32 : *c);
+		crc = (crc >> 8) ^ s_crcTable[(crc ^ lower) & 0xFF];
+	}
+	return crc ^ 0xFFFFFFFFu;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedNs(Clock::time_point a_start, Clock::time_point a_end)
+{
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(a_end - a_start).count();
+}
+
+struct BenchResult
+{
+	double m_insertNs = 0.0;		// Per insert
+	double m_lookupNs = 0.0;		// Per lookup
+	double m_removeNs = 0.0;		// Per remove
+	unsigned long long m_checksum = 0;
+};
+
+// Insert every key, look them all up many times as the managers do each frame, look up keys that
+// are not present, then remove half. Inserts are measured growing from empty and into a map reserved
+// up front, which is what the managers do as their pools cap how many elements there can be
+template <typename TKey>
+static BenchResult BenchEngineMap(const std::vector<TKey> & a_keys, const std::vector<TKey> & a_missingKeys, int a_lookupPasses, bool a_reserve)
+{
+	BenchResult result;
+	HashMap<TKey, void *> map;
+	if (a_reserve)
+	{
+		map.Reserve((unsigned int)a_keys.size());
+	}
+
+	Clock::time_point start = Clock::now();
+	for (size_t i = 0; i < a_keys.size(); ++i)
+	{
+		map.Insert(a_keys[i], (void *)(i + 1));
+	}
+	result.m_insertNs = ElapsedNs(start, Clock::now()) / a_keys.size();
+
+	start = Clock::now();
+	for (int pass = 0; pass < a_lookupPasses; ++pass)
+	{
+		for (const TKey & key : a_keys)
+		{
+			void * value = nullptr;
+			if (map.Get(key, value))
+			{
+				result.m_checksum += (unsigned long long)value;
+			}
+		}
+		for (const TKey & key : a_missingKeys)
+		{
+			result.m_checksum += map.Contains(key) ? 1 : 0;
+		}
+	}
+	result.m_lookupNs = ElapsedNs(start, Clock::now()) / ((a_keys.size() + a_missingKeys.size()) * a_lookupPasses);
+
+	start = Clock::now();
+	for (size_t i = 0; i < a_keys.size(); i += 2)
+	{
+		result.m_checksum += map.Remove(a_keys[i]) ? 1 : 0;
+	}
+	result.m_removeNs = ElapsedNs(start, Clock::now()) / (a_keys.size() / 2);
+	result.m_checksum += map.GetLength();
+	return result;
+}
+
+template <typename TKey>
+static BenchResult BenchStdMap(const std::vector<TKey> & a_keys, const std::vector<TKey> & a_missingKeys, int a_lookupPasses, bool a_reserve)
+{
+	BenchResult result;
+	std::unordered_map<TKey, void *> map;
+	if (a_reserve)
+	{
+		map.reserve(a_keys.size());
+	}
+
+	Clock::time_point start = Clock::now();
+	for (size_t i = 0; i < a_keys.size(); ++i)
+	{
+		map[a_keys[i]] = (void *)(i + 1);
+	}
+	result.m_insertNs = ElapsedNs(start, Clock::now()) / a_keys.size();
+
+	start = Clock::now();
+	for (int pass = 0; pass < a_lookupPasses; ++pass)
+	{
+		for (const TKey & key : a_keys)
+		{
+			auto found = map.find(key);
+			if (found != map.end())
+			{
+				result.m_checksum += (unsigned long long)found->second;
+			}
+		}
+		for (const TKey & key : a_missingKeys)
+		{
+			result.m_checksum += map.count(key) > 0 ? 1 : 0;
+		}
+	}
+	result.m_lookupNs = ElapsedNs(start, Clock::now()) / ((a_keys.size() + a_missingKeys.size()) * a_lookupPasses);
+
+	start = Clock::now();
+	for (size_t i = 0; i < a_keys.size(); i += 2)
+	{
+		result.m_checksum += map.erase(a_keys[i]) > 0 ? 1 : 0;
+	}
+	result.m_removeNs = ElapsedNs(start, Clock::now()) / (a_keys.size() / 2);
+	result.m_checksum += map.size();
+	return result;
+}
+
+// Log::WriteOnce hashes the format string and inserts it the first time, almost every call is a repeat
+static BenchResult BenchWriteOnce(bool a_useEngineMap, const std::vector<unsigned int> & a_messageHashes, int a_numCalls)
+{
+	BenchResult result;
+	HashMap<unsigned int, void *> engineMap;
+	std::unordered_map<unsigned int, void *> stdMap;
+
+	const Clock::time_point start = Clock::now();
+	for (int i = 0; i < a_numCalls; ++i)
+	{
+		// Skewed so a few messages are repeated constantly, like a warning in a per frame loop
+		const unsigned int msg = a_messageHashes[(i * 7 + (i >> 4)) % (i < 1000 ? a_messageHashes.size() : 32)];
+		const bool firstTime = a_useEngineMap ? engineMap.Insert(msg, nullptr) : stdMap.emplace(msg, nullptr).second;
+		result.m_checksum += firstTime ? 1 : 0;
+	}
+	result.m_lookupNs = ElapsedNs(start, Clock::now()) / a_numCalls;
+	return result;
+}
+
+// Run both maps growing and reserved over the same keys
+template <typename TKey>
+static bool Report(const char * a_name, const std::vector<TKey> & a_keys, const std::vector<TKey> & a_missingKeys, int a_lookupPasses)
+{
+	const char * names[4] = { "HashMap", "HashMap reserve", "std::unordered_map", "std::unordered_map reserve" };
+	const BenchResult results[4] =
+	{
+		BenchEngineMap(a_keys, a_missingKeys, a_lookupPasses, false),
+		BenchEngineMap(a_keys, a_missingKeys, a_lookupPasses, true),
+		BenchStdMap(a_keys, a_missingKeys, a_lookupPasses, false),
+		BenchStdMap(a_keys, a_missingKeys, a_lookupPasses, true),
+	};
+
+	bool passed = true;
+	printf("%-28s %10s %10s %10s\n", a_name, "insert", "lookup", "remove");
+	for (int i = 0; i < 4; ++i)
+	{
+		printf("  %-26s %8.2fns %8.2fns %8.2fns\n", names[i], results[i].m_insertNs, results[i].m_lookupNs, results[i].m_removeNs);
+		if (results[i].m_checksum != results[0].m_checksum)
+		{
+			printf("  FAIL: results differ %llu vs %llu\n", results[i].m_checksum, results[0].m_checksum);
+			passed = false;
+		}
+	}
+	return passed;
+}
+
+int main()
+{
+	InitCRCTable();
+	const int lookupPasses = 200;
+	bool passed = true;
+
+	// ModelManager keys models by the CRC of their path
+	std::vector<unsigned int> modelKeys;
+	std::vector<unsigned int> missingModelKeys;
+	char path[256];
+	for (int i = 0; i < 2000; ++i)
+	{
+		snprintf(path, sizeof(path), "c:/Projects/Game/mesh/level%d/prop%d.obj", i / 100, i);
+		modelKeys.push_back(GenerateCRC(path));
+		snprintf(path, sizeof(path), "c:/Projects/Game/mesh/level%d/unloaded%d.obj", i / 100, i);
+		missingModelKeys.push_back(GenerateCRC(path));
+	}
+	passed &= Report("Model path CRC", modelKeys, missingModelKeys, lookupPasses);
+
+	// TextureManager stores the same CRC in a signed int
+	std::vector<int> textureKeys;
+	std::vector<int> missingTextureKeys;
+	for (int i = 0; i < 4000; ++i)
+	{
+		snprintf(path, sizeof(path), "c:/Projects/Game/tex/material%d_%s.tga", i / 3, (i % 3) == 0 ? "diffuse" : (i % 3) == 1 ? "normal" : "specular");
+		textureKeys.push_back((int)GenerateCRC(path));
+		snprintf(path, sizeof(path), "c:/Projects/Game/gui/missing%d.tga", i);
+		missingTextureKeys.push_back((int)GenerateCRC(path));
+	}
+	passed &= Report("Texture path CRC (int)", textureKeys, missingTextureKeys, lookupPasses);
+
+	// Log write once set
+	std::vector<unsigned int> messageHashes;
+	char message[256];
+	for (int i = 0; i < 500; ++i)
+	{
+		snprintf(message, sizeof(message), "Too many primitives of type %d added for renderLayer %%d, max is %%d", i);
+		messageHashes.push_back(GenerateCRC(message));
+	}
+	const int numCalls = 2000000;
+	BenchResult engineLog = BenchWriteOnce(true, messageHashes, numCalls);
+	BenchResult stdLog = BenchWriteOnce(false, messageHashes, numCalls);
+	printf("%-28s %10s\n", "Log write once", "call");
+	printf("  %-26s %8.2fns\n", "HashMap", engineLog.m_lookupNs);
+	printf("  %-26s %8.2fns\n", "std::unordered_map", stdLog.m_lookupNs);
+	if (engineLog.m_checksum != stdLog.m_checksum)
+	{
+		printf("  FAIL: results differ %llu vs %llu\n", engineLog.m_checksum, stdLog.m_checksum);
+		passed = false;
+	}
+
+	printf("\n=== %s ===\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// Benchmark for core/JobSystem.h
+// Measures the cost of scheduling an empty job and how a parallel for over a math heavy loop
+// scales from running everything on the calling thread up to one worker per hardware thread.
+// Checks results along the way so it can run as a smoke test for the scheduler.
+//
+// Build: bazel build -c opt //tests:bench_job_system
+// Run:   bazel-bin/tests/bench_job_system
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../core/JobSystem.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedNs(Clock::time_point a_start, Clock::time_point a_end)
+{
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(a_end - a_start).count();
+}
+
+static void EmptyJob(Job *, void *)
+{
+}
+
+// Time to create, queue, run and wait for jobs that do nothing, batched under a parent like a frame's work would be
+static double BenchSchedulingOverhead(JobSystem & a_jobs, int a_numBatches, int a_jobsPerBatch)
+{
+	const Clock::time_point start = Clock::now();
+	for (int batch = 0; batch < a_numBatches; ++batch)
+	{
+		Job * root = a_jobs.CreateJob(&EmptyJob);
+		for (int i = 0; i < a_jobsPerBatch; ++i)
+		{
+			a_jobs.Run(a_jobs.CreateChildJob(root, &EmptyJob));
+		}
+		a_jobs.Run(root);
+		a_jobs.Wait(root);
+	}
+	return ElapsedNs(start, Clock::now()) / ((double)a_numBatches * a_jobsPerBatch);
+}
+
+// Something like a transform update per element, enough work that the split is worth doing
+static void UpdateRange(std::vector<float> & a_values, unsigned int a_begin, unsigned int a_end)
+{
+	for (unsigned int i = a_begin; i < a_end; ++i)
+	{
+		float v = a_values[i];
+		for (int iter = 0; iter < 16; ++iter)
+		{
+			v = sinf(v) * 0.5f + sqrtf(fabsf(v) + 1.0f);
+		}
+		a_values[i] = v;
+	}
+}
+
+static double BenchParallelFor(JobSystem & a_jobs, std::vector<float> & a_values, unsigned int a_grainSize, int a_passes)
+{
+	const Clock::time_point start = Clock::now();
+	for (int pass = 0; pass < a_passes; ++pass)
+	{
+		a_jobs.ParallelFor(0, (unsigned int)a_values.size(), a_grainSize, [&a_values](unsigned int a_begin, unsigned int a_end)
+		{
+			UpdateRange(a_values, a_begin, a_end);
+		});
+	}
+	return ElapsedNs(start, Clock::now()) / a_passes;
+}
+
+// Continuations must only start after the ancestor and all of its children have finished
+static bool CheckDependencies(JobSystem & a_jobs)
+{
+	std::atomic<int> childrenDone(0);
+	std::atomic<int> seenByContinuation(-1);
+	const int numChildren = 500;
+
+	Job * root = a_jobs.CreateJob([](){});
+	for (int i = 0; i < numChildren; ++i)
+	{
+		a_jobs.Run(a_jobs.CreateChildJob(root, [&childrenDone]() { childrenDone.fetch_add(1); }));
+	}
+	Job * continuation = a_jobs.CreateJob([&childrenDone, &seenByContinuation]() { seenByContinuation = childrenDone.load(); });
+	a_jobs.AddContinuation(root, continuation);
+	a_jobs.Run(root);
+	a_jobs.Wait(root);
+	a_jobs.Wait(continuation);
+	return seenByContinuation.load() == numChildren;
+}
+
+// Every index is visited exactly once whatever the grain size
+static bool CheckParallelForCoverage(JobSystem & a_jobs)
+{
+	const unsigned int count = 100003;
+	std::vector<std::atomic<int>> visits(count);
+	for (std::atomic<int> & visit : visits)
+	{
+		visit = 0;
+	}
+	const unsigned int grainSizes[] = { 1, 7, 64, 1000, count };
+	for (unsigned int grainSize : grainSizes)
+	{
+		a_jobs.ParallelFor(0, count, grainSize, [&visits](unsigned int a_begin, unsigned int a_end)
+		{
+			for (unsigned int i = a_begin; i < a_end; ++i)
+			{
+				visits[i].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+	for (std::atomic<int> & visit : visits)
+	{
+		if (visit.load() != (int)(sizeof(grainSizes) / sizeof(grainSizes[0])))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	const unsigned int maxWorkers = JobSystem::GetDefaultNumWorkers();
+	const unsigned int numValues = 1 << 18;
+	const unsigned int grainSize = 1024;
+	const int passes = 8;
+	bool passed = true;
+
+	// Reference result computed on one thread without the job system
+	std::vector<float> reference(numValues);
+	for (unsigned int i = 0; i < numValues; ++i)
+	{
+		reference[i] = (float)i * 0.001f;
+	}
+	const Clock::time_point serialStart = Clock::now();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		UpdateRange(reference, 0, numValues);
+	}
+	const double serialNs = ElapsedNs(serialStart, Clock::now()) / passes;
+
+	printf("%-10s %14s %14s %10s\n", "workers", "ns per job", "parallel for", "speedup");
+	printf("%-10s %14s %12.2fms %9.2fx\n", "serial", "-", serialNs / 1000000.0, 1.0);
+
+	for (unsigned int numWorkers = 0; numWorkers <= maxWorkers; ++numWorkers)
+	{
+		JobSystem jobs;
+		jobs.Startup(numWorkers);
+
+		passed &= CheckDependencies(jobs);
+		passed &= CheckParallelForCoverage(jobs);
+
+		const double perJobNs = BenchSchedulingOverhead(jobs, 2000, 1000);
+
+		std::vector<float> values(numValues);
+		for (unsigned int i = 0; i < numValues; ++i)
+		{
+			values[i] = (float)i * 0.001f;
+		}
+		const double parallelNs = BenchParallelFor(jobs, values, grainSize, passes);
+		if (values != reference)
+		{
+			printf("  FAIL: parallel for result differs with %u workers\n", numWorkers);
+			passed = false;
+		}
+
+		printf("%-10u %12.2fns %12.2fms %9.2fx\n", numWorkers, perJobNs, parallelNs / 1000000.0, serialNs / parallelNs);
+		jobs.Shutdown();
+	}
+
+	printf("\n=== %s ===\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,308 @@
+// Benchmark and stress test for engine/PhysicsManager.cpp without the rest of the game
+// Builds a level of spheres, boxes and axis boxes falling onto a floor between a few static obstacles and steps
+// the physics manager at a fixed rate, timing each update and counting the pairs tested, contacts found and
+// memory allocated. Nothing is drawn and no window or GL context is made so it runs on any plain machine.
+// Fails if a body ends up somewhere it shouldn't be able to so it can run as a smoke test too, and first checks
+// that spheres thrown at each other bounce off rather than sinking into each other.
+//
+// Build: bazel build -c opt //tests:bench_physics
+// Run:   bazel-bin/tests/bench_physics [--quick] [--threads N]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "../engine/GameFile.h"
+#include "../engine/GameObject.h"
+#include "../engine/JobManager.h"
+#include "../engine/PhysicsManager.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedNs(Clock::time_point a_start, Clock::time_point a_end)
+{
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(a_end - a_start).count();
+}
+
+// Every allocation in the program goes through here so the bytes allocated during an update can be counted
+static std::atomic<size_t> s_bytesAllocated(0);
+static std::atomic<size_t> s_numAllocations(0);
+
+void * operator new(size_t a_size)
+{
+	s_bytesAllocated.fetch_add(a_size, std::memory_order_relaxed);
+	s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void * memory = malloc(a_size > 0 ? a_size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+void * operator new[](size_t a_size) { return operator new(a_size); }
+void operator delete(void * a_memory) noexcept { free(a_memory); }
+void operator delete[](void * a_memory) noexcept { free(a_memory); }
+void operator delete(void * a_memory, size_t) noexcept { free(a_memory); }
+void operator delete[](void * a_memory, size_t) noexcept { free(a_memory); }
+
+static const char * s_configPath = "bench_physics.cfg";
+static const float s_frameTime = 1.0f / 60.0f;
+static const float s_levelSize = 200.0f;
+
+// One collision group that collides with itself, gravity and a fixed step so frame time doesn't matter
+static bool WriteConfig()
+{
+	FILE * configFile = fopen(s_configPath, "w");
+	if (configFile == nullptr)
+	{
+		return false;
+	}
+	fputs("{\n"
+		"\t\"collision\": { \"groups\": { \"group1\": \"body\" }, \"filters\": { \"body\": [ \"body\" ] } },\n"
+		"\t\"physics\": { \"gravity\": [ 0, 0, -10 ], \"fixedStepRate\": 60, \"maxSubSteps\": 4, \"sleepSpeed\": 0.5, \"sleepTime\": 1 }\n"
+		"}\n", configFile);
+	fclose(configFile);
+	return true;
+}
+
+struct BenchResult
+{
+	double m_meanMs = 0.0;
+	double m_p50Ms = 0.0;
+	double m_p99Ms = 0.0;
+	double m_pairTestsPerFrame = 0.0;
+	double m_contactsPerFrame = 0.0;
+	double m_bytesPerFrame = 0.0;
+	double m_allocsPerFrame = 0.0;
+	unsigned int m_numAwake = 0;
+	bool m_passed = true;
+};
+
+static BenchResult BenchScene(unsigned int a_numBodies, int a_numFrames)
+{
+	PhysicsManager & physMan = PhysicsManager::Get();
+	GameFile config(s_configPath);
+	physMan.Startup(config);
+	const int bodyGroup = physMan.GetCollisionGroupId("body");
+
+	std::vector<std::unique_ptr<GameObject>> gameObjects;
+	gameObjects.reserve(a_numBodies + 64);
+	const auto addObject = [&gameObjects, &physMan, bodyGroup](ClipType a_clipType, const Vector & a_pos, const Vector & a_clipSize)
+	{
+		GameObject * gameObj = new GameObject();
+		gameObj->SetId((SlotHandle)(gameObjects.size() + 1));
+		gameObj->SetClipType(a_clipType);
+		gameObj->SetClipSize(a_clipSize);
+		gameObj->SetClipGroup("body", bodyGroup);
+		gameObj->SetPos(a_pos);
+		gameObj->SetActive();
+		gameObjects.emplace_back(gameObj);
+		physMan.AddCollisionObject(gameObj);
+		return gameObj;
+	};
+
+	// Floor and a scattering of static obstacles of each shape for bodies to land on
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	addObject(ClipType::AxisBox, Vector(0.0f, 0.0f, -1.0f), Vector(s_levelSize, s_levelSize, 1.0f));
+	for (int i = 0; i < 48; ++i)
+	{
+		const Vector pos((unit(rng) - 0.5f) * s_levelSize, (unit(rng) - 0.5f) * s_levelSize, 0.5f);
+		switch (i % 3)
+		{
+			case 0: addObject(ClipType::AxisBox, pos, Vector(2.0f, 2.0f, 1.0f)); break;
+			case 1: addObject(ClipType::Box, pos, Vector(1.5f, 3.0f, 1.0f)); break;
+			default: addObject(ClipType::Sphere, pos, Vector(2.0f)); break;
+		}
+	}
+
+	// Bodies start in a cloud over the level with a push so they spread out and pile up
+	const float spawnSize = sqrtf((float)a_numBodies) * 2.0f;
+	for (unsigned int i = 0; i < a_numBodies; ++i)
+	{
+		const Vector pos((unit(rng) - 0.5f) * spawnSize, (unit(rng) - 0.5f) * spawnSize, 2.0f + unit(rng) * 20.0f);
+		GameObject * body = nullptr;
+		switch (i % 3)
+		{
+			case 0: body = addObject(ClipType::Sphere, pos, Vector(0.5f)); break;
+			case 1: body = addObject(ClipType::Box, pos, Vector(0.5f)); break;
+			default: body = addObject(ClipType::AxisBox, pos, Vector(0.5f)); break;
+		}
+		body->SetPhysicsMass(0.5f + unit(rng) * 4.0f);
+		body->SetPhysicsElasticity(0.3f);
+		body->SetPhysicsLinearDrag(0.1f);
+		physMan.AddPhysicsObject(body);
+		physMan.ApplyForce(body, Vector(unit(rng) - 0.5f, unit(rng) - 0.5f, 0.0f) * 20.0f);
+	}
+
+	// Let containers grow to size before measuring so the allocation count shows the steady state
+	const int numWarmupFrames = 10;
+	for (int frame = 0; frame < numWarmupFrames; ++frame)
+	{
+		physMan.Update(s_frameTime);
+	}
+
+	BenchResult result;
+	std::vector<double> frameMs;
+	frameMs.reserve(a_numFrames);
+	double totalPairTests = 0.0;
+	double totalContacts = 0.0;
+	size_t totalBytes = 0;
+	size_t totalAllocs = 0;
+	for (int frame = 0; frame < a_numFrames; ++frame)
+	{
+		const size_t bytesBefore = s_bytesAllocated.load(std::memory_order_relaxed);
+		const size_t allocsBefore = s_numAllocations.load(std::memory_order_relaxed);
+		const Clock::time_point start = Clock::now();
+		physMan.Update(s_frameTime);
+		const Clock::time_point end = Clock::now();
+		totalBytes += s_bytesAllocated.load(std::memory_order_relaxed) - bytesBefore;
+		totalAllocs += s_numAllocations.load(std::memory_order_relaxed) - allocsBefore;
+
+		frameMs.push_back(ElapsedNs(start, end) / 1000000.0);
+		const PhysicsStats & stats = physMan.GetStats();
+		totalPairTests += stats.m_numPairTests;
+		totalContacts += stats.m_numContacts;
+	}
+
+	std::sort(frameMs.begin(), frameMs.end());
+	double sumMs = 0.0;
+	for (double ms : frameMs)
+	{
+		sumMs += ms;
+	}
+	result.m_meanMs = sumMs / a_numFrames;
+	result.m_p50Ms = frameMs[frameMs.size() / 2];
+	result.m_p99Ms = frameMs[std::min(frameMs.size() - 1, (frameMs.size() * 99) / 100)];
+	result.m_pairTestsPerFrame = totalPairTests / a_numFrames;
+	result.m_contactsPerFrame = totalContacts / a_numFrames;
+	result.m_bytesPerFrame = (double)totalBytes / a_numFrames;
+	result.m_allocsPerFrame = (double)totalAllocs / a_numFrames;
+	result.m_numAwake = physMan.GetStats().m_numAwakeBodies;
+
+	// Nothing should have stopped being a number, and spheres over the floor should still be on top of it. Bodies
+	// knocked off the edge fall forever so only the middle of the floor is checked. Box against box pairs are found
+	// but don't have a contact normal to respond along yet, so the boxes are only timed.
+	for (const auto & gameObj : gameObjects)
+	{
+		const Vector pos = gameObj->GetPos();
+		const bool finite = std::isfinite(pos.GetX()) && std::isfinite(pos.GetY()) && std::isfinite(pos.GetZ());
+		const bool overFloor = fabsf(pos.GetX()) < s_levelSize * 0.5f && fabsf(pos.GetY()) < s_levelSize * 0.5f;
+		const bool tunnelled = gameObj->GetClipType() == ClipType::Sphere && overFloor && pos.GetZ() < -2.0f;
+		if (!finite || tunnelled)
+		{
+			printf("  FAIL: %u bodies, object %u ended up at %f, %f, %f\n", a_numBodies, (unsigned int)gameObj->GetId(), pos.GetX(), pos.GetY(), pos.GetZ());
+			result.m_passed = false;
+			break;
+		}
+	}
+	if (totalContacts == 0.0)
+	{
+		printf("  FAIL: %u bodies never touched anything\n", a_numBodies);
+		result.m_passed = false;
+	}
+
+	physMan.Shutdown();
+	return result;
+}
+
+// A sphere thrown at a resting one has to bounce back rather than sink into it, whichever side of the pair it is.
+// The lower id is side A of a contact so the throw is tried from both, high enough above the floor to miss it.
+static bool TestSphereCollision()
+{
+	PhysicsManager & physMan = PhysicsManager::Get();
+	GameFile config(s_configPath);
+	physMan.Startup(config);
+	const int bodyGroup = physMan.GetCollisionGroupId("body");
+
+	GameObject spheres[4];
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		// Throws happen along x, 10 units apart in y so the two throws never meet
+		const bool thrown = i == 0 || i == 3;
+		const float startX = i < 2 ? (thrown ? -2.0f : 0.0f) : (thrown ? 2.0f : 0.0f);
+		GameObject & sphere = spheres[i];
+		sphere.SetId((SlotHandle)(i + 1));
+		sphere.SetClipType(ClipType::Sphere);
+		sphere.SetClipSize(Vector(0.5f));
+		sphere.SetClipGroup("body", bodyGroup);
+		sphere.SetPos(Vector(startX, i < 2 ? 0.0f : 10.0f, 100.0f));
+		sphere.SetActive();
+		sphere.SetPhysicsMass(1.0f);
+		sphere.SetPhysicsElasticity(0.3f);
+		physMan.AddCollisionObject(&sphere);
+		physMan.AddPhysicsObject(&sphere);
+	}
+	physMan.ApplyForce(&spheres[0], Vector(10.0f, 0.0f, 0.0f));
+	physMan.ApplyForce(&spheres[3], Vector(-10.0f, 0.0f, 0.0f));
+	for (int frame = 0; frame < 60; ++frame)
+	{
+		physMan.Update(s_frameTime);
+	}
+
+	bool passed = true;
+	const float lowIdGap = spheres[1].GetPos().GetX() - spheres[0].GetPos().GetX();
+	const float highIdGap = spheres[3].GetPos().GetX() - spheres[2].GetPos().GetX();
+	if (lowIdGap < 1.0f || highIdGap < 1.0f)
+	{
+		printf("  FAIL: thrown spheres ended up inside the spheres they hit, gaps %f from the lower id and %f from the higher id\n", lowIdGap, highIdGap);
+		passed = false;
+	}
+	physMan.Shutdown();
+	return passed;
+}
+
+int main(int argc, char ** argv)
+{
+	bool quick = false;
+	unsigned int numWorkers = JobSystem::GetDefaultNumWorkers();
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--quick") == 0)
+		{
+			quick = true;
+		}
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			const int numThreads = atoi(argv[++i]);
+			numWorkers = numThreads > 1 ? (unsigned int)numThreads - 1 : 0;
+		}
+	}
+
+	if (!WriteConfig())
+	{
+		printf("FAIL: can't write the physics config\n");
+		return 1;
+	}
+	JobManager & jobMan = JobManager::Get();
+	static_cast<JobSystem &>(jobMan).Startup(numWorkers);
+
+	const int numFrames = quick ? 120 : 600;
+	printf("%u threads, %d frames at %.4fs\n\n", numWorkers + 1, numFrames, s_frameTime);
+	printf("%-8s %10s %10s %10s %12s %10s %12s %10s %8s\n", "bodies", "mean", "p50", "p99", "pairs/frame", "contacts", "bytes/frame", "allocs", "awake");
+	bool passed = TestSphereCollision();
+	const unsigned int bodyCounts[] = { 250, 1000, 4000 };
+	for (unsigned int numBodies : bodyCounts)
+	{
+		if (quick && numBodies > 1000)
+		{
+			continue;
+		}
+		const BenchResult result = BenchScene(numBodies, numFrames);
+		printf("%-8u %8.3fms %8.3fms %8.3fms %12.0f %10.0f %12.0f %10.1f %8u\n", numBodies, result.m_meanMs, result.m_p50Ms, result.m_p99Ms,
+			result.m_pairTestsPerFrame, result.m_contactsPerFrame, result.m_bytesPerFrame, result.m_allocsPerFrame, result.m_numAwake);
+		passed &= result.m_passed;
+	}
+
+	jobMan.Shutdown();
+	remove(s_configPath);
+	printf("\n=== %s ===\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
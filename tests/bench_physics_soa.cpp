@@ -0,0 +1,224 @@
+// Benchmark for core/DynamicBodies.h against the array of physics objects the physics manager used to step
+// Integrates the same bodies both ways and times a frame of integration plus writing positions back to the
+// objects that own them. The end states are compared so it can run as a smoke test for the SIMD kernels.
+//
+// Build: bazel build -c opt //tests:bench_physics_soa
+// Run:   bazel-bin/tests/bench_physics_soa
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../core/DynamicBodies.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedNs(Clock::time_point a_start, Clock::time_point a_end)
+{
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(a_end - a_start).count();
+}
+
+// Stand in for a game object, mass and drag live with the rest of its properties and its transform is written each frame
+struct Owner
+{
+	float m_worldMat[16];
+	Vector m_clipOffset;
+	float m_mass;
+	float m_linearDrag;
+	float m_angularDrag;
+	float m_elasticity;
+	char m_name[32];
+};
+
+// Laid out like the old PhysicsObject so each step drags the unused state through the cache too
+struct PhysicsObject
+{
+	Owner * m_owner;
+	Vector m_pos;
+	Vector m_prevPos;
+	float m_rot[4];
+	Vector m_torque;
+	Vector m_inertia;
+	Vector m_force;
+	Vector m_vel;
+	Vector m_acc;
+	Vector m_avgAcc;
+	Vector m_lastAcc;
+};
+
+// What UpdatePhysicsWorld and UpdateGameObjects used to do for each body, minus the rotation
+static void StepAoS(std::vector<PhysicsObject> & a_bodies, const Vector & a_gravity, float a_dt)
+{
+	for (PhysicsObject & body : a_bodies)
+	{
+		const Owner * owner = body.m_owner;
+		const float invMass = owner->m_mass > 0.0f ? 1.0f / owner->m_mass : 0.0f;
+		body.m_prevPos = body.m_pos;
+		if (invMass > 0.0f)
+		{
+			body.m_vel += a_gravity * a_dt * Vector::Up();
+		}
+		body.m_vel += (body.m_force * invMass) * a_dt;
+		body.m_vel *= 1.0f / (1.0f + a_dt * owner->m_linearDrag);
+		body.m_pos += body.m_vel * a_dt;
+	}
+	for (PhysicsObject & body : a_bodies)
+	{
+		Owner * owner = body.m_owner;
+		const Vector pos = body.m_pos + owner->m_clipOffset;
+		owner->m_worldMat[12] = pos.GetX();
+		owner->m_worldMat[13] = pos.GetY();
+		owner->m_worldMat[14] = pos.GetZ();
+	}
+}
+
+static void StepSoA(DynamicBodies & a_bodies, const Vector & a_gravity, float a_dt)
+{
+	a_bodies.StorePreviousPositions();
+	a_bodies.IntegrateEuler(a_gravity, a_dt);
+	for (unsigned int i = 0; i < a_bodies.GetCount(); ++i)
+	{
+		Owner * owner = static_cast<Owner *>(a_bodies.GetOwner(i));
+		const Vector pos = a_bodies.GetPos(i) + owner->m_clipOffset;
+		owner->m_worldMat[12] = pos.GetX();
+		owner->m_worldMat[13] = pos.GetY();
+		owner->m_worldMat[14] = pos.GetZ();
+	}
+}
+
+static bool IsClose(const Vector & a_vecA, const Vector & a_vecB)
+{
+	const Vector diff = a_vecA - a_vecB;
+	const float scale = 1.0f + a_vecA.Length();
+	return fabsf(diff.GetX()) < 1e-4f * scale && fabsf(diff.GetY()) < 1e-4f * scale && fabsf(diff.GetZ()) < 1e-4f * scale;
+}
+
+// Bodies removed from the middle must leave the others where they were with working handles
+static bool CheckHandles()
+{
+	Owner owners[10];
+	DynamicBodies bodies;
+	SlotHandle handles[10];
+	for (int i = 0; i < 10; ++i)
+	{
+		handles[i] = bodies.Add(&owners[i], Vector((float)i, 0.0f, 0.0f), 1.0f, 0.0f);
+	}
+	bodies.Remove(handles[2]);
+	bodies.Remove(handles[7]);
+	bodies.AddImpulse(bodies.GetIndex(handles[9]), Vector(0.0f, 1.0f, 0.0f));
+	bodies.IntegrateEuler(Vector::Zero(), 1.0f);
+
+	if (bodies.GetCount() != 8 || bodies.GetIndex(handles[2]) != DynamicBodies::s_invalidIndex || bodies.Remove(handles[7]))
+	{
+		return false;
+	}
+	for (int i = 0; i < 10; ++i)
+	{
+		if (i == 2 || i == 7)
+		{
+			continue;
+		}
+		const unsigned int index = bodies.GetIndex(handles[i]);
+		const Vector expected((float)i, i == 9 ? 1.0f : 0.0f, 0.0f);
+		if (bodies.GetOwner(index) != &owners[i] || !IsClose(bodies.GetPos(index), expected))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+struct BenchResult
+{
+	double m_aosFrameMs = 0.0;
+	double m_soaFrameMs = 0.0;
+	bool m_matched = true;
+};
+
+static BenchResult BenchBodies(unsigned int a_numBodies, int a_numFrames)
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<Owner> aosOwners(a_numBodies);
+	std::vector<Owner> soaOwners(a_numBodies);
+	std::vector<PhysicsObject> aosBodies(a_numBodies);
+	DynamicBodies soaBodies;
+	for (unsigned int i = 0; i < a_numBodies; ++i)
+	{
+		Owner owner = {};
+		owner.m_clipOffset = Vector(0.0f, 0.0f, 0.5f);
+		owner.m_mass = i % 16 == 0 ? 0.0f : 0.5f + unit(rng) * 4.0f;
+		owner.m_linearDrag = unit(rng) * 0.5f;
+		aosOwners[i] = owner;
+		soaOwners[i] = owner;
+
+		const Vector pos(unit(rng) * 100.0f, unit(rng) * 100.0f, unit(rng) * 10.0f);
+		const Vector force(unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f);
+		PhysicsObject body = {};
+		body.m_owner = &aosOwners[i];
+		body.m_pos = pos;
+		body.m_prevPos = pos;
+		body.m_force = force;
+		aosBodies[i] = body;
+
+		const unsigned int index = soaBodies.GetIndex(soaBodies.Add(&soaOwners[i], pos, owner.m_mass, owner.m_linearDrag));
+		soaBodies.SetForce(index, force);
+	}
+
+	BenchResult result;
+	const Vector gravity(0.0f, 0.0f, -9.8f);
+	const float dt = 1.0f / 60.0f;
+	Clock::time_point start = Clock::now();
+	for (int frame = 0; frame < a_numFrames; ++frame)
+	{
+		StepAoS(aosBodies, gravity, dt);
+	}
+	result.m_aosFrameMs = ElapsedNs(start, Clock::now()) / 1000000.0 / a_numFrames;
+
+	start = Clock::now();
+	for (int frame = 0; frame < a_numFrames; ++frame)
+	{
+		StepSoA(soaBodies, gravity, dt);
+	}
+	result.m_soaFrameMs = ElapsedNs(start, Clock::now()) / 1000000.0 / a_numFrames;
+
+	for (unsigned int i = 0; i < a_numBodies; ++i)
+	{
+		const Vector aosPos(aosOwners[i].m_worldMat[12], aosOwners[i].m_worldMat[13], aosOwners[i].m_worldMat[14]);
+		const Vector soaPos(soaOwners[i].m_worldMat[12], soaOwners[i].m_worldMat[13], soaOwners[i].m_worldMat[14]);
+		if (!IsClose(aosPos, soaPos) || !IsClose(aosBodies[i].m_vel, soaBodies.GetVelocity(i)))
+		{
+			result.m_matched = false;
+			break;
+		}
+	}
+	return result;
+}
+
+int main()
+{
+	bool passed = CheckHandles();
+	if (!passed)
+	{
+		printf("FAIL: bodies wrong after removing from the middle\n");
+	}
+
+	printf("%-8s %12s %12s %14s %9s\n", "bodies", "aos frame", "soa frame", "soa bodies/s", "speedup");
+	const unsigned int bodyCounts[] = { 1000, 10000, 100000 };
+	for (unsigned int numBodies : bodyCounts)
+	{
+		const BenchResult result = BenchBodies(numBodies, 300);
+		printf("%-8u %10.3fms %10.3fms %13.1fM %8.1fx\n", numBodies, result.m_aosFrameMs, result.m_soaFrameMs,
+			numBodies / result.m_soaFrameMs / 1000.0, result.m_aosFrameMs / result.m_soaFrameMs);
+		if (!result.m_matched)
+		{
+			printf("  FAIL: SoA positions differ from AoS with %u bodies\n", numBodies);
+			passed = false;
+		}
+	}
+
+	printf("\n=== %s ===\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
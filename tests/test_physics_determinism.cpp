@@ -0,0 +1,144 @@
+// Test that the parallel narrowphase in engine/PhysicsManager.cpp doesn't change the simulation
+// Drops the same pile of spheres and boxes onto a floor with the job system running one thread and then
+// several, and checks every object ends up at exactly the same position. Contacts are found on whichever
+// thread picks up their pair, so this only passes if they are resolved in an order that doesn't depend on it.
+// Runs headless, nothing is drawn and no window is opened.
+//
+// Build: bazel build -c opt //tests:test_physics_determinism
+// Run:   bazel-bin/tests/test_physics_determinism
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../engine/GameFile.h"
+#include "../engine/GameObject.h"
+#include "../engine/JobManager.h"
+#include "../engine/PhysicsManager.h"
+
+static const char * s_configPath = "test_physics_determinism.cfg";
+
+// One collision group that collides with itself, gravity and a fixed step so frame time doesn't matter
+static bool WriteConfig()
+{
+	FILE * configFile = fopen(s_configPath, "w");
+	if (configFile == nullptr)
+	{
+		return false;
+	}
+	fputs("{\n"
+		"\t\"collision\": { \"groups\": { \"group1\": \"body\" }, \"filters\": { \"body\": [ \"body\" ] } },\n"
+		"\t\"physics\": { \"gravity\": [ 0, 0, -10 ], \"fixedStepRate\": 60, \"maxSubSteps\": 4, \"sleepSpeed\": 0.5, \"sleepTime\": 1 }\n"
+		"}\n", configFile);
+	fclose(configFile);
+	return true;
+}
+
+// Step a scene from the same start with the job system running a number of threads
+static std::vector<Vector> RunScene(unsigned int a_numWorkers, unsigned int a_numBodies, int a_numFrames, unsigned int & a_numContacts_OUT)
+{
+	JobManager & jobMan = JobManager::Get();
+	static_cast<JobSystem &>(jobMan).Startup(a_numWorkers);
+	PhysicsManager & physMan = PhysicsManager::Get();
+	GameFile config(s_configPath);
+	physMan.Startup(config);
+	const int bodyGroup = physMan.GetCollisionGroupId("body");
+
+	std::vector<std::unique_ptr<GameObject>> gameObjects;
+	const auto addObject = [&gameObjects, bodyGroup](ClipType a_clipType, const Vector & a_pos, const Vector & a_clipSize)
+	{
+		GameObject * gameObj = new GameObject();
+		gameObj->SetId((SlotHandle)(gameObjects.size() + 1));
+		gameObj->SetClipType(a_clipType);
+		gameObj->SetClipSize(a_clipSize);
+		gameObj->SetClipGroup("body", bodyGroup);
+		gameObj->SetPos(a_pos);
+		gameObj->SetActive();
+		gameObjects.emplace_back(gameObj);
+		return gameObj;
+	};
+
+	// A floor for everything to land on
+	GameObject * floor = addObject(ClipType::AxisBox, Vector(0.0f, 0.0f, -1.0f), Vector(100.0f, 100.0f, 1.0f));
+	physMan.AddCollisionObject(floor);
+
+	// A loose grid of bodies close enough to pile into each other, same random start every run
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+	const unsigned int side = 16;
+	for (unsigned int i = 0; i < a_numBodies; ++i)
+	{
+		const Vector pos((float)(i % side) * 1.5f - side * 0.75f + jitter(rng), (float)((i / side) % side) * 1.5f - side * 0.75f + jitter(rng), 2.0f + (float)(i / (side * side)) * 1.5f);
+		GameObject * body = i % 3 == 0 ? addObject(ClipType::AxisBox, pos, Vector(0.5f)) : addObject(ClipType::Sphere, pos, Vector(0.6f));
+		body->SetPhysicsMass(1.0f + (float)(i % 5));
+		body->SetPhysicsElasticity(0.2f);
+		body->SetPhysicsLinearDrag(0.1f);
+		physMan.AddCollisionObject(body);
+		physMan.AddPhysicsObject(body);
+		physMan.ApplyForce(body, Vector(jitter(rng), jitter(rng), 0.0f) * 10.0f);
+	}
+
+	a_numContacts_OUT = 0;
+	for (int frame = 0; frame < a_numFrames; ++frame)
+	{
+		physMan.Update(1.0f / 60.0f);
+		for (const auto & gameObj : gameObjects)
+		{
+			unsigned int numContacts = 0;
+			physMan.GetContacts(gameObj.get(), numContacts);
+			a_numContacts_OUT += numContacts;
+		}
+	}
+
+	std::vector<Vector> positions;
+	for (const auto & gameObj : gameObjects)
+	{
+		positions.push_back(gameObj->GetPos());
+	}
+
+	physMan.Shutdown();
+	jobMan.Shutdown();
+	return positions;
+}
+
+int main()
+{
+	if (!WriteConfig())
+	{
+		printf("FAIL: can't write the physics config\n");
+		return 1;
+	}
+
+	const unsigned int numBodies = 768;
+	const int numFrames = 240;
+	const unsigned int hardwareWorkers = JobSystem::GetDefaultNumWorkers();
+	const unsigned int manyWorkers = hardwareWorkers > 3 ? hardwareWorkers : 3;
+
+	unsigned int singleContacts = 0;
+	unsigned int manyContacts = 0;
+	const std::vector<Vector> single = RunScene(0, numBodies, numFrames, singleContacts);
+	const std::vector<Vector> many = RunScene(manyWorkers, numBodies, numFrames, manyContacts);
+	remove(s_configPath);
+
+	printf("%u bodies over %d frames, %u contacts with 1 thread and %u with %u threads\n", numBodies, numFrames, singleContacts, manyContacts, manyWorkers + 1);
+	bool passed = singleContacts > 0 && singleContacts == manyContacts && single.size() == many.size();
+	if (singleContacts == 0)
+	{
+		printf("FAIL: nothing touched so the narrowphase wasn't tested\n");
+	}
+	for (size_t i = 0; passed && i < single.size(); ++i)
+	{
+		// Bit identical, not just close
+		if (memcmp(&single[i], &many[i], sizeof(Vector)) != 0)
+		{
+			printf("FAIL: object %u ended at %f, %f, %f with 1 thread and %f, %f, %f with %u\n", (unsigned int)i,
+				single[i].GetX(), single[i].GetY(), single[i].GetZ(), many[i].GetX(), many[i].GetY(), many[i].GetZ(), manyWorkers + 1);
+			passed = false;
+		}
+	}
+
+	printf("\n=== %s ===\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}